@@ -0,0 +1,1133 @@
+/** @defgroup dict-bench Moduł dict-bench
+    Program mierzy wydajność wybranych operacji słownika.
+  */
+/** @file
+    Główny plik modułu dict-bench
+
+    Użycie: `dict-bench test słownik zapytania [parametry]`
+
+    Plik z zapytaniami zawiera po jednym słowie w linii. Dostępne testy:
+    - `qgram [maks_koszt]` - porównuje czas generowania podpowiedzi przez
+      przeszukiwanie drzewa i z użyciem indeksu q-gramów dla kosztów od 2 do
+      `maks_koszt` (domyślnie 6) i wypisuje najmniejszy koszt, przy którym
+      indeks jest szybszy. Liczy też zapytania, dla których zgubiono
+      podpowiedź jednowyrazową.
+    - `reverse` - porównuje rozkład czasu generowania podpowiedzi bez drzewa
+      odwróconych słów i z nim (mediana, 99. percentyl, maksimum) oraz
+      sprawdza, czy podpowiedzi są takie same.
+    - `rules` - porównuje rozkład czasu generowania podpowiedzi z regułami
+      wykonywanymi przez kod wygenerowany przez rule-compiler i z regułami
+      interpretowanymi, wypisuje, czy wygenerowany kod pasuje do reguł
+      słownika (`compiled rules: yes`), oraz sprawdza, czy podpowiedzi są
+      takie same.
+    - `find [rozmiar_paczki]` - porównuje czas sprawdzania zapytań po jednym
+      (dictionary_find()) i paczkami (dictionary_find_batch(), domyślnie po
+      256 słów) oraz sprawdza, czy wyniki są takie same.
+    - `bloom [bity_na_słowo]` - porównuje czas sprawdzania zapytań bez
+      filtru Blooma i z filtrem (domyślnie 10 bitów na słowo), wypisuje
+      odsetek zapytań spoza słownika, pamięć filtru i szacowany odsetek
+      fałszywych trafień oraz sprawdza, czy wyniki są takie same.
+    - `exact` - porównuje czas sprawdzania zapytań przez przejście drzewa
+      i w indeksie wyszukiwania dokładnego (oba bez filtru Blooma),
+      wypisuje czas budowy i pamięć indeksu oraz sprawdza, czy wyniki są
+      takie same.
+    - `louds` - porównuje czas sprawdzania zapytań przez przejście drzewa
+      i zwięzłego drzewa LOUDS (oba bez filtru Blooma), wypisuje czas
+      budowy, liczbę węzłów i pamięć zwięzłego drzewa (także na węzeł)
+      oraz sprawdza, czy wyniki są takie same.
+    - `compact [liczba_podpowiedzi]` - usuwa słowa zapytań ze słownika
+      i wstawia je ponownie w losowej kolejności, co rozrzuca ich węzły po
+      stercie, a potem porównuje czas sprawdzania zapytań (bez filtru
+      Blooma) i generowania podpowiedzi dla pierwszych `liczba_podpowiedzi`
+      zapytań (domyślnie 2000) przed zagęszczeniem słownika
+      (dictionary_compact()) i po nim, wypisuje czas zagęszczania oraz
+      sprawdza, czy wyniki są takie same.
+    - `utf8` - porównuje czas sprawdzania zapytań w postaci szerokich
+      znaków (dictionary_find()), w UTF-8 (dictionary_find_utf8()) i w UTF-8
+      z konwersją każdego słowa do przydzielonego bufora szerokich znaków,
+      wypisuje rozmiar bufora listy zapytań w obu postaciach oraz sprawdza,
+      czy wyniki są takie same.
+    - `snapshot [maks_wątki]` - porównuje liczbę zapytań sprawdzanych na
+      sekundę przez od 1 do `maks_wątki` (domyślnie 4) wątków, gdy w tym
+      samym czasie inny wątek wstawia i usuwa słowa: ze słownikiem
+      chronionym blokadą czytelników i pisarzy oraz z migawkami drzewa
+      bez blokad.
+    @ingroup dict-bench
+    @author agent <agent@local>
+    @date 2026-10-19
+    @copyright Uniwersytet Warszawski
+  */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "dictionary.h"
+#include "utf8.h"
+#include <locale.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <wchar.h>
+
+/**
+  Maksymalna długość słowa.
+  */
+#define MAX_WORD_LENGTH 100
+
+/**
+  Domyślny maksymalny koszt w teście `qgram`.
+  */
+#define DEFAULT_MAX_COST 6
+
+/**
+  Domyślny rozmiar paczki w teście `find`.
+  */
+#define DEFAULT_BATCH_SIZE 256
+
+/**
+  Domyślna liczba zapytań, dla których test `compact` generuje podpowiedzi.
+  */
+#define DEFAULT_COMPACT_HINTS 2000
+
+/**
+  Domyślna liczba bitów filtru na słowo w teście `bloom`.
+  */
+#define DEFAULT_BLOOM_BITS 10
+
+/**
+  Domyślna maksymalna liczba czytelników w teście `snapshot`.
+  */
+#define DEFAULT_MAX_THREADS 4
+
+/**
+  Maksymalna liczba czytelników w teście `snapshot`.
+  */
+#define MAX_THREADS 64
+
+/**
+  Czas trwania jednego wariantu testu `snapshot` w sekundach.
+  */
+#define SNAPSHOT_SECONDS 1.0
+
+/**
+  Liczba różnych słów wstawianych i usuwanych przez pisarza w teście
+  `snapshot`.
+  */
+#define WRITER_WORDS 1000
+
+/**
+  Zapytania wczytane z pliku.
+  */
+static struct word_list queries;
+
+/**
+  Zwraca bieżący czas w sekundach.
+  @return Czas w sekundach.
+  */
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+  Wczytuje słownik z pliku o podanej nazwie
+  @param[in] filename Nazwa pliku.
+  @return Słownik.
+  */
+static struct dictionary * load_dictionary(const char *filename)
+{
+    struct dictionary *dict;
+    FILE *f = fopen(filename, "r");
+    if (!f || !(dict = dictionary_load(f)))
+    {
+        fprintf(stderr, "Failed to load dictionary from file %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+
+    fclose(f);
+
+    return dict;
+}
+
+/**
+  Wczytuje zapytania z pliku o podanej nazwie.
+  @param[in] filename Nazwa pliku.
+  */
+static void load_queries(const char *filename)
+{
+    FILE *f = fopen(filename, "r");
+    if (!f)
+    {
+        fprintf(stderr, "Failed to open query file %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+
+    wchar_t word[MAX_WORD_LENGTH + 2];
+    word_list_init(&queries);
+    while (fgetws(word, MAX_WORD_LENGTH + 2, f) != NULL)
+    {
+        word[wcscspn(word, L"\r\n")] = L'\0';
+        if (word[0] != L'\0') word_list_add(&queries, word);
+    }
+
+    fclose(f);
+}
+
+/**
+  Generuje podpowiedzi dla wszystkich zapytań.
+  @param[in] dict Słownik.
+  @return Czas w sekundach.
+  */
+static double run_hints(const struct dictionary *dict)
+{
+    const wchar_t * const *a = word_list_get(&queries);
+    double start = now();
+
+    for (size_t i = 0; i < word_list_size(&queries); i++)
+    {
+        struct word_list list;
+        dictionary_hints(dict, a[i], &list);
+        word_list_done(&list);
+    }
+
+    return now() - start;
+}
+
+/**
+  Liczy zapytania, dla których podpowiedzi z indeksem q-gramów różnią się
+  od podpowiedzi z przeszukiwania całego drzewa.
+  @param[in,out] dict Słownik.
+  @param[in] threshold Próg użycia indeksu q-gramów.
+  @return Liczba zapytań z różnymi podpowiedziami.
+  */
+static size_t count_mismatches(struct dictionary *dict, int threshold)
+{
+    const wchar_t * const *a = word_list_get(&queries);
+    size_t mismatches = 0;
+
+    for (size_t i = 0; i < word_list_size(&queries); i++)
+    {
+        struct word_list trie_list, qgram_list;
+
+        dictionary_hints_qgram_threshold(dict, 0);
+        dictionary_hints(dict, a[i], &trie_list);
+        dictionary_hints_qgram_threshold(dict, threshold);
+        dictionary_hints(dict, a[i], &qgram_list);
+
+        const wchar_t * const *hints = word_list_get(&trie_list);
+        bool same = word_list_size(&trie_list) == word_list_size(&qgram_list);
+        for (size_t j = 0; same && j < word_list_size(&trie_list); j++)
+        {
+            same = wcscmp(hints[j], word_list_get(&qgram_list)[j]) == 0;
+        }
+        if (!same) mismatches++;
+
+        word_list_done(&qgram_list);
+        word_list_done(&trie_list);
+    }
+
+    return mismatches;
+}
+
+/**
+  Test `qgram`: porównanie przeszukiwania drzewa z indeksem q-gramów.
+  @param[in,out] dict Słownik.
+  @param[in] argc Liczba parametrów testu.
+  @param[in] argv Parametry testu.
+  */
+static void bench_qgram(struct dictionary *dict, int argc, char *argv[])
+{
+    int max_cost = argc > 0 ? atoi(argv[0]) : DEFAULT_MAX_COST;
+    int crossover = 0;
+
+    printf("%8s %12s %12s %10s\n", "cost", "trie [s]", "qgram [s]",
+           "mismatches");
+
+    for (int cost = 2; cost <= max_cost; cost++)
+    {
+        dictionary_hints_max_cost(dict, cost);
+
+        dictionary_hints_qgram_threshold(dict, 0);
+        double trie_time = run_hints(dict);
+
+        // Pierwsze zapytanie buduje indeks, nie wliczamy go do pomiaru.
+        struct word_list warmup;
+        dictionary_hints_qgram_threshold(dict, cost - 1);
+        dictionary_hints(dict, L"", &warmup);
+        word_list_done(&warmup);
+
+        double qgram_time = run_hints(dict);
+
+        printf("%8d %12.4f %12.4f %10zu\n", cost, trie_time, qgram_time,
+               count_mismatches(dict, cost - 1));
+
+        if (crossover == 0 && qgram_time < trie_time) crossover = cost;
+    }
+
+    if (crossover > 0)
+        printf("q-gram index is first faster at cost %d\n", crossover);
+    else
+        printf("q-gram index is not faster up to cost %d\n", max_cost);
+}
+
+/**
+  Porównanie czasów na potrzeby qsort.
+  */
+static int compare_times(const void *_a, const void *_b)
+{
+    double a = *(const double*) _a;
+    double b = *(const double*) _b;
+
+    return (a > b) - (a < b);
+}
+
+/**
+  Generuje podpowiedzi dla każdego zapytania osobno, mierząc czasy.
+  @param[in] dict Słownik.
+  @param[out] times Czasy w sekundach.
+  @param[out] hints Podpowiedzi.
+  */
+static void run_timed_hints(const struct dictionary *dict, double *times,
+                            struct word_list *hints)
+{
+    const wchar_t * const *a = word_list_get(&queries);
+
+    for (size_t i = 0; i < word_list_size(&queries); i++)
+    {
+        double start = now();
+        dictionary_hints(dict, a[i], &hints[i]);
+        times[i] = now() - start;
+    }
+}
+
+/**
+  Wypisuje statystyki czasów.
+  @param[in] name Nazwa wiersza.
+  @param[in,out] times Czasy w sekundach (zostają posortowane).
+  @param[in] n Liczba czasów.
+  */
+static void print_percentiles(const char *name, double *times, size_t n)
+{
+    double total = 0;
+    for (size_t i = 0; i < n; i++) total += times[i];
+
+    qsort(times, n, sizeof(double), compare_times);
+
+    printf("%8s %12.4f %12.6f %12.6f %12.6f\n", name, total, times[n / 2],
+           times[(n * 99) / 100], times[n - 1]);
+}
+
+/**
+  Liczy zapytania, dla których podpowiedzi się różnią, i zwalnia listy
+  podpowiedzi.
+  @param[in,out] a Podpowiedzi dla każdego zapytania.
+  @param[in,out] b Podpowiedzi dla każdego zapytania.
+  @param[in] n Liczba zapytań.
+  @return Liczba zapytań z różnymi podpowiedziami.
+  */
+static size_t count_different_hints(struct word_list *a, struct word_list *b,
+                                    size_t n)
+{
+    size_t mismatches = 0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        bool same = (word_list_size(&a[i]) == word_list_size(&b[i]));
+        for (size_t j = 0; same && j < word_list_size(&a[i]); j++)
+        {
+            same = (wcscmp(word_list_get(&a[i])[j],
+                           word_list_get(&b[i])[j]) == 0);
+        }
+        if (!same) mismatches++;
+
+        word_list_done(&a[i]);
+        word_list_done(&b[i]);
+    }
+
+    return mismatches;
+}
+
+/**
+  Test `reverse`: wpływ drzewa odwróconych słów na czasy podpowiedzi.
+  @param[in,out] dict Słownik.
+  @param[in] argc Liczba parametrów testu.
+  @param[in] argv Parametry testu.
+  */
+static void bench_reverse(struct dictionary *dict, int argc, char *argv[])
+{
+    size_t n = word_list_size(&queries);
+    if (n == 0) return;
+
+    double *forward_times = malloc(sizeof(double) * n);
+    double *reverse_times = malloc(sizeof(double) * n);
+    struct word_list *forward_hints = malloc(sizeof(struct word_list) * n);
+    struct word_list *reverse_hints = malloc(sizeof(struct word_list) * n);
+    if (!forward_times || !reverse_times || !forward_hints || !reverse_hints)
+    {
+        fprintf(stderr, "Failed to allocate memory for benchmark\n");
+        exit(EXIT_FAILURE);
+    }
+
+    dictionary_reverse_index(dict, false);
+    run_timed_hints(dict, forward_times, forward_hints);
+    dictionary_reverse_index(dict, true);
+    run_timed_hints(dict, reverse_times, reverse_hints);
+
+    size_t mismatches = count_different_hints(forward_hints, reverse_hints,
+                                              n);
+
+    printf("%8s %12s %12s %12s %12s\n", "", "total [s]", "p50 [s]",
+           "p99 [s]", "max [s]");
+    print_percentiles("forward", forward_times, n);
+    print_percentiles("reverse", reverse_times, n);
+    printf("queries with different hints: %zu\n", mismatches);
+
+    free(reverse_hints);
+    free(forward_hints);
+    free(reverse_times);
+    free(forward_times);
+}
+
+/**
+  Test `rules`: reguły wykonywane przez kod z rule-compilera i interpretowane.
+  @param[in,out] dict Słownik.
+  @param[in] argc Liczba parametrów testu.
+  @param[in] argv Parametry testu.
+  */
+static void bench_rules(struct dictionary *dict, int argc, char *argv[])
+{
+    size_t n = word_list_size(&queries);
+    if (n == 0) return;
+
+    double *compiled_times = malloc(sizeof(double) * n);
+    double *interpreted_times = malloc(sizeof(double) * n);
+    struct word_list *compiled_hints = malloc(sizeof(struct word_list) * n);
+    struct word_list *interpreted_hints =
+        malloc(sizeof(struct word_list) * n);
+    if (!compiled_times || !interpreted_times || !compiled_hints
+        || !interpreted_hints)
+    {
+        fprintf(stderr, "Failed to allocate memory for benchmark\n");
+        exit(EXIT_FAILURE);
+    }
+
+    run_timed_hints(dict, compiled_times, compiled_hints);
+    bool compiled = dictionary_compiled_rules(dict, false);
+    run_timed_hints(dict, interpreted_times, interpreted_hints);
+    dictionary_compiled_rules(dict, true);
+
+    size_t mismatches = count_different_hints(compiled_hints,
+                                              interpreted_hints, n);
+
+    printf("compiled rules: %s\n", compiled ? "yes" : "no");
+    printf("%8s %12s %12s %12s %12s\n", "", "total [s]", "p50 [s]",
+           "p99 [s]", "max [s]");
+    print_percentiles("compiled", compiled_times, n);
+    print_percentiles("interp", interpreted_times, n);
+    printf("queries with different hints: %zu\n", mismatches);
+
+    free(interpreted_hints);
+    free(compiled_hints);
+    free(interpreted_times);
+    free(compiled_times);
+}
+
+/**
+  Sprawdza wszystkie zapytania po jednym lub paczkami.
+  @param[in] dict Słownik.
+  @param[in] batch_size Rozmiar paczki (0, jeśli po jednym).
+  @param[out] results Wyniki.
+  @return Czas w sekundach.
+  */
+static double run_find(const struct dictionary *dict, size_t batch_size,
+                        bool *results)
+{
+    const wchar_t * const *a = word_list_get(&queries);
+    size_t n = word_list_size(&queries);
+    double start = now();
+
+    if (batch_size == 0)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            results[i] = dictionary_find(dict, a[i]);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < n; i += batch_size)
+        {
+            size_t len = n - i < batch_size ? n - i : batch_size;
+            dictionary_find_batch(dict, a + i, len, results + i);
+        }
+    }
+
+    return now() - start;
+}
+
+/**
+  Test `find`: sprawdzanie słów po jednym i paczkami.
+  Każdy wariant jest uruchamiany dwa razy na przemian z drugim i liczy się
+  lepszy czas, żeby żaden nie korzystał z pamięci podręcznej zapełnionej
+  przez poprzedni bardziej niż drugi.
+  @param[in,out] dict Słownik.
+  @param[in] argc Liczba parametrów testu.
+  @param[in] argv Parametry testu.
+  */
+static void bench_find(struct dictionary *dict, int argc, char *argv[])
+{
+    size_t n = word_list_size(&queries);
+    int batch_size = argc > 0 ? atoi(argv[0]) : DEFAULT_BATCH_SIZE;
+    if (n == 0 || batch_size < 1) return;
+
+    bool *single = malloc(sizeof(bool) * n);
+    bool *batched = malloc(sizeof(bool) * n);
+    if (!single || !batched)
+    {
+        fprintf(stderr, "Failed to allocate memory for benchmark\n");
+        exit(EXIT_FAILURE);
+    }
+
+    double single_time = 0, batched_time = 0;
+    for (int round = 0; round < 2; round++)
+    {
+        double t = run_find(dict, 0, single);
+        if (round == 0 || t < single_time) single_time = t;
+
+        t = run_find(dict, batch_size, batched);
+        if (round == 0 || t < batched_time) batched_time = t;
+    }
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (single[i] != batched[i]) mismatches++;
+    }
+
+    printf("%8s %12s %12s %10s\n", "batch", "single [s]", "batched [s]",
+           "mismatches");
+    printf("%8d %12.4f %12.4f %10zu\n", batch_size, single_time, batched_time,
+           mismatches);
+
+    free(batched);
+    free(single);
+}
+
+/**
+  Test `bloom`: sprawdzanie słów bez filtru Blooma i z filtrem.
+  Warianty są uruchamiane na przemian, jak w teście `find`.
+  @param[in,out] dict Słownik.
+  @param[in] argc Liczba parametrów testu.
+  @param[in] argv Parametry testu.
+  */
+static void bench_bloom(struct dictionary *dict, int argc, char *argv[])
+{
+    size_t n = word_list_size(&queries);
+    int bits = argc > 0 ? atoi(argv[0]) : DEFAULT_BLOOM_BITS;
+    if (n == 0 || bits < 1) return;
+
+    bool *plain = malloc(sizeof(bool) * n);
+    bool *filtered = malloc(sizeof(bool) * n);
+    if (!plain || !filtered)
+    {
+        fprintf(stderr, "Failed to allocate memory for benchmark\n");
+        exit(EXIT_FAILURE);
+    }
+
+    double plain_time = 0, filtered_time = 0;
+    for (int round = 0; round < 2; round++)
+    {
+        dictionary_bloom_bits(dict, 0);
+        double t = run_find(dict, 0, plain);
+        if (round == 0 || t < plain_time) plain_time = t;
+
+        dictionary_bloom_bits(dict, bits);
+        t = run_find(dict, 0, filtered);
+        if (round == 0 || t < filtered_time) filtered_time = t;
+    }
+
+    struct dictionary_stats stats;
+    dictionary_stats(dict, &stats);
+
+    size_t misses = 0, mismatches = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (!plain[i]) misses++;
+        if (plain[i] != filtered[i]) mismatches++;
+    }
+
+    printf("%6s %8s %10s %8s %12s %12s %10s\n", "bits", "misses",
+           "mem [KiB]", "fp [%]", "plain [s]", "filtered [s]", "mismatches");
+    printf("%6d %7.1f%% %10zu %8.3f %12.4f %12.4f %10zu\n", bits,
+           100.0 * misses / n, stats.bloom_memory / 1024,
+           100.0 * stats.bloom_false_positive_rate, plain_time, filtered_time,
+           mismatches);
+
+    free(filtered);
+    free(plain);
+}
+
+/**
+  Test `exact`: sprawdzanie słów w drzewie i w indeksie wyszukiwania
+  dokładnego.
+  Warianty są uruchamiane na przemian, jak w teście `find`.
+  @param[in,out] dict Słownik.
+  @param[in] argc Liczba parametrów testu.
+  @param[in] argv Parametry testu.
+  */
+static void bench_exact(struct dictionary *dict, int argc, char *argv[])
+{
+    size_t n = word_list_size(&queries);
+    if (n == 0) return;
+
+    bool *walked = malloc(sizeof(bool) * n);
+    bool *hashed = malloc(sizeof(bool) * n);
+    if (!walked || !hashed)
+    {
+        fprintf(stderr, "Failed to allocate memory for benchmark\n");
+        exit(EXIT_FAILURE);
+    }
+
+    dictionary_bloom_bits(dict, 0);
+
+    double build_time = now();
+    dictionary_exact_index(dict, true);
+    build_time = now() - build_time;
+
+    struct dictionary_stats stats;
+    dictionary_stats(dict, &stats);
+
+    double walked_time = 0, hashed_time = 0;
+    for (int round = 0; round < 2; round++)
+    {
+        dictionary_exact_index(dict, false);
+        double t = run_find(dict, 0, walked);
+        if (round == 0 || t < walked_time) walked_time = t;
+
+        dictionary_exact_index(dict, true);
+        t = run_find(dict, 0, hashed);
+        if (round == 0 || t < hashed_time) hashed_time = t;
+    }
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (walked[i] != hashed[i]) mismatches++;
+    }
+
+    printf("%10s %10s %10s %10s %10s\n", "build [s]", "mem [KiB]",
+           "trie [s]", "hash [s]", "mismatches");
+    printf("%10.4f %10zu %10.4f %10.4f %10zu\n", build_time,
+           stats.exact_index_memory / 1024, walked_time, hashed_time,
+           mismatches);
+
+    free(hashed);
+    free(walked);
+}
+
+/**
+  Test `louds`: sprawdzanie słów w drzewie i w zwięzłym drzewie LOUDS.
+  Warianty są uruchamiane na przemian, jak w teście `find`.
+  @param[in,out] dict Słownik.
+  @param[in] argc Liczba parametrów testu.
+  @param[in] argv Parametry testu.
+  */
+static void bench_louds(struct dictionary *dict, int argc, char *argv[])
+{
+    size_t n = word_list_size(&queries);
+    if (n == 0) return;
+
+    bool *walked = malloc(sizeof(bool) * n);
+    bool *succinct = malloc(sizeof(bool) * n);
+    if (!walked || !succinct)
+    {
+        fprintf(stderr, "Failed to allocate memory for benchmark\n");
+        exit(EXIT_FAILURE);
+    }
+
+    dictionary_bloom_bits(dict, 0);
+
+    double build_time = now();
+    dictionary_succinct_index(dict, true);
+    build_time = now() - build_time;
+
+    struct dictionary_stats stats;
+    dictionary_stats(dict, &stats);
+
+    double walked_time = 0, succinct_time = 0;
+    for (int round = 0; round < 2; round++)
+    {
+        dictionary_succinct_index(dict, false);
+        double t = run_find(dict, 0, walked);
+        if (round == 0 || t < walked_time) walked_time = t;
+
+        dictionary_succinct_index(dict, true);
+        t = run_find(dict, 0, succinct);
+        if (round == 0 || t < succinct_time) succinct_time = t;
+    }
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (walked[i] != succinct[i]) mismatches++;
+    }
+
+    printf("%10s %10s %10s %10s %10s %10s %10s\n", "build [s]", "nodes",
+           "mem [KiB]", "B/node", "trie [s]", "louds [s]", "mismatches");
+    printf("%10.4f %10zu %10zu %10.3f %10.4f %10.4f %10zu\n", build_time,
+           stats.succinct_index_nodes, stats.succinct_index_memory / 1024,
+           (double) stats.succinct_index_memory / stats.succinct_index_nodes,
+           walked_time, succinct_time, mismatches);
+
+    free(succinct);
+    free(walked);
+}
+
+/**
+  Generuje podpowiedzi dla początkowych zapytań dwukrotnie (pierwsze
+  przejście rozgrzewa pamięć podręczną i alokator).
+  @param[in] dict Słownik.
+  @param[in] n Liczba zapytań.
+  @return Czas szybszego przejścia w sekundach.
+  */
+static double run_first_hints(const struct dictionary *dict, size_t n)
+{
+    const wchar_t * const *a = word_list_get(&queries);
+    double best = 0;
+
+    for (int round = 0; round < 2; round++)
+    {
+        double start = now();
+        for (size_t i = 0; i < n && i < word_list_size(&queries); i++)
+        {
+            struct word_list list;
+            dictionary_hints(dict, a[i], &list);
+            word_list_done(&list);
+        }
+
+        double t = now() - start;
+        if (round == 0 || t < best) best = t;
+    }
+
+    return best;
+}
+
+/**
+  Test `compact`: sprawdzanie słów i podpowiedzi w słowniku o węzłach
+  rozrzuconych po stercie przed zagęszczeniem i po nim.
+  @param[in,out] dict Słownik.
+  @param[in] argc Liczba parametrów testu.
+  @param[in] argv Parametry testu.
+  */
+static void bench_compact(struct dictionary *dict, int argc, char *argv[])
+{
+    size_t n = word_list_size(&queries);
+    int n_hints = argc > 0 ? atoi(argv[0]) : DEFAULT_COMPACT_HINTS;
+    if (n == 0 || n_hints < 0) return;
+
+    bool *scattered = malloc(sizeof(bool) * n);
+    bool *compacted = malloc(sizeof(bool) * n);
+    const wchar_t **words = malloc(sizeof(wchar_t *) * n);
+    if (!scattered || !compacted || !words)
+    {
+        fprintf(stderr, "Failed to allocate memory for benchmark\n");
+        exit(EXIT_FAILURE);
+    }
+
+    dictionary_bloom_bits(dict, 0);
+
+    // Słowa zapytań są wstawiane ponownie w losowej kolejności, więc ich
+    // węzły trafiają w zwolnione wcześniej miejsca sterty.
+    size_t n_words = 0;
+    run_find(dict, 0, scattered);
+    for (size_t i = 0; i < n; i++)
+    {
+        if (scattered[i]) words[n_words++] = word_list_get(&queries)[i];
+    }
+
+    srand(42);
+    for (size_t i = n_words; i > 1; i--)
+    {
+        size_t j = rand() % i;
+        const wchar_t *tmp = words[i - 1];
+        words[i - 1] = words[j];
+        words[j] = tmp;
+    }
+
+    for (size_t i = 0; i < n_words; i++) dictionary_delete(dict, words[i]);
+    for (size_t i = n_words; i > 0; i--) dictionary_insert(dict, words[i - 1]);
+
+    double scattered_find = 0, compacted_find = 0;
+    for (int round = 0; round < 2; round++)
+    {
+        double t = run_find(dict, 0, scattered);
+        if (round == 0 || t < scattered_find) scattered_find = t;
+    }
+    double scattered_hints = run_first_hints(dict, n_hints);
+
+    double compact_time = now();
+    dictionary_compact(dict);
+    compact_time = now() - compact_time;
+
+    for (int round = 0; round < 2; round++)
+    {
+        double t = run_find(dict, 0, compacted);
+        if (round == 0 || t < compacted_find) compacted_find = t;
+    }
+    double compacted_hints = run_first_hints(dict, n_hints);
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (scattered[i] != compacted[i]) mismatches++;
+    }
+
+    printf("%11s %12s %12s %12s %12s %10s\n", "compact [s]", "find [s]",
+           "find' [s]", "hints [s]", "hints' [s]", "mismatches");
+    printf("%11.4f %12.4f %12.4f %12.4f %12.4f %10zu\n", compact_time,
+           scattered_find, compacted_find, scattered_hints, compacted_hints,
+           mismatches);
+
+    free(words);
+    free(compacted);
+    free(scattered);
+}
+
+/**
+  Sprawdza zapytania w UTF-8.
+  @param[in] dict Słownik.
+  @param[in] words Zapytania w UTF-8.
+  @param[in] convert Czy dekodować słowa do przydzielonego bufora i szukać
+  ich za pomocą dictionary_find().
+  @param[out] results Wyniki.
+  @return Czas w sekundach.
+  */
+static double run_find_utf8(const struct dictionary *dict,
+                            const struct utf8_word_list *words, bool convert,
+                            bool *results)
+{
+    const char * const *a = utf8_word_list_get(words);
+    size_t n = utf8_word_list_size(words);
+    double start = now();
+
+    for (size_t i = 0; i < n; i++)
+    {
+        if (!convert)
+        {
+            results[i] = dictionary_find_utf8(dict, a[i]);
+            continue;
+        }
+
+        wchar_t *wide = malloc(sizeof(wchar_t) * (strlen(a[i]) + 1));
+        if (!wide)
+        {
+            fprintf(stderr, "Failed to allocate memory for benchmark\n");
+            exit(EXIT_FAILURE);
+        }
+        results[i] = utf8_to_wide(a[i], wide) != (size_t) -1
+                     && dictionary_find(dict, wide);
+        free(wide);
+    }
+
+    return now() - start;
+}
+
+/**
+  Test `utf8`: sprawdzanie słów w postaci szerokich znaków i w UTF-8.
+  Warianty są uruchamiane na przemian, jak w teście `find`.
+  @param[in,out] dict Słownik.
+  @param[in] argc Liczba parametrów testu.
+  @param[in] argv Parametry testu.
+  */
+static void bench_utf8(struct dictionary *dict, int argc, char *argv[])
+{
+    size_t n = word_list_size(&queries);
+    if (n == 0) return;
+
+    bool *wide = malloc(sizeof(bool) * n);
+    bool *utf8 = malloc(sizeof(bool) * n);
+    bool *converted = malloc(sizeof(bool) * n);
+    if (!wide || !utf8 || !converted)
+    {
+        fprintf(stderr, "Failed to allocate memory for benchmark\n");
+        exit(EXIT_FAILURE);
+    }
+
+    struct utf8_word_list words;
+    utf8_word_list_init(&words);
+    for (size_t i = 0; i < n; i++)
+        utf8_word_list_add_wide(&words, word_list_get(&queries)[i]);
+
+    double wide_time = 0, utf8_time = 0, converted_time = 0;
+    for (int round = 0; round < 2; round++)
+    {
+        double t = run_find(dict, 0, wide);
+        if (round == 0 || t < wide_time) wide_time = t;
+
+        t = run_find_utf8(dict, &words, false, utf8);
+        if (round == 0 || t < utf8_time) utf8_time = t;
+
+        t = run_find_utf8(dict, &words, true, converted);
+        if (round == 0 || t < converted_time) converted_time = t;
+    }
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (wide[i] != utf8[i] || wide[i] != converted[i]) mismatches++;
+    }
+
+    printf("%10s %10s %13s %12s %12s %10s\n", "wide [s]", "utf8 [s]",
+           "convert [s]", "wide [B]", "utf8 [B]", "mismatches");
+    printf("%10.4f %10.4f %13.4f %12zu %12zu %10zu\n", wide_time, utf8_time,
+           converted_time, queries.buffer_size * sizeof(wchar_t),
+           words.buffer_size, mismatches);
+
+    utf8_word_list_done(&words);
+    free(converted);
+    free(utf8);
+    free(wide);
+}
+
+/**
+  Stan współdzielony przez wątki testu `snapshot`.
+  */
+struct snapshot_run
+{
+    /// Słownik.
+    struct dictionary *dict;
+    /// Blokada słownika (NULL, jeśli słownik używa migawek).
+    pthread_rwlock_t *lock;
+    /// Czy wątki mają skończyć.
+    bool stop;
+};
+
+/**
+  Czytelnik w teście `snapshot`.
+  */
+struct snapshot_reader
+{
+    /// Wspólny stan.
+    struct snapshot_run *run;
+    /// Pierwsze sprawdzane zapytanie.
+    size_t first;
+    /// Liczba sprawdzonych zapytań.
+    size_t lookups;
+    /// Wątek.
+    pthread_t thread;
+};
+
+/**
+  Sprawdza zapytania po kolei aż do zatrzymania testu.
+  @param[in,out] arg Czytelnik.
+  @return NULL.
+  */
+static void * snapshot_reader_thread(void *arg)
+{
+    struct snapshot_reader *reader = arg;
+    struct snapshot_run *run = reader->run;
+    const wchar_t * const *a = word_list_get(&queries);
+    size_t n = word_list_size(&queries), i = reader->first;
+
+    while (!__atomic_load_n(&run->stop, __ATOMIC_RELAXED))
+    {
+        if (run->lock) pthread_rwlock_rdlock(run->lock);
+        dictionary_find(run->dict, a[i]);
+        if (run->lock) pthread_rwlock_unlock(run->lock);
+
+        reader->lookups++;
+        if (++i == n) i = 0;
+    }
+
+    return NULL;
+}
+
+/**
+  Na przemian wstawia i usuwa słowa aż do zatrzymania testu.
+  @param[in,out] arg Wspólny stan.
+  @return Liczba zmian.
+  */
+static void * snapshot_writer_thread(void *arg)
+{
+    struct snapshot_run *run = arg;
+    size_t *changes = calloc(1, sizeof(size_t));
+    wchar_t word[MAX_WORD_LENGTH];
+
+    for (int i = 0; !__atomic_load_n(&run->stop, __ATOMIC_RELAXED); i++)
+    {
+        swprintf(word, MAX_WORD_LENGTH, L"zapis%d", i % WRITER_WORDS);
+        bool insert = (i / WRITER_WORDS) % 2 == 0;
+
+        if (run->lock) pthread_rwlock_wrlock(run->lock);
+        if (insert) dictionary_insert(run->dict, word);
+        else dictionary_delete(run->dict, word);
+        if (run->lock) pthread_rwlock_unlock(run->lock);
+
+        if (changes) (*changes)++;
+    }
+
+    return changes;
+}
+
+/**
+  Uruchamia czytelników i pisarza na czas SNAPSHOT_SECONDS.
+  @param[in,out] dict Słownik.
+  @param[in] lock Blokada słownika lub NULL.
+  @param[in] n_threads Liczba czytelników.
+  @param[out] writes Liczba zmian na sekundę.
+  @return Liczba zapytań na sekundę.
+  */
+static double run_snapshot(struct dictionary *dict, pthread_rwlock_t *lock,
+                           int n_threads, double *writes)
+{
+    struct snapshot_run run = { .dict = dict, .lock = lock, .stop = false };
+    struct snapshot_reader readers[MAX_THREADS];
+    size_t n = word_list_size(&queries);
+    pthread_t writer;
+
+    for (int i = 0; i < n_threads; i++)
+    {
+        readers[i].run = &run;
+        readers[i].first = n * i / n_threads;
+        readers[i].lookups = 0;
+        pthread_create(&readers[i].thread, NULL, snapshot_reader_thread,
+                       &readers[i]);
+    }
+    pthread_create(&writer, NULL, snapshot_writer_thread, &run);
+
+    double start = now();
+    struct timespec duration = { .tv_sec = (time_t) SNAPSHOT_SECONDS,
+        .tv_nsec = (long) ((SNAPSHOT_SECONDS - (time_t) SNAPSHOT_SECONDS)
+                           * 1e9) };
+    nanosleep(&duration, NULL);
+    __atomic_store_n(&run.stop, true, __ATOMIC_RELAXED);
+
+    size_t lookups = 0;
+    for (int i = 0; i < n_threads; i++)
+    {
+        pthread_join(readers[i].thread, NULL);
+        lookups += readers[i].lookups;
+    }
+
+    size_t *changes;
+    pthread_join(writer, (void **) &changes);
+    double elapsed = now() - start;
+
+    *writes = changes ? *changes / elapsed : 0;
+    free(changes);
+
+    return lookups / elapsed;
+}
+
+/**
+  Test `snapshot`: czytelnicy ze współbieżnym pisarzem, z blokadą i
+  z migawkami drzewa.
+  Oba warianty działają bez filtru Blooma, który migawki wyłączają.
+  @param[in,out] dict Słownik.
+  @param[in] argc Liczba parametrów testu.
+  @param[in] argv Parametry testu.
+  */
+static void bench_snapshot(struct dictionary *dict, int argc, char *argv[])
+{
+    int max_threads = argc > 0 ? atoi(argv[0]) : DEFAULT_MAX_THREADS;
+    if (word_list_size(&queries) == 0 || max_threads < 1) return;
+    if (max_threads > MAX_THREADS) max_threads = MAX_THREADS;
+
+    pthread_rwlock_t lock;
+    pthread_rwlock_init(&lock, NULL);
+    dictionary_bloom_bits(dict, 0);
+
+    printf("%8s %14s %14s %14s %14s\n", "threads", "locked [q/s]",
+           "snapshot [q/s]", "locked [w/s]", "snapshot [w/s]");
+
+    for (int threads = 1; threads <= max_threads; threads++)
+    {
+        double locked_writes, snapshot_writes;
+
+        dictionary_snapshots(dict, false);
+        double locked = run_snapshot(dict, &lock, threads, &locked_writes);
+
+        dictionary_snapshots(dict, true);
+        double snapshot = run_snapshot(dict, NULL, threads,
+                                       &snapshot_writes);
+
+        printf("%8d %14.0f %14.0f %14.0f %14.0f\n", threads, locked,
+               snapshot, locked_writes, snapshot_writes);
+    }
+
+    dictionary_snapshots(dict, false);
+    pthread_rwlock_destroy(&lock);
+}
+
+/**
+  Test wydajności.
+  */
+struct benchmark
+{
+    /// Nazwa testu.
+    const char *name;
+    /// Funkcja uruchamiająca test.
+    void (*run)(struct dictionary *dict, int argc, char *argv[]);
+};
+
+/**
+  Dostępne testy.
+  */
+static const struct benchmark benchmarks[] =
+{
+    { "qgram", bench_qgram },
+    { "reverse", bench_reverse },
+    { "rules", bench_rules },
+    { "find", bench_find },
+    { "bloom", bench_bloom },
+    { "exact", bench_exact },
+    { "louds", bench_louds },
+    { "compact", bench_compact },
+    { "utf8", bench_utf8 },
+    { "snapshot", bench_snapshot },
+};
+
+/**
+  Funkcja main.
+  Główna funkcja programu do testów wydajności.
+ */
+int main(int argc, char *argv[])
+{
+    setlocale(LC_ALL, "pl_PL.UTF-8");
+
+    if (argc < 4)
+    {
+        fprintf(stderr, "Usage: %s benchmark dictionary queries [args]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const struct benchmark *benchmark = NULL;
+    for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++)
+    {
+        if (strcmp(benchmarks[i].name, argv[1]) == 0)
+        {
+            benchmark = &benchmarks[i];
+        }
+    }
+
+    if (benchmark == NULL)
+    {
+        fprintf(stderr, "Unknown benchmark: %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    struct dictionary *dict = load_dictionary(argv[2]);
+    load_queries(argv[3]);
+
+    benchmark->run(dict, argc - 4, argv + 4);
+
+    word_list_done(&queries);
+    dictionary_done(dict);
+
+    return 0;
+}
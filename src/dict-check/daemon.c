@@ -0,0 +1,824 @@
+/** @file
+    Implementacja demona sprawdzającego słowa.
+
+    @ingroup dict-check
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "daemon.h"
+#include "dictionary.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+  Maksymalna długość słowa w zapytaniu w bajtach.
+  */
+#define MAX_WORD_BYTES 1024
+
+/**
+  Maksymalna długość odpowiedzi w bajtach.
+  */
+#define MAX_RESPONSE_BYTES (1 << 20)
+
+/**
+  Co ile sekund sprawdzać, czy plik słownika się zmienił.
+  */
+#define RELOAD_INTERVAL 1
+
+/**
+  Po ilu sekundach bezczynności zamykać połączenie.
+  */
+#define IDLE_TIMEOUT 600
+
+/**
+  Co ile milisekund pętla zdarzeń sprawdza bezczynne połączenia.
+  */
+#define POLL_INTERVAL 1000
+
+/**
+  Ile bajtów najwyżej odczytywać z połączenia naraz.
+  */
+#define READ_BYTES 4096
+
+/**
+  Bufor budowanej wiadomości.
+  */
+struct buffer
+{
+    /// Dane.
+    char *data;
+    /// Liczba zajętych bajtów.
+    size_t len;
+    /// Rozmiar bufora.
+    size_t size;
+};
+
+/**
+  Połączenie z klientem.
+  */
+struct connection
+{
+    /// Deskryptor połączenia.
+    int fd;
+    /// Odebrane, jeszcze nieobsłużone bajty.
+    struct buffer input;
+    /// Odpowiedź do wysłania.
+    struct buffer output;
+    /// Liczba wysłanych już bajtów odpowiedzi.
+    size_t sent;
+    /// Czy zapytanie jest obsługiwane przez wątek roboczy.
+    bool busy;
+    /// Czy połączenie należy zamknąć.
+    bool closing;
+    /// Czas ostatniej aktywności.
+    time_t active;
+    /// Rodzaj obsługiwanego zapytania.
+    enum daemon_request request;
+    /// Słowo z obsługiwanego zapytania.
+    wchar_t word[MAX_WORD_BYTES + 1];
+    /// Następne połączenie w kolejce.
+    struct connection *next;
+};
+
+/**
+  Stan demona.
+  */
+struct server
+{
+    /// Gniazdo przyjmujące połączenia.
+    int listen_fd;
+    /// Nazwa pliku słownika.
+    const char *filename;
+    /// Słownik.
+    struct dictionary *dict;
+    /// Blokada słownika: zapytania czytają, podmiana pisze.
+    pthread_rwlock_t lock;
+    /// Stan pliku słownika przy ostatnim wczytaniu.
+    struct stat file;
+    /// Blokada kolejek zapytań i odpowiedzi.
+    pthread_mutex_t queue_lock;
+    /// Sygnalizuje nowe zapytanie w kolejce.
+    pthread_cond_t queue_cond;
+    /// Połączenia z zapytaniami czekającymi na wątek roboczy.
+    struct connection *requests;
+    /// Miejsce na następne zapytanie w kolejce.
+    struct connection **requests_tail;
+    /// Połączenia z gotowymi odpowiedziami.
+    struct connection *responses;
+    /// Łącze budzące pętlę zdarzeń: koniec do czytania i do pisania.
+    int wake[2];
+};
+
+/** @name Funkcje pomocnicze
+  @{
+  */
+
+/**
+  Dopisuje bajty do bufora.
+  @param[in,out] buffer Bufor.
+  @param[in] data Bajty.
+  @param[in] len Liczba bajtów.
+  */
+static void buffer_put(struct buffer *buffer, const void *data, size_t len)
+{
+    if (buffer->len + len > buffer->size)
+    {
+        while (buffer->len + len > buffer->size)
+            buffer->size = buffer->size ? 2 * buffer->size : 64;
+
+        buffer->data = realloc(buffer->data, buffer->size);
+        if (!buffer->data)
+        {
+            fprintf(stderr, "Failed to allocate memory for message\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    memcpy(buffer->data + buffer->len, data, len);
+    buffer->len += len;
+}
+
+/**
+  Dopisuje do bufora liczbę w porządku sieciowym.
+  @param[in,out] buffer Bufor.
+  @param[in] value Liczba.
+  */
+static void buffer_put_u32(struct buffer *buffer, uint32_t value)
+{
+    uint32_t net = htonl(value);
+    buffer_put(buffer, &net, sizeof(net));
+}
+
+/**
+  Dopisuje do bufora napis w UTF-8 poprzedzony długością.
+  @param[in,out] buffer Bufor.
+  @param[in] str Napis.
+  @return 0, jeśli napisu nie da się zakodować, 1 w p.p.
+  */
+static int buffer_put_string(struct buffer *buffer, const wchar_t *str)
+{
+    size_t len = wcstombs(NULL, str, 0);
+    if (len == (size_t) -1) return 0;
+
+    char bytes[len + 1];
+    wcstombs(bytes, str, len + 1);
+
+    buffer_put_u32(buffer, len);
+    buffer_put(buffer, bytes, len);
+
+    return 1;
+}
+
+/**
+  Czyta dokładnie `len` bajtów.
+  @param[in] fd Deskryptor.
+  @param[out] data Bajty.
+  @param[in] len Liczba bajtów.
+  @return Czy się udało.
+  */
+static bool read_full(int fd, void *data, size_t len)
+{
+    char *p = data;
+
+    while (len > 0)
+    {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+
+        p += n;
+        len -= n;
+    }
+
+    return true;
+}
+
+/**
+  Zapisuje dokładnie `len` bajtów.
+  @param[in] fd Deskryptor.
+  @param[in] data Bajty.
+  @param[in] len Liczba bajtów.
+  @return Czy się udało.
+  */
+static bool write_full(int fd, const void *data, size_t len)
+{
+    const char *p = data;
+
+    while (len > 0)
+    {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+
+        p += n;
+        len -= n;
+    }
+
+    return true;
+}
+
+/**
+  Czyta liczbę w porządku sieciowym.
+  @param[in] fd Deskryptor.
+  @param[out] value Liczba.
+  @return Czy się udało.
+  */
+static bool read_u32(int fd, uint32_t *value)
+{
+    uint32_t net;
+    if (!read_full(fd, &net, sizeof(net))) return false;
+
+    *value = ntohl(net);
+    return true;
+}
+
+/**
+  Wczytuje słownik z pliku, zapamiętując stan pliku.
+  @param[in] filename Nazwa pliku.
+  @param[out] file Stan pliku.
+  @return Słownik lub NULL, jeśli operacja się nie powiedzie.
+  */
+static struct dictionary * load_dictionary(const char *filename,
+                                           struct stat *file)
+{
+    struct dictionary *dict = NULL;
+    FILE *f = fopen(filename, "r");
+
+    if (f && fstat(fileno(f), file) == 0) dict = dictionary_load(f);
+    if (f) fclose(f);
+
+    if (!dict)
+        fprintf(stderr, "Failed to load dictionary from file %s\n", filename);
+
+    return dict;
+}
+
+/**
+  Stwierdza, czy plik zmienił się od ostatniego wczytania.
+  @param[in] a Stan pliku przy wczytaniu.
+  @param[in] b Bieżący stan pliku.
+  @return Czy plik się zmienił.
+  */
+static bool file_changed(const struct stat *a, const struct stat *b)
+{
+    return a->st_ino != b->st_ino || a->st_dev != b->st_dev
+        || a->st_size != b->st_size
+        || a->st_mtim.tv_sec != b->st_mtim.tv_sec
+        || a->st_mtim.tv_nsec != b->st_mtim.tv_nsec;
+}
+
+/**
+  Funkcja wątku pilnującego pliku słownika.
+  Nowy słownik jest wczytywany bez blokady, a podmieniany pod blokadą do
+  zapisu, więc zapytania czekają tylko na samą podmianę.
+  @param[in,out] _server Stan demona.
+  @return NULL.
+  */
+static void * watch_dictionary(void *_server)
+{
+    struct server *server = _server;
+
+    while (true)
+    {
+        struct stat st;
+
+        sleep(RELOAD_INTERVAL);
+        if (stat(server->filename, &st) != 0
+            || !file_changed(&server->file, &st))
+            continue;
+
+        // Zapamiętujemy nowy stan także przy błędzie, żeby nie próbować
+        // wczytywać tego samego, niepoprawnego pliku co sekundę.
+        server->file = st;
+
+        struct dictionary *dict = load_dictionary(server->filename, &st);
+        if (!dict) continue;
+        server->file = st;
+
+        pthread_rwlock_wrlock(&server->lock);
+        struct dictionary *old = server->dict;
+        server->dict = dict;
+        pthread_rwlock_unlock(&server->lock);
+
+        dictionary_done(old);
+    }
+
+    return NULL;
+}
+
+/**
+  Obsługuje jedno zapytanie.
+  @param[in,out] server Stan demona.
+  @param[in] request Rodzaj zapytania.
+  @param[in] word Słowo.
+  @param[out] response Odpowiedź.
+  */
+static void answer(struct server *server, enum daemon_request request,
+                   const wchar_t *word, struct buffer *response)
+{
+    struct word_list hints;
+    bool has_hints = false;
+
+    pthread_rwlock_rdlock(&server->lock);
+    bool found = dictionary_find(server->dict, word);
+    if (request == DAEMON_HINTS || (request == DAEMON_CHECK && !found))
+    {
+        dictionary_hints(server->dict, word, &hints);
+        has_hints = true;
+    }
+    pthread_rwlock_unlock(&server->lock);
+
+    uint8_t found_byte = found;
+    buffer_put(response, &found_byte, 1);
+
+    if (!has_hints)
+    {
+        buffer_put_u32(response, 0);
+        return;
+    }
+
+    buffer_put_u32(response, word_list_size(&hints));
+    for (size_t i = 0; i < word_list_size(&hints); i++)
+        buffer_put_string(response, word_list_get(&hints)[i]);
+
+    word_list_done(&hints);
+}
+
+/**
+  Ustawia deskryptor w tryb nieblokujący.
+  @param[in] fd Deskryptor.
+  @return Czy się udało.
+  */
+static bool set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+/**
+  Przekazuje zapytanie połączenia wątkom roboczym.
+  @param[in,out] server Stan demona.
+  @param[in,out] conn Połączenie z odczytanym zapytaniem.
+  */
+static void queue_request(struct server *server, struct connection *conn)
+{
+    conn->busy = true;
+    conn->next = NULL;
+
+    pthread_mutex_lock(&server->queue_lock);
+    *server->requests_tail = conn;
+    server->requests_tail = &conn->next;
+    pthread_cond_signal(&server->queue_cond);
+    pthread_mutex_unlock(&server->queue_lock);
+}
+
+/**
+  Funkcja wątku roboczego: obsługuje kolejne zapytania z kolejki
+  i oddaje połączenia z gotowymi odpowiedziami pętli zdarzeń.
+  @param[in,out] _server Stan demona.
+  @return NULL.
+  */
+static void * serve_requests(void *_server)
+{
+    struct server *server = _server;
+
+    while (true)
+    {
+        pthread_mutex_lock(&server->queue_lock);
+        while (!server->requests)
+            pthread_cond_wait(&server->queue_cond, &server->queue_lock);
+
+        struct connection *conn = server->requests;
+        server->requests = conn->next;
+        if (!server->requests) server->requests_tail = &server->requests;
+        pthread_mutex_unlock(&server->queue_lock);
+
+        conn->output.len = 0;
+        conn->sent = 0;
+        answer(server, conn->request, conn->word, &conn->output);
+
+        pthread_mutex_lock(&server->queue_lock);
+        conn->next = server->responses;
+        server->responses = conn;
+        pthread_mutex_unlock(&server->queue_lock);
+
+        // Pełne łącze oznacza, że pętla zdarzeń i tak zostanie obudzona.
+        uint8_t byte = 0;
+        while (write(server->wake[1], &byte, 1) < 0 && errno == EINTR)
+            continue;
+    }
+
+    return NULL;
+}
+
+/**
+  Odczytuje z połączenia tyle bajtów, ile jest dostępnych, ale nie więcej
+  niż READ_BYTES.
+  @param[in,out] conn Połączenie.
+  @return Czy połączenie jest nadal otwarte.
+  */
+static bool receive(struct connection *conn)
+{
+    char bytes[READ_BYTES];
+    ssize_t n = read(conn->fd, bytes, sizeof(bytes));
+
+    if (n < 0)
+        return errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK;
+    if (n == 0) return false;
+
+    buffer_put(&conn->input, bytes, n);
+    return true;
+}
+
+/**
+  Jeśli połączenie odebrało już całe zapytanie, przekazuje je wątkom
+  roboczym.
+  @param[in,out] server Stan demona.
+  @param[in,out] conn Połączenie bez obsługiwanego zapytania.
+  @return false, jeśli zapytanie jest niepoprawne, true w p.p.
+  */
+static bool parse_request(struct server *server, struct connection *conn)
+{
+    struct buffer *input = &conn->input;
+    char bytes[MAX_WORD_BYTES + 1];
+    uint32_t len;
+
+    if (input->len < 1 + sizeof(len)) return true;
+
+    memcpy(&len, input->data + 1, sizeof(len));
+    len = ntohl(len);
+    if (len > MAX_WORD_BYTES) return false;
+
+    size_t total = 1 + sizeof(len) + len;
+    if (input->len < total) return true;
+
+    uint8_t request = input->data[0];
+    memcpy(bytes, input->data + 1 + sizeof(len), len);
+    bytes[len] = '\0';
+
+    if (mbstowcs(conn->word, bytes, MAX_WORD_BYTES + 1) == (size_t) -1
+        || (request != DAEMON_FIND && request != DAEMON_HINTS
+            && request != DAEMON_CHECK))
+        return false;
+
+    input->len -= total;
+    memmove(input->data, input->data + total, input->len);
+
+    conn->request = request;
+    queue_request(server, conn);
+    return true;
+}
+
+/**
+  Wysyła tyle gotowej odpowiedzi, ile się da bez czekania, a po wysłaniu
+  całej przekazuje wątkom roboczym następne odebrane zapytanie.
+  @param[in,out] server Stan demona.
+  @param[in,out] conn Połączenie bez obsługiwanego zapytania.
+  @return Czy połączenie jest nadal otwarte.
+  */
+static bool advance(struct server *server, struct connection *conn)
+{
+    while (conn->sent < conn->output.len)
+    {
+        ssize_t n = write(conn->fd, conn->output.data + conn->sent,
+                          conn->output.len - conn->sent);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        if (n <= 0) return false;
+
+        conn->sent += n;
+    }
+
+    conn->output.len = 0;
+    conn->sent = 0;
+    return parse_request(server, conn);
+}
+
+/**
+  Przyjmuje oczekujące połączenia.
+  @param[in] server Stan demona.
+  @param[in,out] conns Tablica połączeń.
+  @param[in,out] n_conns Liczba połączeń.
+  @param[in,out] capacity Rozmiar tablicy połączeń.
+  @param[in] now Bieżący czas.
+  @return false, jeśli gniazdo przestało przyjmować połączenia, true w p.p.
+  */
+static bool accept_connections(struct server *server,
+                               struct connection ***conns, size_t *n_conns,
+                               size_t *capacity, time_t now)
+{
+    while (true)
+    {
+        int fd = accept(server->listen_fd, NULL, NULL);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
+            // Brak deskryptorów nie jest trwały: połączenie poczeka.
+            if (errno == EMFILE || errno == ENFILE) return true;
+            perror("accept");
+            return false;
+        }
+
+        struct connection *conn = calloc(1, sizeof(struct connection));
+        if (*n_conns == *capacity)
+        {
+            *capacity = *capacity ? 2 * *capacity : 16;
+            *conns = realloc(*conns, *capacity * sizeof(**conns));
+        }
+        if (!conn || !*conns)
+        {
+            fprintf(stderr, "Failed to allocate memory for connection\n");
+            exit(EXIT_FAILURE);
+        }
+
+        if (!set_nonblocking(fd))
+        {
+            close(fd);
+            free(conn);
+            continue;
+        }
+
+        conn->fd = fd;
+        conn->active = now;
+        (*conns)[(*n_conns)++] = conn;
+    }
+}
+
+/**
+  Pętla zdarzeń: odbiera zapytania ze wszystkich połączeń, przekazuje je
+  wątkom roboczym i odsyła gotowe odpowiedzi. Połączenie, którego
+  zapytanie jest obsługiwane, nie jest obserwowane, więc na jednym
+  połączeniu zapytania są obsługiwane po kolei.
+  @param[in,out] server Stan demona.
+  */
+static void serve_connections(struct server *server)
+{
+    struct connection **conns = NULL;
+    struct pollfd *fds = NULL;
+    size_t n_conns = 0, capacity = 0, n_fds = 0;
+
+    while (true)
+    {
+        if (n_fds < n_conns + 2)
+        {
+            n_fds = capacity + 2;
+            fds = realloc(fds, n_fds * sizeof(struct pollfd));
+            if (!fds)
+            {
+                fprintf(stderr, "Failed to allocate memory for connection\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        fds[0].fd = server->listen_fd;
+        fds[0].events = POLLIN;
+        fds[1].fd = server->wake[0];
+        fds[1].events = POLLIN;
+        for (size_t i = 0; i < n_conns; i++)
+        {
+            // Odpowiedź połączenia z obsługiwanym zapytaniem należy do
+            // wątku roboczego.
+            struct connection *conn = conns[i];
+            fds[i + 2].fd = conn->busy ? -1 : conn->fd;
+            fds[i + 2].events = !conn->busy && conn->sent < conn->output.len
+                                ? POLLOUT : POLLIN;
+        }
+
+        if (poll(fds, n_conns + 2, POLL_INTERVAL) < 0)
+        {
+            if (errno == EINTR) continue;
+            perror("poll");
+            break;
+        }
+        time_t now = time(NULL);
+
+        for (size_t i = 0; i < n_conns; i++)
+        {
+            struct connection *conn = conns[i];
+            short revents = fds[i + 2].revents;
+            if (conn->busy || !revents) continue;
+
+            conn->active = now;
+            if (fds[i + 2].events == POLLOUT)
+                conn->closing = !advance(server, conn);
+            else
+                conn->closing = !receive(conn)
+                                || !parse_request(server, conn);
+        }
+
+        if (fds[1].revents)
+        {
+            uint8_t bytes[64];
+            while (read(server->wake[0], bytes, sizeof(bytes)) > 0)
+                continue;
+
+            pthread_mutex_lock(&server->queue_lock);
+            struct connection *conn = server->responses;
+            server->responses = NULL;
+            pthread_mutex_unlock(&server->queue_lock);
+
+            while (conn)
+            {
+                struct connection *next = conn->next;
+                conn->busy = false;
+                conn->active = now;
+                conn->closing = !advance(server, conn);
+                conn = next;
+            }
+        }
+
+        size_t kept = 0;
+        for (size_t i = 0; i < n_conns; i++)
+        {
+            struct connection *conn = conns[i];
+            if (!conn->busy
+                && (conn->closing || now - conn->active >= IDLE_TIMEOUT))
+            {
+                close(conn->fd);
+                free(conn->input.data);
+                free(conn->output.data);
+                free(conn);
+            }
+            else
+            {
+                conns[kept++] = conn;
+            }
+        }
+        n_conns = kept;
+
+        if (fds[0].revents
+            && !accept_connections(server, &conns, &n_conns, &capacity, now))
+            break;
+    }
+}
+
+/**
+  Wypełnia adres gniazda.
+  @param[out] addr Adres.
+  @param[in] socket_path Ścieżka gniazda.
+  @return 0, jeśli ścieżka jest za długa, 1 w p.p.
+  */
+static int make_address(struct sockaddr_un *addr, const char *socket_path)
+{
+    memset(addr, 0, sizeof(struct sockaddr_un));
+    addr->sun_family = AF_UNIX;
+
+    if (strlen(socket_path) >= sizeof(addr->sun_path))
+    {
+        fprintf(stderr, "Socket path too long: %s\n", socket_path);
+        return 0;
+    }
+
+    strcpy(addr->sun_path, socket_path);
+    return 1;
+}
+
+/**@}*/
+
+/** @name Elementy interfejsu
+  @{
+  */
+
+int daemon_serve(const char *socket_path, const char *filename)
+{
+    struct server server;
+    struct sockaddr_un addr;
+
+    if (!make_address(&addr, socket_path)) return EXIT_FAILURE;
+
+    server.filename = filename;
+    server.dict = load_dictionary(filename, &server.file);
+    if (!server.dict) return EXIT_FAILURE;
+    pthread_rwlock_init(&server.lock, NULL);
+    pthread_mutex_init(&server.queue_lock, NULL);
+    pthread_cond_init(&server.queue_cond, NULL);
+    server.requests = server.responses = NULL;
+    server.requests_tail = &server.requests;
+
+    // Klient może się rozłączyć w trakcie wysyłania odpowiedzi.
+    signal(SIGPIPE, SIG_IGN);
+
+    server.listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socket_path);
+    if (server.listen_fd < 0
+        || bind(server.listen_fd, (struct sockaddr *) &addr, sizeof(addr)) < 0
+        || listen(server.listen_fd, SOMAXCONN) < 0
+        || !set_nonblocking(server.listen_fd))
+    {
+        perror(socket_path);
+        return EXIT_FAILURE;
+    }
+
+    if (pipe(server.wake) < 0 || !set_nonblocking(server.wake[0])
+        || !set_nonblocking(server.wake[1]))
+    {
+        perror("pipe");
+        return EXIT_FAILURE;
+    }
+
+    long n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n_threads < 1) n_threads = 1;
+
+    pthread_t watcher, threads[n_threads];
+    if (pthread_create(&watcher, NULL, watch_dictionary, &server) != 0)
+    {
+        fprintf(stderr, "Failed to create thread\n");
+        return EXIT_FAILURE;
+    }
+    for (long i = 0; i < n_threads; i++)
+    {
+        if (pthread_create(&threads[i], NULL, serve_requests, &server) != 0)
+        {
+            fprintf(stderr, "Failed to create thread\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    serve_connections(&server);
+
+    return EXIT_FAILURE;
+}
+
+int daemon_connect(const char *socket_path)
+{
+    struct sockaddr_un addr;
+
+    if (!make_address(&addr, socket_path)) return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    if (connect(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+bool daemon_query(int fd, enum daemon_request request, const wchar_t *word,
+                  struct word_list *hints)
+{
+    struct buffer query = { NULL, 0, 0 };
+    uint8_t request_byte = request, found;
+    uint32_t n_hints;
+
+    buffer_put(&query, &request_byte, 1);
+    if (!buffer_put_string(&query, word)
+        || !write_full(fd, query.data, query.len)
+        || !read_full(fd, &found, 1) || !read_u32(fd, &n_hints))
+    {
+        fprintf(stderr, "Failed to query dictionary daemon\n");
+        exit(EXIT_FAILURE);
+    }
+    free(query.data);
+
+    word_list_init(hints);
+    for (uint32_t i = 0; i < n_hints; i++)
+    {
+        uint32_t len;
+        if (!read_u32(fd, &len) || len > MAX_RESPONSE_BYTES)
+        {
+            fprintf(stderr, "Failed to query dictionary daemon\n");
+            exit(EXIT_FAILURE);
+        }
+
+        char *bytes = malloc(len + 1);
+        wchar_t *hint = malloc((len + 1) * sizeof(wchar_t));
+        if (!bytes || !hint || !read_full(fd, bytes, len))
+        {
+            fprintf(stderr, "Failed to query dictionary daemon\n");
+            exit(EXIT_FAILURE);
+        }
+        bytes[len] = '\0';
+
+        if (mbstowcs(hint, bytes, len + 1) != (size_t) -1)
+            word_list_add(hints, hint);
+
+        free(hint);
+        free(bytes);
+    }
+
+    return found;
+}
+
+/**@}*/
@@ -0,0 +1,74 @@
+/** @file
+    Interfejs demona sprawdzającego słowa.
+
+    Demon wczytuje słownik raz i odpowiada na zapytania klientów przez
+    gniazdo domeny uniksowej. Gdy plik słownika się zmieni, słownik jest
+    wczytywany ponownie i podmieniany atomowo: każde zapytanie jest
+    obsługiwane w całości przez stary albo przez nowy słownik.
+
+    Protokół (liczby są czterobajtowe, w porządku sieciowym, a napisy
+    w UTF-8):
+    - zapytanie: jeden bajt rodzaju (enum daemon_request), długość słowa,
+      słowo złożone z małych liter;
+    - odpowiedź: jeden bajt (1, jeśli słowo jest w słowniku, 0 w p.p.),
+      liczba podpowiedzi, a potem każda podpowiedź jako długość i treść.
+
+    Połączenie może przesłać dowolnie wiele zapytań; odpowiedzi przychodzą
+    w kolejności zapytań. Wszystkie połączenia obsługuje jedna pętla
+    zdarzeń, która przekazuje pojedyncze zapytania puli wątków roboczych
+    (po jednym na procesor), więc bezczynny klient nie zajmuje wątku.
+    Połączenie bezczynne przez dziesięć minut jest zamykane.
+
+    @ingroup dict-check
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#ifndef __DAEMON_H__
+#define __DAEMON_H__
+
+#include "word_list.h"
+#include <stdbool.h>
+#include <wchar.h>
+
+/**
+  Rodzaj zapytania.
+  */
+enum daemon_request
+{
+    DAEMON_FIND = 'F',  ///< Czy słowo jest w słowniku.
+    DAEMON_HINTS = 'H', ///< Podpowiedzi dla słowa.
+    DAEMON_CHECK = 'C'  ///< Czy słowo jest w słowniku, a jeśli nie, to
+                        ///< podpowiedzi.
+};
+
+/**
+  Uruchamia demona. Funkcja wraca tylko w przypadku błędu.
+  @param[in] socket_path Ścieżka gniazda.
+  @param[in] filename Nazwa pliku słownika.
+  @return Kod wyjścia programu.
+  */
+int daemon_serve(const char *socket_path, const char *filename);
+
+/**
+  Łączy się z demonem.
+  @param[in] socket_path Ścieżka gniazda.
+  @return Deskryptor połączenia lub -1, jeśli operacja się nie powiedzie.
+  */
+int daemon_connect(const char *socket_path);
+
+/**
+  Wysyła zapytanie do demona i odbiera odpowiedź.
+  Błąd komunikacji kończy program.
+  @param[in] fd Deskryptor połączenia.
+  @param[in] request Rodzaj zapytania.
+  @param[in] word Słowo złożone z małych liter.
+  @param[out] hints Podpowiedzi; listę należy zniszczyć za pomocą
+  word_list_done().
+  @return Czy słowo jest w słowniku.
+  */
+bool daemon_query(int fd, enum daemon_request request, const wchar_t *word,
+                  struct word_list *hints);
+
+#endif /* __DAEMON_H__ */
@@ -3,20 +3,80 @@
   */
 /** @file
     Główny plik modułu dict-check
+
+    Użycie: `dict-check [-v] [-j liczba_wątków] [--stats] [--suffix przyrostek]
+    słownik [plik...]`,
+    `dict-check --daemon gniazdo słownik`,
+    `dict-check [-v] [-j liczba_wątków] [--stats] [--suffix przyrostek]
+    --connect gniazdo [plik...]`,
+    `dict-check --publish obraz słownik`,
+    `dict-check --freeze wynik słownik` lub
+    `dict-check [-j liczba_wątków] [--stats] [--suffix przyrostek]
+    --image obraz [plik...]`
+
+    Z opcją `--daemon` program wczytuje słownik i odpowiada na zapytania
+    klientów przez podane gniazdo (zob. daemon.h). Z opcją `--connect`
+    program nie wczytuje słownika, tylko pyta demona; wynik jest taki sam
+    jak przy sprawdzaniu z lokalnym słownikiem. Opcja `--publish` zapisuje
+    słownik jako obraz współdzielony między procesami (zob. image.h),
+    a opcja `--image` sprawdza tekst w dołączonym obrazie, bez wczytywania
+    słownika; podpowiedzi nie są wtedy dostępne. Opcja `--freeze` zapisuje
+    słownik razem z indeksem wyszukiwania dokładnego (zob.
+    dictionary_exact_index()), z którego korzysta każde sprawdzanie
+    z wczytanym słownikiem. Bez opcji `-v` słownik jest wczytywany tylko do
+    sprawdzania słów (zob. dictionary_load_lookup()), bez budowy drzewa
+    potrzebnego do podpowiedzi.
+
+    Wyniki sprawdzania najczęstszych słów są pamiętane, więc powtórzenia nie
+    wymagają przeszukiwania słownika. Opcja `--stats` wypisuje na koniec,
+    jaka część słów została znaleziona w pamięci podręcznej, oraz rozmiar
+    filtru Blooma słownika i szacowany odsetek jego fałszywych trafień.
+
+    Jeśli wejście jest zwykłym plikiem, jest ono mapowane w pamięci
+    i przeglądane bez kopiowania. W p.p. bez opcji `-j` wejście jest
+    przetwarzane potokiem trzech wątków: czytającego i dekodującego tekst,
+    sprawdzającego słowa oraz wypisującego wynik. Z opcją `-j` wejście jest
+    dzielone na fragmenty kończące się na końcu linii, sprawdzane równolegle
+    przez podaną liczbę wątków. Wyjście jest zawsze takie samo jak przy
+    sprawdzaniu po kolei.
+
+    Jeśli podano pliki do sprawdzenia (katalogi oznaczają wszystkie
+    nieukryte pliki w nich i w ich podkatalogach), słownik jest wczytywany
+    raz, a pliki są sprawdzane przez pulę wątków z podkradaniem zadań,
+    domyślnie tylu, ile jest procesorów. Długie pliki są dzielone na
+    fragmenty, które mogą sprawdzać różne wątki. Wynik każdego pliku jest
+    wypisywany na standardowe wyjście po nagłówku `==> plik <==`, w
+    kolejności plików, a linie wyjścia błędów są poprzedzone nazwą pliku
+    i dwukropkiem. Z opcją `--suffix` wynik jest zamiast tego zapisywany
+    do pliku o nazwie z dodanym przyrostkiem, a wyjście błędów do pliku
+    z dodatkowym przyrostkiem `.err`, jeśli jest niepuste.
     @ingroup dict-check
     @author Michał Łazowik <m.lazowik@student.uw.edu.pl>
     @date 2015-06-05
     @copyright Uniwersytet Warszawski
   */
 
+#define _POSIX_C_SOURCE 200809L
+
+#include "daemon.h"
 #include "dictionary.h"
+#include "image.h"
 #include "io.h"
+#include "ring.h"
+#include "token_cache.h"
+#include "tokenizer.h"
+#include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <dirent.h>
+#include <fcntl.h>
 #include <locale.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <wctype.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <wchar.h>
 
 /**
@@ -24,38 +84,180 @@
   */
 #define MAX_WORD_LENGTH 100
 
+/**
+  Maksymalna liczba wątków.
+  */
+#define MAX_JOBS 256
+
+/**
+  Najmniejszy rozmiar fragmentu wejścia w bajtach.
+  Fragment jest dłuższy, jeśli jego ostatnia linia jest dłuższa.
+  */
+#define MIN_CHUNK_SIZE (1 << 14)
+
+/**
+  Największy rozmiar fragmentu wejścia w bajtach, a zarazem rozmiar
+  fragmentu wejścia o nieznanej długości.
+  */
+#define MAX_CHUNK_SIZE (1 << 20)
+
+/**
+  Liczba fragmentów przypadających na jeden wątek.
+  */
+#define CHUNKS_PER_JOB 4
+
+/**
+  Maksymalna liczba znaków w paczce leksemów potoku.
+  */
+#define BATCH_TEXT 8192
+
+/**
+  Maksymalna liczba leksemów w paczce potoku.
+  */
+#define BATCH_TOKENS 1024
+
+/**
+  Maksymalna długość ciągu znaków niebędących literami w jednym leksemie.
+  */
+#define MAX_TEXT_LENGTH 256
+
+/**
+  Liczba słów pamiętanych przez każdy sprawdzający wątek.
+  */
+#define TOKEN_CACHE_SIZE 16384
+
+/**
+  Maksymalna liczba plików sprawdzonych, ale jeszcze niewypisanych na
+  wspólne wyjście.
+  */
+#define MAX_PENDING_FILES 1024
+
+/**
+  Przyrostek pliku z wyjściem błędów przy zapisie wyników obok plików.
+  */
+#define ERR_SUFFIX ".err"
+
+/**
+  Komunikat o zbyt długim słowie.
+  */
+#define LONG_WORD_MESSAGE L"Failed to read word: maximum allowed length is 100"
+
 /**
   Czy stosować szczegółowy format wyjścia.
   */
 static bool verbose;
 
+/**
+  Liczba wątków sprawdzających tekst (0, jeśli nie podano).
+  */
+static int jobs;
+
+/**
+  Pliki i katalogi do sprawdzenia (puste, jeśli sprawdzane jest
+  standardowe wejście).
+  */
+static char **inputs;
+
+/**
+  Liczba plików i katalogów do sprawdzenia.
+  */
+static size_t n_inputs;
+
+/**
+  Przyrostek plików z wynikami zapisywanymi obok sprawdzanych plików lub
+  NULL, jeśli wyniki są wypisywane na wspólne wyjście.
+  */
+static const char *output_suffix;
+
+/**
+  Czy wypisać statystyki pamięci podręcznej.
+  */
+static bool stats;
+
+/**
+  Łączna liczba trafień w pamięci podręcznej.
+  */
+static size_t cache_hits;
+
+/**
+  Łączna liczba wyszukań w pamięci podręcznej.
+  */
+static size_t cache_lookups;
+
+/**
+  Blokada statystyk pamięci podręcznej.
+  */
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+  Nazwa pliku słownika.
+  */
+static const char *dict_filename;
+
+/**
+  Tryb pracy programu.
+  */
+enum mode
+{
+    MODE_CHECK,   ///< Sprawdzanie z wczytanym słownikiem.
+    MODE_DAEMON,  ///< Demon (`--daemon`).
+    MODE_CONNECT, ///< Sprawdzanie z pomocą demona (`--connect`).
+    MODE_PUBLISH, ///< Publikowanie obrazu słownika (`--publish`).
+    MODE_FREEZE,  ///< Zapisywanie słownika z indeksem (`--freeze`).
+    MODE_IMAGE    ///< Sprawdzanie z dołączonym obrazem (`--image`).
+};
+
+/**
+  Tryb pracy programu.
+  */
+static enum mode mode;
+
+/**
+  Ścieżka gniazda demona lub pliku obrazu, zależnie od trybu.
+  */
+static const char *mode_path;
+
+/**
+  Dołączony obraz słownika lub NULL.
+  */
+static Image *image;
+
 /**
   Słownik.
   */
 struct dictionary *dict;
 
-/** Zamienia słowo na złożone z małych liter.
-  @param[in,out] word Modyfikowane słowo.
-  @return 0, jeśli słowo nie jest złożone z samych liter, 1 w p.p.
+/**
+  Stan sprawdzania słów należący do jednego wątku.
   */
-static int make_lowercase(wchar_t *word)
+struct checker
 {
-    for (wchar_t *w = word; *w; ++w)
-        if (!iswalpha(*w))
-            return 0;
-        else
-            *w = towlower(*w);
-    return 1;
-}
+    /// Pamięć podręczna wyników.
+    Token_Cache *cache;
+    /// Połączenie z demonem lub -1, jeśli słownik jest wczytany lokalnie.
+    int server;
+    /// Wyniki wyszukania kolejnych słów fragmentu wyznaczone przez
+    /// find_chunk(): 1 lub 0, albo -1, jeśli słowo sprawdza check_word().
+    signed char *known;
+    /// Liczba wyników w `known`.
+    size_t n_known;
+    /// Rozmiar tablicy `known`.
+    size_t known_size;
+    /// Indeks wyniku dla następnego wypisywanego słowa.
+    size_t next_known;
+};
 
 /**
   Wczytuje słownik z pliku o podanej nazwie
   @param[in] filename Nazwa pliku.
+  @param[in] lookup Czy słownik służy tylko do sprawdzania słów (zob.
+  dictionary_load_lookup()).
   */
-static void load_dictionary(const char *filename)
+static void load_dictionary(const char *filename, bool lookup)
 {
     FILE *f = fopen(filename, "r");
-    if (!f || !(dict = dictionary_load(f)))
+    if (!f || !(dict = lookup ? dictionary_load_lookup(f)
+                              : dictionary_load(f)))
     {
         fprintf(stderr, "Failed to load dictionary from file %s\n", filename);
         exit(1);
@@ -74,6 +276,10 @@ static void parse_option(const char *option)
     {
         verbose = true;
     }
+    else if (strcmp(option, "--stats") == 0)
+    {
+        stats = true;
+    }
     else
     {
         fprintf(stderr, "Unrecognized option: %s\n", option);
@@ -81,19 +287,56 @@ static void parse_option(const char *option)
     }
 }
 
+/**
+  Przetwarza liczbę wątków z argumentów linii poleceń.
+  @param[in] value Napis reprezentujący liczbę wątków.
+  */
+static void parse_jobs(const char *value)
+{
+    char *end;
+    long n = strtol(value, &end, 10);
+
+    if (value[0] == '\0' || *end != '\0' || n < 1 || n > MAX_JOBS)
+    {
+        fprintf(stderr, "Invalid number of jobs: %s\n", value);
+        exit(EXIT_FAILURE);
+    }
+
+    jobs = n;
+}
+
 /**
   Przetwarza nazwę pliku z argumentów linii poleceń.
+  Pierwsza nazwa jest nazwą słownika, a kolejne plikami do sprawdzenia.
   @param[in] filename Nazwa pliku
   */
-static void parse_filename(const char *filename)
+static void parse_filename(char *filename)
+{
+    if (dict_filename == NULL) dict_filename = filename;
+    else inputs[n_inputs++] = filename;
+}
+
+/**
+  Przetwarza opcję wybierającą tryb pracy z argumentów linii poleceń.
+  @param[in] option Opcja.
+  @param[in] path Ścieżka gniazda, pliku obrazu lub zapisywanego słownika.
+  */
+static void parse_mode(const char *option, const char *path)
 {
-    if (dict != NULL)
+    if (mode != MODE_CHECK)
     {
-        fprintf(stderr, "Only one dictionary file can be loaded\n");
+        fprintf(stderr, "Only one of --daemon, --connect, --publish, "
+                        "--freeze and --image can be used\n");
         exit(EXIT_FAILURE);
     }
 
-    load_dictionary(filename);
+    if (strcmp(option, "--daemon") == 0) mode = MODE_DAEMON;
+    else if (strcmp(option, "--connect") == 0) mode = MODE_CONNECT;
+    else if (strcmp(option, "--publish") == 0) mode = MODE_PUBLISH;
+    else if (strcmp(option, "--freeze") == 0) mode = MODE_FREEZE;
+    else mode = MODE_IMAGE;
+
+    mode_path = path;
 }
 
 /**
@@ -105,70 +348,240 @@ static void parse_filename(const char *filename)
   */
 static void parse_args(int argc, char *argv[])
 {
+    inputs = malloc((argc + 1) * sizeof(char *));
+    if (!inputs)
+    {
+        fprintf(stderr, "Failed to allocate memory for arguments\n");
+        exit(EXIT_FAILURE);
+    }
+
     for (size_t i = 0; i < argc; i++)
     {
-        if (argv[i][0] == '-') parse_option(argv[i]);
+        if (strcmp(argv[i], "-j") == 0)
+        {
+            if (i + 1 == argc)
+            {
+                fprintf(stderr, "Missing number of jobs\n");
+                exit(EXIT_FAILURE);
+            }
+            parse_jobs(argv[++i]);
+        }
+        else if (strncmp(argv[i], "-j", 2) == 0) parse_jobs(argv[i] + 2);
+        else if (strcmp(argv[i], "--daemon") == 0
+                 || strcmp(argv[i], "--connect") == 0
+                 || strcmp(argv[i], "--publish") == 0
+                 || strcmp(argv[i], "--freeze") == 0
+                 || strcmp(argv[i], "--image") == 0)
+        {
+            if (i + 1 == argc)
+            {
+                fprintf(stderr, "Missing path after %s\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+            parse_mode(argv[i], argv[i + 1]);
+            i++;
+        }
+        else if (strcmp(argv[i], "--suffix") == 0)
+        {
+            if (i + 1 == argc || argv[i + 1][0] == '\0')
+            {
+                fprintf(stderr, "Missing output suffix\n");
+                exit(EXIT_FAILURE);
+            }
+            output_suffix = argv[++i];
+        }
+        else if (argv[i][0] == '-') parse_option(argv[i]);
         else parse_filename(argv[i]);
     }
 
-    if (dict == NULL)
+    // Bez słownika wszystkie nazwy plików są plikami do sprawdzenia.
+    if ((mode == MODE_CONNECT || mode == MODE_IMAGE) && dict_filename != NULL)
+    {
+        memmove(inputs + 1, inputs, n_inputs * sizeof(char *));
+        inputs[0] = (char *) dict_filename;
+        n_inputs++;
+        dict_filename = NULL;
+    }
+
+    if (dict_filename == NULL && mode != MODE_CONNECT && mode != MODE_IMAGE)
     {
         fprintf(stderr, "No dictionary file provided\n");
         exit(EXIT_FAILURE);
     }
+
+    if ((mode == MODE_DAEMON || mode == MODE_PUBLISH || mode == MODE_FREEZE)
+        && n_inputs > 0)
+    {
+        fprintf(stderr, "Input files cannot be checked with --daemon, "
+                        "--publish or --freeze\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (output_suffix != NULL && n_inputs == 0)
+    {
+        fprintf(stderr, "--suffix requires input files\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (mode == MODE_IMAGE && verbose)
+    {
+        fprintf(stderr, "Hints are not available with --image\n");
+        exit(EXIT_FAILURE);
+    }
 }
 
 /**
-  Wczytuje słowo do `word`.
+  Wczytuje słowo do `word`, a jego wersję z małych liter do `folded`.
   @param[in,out] io We/wy.
   @param[in,out] word Docelowe słowo.
+  @param[in,out] folded Docelowe słowo z małych liter.
+  @return Czy słowo nie było za długie.
   */
-static void parse_word(IO *io, wchar_t *word)
+static bool parse_word(IO *io, wchar_t *word, wchar_t *folded)
 {
     int i = 0;
-    while (io_peek_next(io) != WEOF && iswalpha(io_peek_next(io)))
+    wint_t c;
+    while ((c = io_peek_next(io)) != WEOF && tokenizer_is_letter(c))
     {
         if (i > MAX_WORD_LENGTH)
         {
-            fprintf(stderr, "Failed to read word: maximum allowed length is 100");
-            exit(EXIT_FAILURE);
+            io_eprintf(io, LONG_WORD_MESSAGE);
+            return false;
         }
 
+        folded[i] = tokenizer_fold(c);
         word[i++] = io_get_next(io);
     }
 
-    word[i] = '\0';
+    word[i] = L'\0';
+    folded[i] = L'\0';
+
+    return true;
 }
 
 /**
-  Wypisuje podpowiedzi dla danego słowa.
+  Wypisuje linię z podpowiedziami dla słowa.
   @param[in,out] io We/wy.
-  @param[in] word Słowo dla którego szukane są podpowiedzi.
+  @param[in] n_line Numer linii słowa.
+  @param[in] n_char Numer znaku, od którego zaczyna się słowo.
+  @param[in] word Słowo.
+  @param[in] list Podpowiedzi.
   */
-static void print_hints(IO *io, const wchar_t *word)
+static void print_hint_list(IO *io, size_t n_line, size_t n_char,
+                            const wchar_t *word, const struct word_list *list)
 {
-    struct word_list list;
-    wchar_t lowercase[wcslen(word)];
+    const wchar_t * const *a = word_list_get(list);
 
-    wcscpy(lowercase, word);
-    make_lowercase(lowercase);
-
-    dictionary_hints(dict, lowercase, &list);
-    const wchar_t * const *a = word_list_get(&list);
-
-    size_t n_line = io_get_n_line(io);
-    size_t n_char = io_get_n_char(io) - wcslen(word);
     io_eprintf(io, L"%d,%d %ls: ", n_line, n_char, word);
 
-    for (size_t i = 0; i < word_list_size(&list); i++)
+    for (size_t i = 0; i < word_list_size(list); i++)
     {
         if (i > 0) io_eprintf(io, L" ");
         io_eprintf(io, L"%ls", a[i]);
     }
 
     io_eprintf(io, L"\n");
+}
+
+/**
+  Tworzy stan sprawdzania dla jednego wątku.
+  W trybie klienta otwiera własne połączenie z demonem.
+  @return Nowy stan sprawdzania.
+  */
+static struct checker * checker_new(void)
+{
+    struct checker *checker = malloc(sizeof(struct checker));
+    if (!checker)
+    {
+        fprintf(stderr, "Failed to allocate memory for checker\n");
+        exit(EXIT_FAILURE);
+    }
+
+    checker->cache = token_cache_new(TOKEN_CACHE_SIZE);
+    checker->server = -1;
+    checker->known = NULL;
+    checker->n_known = checker->known_size = checker->next_known = 0;
+
+    if (mode == MODE_CONNECT)
+    {
+        checker->server = daemon_connect(mode_path);
+        if (checker->server < 0)
+        {
+            fprintf(stderr, "Failed to connect to daemon at %s\n",
+                    mode_path);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    return checker;
+}
+
+/**
+  Niszczy stan sprawdzania, doliczając statystyki pamięci podręcznej do
+  łącznych.
+  @param[in,out] checker Stan sprawdzania.
+  */
+static void checker_done(struct checker *checker)
+{
+    pthread_mutex_lock(&stats_lock);
+    cache_hits += token_cache_hits(checker->cache);
+    cache_lookups += token_cache_lookups(checker->cache);
+    pthread_mutex_unlock(&stats_lock);
+
+    if (checker->server >= 0) close(checker->server);
+    token_cache_done(checker->cache);
+    free(checker->known);
+    free(checker);
+}
+
+/**
+  Sprawdza słowo, korzystając z pamięci podręcznej.
+  Podpowiedzi są wyznaczane tylko w trybie szczegółowym dla słów spoza
+  słownika. W trybie klienta słowa spoza pamięci podręcznej sprawdza demon,
+  a z opcją `--image` są one szukane w dołączonym obrazie.
+  @param[in,out] checker Stan sprawdzania.
+  @param[in] folded Słowo złożone z małych liter.
+  @param[in] known Wynik wyszukania słowa w słowniku, jeśli jest już znany,
+  lub NULL.
+  @param[out] hints Podpowiedzi (ważne do następnego sprawdzenia) lub NULL.
+  @return Czy słowo jest w słowniku.
+  */
+static bool check_word(struct checker *checker, const wchar_t *folded,
+                       const bool *known, const struct word_list **hints)
+{
+    Token_Cache *cache = checker->cache;
+    struct word_list list;
+    bool found;
+
+    if (token_cache_find(cache, folded, &found, hints)) return found;
+
+    if (checker->server >= 0)
+    {
+        found = daemon_query(checker->server,
+                             verbose ? DAEMON_CHECK : DAEMON_FIND, folded,
+                             &list);
+        if (verbose && !found)
+        {
+            *hints = token_cache_add(cache, folded, found, &list);
+            return found;
+        }
+
+        word_list_done(&list);
+    }
+    else if (image != NULL) found = image_has_word(image, folded);
+    else
+    {
+        found = known ? *known : dictionary_find(dict, folded);
+        if (verbose && !found)
+        {
+            dictionary_hints(dict, folded, &list);
+            *hints = token_cache_add(cache, folded, found, &list);
+            return found;
+        }
+    }
 
-    word_list_done(&list);
+    *hints = token_cache_add(cache, folded, found, NULL);
+    return found;
 }
 
 /**
@@ -177,65 +590,1885 @@ static void print_hints(IO *io, const wchar_t *word)
   Jeśli użyta została opcja verbose a słowa nie ma w słowniku, wypisuje także
   podpowiedzi dla tego słowa.
   @param[in,out] io We/wy.
+  @param[in,out] checker Stan sprawdzania.
   @param[in] word Słowo do wypisania.
+  @param[in] folded Słowo złożone z małych liter.
   */
-static void print_word(IO *io, const wchar_t *word)
+static void print_word(IO *io, struct checker *checker, const wchar_t *word,
+                       const wchar_t *folded)
 {
-    wchar_t lowercase[wcslen(word)];
+    const struct word_list *hints;
+    const bool *known = NULL;
+    bool found;
 
-    wcscpy(lowercase, word);
-    make_lowercase(lowercase);
+    if (checker->next_known < checker->n_known)
+    {
+        signed char result = checker->known[checker->next_known++];
+        if (result >= 0)
+        {
+            found = result;
+            known = &found;
+        }
+    }
 
-    bool word_exists = dictionary_find(dict, lowercase);
+    bool word_exists = check_word(checker, folded, known, &hints);
 
     if (!word_exists) io_printf(io, L"#");
     io_printf(io, L"%ls", word);
 
-    if (verbose && !word_exists) print_hints(io, word);
+    if (verbose && !word_exists)
+        print_hint_list(io, io_get_n_line(io),
+                        io_get_n_char(io) - wcslen(word), word, hints);
 }
 
 /**
   Przetwarza wejście programu.
   @param[in,out] io We/wy.
+  @param[in,out] checker Stan sprawdzania.
+  @return Czy wejście przetworzono do końca (false, jeśli słowo było za
+  długie).
   */
-static void parse_input(IO *io)
+static bool parse_input(IO *io, struct checker *checker)
 {
-    wchar_t word[MAX_WORD_LENGTH+1];
+    wchar_t word[MAX_WORD_LENGTH + 2], folded[MAX_WORD_LENGTH + 2];
+    wint_t c;
 
-    while (io_peek_next(io) != WEOF)
+    while ((c = io_peek_next(io)) != WEOF)
     {
-        if (iswalpha(io_peek_next(io)))
+        if (tokenizer_is_letter(c))
         {
-            parse_word(io, word);
-            print_word(io, word);
+            if (!parse_word(io, word, folded)) return false;
+            print_word(io, checker, word, folded);
         }
         else
         {
             io_printf(io, L"%lc", io_get_next(io));
         }
     }
+
+    return true;
 }
 
 /**
-  Funkcja main.
-  Główna funkcja programu do sprawdzania pisowni.
- */
-int main(int argc, char *argv[])
+  Stan fragmentu wejścia.
+  */
+enum chunk_state
 {
-    setlocale(LC_ALL, "pl_PL.UTF-8");
+    CHUNK_FREE,    ///< Miejsce na fragment jest wolne.
+    CHUNK_READY,   ///< Fragment czeka na sprawdzenie.
+    CHUNK_WORKING, ///< Fragment jest sprawdzany.
+    CHUNK_DONE     ///< Fragment czeka na wypisanie.
+};
 
-    verbose = false;
-    dict = NULL;
+/**
+  Fragment wejścia składający się z całych linii.
+  */
+struct chunk
+{
+    /// Stan fragmentu.
+    enum chunk_state state;
+    /// Wejście.
+    char *in;
+    /// Długość wejścia.
+    size_t in_len;
+    /// Numer pierwszej linii fragmentu.
+    size_t n_line;
+    /// Wyjście.
+    wchar_t *out;
+    /// Długość wyjścia.
+    size_t out_len;
+    /// Wyjście błędów.
+    wchar_t *err;
+    /// Długość wyjścia błędów.
+    size_t err_len;
+    /// Czy sprawdzanie zakończyło się błędem odczytu.
+    bool failed;
+    /// Czy sprawdzanie przerwano z powodu zbyt długiego słowa.
+    bool fatal;
+};
 
-    IO *io = io_new(stdin, stdout, stderr);
+/**
+  Kolejka fragmentów współdzielona przez wątki.
+  Fragment o numerze `i` zajmuje miejsce `i % n_chunks`. Fragmenty są
+  wczytywane i wypisywane w kolejności przez główny wątek, a sprawdzane
+  w kolejności wczytania przez wątki robocze.
+  */
+struct pool
+{
+    /// Blokada.
+    pthread_mutex_t lock;
+    /// Zmienna warunkowa sygnalizująca zmianę stanu fragmentu.
+    pthread_cond_t cond;
+    /// Miejsca na fragmenty.
+    struct chunk *chunks;
+    /// Liczba miejsc na fragmenty.
+    size_t n_chunks;
+    /// Numer następnego fragmentu do sprawdzenia.
+    size_t next_check;
+    /// Czy wczytano już całe wejście.
+    bool finished;
+};
 
-    parse_args(argc-1, argv+1);
+/**
+  Bufor wejścia dzielonego na fragmenty.
+  */
+struct reader
+{
+    /// Wejście.
+    FILE *in;
+    /// Bufor.
+    char *buf;
+    /// Liczba bajtów w buforze.
+    size_t len;
+    /// Rozmiar bufora.
+    size_t size;
+    /// Numer linii na początku bufora.
+    size_t n_line;
+    /// Czy osiągnięto koniec wejścia.
+    bool eof;
+};
 
-    parse_input(io);
+/** @name Wielowątkowe sprawdzanie
+  @{
+  */
 
-    io_done(io);
+/**
+  Wczytuje kolejny fragment wejścia.
+  Fragment kończy się na ostatnim końcu linii w wczytanych danych; jeśli
+  takiego nie ma, bufor jest powiększany.
+  @param[in,out] reader Bufor wejścia.
+  @param[out] chunk Fragment.
+  @return Czy wczytano niepusty fragment.
+  */
+static bool read_chunk(struct reader *reader, struct chunk *chunk)
+{
+    size_t end = 0;
+
+    while (true)
+    {
+        while (!reader->eof && reader->len < reader->size)
+        {
+            size_t n = fread(reader->buf + reader->len, 1,
+                             reader->size - reader->len, reader->in);
+            if (n == 0)
+            {
+                if (ferror(reader->in))
+                {
+                    fprintf(stderr, "Failed to read\n");
+                    exit(EXIT_FAILURE);
+                }
+                reader->eof = true;
+            }
+            reader->len += n;
+        }
+
+        for (end = reader->len; end > 0 && reader->buf[end - 1] != '\n';
+             end--);
+
+        if (end > 0 || reader->eof) break;
+
+        reader->size *= 2;
+        reader->buf = realloc(reader->buf, reader->size);
+        if (!reader->buf)
+        {
+            fprintf(stderr, "Failed to allocate memory for input\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (end == 0) end = reader->len;
+    if (end == 0) return false;
+
+    chunk->in = malloc(end);
+    if (!chunk->in)
+    {
+        fprintf(stderr, "Failed to allocate memory for input\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(chunk->in, reader->buf, end);
+    chunk->in_len = end;
+    chunk->n_line = reader->n_line;
+
+    for (size_t i = 0; i < end; i++)
+        if (reader->buf[i] == '\n') reader->n_line++;
+
+    reader->len -= end;
+    memmove(reader->buf, reader->buf + end, reader->len);
+
+    return true;
+}
+
+/**
+  Dopisuje wynik dla kolejnego słowa fragmentu.
+  @param[in,out] checker Stan sprawdzania.
+  @param[in] result Wynik.
+  */
+static void add_known(struct checker *checker, signed char result)
+{
+    if (checker->n_known == checker->known_size)
+    {
+        checker->known_size = checker->known_size ? 2 * checker->known_size
+                                                  : BATCH_TOKENS;
+        checker->known = realloc(checker->known, checker->known_size);
+        if (!checker->known)
+        {
+            fprintf(stderr, "Failed to allocate memory for checker\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    checker->known[checker->n_known++] = result;
+}
+
+/**
+  Szuka w słowniku słów zebranych przez find_chunk() i zapisuje wyniki.
+  @param[in,out] checker Stan sprawdzania.
+  @param[in] words Słowa.
+  @param[in] index Indeksy wyników słów w `checker->known`.
+  @param[in] n Liczba słów.
+  */
+static void find_known(struct checker *checker, const wchar_t **words,
+                       const size_t *index, size_t n)
+{
+    bool found[BATCH_TOKENS];
+
+    if (n == 0) return;
+    dictionary_find_batch(dict, words, n, found);
+
+    for (size_t j = 0; j < n; j++)
+        checker->known[index[j]] = found[j];
+}
+
+/**
+  Szuka w słowniku naraz słów fragmentu spoza pamięci podręcznej, tak jak
+  find_batch() w potoku. Wyniki trafiają do `checker->known` w kolejności
+  słów i są zużywane przez print_word(). Fragment jest przeglądany do
+  błędu kodowania lub za długiego słowa, bo na nich kończy się też
+  parse_input().
+  @param[in] chunk Fragment.
+  @param[in,out] checker Stan sprawdzania.
+  */
+static void find_chunk(const struct chunk *chunk, struct checker *checker)
+{
+    const wchar_t *words[BATCH_TOKENS];
+    size_t index[BATCH_TOKENS], n = 0;
+    wchar_t text[BATCH_TEXT];
+    size_t text_len = 0, start = 0, len = 0, pos = 0;
+    mbstate_t state;
+
+    checker->n_known = checker->next_known = 0;
+
+    // Z demonem i obrazem słowa są sprawdzane pojedynczo.
+    if (checker->server >= 0 || image != NULL) return;
+
+    memset(&state, 0, sizeof(mbstate_t));
+    while (true)
+    {
+        wchar_t c = L'\0';
+        size_t bytes = 0;
+
+        if (pos < chunk->in_len)
+            bytes = mbrtowc(&c, chunk->in + pos, chunk->in_len - pos, &state);
+        bool end = pos == chunk->in_len || bytes == (size_t) -1
+                   || bytes == (size_t) -2;
+
+        if (!end && tokenizer_is_letter(c))
+        {
+            if (len == MAX_WORD_LENGTH + 1) break;
+            if (len == 0)
+            {
+                if (n == BATCH_TOKENS
+                    || text_len + MAX_WORD_LENGTH + 2 > BATCH_TEXT)
+                {
+                    find_known(checker, words, index, n);
+                    n = text_len = 0;
+                }
+                start = text_len;
+            }
+            text[text_len++] = tokenizer_fold(c);
+            len++;
+        }
+        else if (len > 0)
+        {
+            text[text_len++] = L'\0';
+            if (token_cache_contains(checker->cache, text + start))
+            {
+                add_known(checker, -1);
+                text_len = start;
+            }
+            else
+            {
+                index[n] = checker->n_known;
+                words[n++] = text + start;
+                add_known(checker, -1);
+            }
+            len = 0;
+        }
+
+        if (end) break;
+        pos += bytes == 0 ? 1 : bytes;
+    }
+
+    find_known(checker, words, index, n);
+}
+
+/**
+  Sprawdza fragment wejścia, zapisując wyjście w pamięci.
+  Strumienie z fmemopen() nie obsługują znaków szerokich, dlatego wejście
+  jest czytane bezpośrednio z bufora.
+  @param[in,out] chunk Fragment.
+  @param[in,out] checker Stan sprawdzania.
+  */
+static void check_chunk(struct chunk *chunk, struct checker *checker)
+{
+    FILE *out = open_wmemstream(&chunk->out, &chunk->out_len);
+    FILE *err = open_wmemstream(&chunk->err, &chunk->err_len);
+    if (!out || !err)
+    {
+        fprintf(stderr, "Failed to open memory stream\n");
+        exit(EXIT_FAILURE);
+    }
+
+    IO *io = io_new_buffer(chunk->in, chunk->in_len, out, err);
+    io_set_n_line(io, chunk->n_line);
+
+    find_chunk(chunk, checker);
+    chunk->fatal = !parse_input(io, checker);
+    chunk->failed = io_error(io);
+    checker->n_known = checker->next_known = 0;
+
+    io_done(io);
+    fclose(err);
+    fclose(out);
+}
+
+/**
+  Wypisuje napis, który może zawierać znaki zerowe.
+  @param[in] str Napis.
+  @param[in] len Długość napisu.
+  @param[in,out] stream Strumień.
+  */
+static void write_wide(const wchar_t *str, size_t len, FILE *stream)
+{
+    const wchar_t *end = str + len;
+
+    while (str < end)
+    {
+        fputws(str, stream);
+        str += wcslen(str);
+        if (str < end) fputwc(*str++, stream);
+    }
+}
+
+/**
+  Funkcja wątku roboczego: sprawdza kolejne wczytane fragmenty.
+  @param[in,out] _pool Kolejka fragmentów.
+  @return NULL.
+  */
+static void * worker(void *_pool)
+{
+    struct pool *pool = _pool;
+    struct checker *checker = checker_new();
+
+    pthread_mutex_lock(&pool->lock);
+    while (true)
+    {
+        struct chunk *chunk =
+            &pool->chunks[pool->next_check % pool->n_chunks];
+
+        if (chunk->state == CHUNK_READY)
+        {
+            chunk->state = CHUNK_WORKING;
+            pool->next_check++;
+
+            pthread_mutex_unlock(&pool->lock);
+            check_chunk(chunk, checker);
+            pthread_mutex_lock(&pool->lock);
+
+            chunk->state = CHUNK_DONE;
+            pthread_cond_broadcast(&pool->cond);
+        }
+        else if (pool->finished) break;
+        else pthread_cond_wait(&pool->cond, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    checker_done(checker);
+
+    return NULL;
+}
+
+/**
+  Wyznacza rozmiar fragmentu wejścia o danej długości tak, żeby wejście
+  dzieliło się na tyle fragmentów, ile mieści pula, i żeby wszystkie
+  wątki dostały pracę także przy krótkim wejściu.
+  @param[in] input_size Długość wejścia w bajtach.
+  @param[in] n_jobs Liczba wątków.
+  @return Rozmiar fragmentu w bajtach.
+  */
+static size_t chunk_size(size_t input_size, int n_jobs)
+{
+    size_t size = input_size / ((size_t) n_jobs * CHUNKS_PER_JOB);
+
+    if (size < MIN_CHUNK_SIZE) return MIN_CHUNK_SIZE;
+    if (size > MAX_CHUNK_SIZE) return MAX_CHUNK_SIZE;
+    return size;
+}
+
+/**
+  Wyznacza rozmiar fragmentu czytanego wejścia.
+  @param[in] in Wejście.
+  @return Rozmiar fragmentu w bajtach; MAX_CHUNK_SIZE, jeśli długość
+  wejścia nie jest znana.
+  */
+static size_t stream_chunk_size(FILE *in)
+{
+    struct stat st;
+    off_t pos = ftello(in);
+
+    if (fstat(fileno(in), &st) != 0 || !S_ISREG(st.st_mode) || pos < 0
+        || st.st_size <= pos)
+        return MAX_CHUNK_SIZE;
+
+    return chunk_size(st.st_size - pos, jobs);
+}
+
+/**
+  Przetwarza wejście programu z użyciem `jobs` wątków.
+  Główny wątek wczytuje fragmenty i wypisuje wyniki w kolejności wejścia.
+  Tak jak przy sprawdzaniu po kolei, błąd odczytu kończy przetwarzanie:
+  wyniki dalszych fragmentów są pomijane.
+  @param[in] in Wejście.
+  */
+static void parse_input_parallel(FILE *in)
+{
+    struct pool pool;
+    size_t size = stream_chunk_size(in);
+    struct reader reader = {
+        .in = in,
+        .buf = malloc(size),
+        .len = 0,
+        .size = size,
+        .n_line = 1,
+        .eof = false
+    };
+    pthread_t threads[jobs];
+
+    pool.n_chunks = CHUNKS_PER_JOB * jobs;
+    pool.chunks = calloc(pool.n_chunks, sizeof(struct chunk));
+    pool.next_check = 0;
+    pool.finished = false;
+    if (!reader.buf || !pool.chunks)
+    {
+        fprintf(stderr, "Failed to allocate memory for input\n");
+        exit(EXIT_FAILURE);
+    }
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.cond, NULL);
+
+    for (int i = 0; i < jobs; i++)
+    {
+        if (pthread_create(&threads[i], NULL, worker, &pool) != 0)
+        {
+            fprintf(stderr, "Failed to create thread\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    size_t next_read = 0, next_write = 0;
+    bool failed = false;
+
+    pthread_mutex_lock(&pool.lock);
+    while (!pool.finished || next_write < next_read)
+    {
+        struct chunk *chunk = &pool.chunks[next_write % pool.n_chunks];
+        if (next_write < next_read && chunk->state == CHUNK_DONE)
+        {
+            pthread_mutex_unlock(&pool.lock);
+            if (!failed)
+            {
+                write_wide(chunk->out, chunk->out_len, stdout);
+                write_wide(chunk->err, chunk->err_len, stderr);
+                // Tak jak przy sprawdzaniu po kolei.
+                if (chunk->fatal) exit(EXIT_FAILURE);
+                failed = chunk->failed;
+            }
+            free(chunk->out);
+            free(chunk->err);
+            free(chunk->in);
+            pthread_mutex_lock(&pool.lock);
+
+            chunk->state = CHUNK_FREE;
+            next_write++;
+            if (failed && !pool.finished)
+            {
+                pool.finished = true;
+                pthread_cond_broadcast(&pool.cond);
+            }
+            continue;
+        }
+
+        chunk = &pool.chunks[next_read % pool.n_chunks];
+        if (!pool.finished && chunk->state == CHUNK_FREE)
+        {
+            pthread_mutex_unlock(&pool.lock);
+            bool read = read_chunk(&reader, chunk);
+            pthread_mutex_lock(&pool.lock);
+
+            if (read)
+            {
+                chunk->state = CHUNK_READY;
+                next_read++;
+            }
+            else pool.finished = true;
+            pthread_cond_broadcast(&pool.cond);
+            continue;
+        }
+
+        pthread_cond_wait(&pool.cond, &pool.lock);
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    for (int i = 0; i < jobs; i++) pthread_join(threads[i], NULL);
+
+    pthread_cond_destroy(&pool.cond);
+    pthread_mutex_destroy(&pool.lock);
+    free(pool.chunks);
+    free(reader.buf);
+}
+
+/**@}*/
+
+/**
+  Rodzaj leksemu.
+  */
+enum token_type
+{
+    TOKEN_TEXT,  ///< Ciąg znaków niebędących literami.
+    TOKEN_WORD,  ///< Słowo.
+    TOKEN_ERROR, ///< Komunikat o błędzie wejścia.
+    TOKEN_FATAL  ///< Komunikat o błędzie kończącym program.
+};
+
+/**
+  Leksem wejścia.
+  */
+struct token
+{
+    /// Rodzaj leksemu.
+    enum token_type type;
+    /// Początek tekstu leksemu w buforze paczki. Za tekstem słowa jest
+    /// jego wersja złożona z małych liter.
+    size_t start;
+    /// Długość tekstu leksemu.
+    size_t len;
+    /// Numer linii, w której zaczyna się leksem.
+    size_t n_line;
+    /// Numer znaku, od którego zaczyna się leksem.
+    size_t n_char;
+    /// Czy słowo jest w słowniku.
+    bool found;
+    /// Czy `found` jest już wyznaczone przez find_batch().
+    bool known;
+    /// Podpowiedzi dla słowa spoza słownika w trybie szczegółowym.
+    struct word_list hints;
+};
+
+/**
+  Paczka leksemów przekazywana między etapami potoku.
+  Tekst każdego leksemu jest zakończony znakiem zerowym.
+  */
+struct batch
+{
+    /// Teksty leksemów.
+    wchar_t text[BATCH_TEXT];
+    /// Liczba zajętych znaków w `text`.
+    size_t text_len;
+    /// Leksemy.
+    struct token tokens[BATCH_TOKENS];
+    /// Liczba leksemów.
+    size_t n_tokens;
+    /// Czy to ostatnia paczka.
+    bool last;
+};
+
+/**
+  Potok sprawdzania tekstu.
+  Paczki krążą w kółko: od czytającego do sprawdzającego, od niego do
+  wypisującego i z powrotem do czytającego.
+  */
+struct pipeline
+{
+    /// Wejście.
+    FILE *in;
+    /// Paczki puste, do zapełnienia przez wątek czytający.
+    Ring *empty;
+    /// Paczki wczytane, do sprawdzenia.
+    Ring *read;
+    /// Paczki sprawdzone, do wypisania.
+    Ring *checked;
+};
+
+/** @name Potok sprawdzania
+  @{
+  */
+
+/**
+  Zwraca pustą paczkę.
+  @param[in,out] pipeline Potok.
+  @return Paczka.
+  */
+static struct batch * empty_batch(struct pipeline *pipeline)
+{
+    struct batch *batch = ring_pop(pipeline->empty);
+
+    batch->text_len = 0;
+    batch->n_tokens = 0;
+    batch->last = false;
+
+    return batch;
+}
+
+/**
+  Dodaje leksem do paczki. Pełną paczkę przekazuje do sprawdzenia.
+  @param[in,out] pipeline Potok.
+  @param[in,out] batch Bieżąca paczka.
+  @param[in] type Rodzaj leksemu.
+  @param[in] text Tekst leksemu.
+  @param[in] folded Tekst złożony z małych liter lub NULL, jeśli leksem
+  nie jest słowem.
+  @param[in] len Długość tekstu.
+  @param[in] n_line Numer linii.
+  @param[in] n_char Numer znaku.
+  @return Bieżąca paczka.
+  */
+static struct batch * add_token(struct pipeline *pipeline, struct batch *batch,
+                                enum token_type type, const wchar_t *text,
+                                const wchar_t *folded, size_t len,
+                                size_t n_line, size_t n_char)
+{
+    size_t size = (folded != NULL ? 2 : 1) * (len + 1);
+
+    if (batch->n_tokens == BATCH_TOKENS
+        || batch->text_len + size > BATCH_TEXT)
+    {
+        ring_push(pipeline->read, batch);
+        batch = empty_batch(pipeline);
+    }
+
+    struct token *token = &batch->tokens[batch->n_tokens++];
+    token->type = type;
+    token->start = batch->text_len;
+    token->len = len;
+    token->n_line = n_line;
+    token->n_char = n_char;
+
+    wmemcpy(batch->text + batch->text_len, text, len);
+    batch->text[batch->text_len + len] = L'\0';
+    if (folded != NULL)
+    {
+        wmemcpy(batch->text + batch->text_len + len + 1, folded, len);
+        batch->text[batch->text_len + 2 * len + 1] = L'\0';
+    }
+    batch->text_len += size;
+
+    return batch;
+}
+
+/**
+  Funkcja wątku czytającego: dekoduje wejście i dzieli je na leksemy.
+  Błędy wejścia są przekazywane jako leksemy, żeby komunikaty pojawiły się
+  w tym samym miejscu wyjścia co przy sprawdzaniu po kolei.
+  @param[in,out] _pipeline Potok.
+  @return NULL.
+  */
+static void * read_tokens(void *_pipeline)
+{
+    struct pipeline *pipeline = _pipeline;
+    struct batch *batch = empty_batch(pipeline);
+
+    wchar_t word[MAX_WORD_LENGTH + 1], folded[MAX_WORD_LENGTH + 1];
+    wchar_t text[MAX_TEXT_LENGTH];
+    size_t word_len = 0, text_len = 0;
+    size_t n_line = 1, n_char = 1;
+    size_t word_line = 0, word_char = 0, text_line = 1, text_char = 1;
+    wint_t c;
+
+    while ((c = fgetwc(pipeline->in)) != WEOF)
+    {
+        if (tokenizer_is_letter(c))
+        {
+            if (text_len > 0)
+            {
+                batch = add_token(pipeline, batch, TOKEN_TEXT, text, NULL,
+                                  text_len, text_line, text_char);
+                text_len = 0;
+            }
+            if (word_len == 0)
+            {
+                word_line = n_line;
+                word_char = n_char;
+            }
+            if (word_len == MAX_WORD_LENGTH + 1)
+            {
+                batch = add_token(pipeline, batch, TOKEN_FATAL,
+                                  LONG_WORD_MESSAGE, NULL,
+                                  wcslen(LONG_WORD_MESSAGE), n_line, n_char);
+                word_len = 0;
+                break;
+            }
+            folded[word_len] = tokenizer_fold(c);
+            word[word_len++] = c;
+        }
+        else
+        {
+            if (word_len > 0)
+            {
+                batch = add_token(pipeline, batch, TOKEN_WORD, word, folded,
+                                  word_len, word_line, word_char);
+                word_len = 0;
+            }
+            if (text_len == 0)
+            {
+                text_line = n_line;
+                text_char = n_char;
+            }
+            text[text_len++] = c;
+            if (text_len == MAX_TEXT_LENGTH)
+            {
+                batch = add_token(pipeline, batch, TOKEN_TEXT, text, NULL,
+                                  text_len, text_line, text_char);
+                text_len = 0;
+            }
+        }
+
+        n_char++;
+        if (c == L'\n')
+        {
+            n_char = 1;
+            n_line++;
+        }
+    }
+
+    bool error = ferror(pipeline->in);
+    const wchar_t *message = L"Failed to read\n";
+
+    if (text_len > 0)
+        batch = add_token(pipeline, batch, TOKEN_TEXT, text, NULL, text_len,
+                          text_line, text_char);
+    if (error)
+        batch = add_token(pipeline, batch, TOKEN_ERROR, message, NULL,
+                          wcslen(message), n_line, n_char);
+    if (word_len > 0)
+        batch = add_token(pipeline, batch, TOKEN_WORD, word, folded, word_len,
+                          word_line, word_char);
+    // Przy sprawdzaniu po kolei błąd w środku słowa jest zgłaszany dwa razy.
+    if (error && word_len > 0)
+        batch = add_token(pipeline, batch, TOKEN_ERROR, message, NULL,
+                          wcslen(message), n_line, n_char);
+
+    batch->last = true;
+    ring_push(pipeline->read, batch);
+
+    return NULL;
+}
+
+/**
+  Szuka w słowniku naraz wszystkich słów paczki spoza pamięci podręcznej.
+  Wyniki trafiają do pól `found` i `known` leksemów.
+  @param[in] checker Stan sprawdzania.
+  @param[in,out] batch Paczka leksemów.
+  */
+static void find_batch(struct checker *checker, struct batch *batch)
+{
+    const wchar_t *words[BATCH_TOKENS];
+    bool found[BATCH_TOKENS];
+    size_t index[BATCH_TOKENS], n = 0;
+
+    for (size_t i = 0; i < batch->n_tokens; i++)
+        batch->tokens[i].known = false;
+
+    // Z demonem i obrazem słowa są sprawdzane pojedynczo.
+    if (checker->server >= 0 || image != NULL) return;
+
+    for (size_t i = 0; i < batch->n_tokens; i++)
+    {
+        struct token *token = &batch->tokens[i];
+        const wchar_t *folded = batch->text + token->start + token->len + 1;
+
+        if (token->type == TOKEN_WORD
+            && !token_cache_contains(checker->cache, folded))
+        {
+            index[n] = i;
+            words[n++] = folded;
+        }
+    }
+
+    if (n == 0) return;
+    dictionary_find_batch(dict, words, n, found);
+
+    for (size_t j = 0; j < n; j++)
+    {
+        batch->tokens[index[j]].found = found[j];
+        batch->tokens[index[j]].known = true;
+    }
+}
+
+/**
+  Funkcja wątku sprawdzającego: szuka słów w słowniku.
+  @param[in,out] _pipeline Potok.
+  @return NULL.
+  */
+static void * check_tokens(void *_pipeline)
+{
+    struct pipeline *pipeline = _pipeline;
+    struct checker *checker = checker_new();
+    bool last = false;
+
+    while (!last)
+    {
+        struct batch *batch = ring_pop(pipeline->read);
+
+        find_batch(checker, batch);
+        for (size_t i = 0; i < batch->n_tokens; i++)
+        {
+            struct token *token = &batch->tokens[i];
+            if (token->type != TOKEN_WORD) continue;
+
+            const wchar_t *folded = batch->text + token->start + token->len + 1;
+            const struct word_list *hints;
+
+            // Wątek wypisujący potrzebuje własnej kopii podpowiedzi, bo
+            // pamięć podręczna może je w tym czasie usunąć.
+            token->found = check_word(checker, folded,
+                                      token->known ? &token->found : NULL,
+                                      &hints);
+            if (verbose && !token->found)
+            {
+                word_list_init(&token->hints);
+                for (size_t j = 0; j < word_list_size(hints); j++)
+                    word_list_add(&token->hints, word_list_get(hints)[j]);
+            }
+        }
+
+        last = batch->last;
+        ring_push(pipeline->checked, batch);
+    }
+
+    checker_done(checker);
+
+    return NULL;
+}
+
+/**
+  Wypisuje sprawdzone leksemy.
+  @param[in,out] pipeline Potok.
+  */
+static void write_tokens(struct pipeline *pipeline)
+{
+    IO *io = io_new(pipeline->in, stdout, stderr);
+    bool last = false;
+
+    while (!last)
+    {
+        struct batch *batch = ring_pop(pipeline->checked);
+
+        for (size_t i = 0; i < batch->n_tokens; i++)
+        {
+            struct token *token = &batch->tokens[i];
+            const wchar_t *text = batch->text + token->start;
+
+            switch (token->type)
+            {
+                case TOKEN_TEXT:
+                    write_wide(text, token->len, stdout);
+                    break;
+                case TOKEN_WORD:
+                    if (!token->found) io_printf(io, L"#");
+                    io_printf(io, L"%ls", text);
+                    if (verbose && !token->found)
+                    {
+                        print_hint_list(io, token->n_line, token->n_char,
+                                        text, &token->hints);
+                        word_list_done(&token->hints);
+                    }
+                    break;
+                case TOKEN_ERROR:
+                    io_eprintf(io, L"%ls", text);
+                    break;
+                case TOKEN_FATAL:
+                    io_eprintf(io, L"%ls", text);
+                    exit(EXIT_FAILURE);
+            }
+        }
+
+        last = batch->last;
+        ring_push(pipeline->empty, batch);
+    }
+
+    io_done(io);
+}
+
+/**
+  Przetwarza wejście programu potokiem trzech wątków.
+  @param[in] in Wejście.
+  */
+static void parse_input_pipeline(FILE *in)
+{
+    struct pipeline pipeline;
+    struct batch *batches = malloc(sizeof(struct batch) * RING_SIZE);
+    pthread_t reader, checker;
+
+    pipeline.in = in;
+    pipeline.empty = ring_new();
+    pipeline.read = ring_new();
+    pipeline.checked = ring_new();
+    if (!batches)
+    {
+        fprintf(stderr, "Failed to allocate memory for input\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < RING_SIZE; i++)
+        ring_push(pipeline.empty, &batches[i]);
+
+    if (pthread_create(&reader, NULL, read_tokens, &pipeline) != 0
+        || pthread_create(&checker, NULL, check_tokens, &pipeline) != 0)
+    {
+        fprintf(stderr, "Failed to create thread\n");
+        exit(EXIT_FAILURE);
+    }
+
+    write_tokens(&pipeline);
+
+    pthread_join(checker, NULL);
+    pthread_join(reader, NULL);
+
+    ring_done(pipeline.checked);
+    ring_done(pipeline.read);
+    ring_done(pipeline.empty);
+    free(batches);
+}
+
+/**@}*/
+
+/** @name Sprawdzanie zmapowanego pliku
+  @{
+  */
+
+/**
+  Aktualizuje numer linii i znaku po przejściu przez poprawny tekst.
+  @param[in] data Tekst.
+  @param[in] size Długość tekstu w bajtach.
+  @param[in,out] n_line Numer linii.
+  @param[in,out] n_char Numer znaku w linii.
+  */
+static void advance_position(const char *data, size_t size, size_t *n_line,
+                             size_t *n_char)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        if (data[i] == '\n')
+        {
+            (*n_line)++;
+            *n_char = 1;
+        }
+        else if ((data[i] & 0xC0) != 0x80) (*n_char)++;
+    }
+}
+
+/**
+  Dekoduje poprawny tekst.
+  @param[in] data Tekst.
+  @param[in] size Długość tekstu w bajtach.
+  @param[out] word Zdekodowany tekst.
+  */
+static void decode_word(const char *data, size_t size, wchar_t *word)
+{
+    for (size_t pos = 0; pos < size; word++)
+        pos += tokenizer_decode(data + pos, size - pos, word);
+
+    *word = L'\0';
+}
+
+/**
+  Wyznacza długość tekstu bez niepełnego znaku na jego końcu. Przy
+  czytaniu strumienia taki znak kończy wejście, a nie jest błędem.
+  @param[in] data Tekst.
+  @param[in] size Długość tekstu w bajtach.
+  @return Długość tekstu bez niepełnego znaku na końcu.
+  */
+static size_t complete_length(const char *data, size_t size)
+{
+    for (size_t k = 1; k <= size && k <= MB_CUR_MAX; k++)
+    {
+        mbstate_t state;
+        memset(&state, 0, sizeof(mbstate_t));
+
+        size_t n = mbrtowc(NULL, data + size - k, k, &state);
+        if (n == (size_t) -2) return size - k;
+        if (n != (size_t) -1) break;
+    }
+
+    return size;
+}
+
+/**
+  Przetwarza wejście programu zmapowane w pamięci.
+  Tekst między słowami jest wypisywany bez dekodowania, całymi fragmentami,
+  a słowa są zamieniane na małe litery od razu przy wczytywaniu. Wyjście
+  jest takie samo jak przy czytaniu strumienia.
+  @param[in] data Wejście.
+  @param[in] size Długość wejścia w bajtach.
+  */
+static void parse_input_mapped(const char *data, size_t size)
+{
+    IO *io = io_new(stdin, stdout, stderr);
+    struct checker *checker = checker_new();
+    wchar_t lowercase[MAX_WORD_LENGTH + 2];
+    size_t pos = 0, n_line = 1, n_char = 1;
+    bool error = false;
+
+    size = complete_length(data, size);
+    while (pos < size && !error)
+    {
+        size_t start = pos;
+        pos = tokenizer_skip_text(data, size, pos, &error);
+        fwrite(data + start, 1, pos - start, stdout);
+        advance_position(data + start, pos - start, &n_line, &n_char);
+
+        if (error) io_eprintf(io, L"Failed to read\n");
+        if (pos == size || error) break;
+
+        size_t word_line = n_line, word_char = n_char, len;
+        wchar_t c;
+        start = pos;
+        pos = tokenizer_scan_word(data, size, pos, lowercase,
+                                  MAX_WORD_LENGTH + 1, &len, &error);
+        if (len == MAX_WORD_LENGTH + 1 && pos < size && !error)
+        {
+            if (tokenizer_decode(data + pos, size - pos, &c) == 0)
+                error = true;
+            else if (tokenizer_is_letter(c))
+            {
+                fwprintf(stderr, LONG_WORD_MESSAGE);
+                exit(EXIT_FAILURE);
+            }
+        }
+        n_char += len;
+
+        // Przy czytaniu strumienia błąd w środku słowa jest zgłaszany dwa razy.
+        if (error) io_eprintf(io, L"Failed to read\n");
+
+        const struct word_list *hints;
+        bool found = check_word(checker, lowercase, NULL, &hints);
+        if (!found) fputc('#', stdout);
+        fwrite(data + start, 1, pos - start, stdout);
+
+        if (verbose && !found)
+        {
+            wchar_t word[MAX_WORD_LENGTH + 2];
+
+            decode_word(data + start, pos - start, word);
+            print_hint_list(io, word_line, word_char, word, hints);
+        }
+
+        if (error) io_eprintf(io, L"Failed to read\n");
+    }
+
+    checker_done(checker);
+    io_done(io);
+}
+
+/**
+  Mapuje standardowe wejście w pamięci, jeśli jest ono zwykłym plikiem.
+  @param[out] size Długość wejścia w bajtach.
+  @return Zmapowane wejście lub NULL, jeśli trzeba je czytać strumieniowo.
+  */
+static const char * map_input(size_t *size)
+{
+    struct stat st;
+
+    if (fstat(STDIN_FILENO, &st) != 0 || !S_ISREG(st.st_mode)
+        || st.st_size == 0 || lseek(STDIN_FILENO, 0, SEEK_CUR) != 0)
+        return NULL;
+
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+                      STDIN_FILENO, 0);
+    if (data == MAP_FAILED) return NULL;
+
+    posix_madvise(data, st.st_size, POSIX_MADV_SEQUENTIAL);
+    *size = st.st_size;
+
+    return data;
+}
+
+/**@}*/
+
+/**
+  Plik wejściowy sprawdzany w trybie wielu plików.
+  */
+struct input_file
+{
+    /// Ścieżka pliku.
+    char *path;
+    /// Zmapowana zawartość pliku lub NULL.
+    char *data;
+    /// Rozmiar pliku.
+    size_t size;
+    /// Fragmenty pliku.
+    struct chunk *chunks;
+    /// Liczba fragmentów.
+    size_t n_chunks;
+    /// Liczba fragmentów, które nie zostały jeszcze sprawdzone.
+    size_t remaining;
+    /// Czy plik został w całości sprawdzony.
+    bool checked;
+    /// Czy nie udało się otworzyć pliku.
+    bool failed;
+    /// Czy sprawdzanie przerwano z powodu zbyt długiego słowa.
+    bool fatal;
+};
+
+/**
+  Zadanie dla wątku: sprawdzenie jednego fragmentu pliku.
+  */
+struct task
+{
+    /// Plik.
+    struct input_file *file;
+    /// Numer fragmentu.
+    size_t index;
+};
+
+/**
+  Kolejka zadań wątku.
+  Właściciel dodaje i zdejmuje zadania z końca, a pozostałe wątki kradną
+  je z początku, więc zabierają fragmenty najdalsze od tych, które
+  właściciel właśnie sprawdza.
+  */
+struct deque
+{
+    /// Blokada.
+    pthread_mutex_t lock;
+    /// Zadania.
+    struct task *tasks;
+    /// Indeks pierwszego zadania.
+    size_t head;
+    /// Indeks za ostatnim zadaniem.
+    size_t tail;
+    /// Rozmiar tablicy zadań.
+    size_t size;
+};
+
+/**
+  Stan sprawdzania wielu plików.
+  */
+struct file_pool
+{
+    /// Blokada.
+    pthread_mutex_t lock;
+    /// Zmienna warunkowa sygnalizująca zmianę stanu.
+    pthread_cond_t cond;
+    /// Licznik zmian stanu, na które mogą czekać bezczynne wątki.
+    unsigned long version;
+    /// Pliki wejściowe.
+    struct input_file *files;
+    /// Liczba plików.
+    size_t n_files;
+    /// Rozmiar tablicy plików.
+    size_t size;
+    /// Numer następnego pliku do podjęcia przez wątek.
+    size_t next_claim;
+    /// Liczba plików w całości sprawdzonych.
+    size_t n_checked;
+    /// Numer następnego pliku do wypisania na wspólne wyjście.
+    size_t next_write;
+    /// Kolejki zadań wątków.
+    struct deque *deques;
+    /// Liczba wątków.
+    int n_workers;
+};
+
+/**
+  Argument wątku sprawdzającego pliki.
+  */
+struct file_worker
+{
+    /// Stan sprawdzania.
+    struct file_pool *pool;
+    /// Numer wątku.
+    int id;
+};
+
+/** @name Sprawdzanie wielu plików
+  @{
+  */
+
+/**
+  Kończy program z powodu braku pamięci.
+  */
+static void files_out_of_memory(void)
+{
+    fprintf(stderr, "Failed to allocate memory for input files\n");
+    exit(EXIT_FAILURE);
+}
+
+/**
+  Sprawdza, czy nazwa pliku kończy się danym napisem.
+  @param[in] name Nazwa pliku.
+  @param[in] end Napis.
+  @return Czy nazwa kończy się napisem.
+  */
+static bool ends_with(const char *name, const char *end)
+{
+    size_t len = strlen(name), end_len = strlen(end);
+
+    return len >= end_len && strcmp(name + len - end_len, end) == 0;
+}
+
+/**
+  Dodaje plik do listy plików wejściowych.
+  @param[in,out] pool Stan sprawdzania.
+  @param[in] path Ścieżka pliku.
+  */
+static void add_input_file(struct file_pool *pool, const char *path)
+{
+    if (pool->n_files == pool->size)
+    {
+        pool->size = pool->size ? 2 * pool->size : 64;
+        pool->files = realloc(pool->files,
+                              pool->size * sizeof(struct input_file));
+        if (!pool->files) files_out_of_memory();
+    }
+
+    struct input_file *file = &pool->files[pool->n_files++];
+    memset(file, 0, sizeof(struct input_file));
+    file->path = strdup(path);
+    if (!file->path) files_out_of_memory();
+}
+
+/**
+  Dodaje do listy plików wejściowych zwykłe pliki z katalogu i jego
+  podkatalogów, w kolejności alfabetycznej.
+  Pomijane są pliki ukryte i pliki wynikowe poprzednich uruchomień.
+  @param[in,out] pool Stan sprawdzania.
+  @param[in] dir Ścieżka katalogu.
+  */
+static void add_input_dir(struct file_pool *pool, const char *dir)
+{
+    struct dirent **entries;
+    int n = scandir(dir, &entries, NULL, alphasort);
+    if (n < 0)
+    {
+        fwprintf(stderr, L"Failed to open directory %s\n", dir);
+        return;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        const char *name = entries[i]->d_name;
+        char path[strlen(dir) + strlen(name) + 2];
+        struct stat st;
+
+        sprintf(path, "%s/%s", dir, name);
+
+        if (name[0] != '.' && stat(path, &st) == 0)
+        {
+            if (S_ISDIR(st.st_mode)) add_input_dir(pool, path);
+            else if (S_ISREG(st.st_mode)
+                     && !(output_suffix != NULL
+                          && (ends_with(name, output_suffix)
+                              || ends_with(name, ERR_SUFFIX))))
+                add_input_file(pool, path);
+        }
+
+        free(entries[i]);
+    }
+
+    free(entries);
+}
+
+/**
+  Dzieli zmapowany plik na fragmenty kończące się na końcu linii.
+  @param[in,out] file Plik.
+  @param[in] n_workers Liczba wątków puli.
+  */
+static void split_file(struct input_file *file, int n_workers)
+{
+    size_t size = 0, pos = 0, n_line = 1;
+    size_t split = chunk_size(file->size, n_workers);
+
+    do
+    {
+        if (file->n_chunks == size)
+        {
+            size = size ? 2 * size : 1;
+            file->chunks = realloc(file->chunks, size * sizeof(struct chunk));
+            if (!file->chunks) files_out_of_memory();
+        }
+
+        size_t end = file->size;
+        if (file->size - pos > split)
+        {
+            const char *nl = memchr(file->data + pos + split, '\n',
+                                    file->size - pos - split);
+            if (nl != NULL) end = nl - file->data + 1;
+        }
+
+        struct chunk *chunk = &file->chunks[file->n_chunks++];
+        memset(chunk, 0, sizeof(struct chunk));
+        chunk->in = file->data + pos;
+        chunk->in_len = end - pos;
+        chunk->n_line = n_line;
+
+        for (const char *p = chunk->in; p < file->data + end
+             && (p = memchr(p, '\n', file->data + end - p)) != NULL; p++)
+            n_line++;
+
+        pos = end;
+    }
+    while (pos < file->size);
+
+    file->remaining = file->n_chunks;
+}
+
+/**
+  Otwiera i mapuje plik, a następnie dzieli go na fragmenty.
+  @param[in,out] file Plik.
+  @param[in] n_workers Liczba wątków puli.
+  @return Czy się udało.
+  */
+static bool open_input_file(struct input_file *file, int n_workers)
+{
+    int fd = open(file->path, O_RDONLY);
+    struct stat st;
+
+    if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+    {
+        if (fd >= 0) close(fd);
+        return false;
+    }
+
+    file->size = st.st_size;
+    if (file->size > 0)
+    {
+        file->data = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (file->data == MAP_FAILED) file->data = NULL;
+    }
+    close(fd);
+
+    if (file->size > 0 && file->data == NULL) return false;
+    if (file->data) posix_madvise(file->data, file->size,
+                                  POSIX_MADV_SEQUENTIAL);
+
+    split_file(file, n_workers);
+
+    return true;
+}
+
+/**
+  Zwalnia pamięć sprawdzonego pliku.
+  @param[in,out] file Plik.
+  */
+static void release_file(struct input_file *file)
+{
+    for (size_t i = 0; i < file->n_chunks; i++)
+    {
+        free(file->chunks[i].out);
+        free(file->chunks[i].err);
+    }
+
+    if (file->data) munmap(file->data, file->size);
+    free(file->chunks);
+    free(file->path);
+    file->data = NULL;
+    file->chunks = NULL;
+    file->n_chunks = 0;
+    file->path = NULL;
+}
+
+/**
+  Wypisuje wyjście błędów, poprzedzając każdą linię ścieżką pliku
+  i kończąc ostatnią linię znakiem końca linii.
+  @param[in] str Wyjście błędów.
+  @param[in] len Długość wyjścia błędów.
+  @param[in] path Ścieżka pliku.
+  @param[in,out] stream Strumień.
+  */
+static void write_prefixed(const wchar_t *str, size_t len, const char *path,
+                           FILE *stream)
+{
+    const wchar_t *end = str + len;
+
+    while (str < end)
+    {
+        const wchar_t *nl = wmemchr(str, L'\n', end - str);
+        size_t line_len = nl ? nl - str + 1 : end - str;
+
+        // Linia bez końca linii (np. komunikat o zbyt długim słowie) nie
+        // może skleić się z linią następnego pliku.
+        fwprintf(stream, L"%s:%.*ls%ls", path, (int) line_len, str,
+                 nl ? L"" : L"\n");
+        str += line_len;
+    }
+}
+
+/**
+  Wypisuje wynik sprawdzania pliku na wspólne wyjście.
+  Tak jak przy sprawdzaniu standardowego wejścia, po fragmencie z błędem
+  odczytu lub zbyt długim słowem nic już nie jest wypisywane.
+  @param[in] file Plik.
+  */
+static void write_to_stream(const struct input_file *file)
+{
+    fwprintf(stdout, L"==> %s <==\n", file->path);
+
+    if (file->failed)
+    {
+        fwprintf(stderr, L"Failed to open file %s\n", file->path);
+        return;
+    }
+
+    for (size_t i = 0; i < file->n_chunks; i++)
+    {
+        const struct chunk *chunk = &file->chunks[i];
+
+        write_wide(chunk->out, chunk->out_len, stdout);
+        write_prefixed(chunk->err, chunk->err_len, file->path, stderr);
+        if (chunk->failed || chunk->fatal) break;
+    }
+}
+
+/**
+  Zapisuje wynik sprawdzania pliku do plików obok niego.
+  Wyjście trafia do pliku z przyrostkiem output_suffix, a wyjście błędów
+  (jeśli jest niepuste) do pliku z dodatkowym przyrostkiem ERR_SUFFIX.
+  @param[in] file Plik.
+  */
+static void write_to_siblings(const struct input_file *file)
+{
+    if (file->failed)
+    {
+        fwprintf(stderr, L"Failed to open file %s\n", file->path);
+        return;
+    }
+
+    char out_path[strlen(file->path) + strlen(output_suffix) + 1];
+    char err_path[sizeof(out_path) + strlen(ERR_SUFFIX)];
+    sprintf(out_path, "%s%s", file->path, output_suffix);
+    sprintf(err_path, "%s%s", out_path, ERR_SUFFIX);
+
+    FILE *out = fopen(out_path, "w");
+    FILE *err = NULL;
+    if (!out)
+    {
+        fwprintf(stderr, L"Failed to write file %s\n", out_path);
+        return;
+    }
+
+    for (size_t i = 0; i < file->n_chunks; i++)
+    {
+        const struct chunk *chunk = &file->chunks[i];
+
+        write_wide(chunk->out, chunk->out_len, out);
+        if (chunk->err_len > 0 && err == NULL
+            && (err = fopen(err_path, "w")) == NULL)
+            fwprintf(stderr, L"Failed to write file %s\n", err_path);
+        if (err) write_wide(chunk->err, chunk->err_len, err);
+        if (chunk->failed || chunk->fatal) break;
+    }
+
+    fclose(out);
+    // Wynik poprzedniego uruchomienia nie może zostać.
+    if (err) fclose(err);
+    else unlink(err_path);
+}
+
+/**
+  Zgłasza bezczynnym wątkom zmianę stanu.
+  @param[in,out] pool Stan sprawdzania.
+  */
+static void files_notify(struct file_pool *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->version++;
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+  Oznacza plik jako sprawdzony. Przy zapisie do plików obok wynik jest
+  zapisywany od razu, w p.p. wypisuje go główny wątek w kolejności plików.
+  @param[in,out] pool Stan sprawdzania.
+  @param[in,out] file Plik.
+  */
+static void finish_file(struct file_pool *pool, struct input_file *file)
+{
+    if (output_suffix != NULL)
+    {
+        write_to_siblings(file);
+        release_file(file);
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    file->checked = true;
+    pool->n_checked++;
+    pool->version++;
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+  Dodaje zadanie na koniec kolejki.
+  @param[in,out] deque Kolejka.
+  @param[in] task Zadanie.
+  */
+static void deque_push(struct deque *deque, struct task task)
+{
+    pthread_mutex_lock(&deque->lock);
+    if (deque->tail == deque->size)
+    {
+        if (deque->head > 0)
+        {
+            memmove(deque->tasks, deque->tasks + deque->head,
+                    (deque->tail - deque->head) * sizeof(struct task));
+            deque->tail -= deque->head;
+            deque->head = 0;
+        }
+        else
+        {
+            deque->size = deque->size ? 2 * deque->size : 16;
+            deque->tasks = realloc(deque->tasks,
+                                   deque->size * sizeof(struct task));
+            if (!deque->tasks) files_out_of_memory();
+        }
+    }
+    deque->tasks[deque->tail++] = task;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+/**
+  Zdejmuje zadanie z kolejki.
+  @param[in,out] deque Kolejka.
+  @param[in] steal Czy zdjąć zadanie z początku (kradzież), czy z końca.
+  @param[out] task Zadanie.
+  @return Czy kolejka była niepusta.
+  */
+static bool deque_pop(struct deque *deque, bool steal, struct task *task)
+{
+    bool found = false;
+
+    pthread_mutex_lock(&deque->lock);
+    if (deque->head < deque->tail)
+    {
+        *task = steal ? deque->tasks[deque->head++]
+                      : deque->tasks[--deque->tail];
+        found = true;
+    }
+    pthread_mutex_unlock(&deque->lock);
+
+    return found;
+}
+
+/**
+  Podejmuje następny plik: otwiera go, dzieli na fragmenty, dokłada
+  wszystkie fragmenty oprócz pierwszego do kolejki wątku i zwraca
+  pierwszy. Przy wypisywaniu na wspólne wyjście wątki nie wyprzedzają
+  wypisywania o więcej niż MAX_PENDING_FILES plików.
+  @param[in,out] pool Stan sprawdzania.
+  @param[in] id Numer wątku.
+  @param[out] task Zadanie.
+  @return Czy podjęto plik.
+  */
+static bool claim_file(struct file_pool *pool, int id, struct task *task)
+{
+    while (true)
+    {
+        pthread_mutex_lock(&pool->lock);
+        if (pool->next_claim == pool->n_files
+            || (output_suffix == NULL
+                && pool->next_claim >= pool->next_write + MAX_PENDING_FILES))
+        {
+            pthread_mutex_unlock(&pool->lock);
+            return false;
+        }
+        struct input_file *file = &pool->files[pool->next_claim++];
+        pthread_mutex_unlock(&pool->lock);
+
+        if (!open_input_file(file, pool->n_workers))
+        {
+            file->failed = true;
+            finish_file(pool, file);
+            continue;
+        }
+
+        for (size_t i = file->n_chunks; i-- > 1; )
+            deque_push(&pool->deques[id], (struct task) { file, i });
+        if (file->n_chunks > 1) files_notify(pool);
+
+        task->file = file;
+        task->index = 0;
+        return true;
+    }
+}
+
+/**
+  Funkcja wątku sprawdzającego pliki.
+  Wątek sprawdza najpierw fragmenty ze swojej kolejki, potem podejmuje
+  nowe pliki, a gdy ich brak, kradnie fragmenty z kolejek innych wątków.
+  @param[in] _worker Argument wątku.
+  @return NULL.
+  */
+static void * file_worker(void *_worker)
+{
+    struct file_worker *worker = _worker;
+    struct file_pool *pool = worker->pool;
+    struct checker *checker = checker_new();
+
+    while (true)
+    {
+        pthread_mutex_lock(&pool->lock);
+        unsigned long seen = pool->version;
+        pthread_mutex_unlock(&pool->lock);
+
+        struct task task;
+        bool found = deque_pop(&pool->deques[worker->id], false, &task)
+                     || claim_file(pool, worker->id, &task);
+
+        for (int i = 1; !found && i < pool->n_workers; i++)
+        {
+            int victim = (worker->id + i) % pool->n_workers;
+            found = deque_pop(&pool->deques[victim], true, &task);
+        }
+
+        if (found)
+        {
+            struct chunk *chunk = &task.file->chunks[task.index];
+
+            check_chunk(chunk, checker);
+            if (chunk->fatal)
+                __atomic_store_n(&task.file->fatal, true, __ATOMIC_RELAXED);
+            if (__atomic_sub_fetch(&task.file->remaining, 1,
+                                   __ATOMIC_ACQ_REL) == 0)
+                finish_file(pool, task.file);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        while (pool->version == seen && pool->n_checked < pool->n_files)
+            pthread_cond_wait(&pool->cond, &pool->lock);
+        bool finished = pool->n_checked == pool->n_files;
+        pthread_mutex_unlock(&pool->lock);
+
+        if (finished) break;
+    }
+
+    checker_done(checker);
+
+    return NULL;
+}
+
+/**
+  Sprawdza pliki wejściowe i katalogi na puli wątków.
+  @return Czy wszystkie pliki udało się otworzyć i sprawdzić do końca.
+  */
+static bool check_files(void)
+{
+    struct file_pool pool;
+
+    memset(&pool, 0, sizeof(pool));
+    for (size_t i = 0; i < n_inputs; i++)
+    {
+        struct stat st;
+
+        if (stat(inputs[i], &st) == 0 && S_ISDIR(st.st_mode))
+            add_input_dir(&pool, inputs[i]);
+        else add_input_file(&pool, inputs[i]);
+    }
+
+    pool.n_workers = jobs;
+    if (pool.n_workers < 1)
+    {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        pool.n_workers = n < 1 ? 1 : (n > MAX_JOBS ? MAX_JOBS : n);
+    }
+
+    pool.deques = calloc(pool.n_workers, sizeof(struct deque));
+    if (!pool.deques) files_out_of_memory();
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.cond, NULL);
+
+    pthread_t threads[pool.n_workers];
+    struct file_worker workers[pool.n_workers];
+    for (int i = 0; i < pool.n_workers; i++)
+    {
+        pthread_mutex_init(&pool.deques[i].lock, NULL);
+        workers[i].pool = &pool;
+        workers[i].id = i;
+    }
+    for (int i = 0; i < pool.n_workers; i++)
+    {
+        if (pthread_create(&threads[i], NULL, file_worker, &workers[i]) != 0)
+        {
+            fprintf(stderr, "Failed to create thread\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (output_suffix == NULL)
+    {
+        pthread_mutex_lock(&pool.lock);
+        while (pool.next_write < pool.n_files)
+        {
+            struct input_file *file = &pool.files[pool.next_write];
+            if (!file->checked)
+            {
+                pthread_cond_wait(&pool.cond, &pool.lock);
+                continue;
+            }
+
+            pthread_mutex_unlock(&pool.lock);
+            write_to_stream(file);
+            release_file(file);
+            pthread_mutex_lock(&pool.lock);
+
+            pool.next_write++;
+            pool.version++;
+            pthread_cond_broadcast(&pool.cond);
+        }
+        pthread_mutex_unlock(&pool.lock);
+    }
+
+    for (int i = 0; i < pool.n_workers; i++) pthread_join(threads[i], NULL);
+
+    bool ok = true;
+    for (size_t i = 0; i < pool.n_files; i++)
+    {
+        if (pool.files[i].failed || pool.files[i].fatal) ok = false;
+        release_file(&pool.files[i]);
+    }
+
+    for (int i = 0; i < pool.n_workers; i++)
+    {
+        pthread_mutex_destroy(&pool.deques[i].lock);
+        free(pool.deques[i].tasks);
+    }
+    pthread_cond_destroy(&pool.cond);
+    pthread_mutex_destroy(&pool.lock);
+    free(pool.deques);
+    free(pool.files);
+
+    return ok;
+}
+
+/**@}*/
+
+/**
+  Funkcja main.
+  Główna funkcja programu do sprawdzania pisowni.
+ */
+int main(int argc, char *argv[])
+{
+    setlocale(LC_ALL, "pl_PL.UTF-8");
+    tokenizer_init();
+
+    verbose = false;
+    jobs = 0;
+    stats = false;
+    dict = NULL;
+    dict_filename = NULL;
+    inputs = NULL;
+    n_inputs = 0;
+    output_suffix = NULL;
+    mode = MODE_CHECK;
+    mode_path = NULL;
+    image = NULL;
+
+    parse_args(argc-1, argv+1);
+
+    if (mode == MODE_DAEMON) return daemon_serve(mode_path, dict_filename);
+
+    if (mode == MODE_IMAGE && !(image = image_attach(mode_path)))
+    {
+        fprintf(stderr, "Failed to attach dictionary image %s\n", mode_path);
+        exit(EXIT_FAILURE);
+    }
+
+    // Klient i obraz nie potrzebują słownika, a bez podpowiedzi wystarczy
+    // słownik tylko do sprawdzania.
+    if (mode == MODE_CHECK || mode == MODE_PUBLISH || mode == MODE_FREEZE)
+        load_dictionary(dict_filename, mode == MODE_CHECK && !verbose);
+
+    if (mode == MODE_FREEZE)
+    {
+        dictionary_exact_index(dict, true);
+
+        FILE *f = fopen(mode_path, "w");
+        int ret = f ? dictionary_save(dict, f) : -1;
+        if (f && fclose(f) != 0) ret = -1;
+        if (ret < 0)
+            fprintf(stderr, "Failed to save dictionary to file %s\n",
+                    mode_path);
+
+        dictionary_done(dict);
+        return ret < 0 ? EXIT_FAILURE : 0;
+    }
+
+    if (mode == MODE_PUBLISH)
+    {
+        int ret = dictionary_publish(dict, mode_path);
+        if (ret < 0)
+            fprintf(stderr, "Failed to publish dictionary image %s\n",
+                    mode_path);
+
+        dictionary_done(dict);
+        return ret < 0 ? EXIT_FAILURE : 0;
+    }
+
+    bool ok = true;
+
+    if (n_inputs > 0)
+    {
+        ok = check_files();
+    }
+    else if (jobs > 1)
+    {
+        parse_input_parallel(stdin);
+    }
+    else
+    {
+        size_t size;
+        const char *data = map_input(&size);
+
+        if (data != NULL)
+        {
+            parse_input_mapped(data, size);
+            munmap((void *) data, size);
+        }
+        else parse_input_pipeline(stdin);
+    }
+
+    if (stats)
+    {
+        fwprintf(stderr, L"token cache: %zu lookups, %zu hits (%.1f%%)\n",
+                 cache_lookups, cache_hits,
+                 cache_lookups > 0 ? 100.0 * cache_hits / cache_lookups : 0.0);
+
+        struct dictionary_stats dict_stats;
+        if (dict != NULL) dictionary_stats(dict, &dict_stats);
+        if (dict != NULL && dict_stats.bloom_memory > 0)
+        {
+            fwprintf(stderr, L"bloom filter: %zu KiB, %zu words, "
+                     L"estimated false positive rate %.3f%%\n",
+                     dict_stats.bloom_memory / 1024, dict_stats.bloom_words,
+                     100.0 * dict_stats.bloom_false_positive_rate);
+        }
+    }
 
-    dictionary_done(dict);
+    if (dict != NULL) dictionary_done(dict);
+    if (image != NULL) image_detach(image);
+    free(inputs);
 
-    return 0;
+    return ok ? 0 : EXIT_FAILURE;
 }
@@ -0,0 +1,85 @@
+/** @file
+    Implementacja bufora cyklicznego dla jednego producenta i jednego
+    konsumenta.
+
+    @ingroup dict-check
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#include "ring.h"
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+  Rozmiar linii pamięci podręcznej.
+  */
+#define CACHE_LINE 64
+
+/**
+  Struktura przechowująca bufor cykliczny.
+  Liczniki rosną bez ograniczeń, a pozycja w tablicy to licznik modulo
+  RING_SIZE. Liczniki są w osobnych liniach pamięci podręcznej, żeby
+  producent i konsument nie unieważniali sobie nawzajem linii.
+  */
+struct ring
+{
+    /// Numer pierwszego elementu, zmieniany przez konsumenta.
+    size_t head __attribute__((aligned(CACHE_LINE)));
+    /// Numer pierwszego wolnego miejsca, zmieniany przez producenta.
+    size_t tail __attribute__((aligned(CACHE_LINE)));
+    /// Elementy.
+    void *items[RING_SIZE] __attribute__((aligned(CACHE_LINE)));
+};
+
+/** @name Elementy interfejsu
+  @{
+  */
+
+Ring * ring_new(void)
+{
+    Ring *ring = NULL;
+    if (posix_memalign((void **) &ring, CACHE_LINE, sizeof(Ring)) != 0)
+    {
+        fprintf(stderr, "Failed to allocate memory for ring buffer\n");
+        exit(EXIT_FAILURE);
+    }
+
+    ring->head = 0;
+    ring->tail = 0;
+
+    return ring;
+}
+
+void ring_done(Ring *ring)
+{
+    free(ring);
+}
+
+void ring_push(Ring *ring, void *item)
+{
+    size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+
+    while (tail - __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == RING_SIZE)
+        sched_yield();
+
+    ring->items[tail % RING_SIZE] = item;
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+void * ring_pop(Ring *ring)
+{
+    size_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+
+    while (__atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) == head)
+        sched_yield();
+
+    void *item = ring->items[head % RING_SIZE];
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+    return item;
+}
+
+/**@}*/
@@ -0,0 +1,56 @@
+/** @file
+    Interfejs bufora cyklicznego dla jednego producenta i jednego konsumenta.
+
+    Bufor nie używa blokad: producent zmienia tylko koniec, a konsument
+    tylko początek kolejki. Wątek czekający na miejsce lub element oddaje
+    procesor.
+
+    @ingroup dict-check
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#ifndef __RING_H__
+#define __RING_H__
+
+/**
+  Pojemność bufora.
+  */
+#define RING_SIZE 16
+
+/**
+  Struktura przechowująca bufor cykliczny.
+  */
+typedef struct ring Ring;
+
+/**
+  Tworzy nowy, pusty bufor.
+  Należy go zniszczyć za pomocą ring_done().
+  @return Nowy bufor.
+  */
+Ring * ring_new(void);
+
+/**
+  Destrukcja bufora.
+  @param[in,out] ring Bufor.
+  */
+void ring_done(Ring *ring);
+
+/**
+  Wstawia element na koniec bufora, czekając na wolne miejsce.
+  Może być wywoływana tylko przez wątek producenta.
+  @param[in,out] ring Bufor.
+  @param[in] item Element.
+  */
+void ring_push(Ring *ring, void *item);
+
+/**
+  Zdejmuje element z początku bufora, czekając na jego pojawienie się.
+  Może być wywoływana tylko przez wątek konsumenta.
+  @param[in,out] ring Bufor.
+  @return Element.
+  */
+void * ring_pop(Ring *ring);
+
+#endif /* __RING_H__ */
@@ -0,0 +1,236 @@
+/** @file
+    Implementacja pamięci podręcznej wyników sprawdzania słów.
+
+    @ingroup dict-check
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#include "token_cache.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+  Liczba miejsc w jednym zbiorze.
+  */
+#define WAYS 4
+
+/**
+  Zapamiętane słowo.
+  */
+struct entry
+{
+    /// Słowo lub NULL, jeśli miejsce jest wolne.
+    wchar_t *word;
+    /// Skrót słowa.
+    uint64_t hash;
+    /// Czas ostatniego użycia.
+    size_t stamp;
+    /// Czy słowo jest w słowniku.
+    bool found;
+    /// Czy zapamiętano podpowiedzi.
+    bool has_hints;
+    /// Podpowiedzi.
+    struct word_list hints;
+};
+
+/**
+  Struktura przechowująca pamięć podręczną.
+  Słowo może być tylko w zbiorze wyznaczonym przez jego skrót.
+  */
+struct token_cache
+{
+    /// Miejsca, po WAYS na zbiór.
+    struct entry *entries;
+    /// Liczba zbiorów (potęga dwójki).
+    size_t n_sets;
+    /// Licznik czasu.
+    size_t clock;
+    /// Liczba trafień.
+    size_t hits;
+    /// Liczba wyszukań.
+    size_t lookups;
+};
+
+/** @name Funkcje pomocnicze
+  @{
+  */
+
+/**
+  Liczy skrót słowa (FNV-1a).
+  @param[in] word Słowo.
+  @return Skrót.
+  */
+static uint64_t hash_word(const wchar_t *word)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (; *word; word++)
+    {
+        hash ^= (uint64_t) *word;
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+/**
+  Zwalnia zawartość miejsca.
+  @param[in,out] entry Miejsce.
+  */
+static void entry_clear(struct entry *entry)
+{
+    if (entry->word == NULL) return;
+
+    free(entry->word);
+    if (entry->has_hints) word_list_done(&entry->hints);
+    entry->word = NULL;
+}
+
+/**
+  Zwraca pierwsze miejsce zbioru, do którego należy słowo.
+  @param[in] cache Pamięć podręczna.
+  @param[in] hash Skrót słowa.
+  @return Pierwsze miejsce zbioru.
+  */
+static struct entry * set_of(const Token_Cache *cache, uint64_t hash)
+{
+    return cache->entries + (hash & (cache->n_sets - 1)) * WAYS;
+}
+
+/**
+  Szuka wpisu słowa.
+  @param[in] cache Pamięć podręczna.
+  @param[in] word Słowo.
+  @return Wpis lub NULL, jeśli słowa nie ma w pamięci podręcznej.
+  */
+static struct entry * lookup(const Token_Cache *cache, const wchar_t *word)
+{
+    uint64_t hash = hash_word(word);
+    struct entry *set = set_of(cache, hash);
+
+    for (size_t i = 0; i < WAYS; i++)
+    {
+        struct entry *entry = &set[i];
+        if (entry->word != NULL && entry->hash == hash
+            && wcscmp(entry->word, word) == 0)
+            return entry;
+    }
+
+    return NULL;
+}
+
+/**@}*/
+
+/** @name Elementy interfejsu
+  @{
+  */
+
+Token_Cache * token_cache_new(size_t capacity)
+{
+    Token_Cache *cache = malloc(sizeof(Token_Cache));
+    if (!cache)
+    {
+        fprintf(stderr, "Failed to allocate memory for token cache\n");
+        exit(EXIT_FAILURE);
+    }
+
+    cache->n_sets = 1;
+    while (cache->n_sets * WAYS < capacity) cache->n_sets *= 2;
+
+    cache->entries = calloc(cache->n_sets * WAYS, sizeof(struct entry));
+    if (!cache->entries)
+    {
+        fprintf(stderr, "Failed to allocate memory for token cache\n");
+        exit(EXIT_FAILURE);
+    }
+
+    cache->clock = 0;
+    cache->hits = 0;
+    cache->lookups = 0;
+
+    return cache;
+}
+
+void token_cache_done(Token_Cache *cache)
+{
+    for (size_t i = 0; i < cache->n_sets * WAYS; i++)
+        entry_clear(&cache->entries[i]);
+
+    free(cache->entries);
+    free(cache);
+}
+
+bool token_cache_find(Token_Cache *cache, const wchar_t *word, bool *found,
+                      const struct word_list **hints)
+{
+    struct entry *entry = lookup(cache, word);
+
+    cache->lookups++;
+    if (entry == NULL) return false;
+
+    entry->stamp = ++cache->clock;
+    *found = entry->found;
+    *hints = entry->has_hints ? &entry->hints : NULL;
+    cache->hits++;
+
+    return true;
+}
+
+bool token_cache_contains(const Token_Cache *cache, const wchar_t *word)
+{
+    return lookup(cache, word) != NULL;
+}
+
+const struct word_list * token_cache_add(Token_Cache *cache,
+                                         const wchar_t *word, bool found,
+                                         struct word_list *hints)
+{
+    uint64_t hash = hash_word(word);
+    struct entry *set = set_of(cache, hash);
+    struct entry *victim = &set[0];
+
+    for (size_t i = 0; i < WAYS; i++)
+    {
+        if (set[i].word == NULL)
+        {
+            victim = &set[i];
+            break;
+        }
+        if (set[i].stamp < victim->stamp) victim = &set[i];
+    }
+
+    entry_clear(victim);
+
+    size_t size = (wcslen(word) + 1) * sizeof(wchar_t);
+    victim->word = malloc(size);
+    if (!victim->word)
+    {
+        fprintf(stderr, "Failed to allocate memory for token cache\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(victim->word, word, size);
+
+    victim->hash = hash;
+    victim->stamp = ++cache->clock;
+    victim->found = found;
+    victim->has_hints = (hints != NULL);
+    if (hints != NULL) victim->hints = *hints;
+
+    return victim->has_hints ? &victim->hints : NULL;
+}
+
+size_t token_cache_hits(const Token_Cache *cache)
+{
+    return cache->hits;
+}
+
+size_t token_cache_lookups(const Token_Cache *cache)
+{
+    return cache->lookups;
+}
+
+/**@}*/
@@ -0,0 +1,91 @@
+/** @file
+    Interfejs pamięci podręcznej wyników sprawdzania słów.
+
+    Pamięć przechowuje dla ograniczonej liczby słów (złożonych z małych
+    liter) informację, czy słowo jest w słowniku, i ewentualnie listę
+    podpowiedzi. Przy braku miejsca usuwane jest najdawniej używane słowo
+    z tego samego zbioru.
+
+    @ingroup dict-check
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#ifndef __TOKEN_CACHE_H__
+#define __TOKEN_CACHE_H__
+
+#include "word_list.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <wchar.h>
+
+/**
+  Struktura przechowująca pamięć podręczną.
+  */
+typedef struct token_cache Token_Cache;
+
+/**
+  Tworzy nową, pustą pamięć podręczną.
+  Należy ją zniszczyć za pomocą token_cache_done().
+  @param[in] capacity Maksymalna liczba pamiętanych słów.
+  @return Nowa pamięć podręczna.
+  */
+Token_Cache * token_cache_new(size_t capacity);
+
+/**
+  Destrukcja pamięci podręcznej.
+  @param[in,out] cache Pamięć podręczna.
+  */
+void token_cache_done(Token_Cache *cache);
+
+/**
+  Szuka słowa w pamięci podręcznej.
+  @param[in,out] cache Pamięć podręczna.
+  @param[in] word Słowo.
+  @param[out] found Czy słowo jest w słowniku.
+  @param[out] hints Zapamiętane podpowiedzi lub NULL, jeśli ich nie ma.
+  Lista jest ważna do następnej zmiany pamięci podręcznej.
+  @return Czy słowo było w pamięci podręcznej.
+  */
+bool token_cache_find(Token_Cache *cache, const wchar_t *word, bool *found,
+                      const struct word_list **hints);
+
+/**
+  Sprawdza, czy słowo jest w pamięci podręcznej, nie licząc tego jako
+  wyszukania i nie zmieniając kolejności usuwania słów.
+  @param[in] cache Pamięć podręczna.
+  @param[in] word Słowo.
+  @return Czy słowo jest w pamięci podręcznej.
+  */
+bool token_cache_contains(const Token_Cache *cache, const wchar_t *word);
+
+/**
+  Zapamiętuje wynik sprawdzenia słowa, którego nie ma w pamięci podręcznej.
+  @param[in,out] cache Pamięć podręczna.
+  @param[in] word Słowo.
+  @param[in] found Czy słowo jest w słowniku.
+  @param[in,out] hints Podpowiedzi lub NULL. Pamięć podręczna przejmuje
+  listę i sama ją zniszczy.
+  @return Zapamiętane podpowiedzi (ważne do następnej zmiany pamięci
+  podręcznej) lub NULL.
+  */
+const struct word_list * token_cache_add(Token_Cache *cache,
+                                         const wchar_t *word, bool found,
+                                         struct word_list *hints);
+
+/**
+  Zwraca liczbę wyszukań zakończonych trafieniem.
+  @param[in] cache Pamięć podręczna.
+  @return Liczba trafień.
+  */
+size_t token_cache_hits(const Token_Cache *cache);
+
+/**
+  Zwraca liczbę wszystkich wyszukań.
+  @param[in] cache Pamięć podręczna.
+  @return Liczba wyszukań.
+  */
+size_t token_cache_lookups(const Token_Cache *cache);
+
+#endif /* __TOKEN_CACHE_H__ */
@@ -12,6 +12,7 @@
   */
 
 #include "dictionary.h"
+#include "tokenizer.h"
 #include <assert.h>
 #include <locale.h>
 #include <stdio.h>
@@ -93,21 +94,6 @@ int ignored()
 }
 
 
-/** Zamienia słowo na złożone z małych liter.
-  @param[in,out] word Modyfikowane słowo.
-  @return 0, jeśli słowo nie jest złożone z samych liter, 1 w p.p.
- */
-int make_lowercase(wchar_t *word)
-{
-    for (wchar_t *w = word; *w; ++w)
-        if (!iswalpha(*w))
-            return 0;
-        else
-            *w = towlower(*w);
-    return 1;
-}
-
-
 /** Przetwarza komendę operującą na słowniku.
   @param[in,out] dict Słownik, na którym wykonywane są operacje.
   @param[in] c Komenda.
@@ -121,7 +107,7 @@ static int dict_command(struct dictionary **dict, enum Command c)
         fprintf(stderr, "Failed to read word\n");
         exit(1);
     }
-    if (!make_lowercase(word))
+    if (!tokenizer_fold_word(word))
     {
         fprintf(stderr, "Invalid word '%ls'\n", word);
         return ignored();
@@ -272,6 +258,7 @@ int try_process_command(struct dictionary **dict)
 int main(void)
 {
     setlocale(LC_ALL, "pl_PL.UTF-8");
+    tokenizer_init();
     struct dictionary *dict = dictionary_new();
     do {} while (try_process_command(&dict));
     dictionary_done(dict);
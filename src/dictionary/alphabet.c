@@ -0,0 +1,196 @@
+/** @file
+    Implementacja alfabetu drzewa.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#include "alphabet.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wctype.h>
+
+/**
+  Liczba początkowych znaków Unicode, których kody są pamiętane w tablicy.
+  Obejmuje alfabet łaciński z rozszerzeniem A, a więc i polskie litery.
+  */
+#define ALPHABET_DIRECT_SIZE 0x180
+
+/**
+  Początkowa pojemność alfabetu.
+  */
+#define MINIMAL_CAPACITY 32
+
+/**
+  Struktura przechowująca alfabet.
+  */
+struct alphabet
+{
+    /// Posortowane znaki alfabetu.
+    wchar_t *chars;
+    /// Liczba znaków.
+    size_t size;
+    /// Pojemność tablicy znaków.
+    size_t capacity;
+    /// Kody początkowych znaków Unicode (ALPHABET_NONE, jeśli ich nie ma).
+    short direct[ALPHABET_DIRECT_SIZE];
+};
+
+/** @name Funkcje pomocnicze
+  @{
+  */
+
+/**
+  Wyszukuje pozycję znaku na liście lub pozycję, na którą należy go wstawić.
+  @param[in] alphabet Alfabet.
+  @param[in] character Znak.
+  @return Pozycja.
+  */
+static size_t find_position(const Alphabet *alphabet, wchar_t character)
+{
+    size_t l = 0, r = alphabet->size;
+
+    while (l < r)
+    {
+        size_t mid = (l + r) / 2;
+        if (alphabet->chars[mid] < character) l = mid + 1;
+        else r = mid;
+    }
+
+    return l;
+}
+
+/**
+  Uaktualnia kody znaków z tablicy od danej pozycji listy.
+  @param[in,out] alphabet Alfabet.
+  @param[in] from Pozycja.
+  */
+static void update_direct(Alphabet *alphabet, size_t from)
+{
+    for (size_t i = from; i < alphabet->size; i++)
+    {
+        if ((unsigned long) alphabet->chars[i] < ALPHABET_DIRECT_SIZE)
+            alphabet->direct[alphabet->chars[i]] = i;
+    }
+}
+
+/**@}*/
+/** @name Elementy interfejsu
+  @{
+  */
+
+Alphabet * alphabet_new(void)
+{
+    Alphabet *alphabet = malloc(sizeof(Alphabet));
+    if (!alphabet)
+    {
+        fprintf(stderr, "Failed to allocate memory for alphabet\n");
+        exit(EXIT_FAILURE);
+    }
+
+    alphabet->chars = NULL;
+    alphabet->size = 0;
+    alphabet->capacity = 0;
+    for (size_t i = 0; i < ALPHABET_DIRECT_SIZE; i++)
+        alphabet->direct[i] = ALPHABET_NONE;
+
+    return alphabet;
+}
+
+void alphabet_done(Alphabet *alphabet)
+{
+    free(alphabet->chars);
+    free(alphabet);
+}
+
+int alphabet_add(Alphabet *alphabet, wchar_t character)
+{
+    size_t pos = find_position(alphabet, character);
+    if (pos < alphabet->size && alphabet->chars[pos] == character) return 0;
+
+    if (alphabet->size == alphabet->capacity)
+    {
+        alphabet->capacity = alphabet->capacity > 0 ? 2 * alphabet->capacity
+                                                    : MINIMAL_CAPACITY;
+        alphabet->chars = realloc(alphabet->chars,
+                                  alphabet->capacity * sizeof(wchar_t));
+        if (!alphabet->chars)
+        {
+            fprintf(stderr, "Failed to allocate memory for alphabet\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    memmove(alphabet->chars + pos + 1, alphabet->chars + pos,
+            (alphabet->size - pos) * sizeof(wchar_t));
+    alphabet->chars[pos] = character;
+    alphabet->size++;
+    update_direct(alphabet, pos);
+
+    return 1;
+}
+
+int alphabet_find(const Alphabet *alphabet, wchar_t character)
+{
+    if ((unsigned long) character < ALPHABET_DIRECT_SIZE)
+        return alphabet->direct[character];
+
+    size_t pos = find_position(alphabet, character);
+    if (pos < alphabet->size && alphabet->chars[pos] == character)
+        return pos;
+
+    return ALPHABET_NONE;
+}
+
+wchar_t alphabet_get(const Alphabet *alphabet, int code)
+{
+    return alphabet->chars[code];
+}
+
+size_t alphabet_size(const Alphabet *alphabet)
+{
+    return alphabet->size;
+}
+
+int alphabet_save(const Alphabet *alphabet, IO *io)
+{
+    if (io_printf(io, L"@") < 0) return -1;
+
+    for (size_t i = 0; i < alphabet->size; i++)
+    {
+        if (io_printf(io, L"%lc", alphabet->chars[i]) < 0) return -1;
+    }
+
+    if (io_printf(io, L"\n") < 0) return -1;
+
+    return 0;
+}
+
+Alphabet * alphabet_load(IO *io)
+{
+    if (io_get_next(io) != L'@') return NULL;
+
+    Alphabet *alphabet = alphabet_new();
+    wint_t c;
+
+    while ((c = io_get_next(io)) != L'\n')
+    {
+        // Znaki są zapisane rosnąco, więc każdy trafia na koniec listy.
+        bool sorted = alphabet->size == 0
+                      || alphabet->chars[alphabet->size - 1] < c;
+        if (c == WEOF || !iswalpha(c) || !sorted)
+        {
+            alphabet_done(alphabet);
+            return NULL;
+        }
+        alphabet_add(alphabet, c);
+    }
+
+    return alphabet;
+}
+
+/**@}*/
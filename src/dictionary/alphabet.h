@@ -0,0 +1,94 @@
+/** @file
+    Interfejs alfabetu drzewa.
+
+    Alfabet przypisuje znakom występującym w słowach drzewa małe, gęste
+    kody: kodem znaku jest jego pozycja na posortowanej liście znaków
+    alfabetu. Kolejność kodów jest więc taka sama jak kolejność znaków,
+    a dodanie znaku zwiększa kody znaków od niego większych.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#ifndef __ALPHABET_H__
+#define __ALPHABET_H__
+
+#include "io.h"
+#include <stddef.h>
+#include <wchar.h>
+
+/**
+  Kod znaku spoza alfabetu.
+  */
+#define ALPHABET_NONE -1
+
+/**
+  Struktura przechowująca alfabet.
+  */
+typedef struct alphabet Alphabet;
+
+/**
+  Inicjalizacja pustego alfabetu.
+  Należy go zniszczyć za pomocą alphabet_done().
+  @return Nowy alfabet.
+  */
+Alphabet * alphabet_new(void);
+
+/**
+  Destrukcja alfabetu.
+  @param[in,out] alphabet Alfabet.
+  */
+void alphabet_done(Alphabet *alphabet);
+
+/**
+  Dodaje znak do alfabetu.
+  @param[in,out] alphabet Alfabet.
+  @param[in] character Znak.
+  @return 1, jeśli znak został dodany (i kody większych znaków się
+  zmieniły), 0, jeśli już był w alfabecie.
+  */
+int alphabet_add(Alphabet *alphabet, wchar_t character);
+
+/**
+  Zwraca kod znaku.
+  @param[in] alphabet Alfabet.
+  @param[in] character Znak.
+  @return Kod znaku lub ALPHABET_NONE, jeśli go nie ma w alfabecie.
+  */
+int alphabet_find(const Alphabet *alphabet, wchar_t character);
+
+/**
+  Zwraca znak o danym kodzie.
+  @param[in] alphabet Alfabet.
+  @param[in] code Kod mniejszy niż alphabet_size().
+  @return Znak.
+  */
+wchar_t alphabet_get(const Alphabet *alphabet, int code);
+
+/**
+  Zwraca liczbę znaków alfabetu.
+  @param[in] alphabet Alfabet.
+  @return Liczba znaków.
+  */
+size_t alphabet_size(const Alphabet *alphabet);
+
+/**
+  Zapisuje alfabet w jednej linii: znak `@` i znaki alfabetu w kolejności
+  kodów.
+  @param[in] alphabet Alfabet.
+  @param[in,out] io We/wy.
+  @return <0 jeśli operacja się nie powiedzie, 0 w p.p.
+  */
+int alphabet_save(const Alphabet *alphabet, IO *io);
+
+/**
+  Inicjuje i wczytuje alfabet zapisany za pomocą alphabet_save().
+  Alfabet ten należy zniszczyć za pomocą alphabet_done().
+  @param[in,out] io We/wy.
+  @return Nowy alfabet lub NULL, jeśli zapis jest błędny.
+  */
+Alphabet * alphabet_load(IO *io);
+
+#endif /* __ALPHABET_H__ */
@@ -0,0 +1,132 @@
+/** @file
+    Testy alfabetu drzewa.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwerstet Warszawski
+    @date 2026-10-19
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <cmocka.h>
+#include <locale.h>
+#include "alphabet.c"
+#include "utils.h"
+
+/**
+  Wczytuje alfabet z tekstu.
+  @param[in] text Tekst.
+  @return Wczytany alfabet lub NULL, jeśli zapis jest błędny.
+  */
+static Alphabet * load_from_text(const wchar_t *text)
+{
+    FILE *file = tmpfile();
+    assert_non_null(file);
+    fputws(text, file);
+    rewind(file);
+
+    IO *io = io_new(file, stdout, stderr);
+    Alphabet *alphabet = alphabet_load(io);
+    io_done(io);
+    fclose(file);
+
+    return alphabet;
+}
+
+/**
+  Testuje dodawanie i wyszukiwanie znaków.
+  @param state Środowisko testowe.
+  */
+static void alphabet_add_find_test(void** state)
+{
+    Alphabet *alphabet = alphabet_new();
+
+    assert_int_equal(alphabet_find(alphabet, L'a'), ALPHABET_NONE);
+    assert_int_equal(alphabet_add(alphabet, L'ż'), 1);
+    assert_int_equal(alphabet_add(alphabet, L'a'), 1);
+    assert_int_equal(alphabet_add(alphabet, L'一'), 1);
+    assert_int_equal(alphabet_add(alphabet, L'ą'), 1);
+    assert_int_equal(alphabet_add(alphabet, L'ą'), 0);
+    assert_int_equal(alphabet_size(alphabet), 4);
+
+    // Kody są pozycjami na posortowanej liście znaków.
+    assert_int_equal(alphabet_find(alphabet, L'a'), 0);
+    assert_int_equal(alphabet_find(alphabet, L'ą'), 1);
+    assert_int_equal(alphabet_find(alphabet, L'ż'), 2);
+    assert_int_equal(alphabet_find(alphabet, L'一'), 3);
+    assert_int_equal(alphabet_find(alphabet, L'b'), ALPHABET_NONE);
+    assert_int_equal(alphabet_find(alphabet, L'丁'), ALPHABET_NONE);
+
+    // Dodanie znaku zmienia kody większych znaków.
+    assert_int_equal(alphabet_add(alphabet, L'b'), 1);
+    assert_int_equal(alphabet_find(alphabet, L'a'), 0);
+    assert_int_equal(alphabet_find(alphabet, L'b'), 1);
+    assert_int_equal(alphabet_find(alphabet, L'ż'), 3);
+    assert_int_equal(alphabet_find(alphabet, L'一'), 4);
+
+    for (int i = 0; i < alphabet_size(alphabet); i++)
+        assert_int_equal(alphabet_find(alphabet, alphabet_get(alphabet, i)), i);
+
+    alphabet_done(alphabet);
+}
+
+/**
+  Testuje zapisywanie i wczytywanie alfabetu.
+  @param state Środowisko testowe.
+  */
+static void alphabet_save_load_test(void** state)
+{
+    Alphabet *alphabet = alphabet_new();
+    for (const wchar_t *c = L"żółwkot"; *c != L'\0'; c++)
+        alphabet_add(alphabet, *c);
+
+    FILE *file = tmpfile();
+    assert_non_null(file);
+    IO *io = io_new(stdin, file, stderr);
+    assert_int_equal(alphabet_save(alphabet, io), 0);
+    io_done(io);
+
+    wchar_t buf[32];
+    rewind(file);
+    assert_non_null(fgetws(buf, 32, file));
+    assert_true(wcscmp(buf, L"@kotwółż\n") == 0);
+    fclose(file);
+    alphabet_done(alphabet);
+
+    alphabet = load_from_text(L"@kotwółż\n");
+    assert_non_null(alphabet);
+    assert_int_equal(alphabet_size(alphabet), 7);
+    assert_int_equal(alphabet_find(alphabet, L'ó'), 4);
+    alphabet_done(alphabet);
+
+    alphabet = load_from_text(L"@\n");
+    assert_non_null(alphabet);
+    assert_int_equal(alphabet_size(alphabet), 0);
+    alphabet_done(alphabet);
+
+    // Błędne zapisy.
+    assert_null(load_from_text(L"kot\n"));
+    assert_null(load_from_text(L"@tok\n"));
+    assert_null(load_from_text(L"@kk\n"));
+    assert_null(load_from_text(L"@k1\n"));
+    assert_null(load_from_text(L"@ko"));
+}
+
+/**
+  Główna funkcja uruchamiająca testy.
+  */
+int main(void)
+{
+    setlocale(LC_ALL, "pl_PL.UTF-8");
+
+    const struct CMUnitTest tests[] =
+    {
+        cmocka_unit_test(alphabet_add_find_test),
+        cmocka_unit_test(alphabet_save_load_test),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
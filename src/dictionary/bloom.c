@@ -0,0 +1,257 @@
+/** @file
+    Implementacja blokowego filtru Blooma.
+
+    Skrót słowa wyznacza blok, a jego przemieszana wersja - po 9 bitów na
+    pozycję - bity ustawiane w bloku.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#include "bloom.h"
+#include "utf8.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+  Liczba bitów bloku (linia pamięci podręcznej).
+  */
+#define BLOCK_BITS 512
+
+/**
+  Liczba 64-bitowych słów w bloku.
+  */
+#define BLOCK_WORDS (BLOCK_BITS / 64)
+
+/**
+  Maksymalna liczba bitów ustawianych dla słowa (po 9 bitów skrótu na
+  pozycję w 64-bitowym skrócie).
+  */
+#define MAX_HASHES 7
+
+/**
+  Blok filtru.
+  */
+struct block
+{
+    /// Bity bloku.
+    uint64_t bits[BLOCK_WORDS];
+};
+
+/**
+  Struktura przechowująca filtr Blooma.
+  */
+struct bloom
+{
+    /// Bloki wyrównane do linii pamięci podręcznej.
+    struct block *blocks;
+    /// Liczba bloków.
+    size_t n_blocks;
+    /// Liczba bitów ustawianych dla słowa.
+    int n_hashes;
+    /// Pojemność filtru.
+    size_t capacity;
+    /// Liczba dodanych słów.
+    size_t size;
+};
+
+/** @name Funkcje pomocnicze
+  @{
+  */
+
+/**
+  Wyznacza skrót słowa (FNV-1a z końcowym przemieszaniem).
+  @param[in] word Słowo.
+  @return Skrót.
+  */
+static uint64_t hash_word(const wchar_t *word)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (; *word != L'\0'; word++)
+    {
+        hash ^= (uint32_t) *word;
+        hash *= 1099511628211ULL;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+/**
+  Wyznacza skrót słowa zakodowanego w UTF-8, równy skrótowi tego słowa
+  jako ciągu znaków.
+  @param[in] word Słowo.
+  @param[out] hash Skrót.
+  @return false, jeśli słowo jest błędnie zakodowane, true w p.p.
+  */
+static bool hash_word_utf8(const char *word, uint64_t *hash)
+{
+    uint64_t h = 14695981039346656037ULL;
+
+    while (*word != '\0')
+    {
+        wchar_t c;
+        size_t n = utf8_decode(word, &c);
+        if (n == 0) return false;
+
+        h ^= (uint32_t) c;
+        h *= 1099511628211ULL;
+        word += n;
+    }
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+
+    *hash = h;
+    return true;
+}
+
+/**
+  Wyznacza blok słowa o danym skrócie.
+  @param[in] bloom Filtr.
+  @param[in] hash Skrót słowa.
+  @return Blok.
+  */
+static struct block * block_of(const Bloom *bloom, uint64_t hash)
+{
+    return &bloom->blocks[((hash >> 32) * bloom->n_blocks) >> 32];
+}
+
+/**
+  Sprawdza, czy w filtrze są ustawione bity słowa o danym skrócie.
+  @param[in] bloom Filtr.
+  @param[in] hash Skrót słowa.
+  @return false, jeśli słowa na pewno nie dodano do filtru, true w p.p.
+  */
+static bool contains_hash(const Bloom *bloom, uint64_t hash)
+{
+    const struct block *block = block_of(bloom, hash);
+
+    hash *= 0x9e3779b97f4a7c15ULL;
+    for (int i = 0; i < bloom->n_hashes; i++, hash >>= 9)
+    {
+        if (!(block->bits[(hash >> 6) & (BLOCK_WORDS - 1)]
+              & (UINT64_C(1) << (hash & 63))))
+            return false;
+    }
+
+    return true;
+}
+
+/**@}*/
+/** @name Elementy interfejsu
+  @{
+  */
+
+Bloom * bloom_new(size_t capacity, int bits_per_word)
+{
+    Bloom *bloom = malloc(sizeof(Bloom));
+    if (!bloom)
+    {
+        fprintf(stderr, "Failed to allocate memory for bloom filter\n");
+        exit(EXIT_FAILURE);
+    }
+
+    bloom->n_blocks = (capacity * bits_per_word + BLOCK_BITS - 1) / BLOCK_BITS;
+    if (bloom->n_blocks == 0) bloom->n_blocks = 1;
+
+    void *blocks;
+    if (bloom->n_blocks > UINT32_MAX
+        || posix_memalign(&blocks, sizeof(struct block),
+                          bloom->n_blocks * sizeof(struct block)) != 0)
+    {
+        fprintf(stderr, "Failed to allocate memory for bloom filter\n");
+        exit(EXIT_FAILURE);
+    }
+    bloom->blocks = blocks;
+    memset(bloom->blocks, 0, bloom->n_blocks * sizeof(struct block));
+
+    // Optymalna liczba ustawianych bitów to ln 2 razy liczba bitów filtru
+    // na słowo.
+    bloom->n_hashes = (bits_per_word * 69 + 50) / 100;
+    if (bloom->n_hashes < 1) bloom->n_hashes = 1;
+    if (bloom->n_hashes > MAX_HASHES) bloom->n_hashes = MAX_HASHES;
+
+    bloom->capacity = capacity;
+    bloom->size = 0;
+
+    return bloom;
+}
+
+void bloom_done(Bloom *bloom)
+{
+    free(bloom->blocks);
+    free(bloom);
+}
+
+void bloom_add(Bloom *bloom, const wchar_t *word)
+{
+    uint64_t hash = hash_word(word);
+    struct block *block = block_of(bloom, hash);
+
+    hash *= 0x9e3779b97f4a7c15ULL;
+    for (int i = 0; i < bloom->n_hashes; i++, hash >>= 9)
+        block->bits[(hash >> 6) & (BLOCK_WORDS - 1)] |=
+            UINT64_C(1) << (hash & 63);
+
+    bloom->size++;
+}
+
+bool bloom_may_contain(const Bloom *bloom, const wchar_t *word)
+{
+    return contains_hash(bloom, hash_word(word));
+}
+
+bool bloom_may_contain_utf8(const Bloom *bloom, const char *word)
+{
+    uint64_t hash;
+    return hash_word_utf8(word, &hash) && contains_hash(bloom, hash);
+}
+
+size_t bloom_size(const Bloom *bloom)
+{
+    return bloom->size;
+}
+
+size_t bloom_capacity(const Bloom *bloom)
+{
+    return bloom->capacity;
+}
+
+size_t bloom_memory(const Bloom *bloom)
+{
+    return bloom->n_blocks * sizeof(struct block);
+}
+
+double bloom_false_positive_rate(const Bloom *bloom)
+{
+    double sum = 0.0;
+
+    // Słowo spoza filtru trafia do losowego bloku i jest przepuszczane,
+    // jeśli wszystkie jego bity w tym bloku są ustawione.
+    for (size_t i = 0; i < bloom->n_blocks; i++)
+    {
+        int set = 0;
+        for (int j = 0; j < BLOCK_WORDS; j++)
+            set += __builtin_popcountll(bloom->blocks[i].bits[j]);
+
+        double rate = 1.0;
+        for (int j = 0; j < bloom->n_hashes; j++)
+            rate *= (double) set / BLOCK_BITS;
+
+        sum += rate;
+    }
+
+    return sum / bloom->n_blocks;
+}
+
+/**@}*/
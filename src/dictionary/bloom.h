@@ -0,0 +1,103 @@
+/** @file
+    Interfejs blokowego filtru Blooma.
+
+    Filtr pozwala szybko stwierdzić, że słowa na pewno nie ma w zbiorze;
+    odpowiedź pozytywna może być fałszywa. Bity każdego słowa leżą w jednym
+    bloku wielkości linii pamięci podręcznej, więc sprawdzenie słowa
+    wymaga odczytu jednej linii.
+
+    Ze słowa nie da się usunąć bitów; usunięcie słowa ze zbioru tylko
+    zwiększa prawdopodobieństwo fałszywej odpowiedzi pozytywnej, dopóki
+    filtr nie zostanie zbudowany od nowa.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#ifndef __BLOOM_H__
+#define __BLOOM_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <wchar.h>
+
+/**
+  Struktura przechowująca filtr Blooma.
+  */
+typedef struct bloom Bloom;
+
+/**
+  Inicjalizacja filtru.
+  Należy go zniszczyć za pomocą bloom_done().
+  @param[in] capacity Liczba słów, dla której filtr ma zadaną dokładność.
+  @param[in] bits_per_word Liczba bitów filtru na słowo (większa od 0).
+  @return Nowy filtr.
+  */
+Bloom * bloom_new(size_t capacity, int bits_per_word);
+
+/**
+  Destrukcja filtru.
+  @param[in,out] bloom Filtr.
+  */
+void bloom_done(Bloom *bloom);
+
+/**
+  Dodaje słowo do filtru.
+  @param[in,out] bloom Filtr.
+  @param[in] word Słowo.
+  */
+void bloom_add(Bloom *bloom, const wchar_t *word);
+
+/**
+  Sprawdza, czy słowo może należeć do zbioru.
+  Funkcję można wywoływać jednocześnie z wielu wątków.
+  @param[in] bloom Filtr.
+  @param[in] word Słowo.
+  @return false, jeśli słowa na pewno nie dodano do filtru, true w p.p.
+  */
+bool bloom_may_contain(const Bloom *bloom, const wchar_t *word);
+
+/**
+  Sprawdza, czy słowo zakodowane w UTF-8 może należeć do zbioru.
+  Funkcję można wywoływać jednocześnie z wielu wątków.
+  @param[in] bloom Filtr.
+  @param[in] word Słowo.
+  @return false, jeśli słowa na pewno nie dodano do filtru lub jest ono
+  błędnie zakodowane, true w p.p.
+  */
+bool bloom_may_contain_utf8(const Bloom *bloom, const char *word);
+
+/**
+  Zwraca liczbę słów dodanych do filtru.
+  @param[in] bloom Filtr.
+  @return Liczba słów.
+  */
+size_t bloom_size(const Bloom *bloom);
+
+/**
+  Zwraca pojemność filtru.
+  @param[in] bloom Filtr.
+  @return Liczba słów podana przy tworzeniu filtru.
+  */
+size_t bloom_capacity(const Bloom *bloom);
+
+/**
+  Zwraca pamięć zajmowaną przez tablicę bitów filtru.
+  @param[in] bloom Filtr.
+  @return Rozmiar w bajtach.
+  */
+size_t bloom_memory(const Bloom *bloom);
+
+/**
+  Szacuje prawdopodobieństwo fałszywej odpowiedzi pozytywnej.
+  Oszacowanie wynika z zapełnienia bloków, więc uwzględnia też słowa
+  usunięte ze zbioru, których bity zostały w filtrze.
+  @param[in] bloom Filtr.
+  @return Prawdopodobieństwo, że bloom_may_contain() zwróci true dla
+  słowa, którego nie dodano do filtru.
+  */
+double bloom_false_positive_rate(const Bloom *bloom);
+
+#endif /* __BLOOM_H__ */
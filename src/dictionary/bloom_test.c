@@ -0,0 +1,131 @@
+/** @file
+    Testy filtru Blooma.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwerstet Warszawski
+    @date 2026-10-19
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <cmocka.h>
+#include <locale.h>
+#include "bloom.c"
+#include "utils.h"
+
+/**
+  Liczba słów używanych w testach.
+  */
+#define N_WORDS 10000
+
+/**
+  Zapisuje do bufora słowo o danym numerze.
+  @param[out] word Bufor na co najmniej 16 znaków.
+  @param[in] i Numer słowa.
+  @param[in] inside Czy słowo należy do zbioru dodanego do filtru.
+  */
+static void make_word(wchar_t *word, int i, bool inside)
+{
+    swprintf(word, 16, inside ? L"słowo%d" : L"inne%d", i);
+}
+
+/**
+  Testuje inicjalizację filtru.
+  @param state Środowisko testowe.
+  */
+static void bloom_init_test(void** state)
+{
+    Bloom *bloom = bloom_new(N_WORDS, 10);
+
+    assert_int_equal(bloom_size(bloom), 0);
+    assert_int_equal(bloom_capacity(bloom), N_WORDS);
+    assert_true(bloom_memory(bloom) * 8 >= N_WORDS * 10);
+    assert_false(bloom_may_contain(bloom, L"kot"));
+    assert_false(bloom_may_contain(bloom, L""));
+    assert_true(bloom_false_positive_rate(bloom) == 0.0);
+
+    bloom_done(bloom);
+
+    bloom = bloom_new(0, 1);
+    bloom_add(bloom, L"kot");
+    assert_true(bloom_may_contain(bloom, L"kot"));
+    bloom_done(bloom);
+}
+
+/**
+  Testuje, że filtr przepuszcza wszystkie dodane słowa.
+  @param state Środowisko testowe.
+  */
+static void bloom_add_test(void** state)
+{
+    Bloom *bloom = bloom_new(N_WORDS, 10);
+    wchar_t word[16];
+
+    for (int i = 0; i < N_WORDS; i++)
+    {
+        make_word(word, i, true);
+        bloom_add(bloom, word);
+    }
+    bloom_add(bloom, L"");
+
+    assert_int_equal(bloom_size(bloom), N_WORDS + 1);
+    assert_true(bloom_may_contain(bloom, L""));
+
+    for (int i = 0; i < N_WORDS; i++)
+    {
+        make_word(word, i, true);
+        assert_true(bloom_may_contain(bloom, word));
+    }
+
+    bloom_done(bloom);
+}
+
+/**
+  Testuje odsetek fałszywych odpowiedzi pozytywnych i jego oszacowanie.
+  @param state Środowisko testowe.
+  */
+static void bloom_false_positive_test(void** state)
+{
+    Bloom *bloom = bloom_new(N_WORDS, 10);
+    wchar_t word[16];
+
+    for (int i = 0; i < N_WORDS; i++)
+    {
+        make_word(word, i, true);
+        bloom_add(bloom, word);
+    }
+
+    int false_positives = 0;
+    for (int i = 0; i < N_WORDS; i++)
+    {
+        make_word(word, i, false);
+        if (bloom_may_contain(bloom, word)) false_positives++;
+    }
+
+    // Dla 10 bitów na słowo oczekiwany odsetek to około 1%.
+    double rate = bloom_false_positive_rate(bloom);
+    assert_true(rate > 0.001 && rate < 0.05);
+    assert_true(false_positives < N_WORDS / 20);
+
+    bloom_done(bloom);
+}
+
+/**
+  Główna funkcja uruchamiająca testy.
+  */
+int main(void)
+{
+    setlocale(LC_ALL, "pl_PL.UTF-8");
+
+    const struct CMUnitTest tests[] =
+    {
+        cmocka_unit_test(bloom_init_test),
+        cmocka_unit_test(bloom_add_test),
+        cmocka_unit_test(bloom_false_positive_test),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
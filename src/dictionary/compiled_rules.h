@@ -0,0 +1,71 @@
+/** @file
+    Interfejs reguł skompilowanych do kodu C.
+
+    Program rule-compiler na podstawie zestawu reguł słownika generuje plik
+    źródłowy, w którym dla każdej reguły znajdują się wyspecjalizowane funkcje
+    dopasowania lewej strony i stosowania prawej strony. Jeśli taki plik
+    zostanie dołączony do programu, a odcisk wczytanego zestawu reguł się
+    zgadza, generator podpowiedzi używa tych funkcji zamiast interpretować
+    reguły.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#ifndef __COMPILED_RULES_H__
+#define __COMPILED_RULES_H__
+
+#include "node.h"
+#include "vector.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <wchar.h>
+
+/**
+  Typ funkcji dopasowującej lewą stronę reguły do prefiksu słowa.
+  Funkcja zakłada, że słowo jest nie krótsze niż lewa strona reguły.
+  Ustawia wartości zmiennych (nieustalone zmienne mają wartość L'\0').
+  */
+typedef bool (*compiled_rule_match_func)(const wchar_t *word, wchar_t *vars);
+
+/**
+  Typ funkcji stosującej prawą stronę reguły od danego węzła.
+  Do wektora dodawane są węzły, do których prowadzi prawa strona.
+  */
+typedef void (*compiled_rule_apply_func)(const wchar_t *vars, Node *node,
+                                         Vector *nodes);
+
+/**
+  Struktura przechowująca skompilowaną regułę.
+  */
+typedef struct compiled_rule
+{
+    /// Dopasowanie lewej strony.
+    compiled_rule_match_func match;
+    /// Zastosowanie prawej strony.
+    compiled_rule_apply_func apply;
+} Compiled_Rule;
+
+/**
+  Struktura przechowująca skompilowany zestaw reguł.
+  */
+typedef struct compiled_rule_set
+{
+    /// Odcisk zestawu reguł, patrz hints_generator_fingerprint().
+    uint64_t fingerprint;
+    /// Liczba reguł.
+    size_t n_rules;
+    /// Reguły w kolejności z pliku słownika.
+    const Compiled_Rule *rules;
+} Compiled_Rule_Set;
+
+/**
+  Zestaw reguł wygenerowany przez rule-compiler.
+  Symbol jest słaby: jeśli plik wygenerowany nie został dołączony do programu,
+  jego adres jest równy NULL.
+  */
+extern const Compiled_Rule_Set compiled_rule_set __attribute__((weak));
+
+#endif /* __COMPILED_RULES_H__ */
@@ -12,17 +12,82 @@
 #include "dictionary.h"
 #include "trie.h"
 #include "hints_generator.h"
+#include "qgram_index.h"
+#include "image.h"
+#include "bloom.h"
+#include "perfect_hash.h"
+#include "louds.h"
+#include "epoch.h"
+#include "journal.h"
+#include "utf8.h"
 #include "io.h"
 #include "conf.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include <dirent.h>
 #include <string.h>
+#include <wctype.h>
 #include <sys/stat.h>
 #include <argz.h>
+#include <pthread.h>
 
 #define _GNU_SOURCE
 
+/**
+  Długość q-gramów w indeksie kandydatów na podpowiedzi.
+  */
+#define QGRAM_LENGTH 2
+
+/**
+  Najmniejsza pojemność filtru Blooma.
+  */
+#define MINIMAL_BLOOM_CAPACITY 1024
+
+/**
+  Liczba słów paczki sprawdzanych filtrem Blooma przed przeszukaniem drzewa.
+  */
+#define BATCH_FILTER_WORDS 256
+
+/**
+  Przyrostek nazwy pliku z nakładką słownika warstwowego dla języka.
+  */
+#define OVERLAY_SUFFIX ".overlay"
+
+/**
+  Przyrostek nazwy pliku z dziennikiem zmian słownika dla języka.
+  */
+#define JOURNAL_SUFFIX ".journal"
+
+/**
+  Przyrostek nazwy pliku, do którego zapisywany jest słownik przed
+  zastąpieniem nim pliku słownika dla języka.
+  */
+#define TEMPORARY_SUFFIX ".tmp"
+
+/**
+  Liczba rekordów dziennika, po której dictionary_save_lang() zapisuje
+  w tle cały słownik, a potem usuwa z dziennika zapisane rekordy.
+  */
+#define JOURNAL_COMPACT_RECORDS 4096
+
+/**
+  Początkowa długość bufora na słowo wczytywane z nakładki.
+  */
+#define MINIMAL_WORD_CAPACITY 32
+
+/**
+  Największa liczba bajtów słowa UTF-8 dekodowanego w buforze na stosie.
+  Dłuższe słowa są dekodowane na stercie.
+  */
+#define UTF8_STACK_BYTES 128
+
+/**
+  Funkcja zapisująca dane do strumienia.
+  Zwraca 0, jeśli się udało, -1 w p.p.
+  */
+typedef int (*save_func)(const void *data, FILE *stream);
+
 /**
   Struktura przechowująca słownik.
  */
@@ -32,19 +97,492 @@ struct dictionary
     Trie *trie;
     /// Generator podpowiedzi.
     Hints_Generator *hints_generator;
+    /// Indeks q-gramów (NULL, jeśli nie jest używany).
+    Qgram_Index *qgram_index;
+    /// Próg kosztu, powyżej którego używany jest indeks q-gramów.
+    int qgram_threshold;
+    /// Drzewo odwróconych słów (NULL, jeśli nie jest używane).
+    Trie *reverse_trie;
+    /// Blokada odbudowy indeksu q-gramów.
+    pthread_mutex_t qgram_lock;
+    /// Filtr Blooma słów (NULL, jeśli nie jest używany).
+    Bloom *bloom;
+    /// Liczba bitów filtru na słowo (0 - filtr nie jest używany).
+    int bloom_bits;
+    /// Liczba słów usuniętych od ostatniej odbudowy filtru.
+    size_t bloom_deleted;
+    /// Indeks słów do wyszukiwania dokładnego (NULL, jeśli nie jest używany).
+    Perfect_Hash *exact_index;
+    /// Zwięzłe drzewo (NULL, jeśli nie jest używane).
+    Louds *succinct_index;
+    /// Odzyskiwanie pamięci migawek (NULL, jeśli nie są używane).
+    Epoch *epoch;
+    /// Blokada zmian słownika przy włączonych migawkach.
+    pthread_mutex_t write_lock;
+    /// Słownik bazowy (NULL, jeśli słownik nie jest warstwowy).
+    const struct dictionary *base;
+    /// Dziennik zmian języka, z którego wczytano słownik (lub NULL).
+    Journal *journal;
+    /// Język, do którego należy dziennik.
+    char *journal_lang;
+    /// Czy zmiany są dopisywane do dziennika.
+    bool journal_enabled;
+    /// Czy reguły lub maksymalny koszt podpowiedzi zmieniono; słownik
+    /// warstwowy zapisuje je wtedy w nakładce.
+    bool rules_changed;
+    /// Zapis całego słownika w tle, po którym z dziennika są usuwane
+    /// rekordy sprzed jego rozpoczęcia (NULL, jeśli go nie ma).
+    struct dictionary_save *compaction;
+    /// Czy słownik wczytano przez dictionary_load_lookup(): słowa są tylko
+    /// w zwięzłym drzewie, a drzewo słownika jest puste.
+    bool lookup_only;
+};
+
+/**
+  Stan zapisu słownika w tle.
+  */
+struct dictionary_save
+{
+    /// Słownik.
+    const struct dictionary *dict;
+    /// Ścieżka pliku.
+    char *path;
+    /// Zapisywany korzeń drzewa (migawka).
+    const Node *root;
+    /// Kopia generatora podpowiedzi z chwili rozpoczęcia zapisu.
+    Hints_Generator *hints_generator;
+    /// Słownik zapisany w pamięci w chwili rozpoczęcia zapisu (NULL, jeśli
+    /// zapisywana jest migawka).
+    wchar_t *image;
+    /// Czytelnik migawki, który nie pozwala zwolnić jej węzłów.
+    int reader;
+    /// Wątek zapisujący.
+    pthread_t thread;
+    /// Czy zapis odbywa się w osobnym wątku.
+    bool threaded;
+    /// Czy zapis się zakończył.
+    bool finished;
+    /// Wynik zapisu.
+    int result;
 };
 
 /** @name Funkcje pomocnicze
   @{
  */
 
+/*
+ Kończy zapis słownika w tle zaczęty przez start_compaction(): czeka na
+ niego albo, jeśli wait jest fałszem, tylko sprawdza, czy się zakończył.
+ Po udanym zapisie usuwa z dziennika zapisane już rekordy. Nieudany zapis
+ powtórzy kolejne dictionary_save_lang(), bo dziennik się nie skrócił.
+ */
+static void finish_compaction(struct dictionary *dict, bool wait)
+{
+    if (dict->compaction == NULL) return;
+    if (!wait && !dictionary_save_finished(dict->compaction)) return;
+
+    int ret = dictionary_save_wait(dict->compaction);
+    dict->compaction = NULL;
+
+    if (ret == 0) journal_clear_checkpoint(dict->journal);
+}
+
 /*
  Czyszczenie pamięci słownika
  */
 static void dictionary_free(struct dictionary *dict)
 {
+    finish_compaction(dict, true);
+    // Zastąpione węzły mogą należeć do bloku zwalnianego razem z drzewem.
+    if (dict->epoch) epoch_done(dict->epoch);
     trie_done(dict->trie);
     hints_generator_done(dict->hints_generator);
+    if (dict->qgram_index) qgram_index_done(dict->qgram_index);
+    if (dict->reverse_trie) trie_done(dict->reverse_trie);
+    if (dict->bloom) bloom_done(dict->bloom);
+    if (dict->exact_index) perfect_hash_done(dict->exact_index);
+    if (dict->succinct_index) louds_done(dict->succinct_index);
+    if (dict->journal) journal_done(dict->journal);
+    free(dict->journal_lang);
+    pthread_mutex_destroy(&dict->qgram_lock);
+    pthread_mutex_destroy(&dict->write_lock);
+}
+
+/*
+ Dekoduje słowo UTF-8 do bufora buf na UTF8_STACK_BYTES + 1 znaków, a zbyt
+ długie słowo do pamięci na stercie. Zwraca zdekodowane słowo, które należy
+ zwolnić przez free_wide_word(), lub NULL, jeśli słowo jest błędnie
+ zakodowane.
+ */
+static wchar_t * decode_utf8_word(const char *word, wchar_t *buf)
+{
+    size_t len = strlen(word);
+    wchar_t *wide = buf;
+
+    if (len > UTF8_STACK_BYTES)
+    {
+        wide = malloc((len + 1) * sizeof(wchar_t));
+        if (!wide)
+        {
+            fprintf(stderr, "Failed to allocate memory for word\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (utf8_to_wide(word, wide) == (size_t) -1)
+    {
+        if (wide != buf) free(wide);
+        return NULL;
+    }
+
+    return wide;
+}
+
+/*
+ Zwalnia słowo zdekodowane przez decode_utf8_word().
+ */
+static void free_wide_word(wchar_t *wide, wchar_t *buf)
+{
+    if (wide != buf) free(wide);
+}
+
+/*
+ Odwraca słowo.
+ */
+static void reverse_word(const wchar_t *word, wchar_t *reversed, size_t len)
+{
+    for (size_t i = 0; i < len; i++) reversed[i] = word[len - 1 - i];
+    reversed[len] = L'\0';
+}
+
+/*
+ Buduje drzewo odwróconych słów na podstawie drzewa.
+ */
+static void build_reverse_trie(struct dictionary *dict)
+{
+    // Nakładka na drzewo bazowe wymaga odwrócenia tylko zmienionych słów.
+    if (dict->base != NULL && dict->base->reverse_trie != NULL)
+    {
+        struct word_list added, deleted;
+        word_list_init(&added);
+        word_list_init(&deleted);
+        trie_overlay_changes(dict->trie, &added, &deleted);
+
+        dict->reverse_trie = trie_new_overlay(dict->base->reverse_trie);
+
+        for (size_t i = 0; i < word_list_size(&added); i++)
+        {
+            const wchar_t *word = word_list_get(&added)[i];
+            size_t len = wcslen(word);
+            wchar_t reversed[len + 1];
+            reverse_word(word, reversed, len);
+            trie_insert_word(dict->reverse_trie, reversed);
+        }
+
+        for (size_t i = 0; i < word_list_size(&deleted); i++)
+        {
+            const wchar_t *word = word_list_get(&deleted)[i];
+            size_t len = wcslen(word);
+            wchar_t reversed[len + 1];
+            reverse_word(word, reversed, len);
+            trie_delete_word(dict->reverse_trie, reversed);
+        }
+
+        word_list_done(&deleted);
+        word_list_done(&added);
+        return;
+    }
+
+    struct word_list words;
+    word_list_init(&words);
+    trie_to_word_list(dict->trie, &words);
+
+    dict->reverse_trie = trie_new();
+
+    const wchar_t * const *a = word_list_get(&words);
+    for (size_t i = 0; i < word_list_size(&words); i++)
+    {
+        size_t len = wcslen(a[i]);
+        wchar_t reversed[len + 1];
+        reverse_word(a[i], reversed, len);
+        trie_insert_word(dict->reverse_trie, reversed);
+    }
+
+    word_list_done(&words);
+}
+
+/*
+ Tworzy pusty filtr Blooma na podaną liczbę słów.
+ */
+static void new_bloom(struct dictionary *dict, size_t n_words)
+{
+    // Zapas pojemności pozwala wstawiać słowa bez częstej odbudowy.
+    size_t capacity = 2 * n_words;
+    if (capacity < MINIMAL_BLOOM_CAPACITY) capacity = MINIMAL_BLOOM_CAPACITY;
+    dict->bloom = bloom_new(capacity, dict->bloom_bits);
+}
+
+/*
+ Buduje od nowa filtr Blooma na podstawie drzewa.
+ */
+static void rebuild_bloom(struct dictionary *dict)
+{
+    if (dict->bloom) bloom_done(dict->bloom);
+    dict->bloom = NULL;
+    dict->bloom_deleted = 0;
+
+    // Filtr byłby zmieniany podczas czytania.
+    if (dict->bloom_bits <= 0 || dict->epoch != NULL) return;
+
+    struct word_list words;
+    word_list_init(&words);
+
+    // Słowa słownika bazowego są w jego filtrze, więc filtr słownika
+    // warstwowego zawiera tylko słowa wstawione do nakładki.
+    if (dict->base != NULL)
+    {
+        struct word_list deleted;
+        word_list_init(&deleted);
+        trie_overlay_changes(dict->trie, &words, &deleted);
+        word_list_done(&deleted);
+    }
+    else trie_to_word_list(dict->trie, &words);
+
+    new_bloom(dict, word_list_size(&words));
+
+    const wchar_t * const *a = word_list_get(&words);
+    for (size_t i = 0; i < word_list_size(&words); i++)
+        bloom_add(dict->bloom, a[i]);
+
+    word_list_done(&words);
+}
+
+/*
+ Sprawdza, czy słowa można odrzucać filtrem Blooma.
+ */
+static bool bloom_usable(const struct dictionary *dict)
+{
+    return dict->bloom != NULL
+           && (dict->base == NULL || dict->base->bloom != NULL);
+}
+
+/*
+ Sprawdza, czy filtr Blooma wyklucza słowo. Słowo słownika warstwowego
+ jest w filtrze nakładki albo w filtrze słownika bazowego.
+ */
+static bool bloom_rejects(const struct dictionary *dict, const wchar_t *word)
+{
+    return !bloom_may_contain(dict->bloom, word)
+           && (dict->base == NULL
+               || !bloom_may_contain(dict->base->bloom, word));
+}
+
+/*
+ Sprawdza, czy filtr Blooma wyklucza słowo zakodowane w UTF-8.
+ */
+static bool bloom_rejects_utf8(const struct dictionary *dict,
+                               const char *word)
+{
+    return !bloom_may_contain_utf8(dict->bloom, word)
+           && (dict->base == NULL
+               || !bloom_may_contain_utf8(dict->base->bloom, word));
+}
+
+/*
+ Ustawia generatorowi podpowiedzi korzenie drzew, które w słowniku
+ warstwowym zmieniają się przy skopiowaniu korzenia bazowego.
+ */
+static void update_hint_roots(struct dictionary *dict)
+{
+    hints_generator_set_root(dict->hints_generator,
+                             trie_get_root(dict->trie));
+    hints_generator_set_reverse_root(dict->hints_generator,
+        dict->reverse_trie ? trie_get_root(dict->reverse_trie) : NULL);
+}
+
+/*
+ Porzuca indeks wyszukiwania dokładnego po zmianie słownika.
+ */
+static void drop_exact_index(struct dictionary *dict)
+{
+    if (dict->exact_index == NULL) return;
+
+    perfect_hash_done(dict->exact_index);
+    dict->exact_index = NULL;
+}
+
+/*
+ Porzuca zwięzłe drzewo po zmianie słownika.
+ */
+static void drop_succinct_index(struct dictionary *dict)
+{
+    if (dict->succinct_index == NULL) return;
+
+    louds_done(dict->succinct_index);
+    dict->succinct_index = NULL;
+}
+
+/*
+ Ustawia generatorowi podpowiedzi indeks q-gramów i próg jego użycia.
+ */
+static void setup_qgram_index(struct dictionary *dict)
+{
+    if (dict->qgram_threshold > 0 && dict->qgram_index == NULL)
+    {
+        dict->qgram_index = qgram_index_new(QGRAM_LENGTH);
+        qgram_index_invalidate(dict->qgram_index);
+    }
+
+    // Indeks byłby odbudowywany podczas zmian migawek.
+    bool enabled = (dict->epoch == NULL);
+
+    hints_generator_set_qgram_index(dict->hints_generator,
+                                    enabled ? dict->qgram_index : NULL);
+    hints_generator_qgram_threshold(dict->hints_generator,
+                                    enabled ? dict->qgram_threshold : 0);
+}
+
+/*
+ Wyznacza długość najdłuższego słowa w zapisie drzewa (trie_load_text()).
+ */
+static size_t text_longest(const wchar_t *text, size_t length)
+{
+    size_t depth = 0, longest = 0;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        if (text[i] == L'^') depth--;
+        else if (text[i] != L'*' && ++depth > longest) longest = depth;
+    }
+
+    return longest;
+}
+
+/*
+ Wyznacza kolejne słowo zapisu drzewa, od pozycji pos, w kolejności
+ trie_to_word_list(). Bufor prefix na text_longest() + 1 znaków i depth
+ przechowują ścieżkę między wywołaniami. Zwraca false na końcu zapisu.
+ */
+static bool text_next_word(const wchar_t *text, size_t length, size_t *pos,
+                           wchar_t *prefix, size_t *depth)
+{
+    while (*pos < length)
+    {
+        wchar_t c = text[(*pos)++];
+
+        if (c == L'^') (*depth)--;
+        else if (c != L'*') prefix[(*depth)++] = c;
+        else
+        {
+            prefix[*depth] = L'\0';
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ Zwraca, czy zmiany słownika są dopisywane do dziennika.
+ */
+static bool journaling(const struct dictionary *dict)
+{
+    return dict->journal != NULL && dict->journal_enabled;
+}
+
+/*
+ Dopisuje do dziennika wstawienie albo usunięcie słowa. Błąd zapisu
+ wychodzi przy utrwalaniu dziennika w dictionary_save_lang().
+ */
+static void log_word(struct dictionary *dict, wchar_t op, const wchar_t *word)
+{
+    if (journaling(dict)) journal_append(dict->journal, L"%lc%ls", op, word);
+}
+
+/*
+ Wstawia słowo przy włączonych migawkach.
+ */
+static int insert_shared(struct dictionary *dict, const wchar_t *word)
+{
+    pthread_mutex_lock(&dict->write_lock);
+
+    int ret = trie_insert_word_shared(dict->trie, word, dict->epoch);
+
+    if (ret == 1) log_word(dict, L'+', word);
+
+    if (ret == 1 && dict->qgram_index != NULL)
+    {
+        qgram_index_invalidate(dict->qgram_index);
+    }
+
+    if (ret == 1 && dict->reverse_trie != NULL)
+    {
+        size_t len = wcslen(word);
+        wchar_t reversed[len + 1];
+        reverse_word(word, reversed, len);
+        trie_insert_word_shared(dict->reverse_trie, reversed, dict->epoch);
+    }
+
+    pthread_mutex_unlock(&dict->write_lock);
+
+    return ret;
+}
+
+/*
+ Usuwa słowo przy włączonych migawkach.
+ */
+static int delete_shared(struct dictionary *dict, const wchar_t *word)
+{
+    pthread_mutex_lock(&dict->write_lock);
+
+    int ret = trie_delete_word_shared(dict->trie, word, dict->epoch);
+
+    if (ret == 1) log_word(dict, L'-', word);
+
+    if (ret == 1 && dict->qgram_index != NULL)
+    {
+        qgram_index_invalidate(dict->qgram_index);
+    }
+
+    if (ret == 1 && dict->reverse_trie != NULL)
+    {
+        size_t len = wcslen(word);
+        wchar_t reversed[len + 1];
+        reverse_word(word, reversed, len);
+        trie_delete_word_shared(dict->reverse_trie, reversed, dict->epoch);
+    }
+
+    pthread_mutex_unlock(&dict->write_lock);
+
+    return ret;
+}
+
+/*
+ Odbudowuje indeks q-gramów na podstawie drzewa, jeśli jest nieaktualny.
+ */
+static void refresh_qgram_index(struct dictionary *dict)
+{
+    pthread_mutex_lock(&dict->qgram_lock);
+    if (qgram_index_is_valid(dict->qgram_index))
+    {
+        pthread_mutex_unlock(&dict->qgram_lock);
+        return;
+    }
+
+    struct word_list words;
+    word_list_init(&words);
+    trie_to_word_list(dict->trie, &words);
+
+    qgram_index_clear(dict->qgram_index);
+
+    const wchar_t * const *a = word_list_get(&words);
+    for (size_t i = 0; i < word_list_size(&words); i++)
+    {
+        qgram_index_add(dict->qgram_index, a[i]);
+    }
+
+    word_list_done(&words);
+    pthread_mutex_unlock(&dict->qgram_lock);
 }
 
 /*
@@ -52,70 +590,827 @@ static void dictionary_free(struct dictionary *dict)
  */
 static bool file_is_current_or_parent_dir(char *filename)
 {
-    return (strcmp(filename, ".") == 0 || strcmp(filename, "..") == 0);
+    return (strcmp(filename, ".") == 0 || strcmp(filename, "..") == 0);
+}
+
+static FILE * open_dict_file(const char *lang, char *permissions)
+{
+    char path[strlen(CONF_PATH) + strlen(lang) + 2];
+
+    strcpy(path, CONF_PATH);
+    strcat(path, "/");
+    strcat(path, lang);
+
+    return fopen(path, permissions);
+}
+
+/*
+ Otwiera plik z nakładką słownika warstwowego dla języka.
+ */
+static FILE * open_overlay_file(const char *lang, char *permissions)
+{
+    char name[strlen(lang) + strlen(OVERLAY_SUFFIX) + 1];
+
+    strcpy(name, lang);
+    strcat(name, OVERLAY_SUFFIX);
+
+    return open_dict_file(name, permissions);
+}
+
+/*
+ Zwraca, czy nazwa pliku kończy się danym przyrostkiem.
+ */
+static bool file_has_suffix(const char *filename, const char *suffix)
+{
+    size_t len = strlen(filename), suffix_len = strlen(suffix);
+
+    return (len > suffix_len
+            && strcmp(filename + len - suffix_len, suffix) == 0);
+}
+
+/*
+ Zwraca, czy plik nie jest słownikiem języka, tylko nakładką, dziennikiem
+ lub niedokończonym zapisem słownika.
+ */
+static bool file_is_auxiliary(const char *filename)
+{
+    return (file_has_suffix(filename, OVERLAY_SUFFIX)
+            || file_has_suffix(filename, JOURNAL_SUFFIX)
+            || file_has_suffix(filename, TEMPORARY_SUFFIX));
+}
+
+/*
+ Zwraca ścieżkę pliku słownika dla języka (lub nakładki, jeśli słownik
+ jest warstwowy) z dodanym przyrostkiem. Ścieżkę należy zwolnić.
+ */
+static char * lang_file_path(const struct dictionary *dict, const char *lang,
+                             const char *suffix)
+{
+    const char *overlay = dict->base != NULL ? OVERLAY_SUFFIX : "";
+    char *path = malloc(strlen(CONF_PATH) + strlen(lang) + strlen(overlay)
+                        + strlen(suffix) + 2);
+    if (!path)
+    {
+        fprintf(stderr, "Failed to allocate memory for dictionary\n");
+        exit(EXIT_FAILURE);
+    }
+
+    strcpy(path, CONF_PATH);
+    strcat(path, "/");
+    strcat(path, lang);
+    strcat(path, overlay);
+    strcat(path, suffix);
+
+    return path;
+}
+
+/*
+ Odtwarza rekord dziennika zmian: `+słowo`, `-słowo`, `!` (usunięcie
+ reguł), `c` z kosztem albo `r` z regułą w formacie rule_save().
+ */
+static int replay_record(void *data, const wchar_t *record)
+{
+    struct dictionary *dict = data;
+    wchar_t *end;
+
+    switch (record[0])
+    {
+        case L'+':
+        case L'-':
+            if (record[1] == L'\0') return -1;
+            if (record[0] == L'+') dictionary_insert(dict, record + 1);
+            else dictionary_delete(dict, record + 1);
+            return 0;
+
+        case L'!':
+            if (record[1] != L'\0') return -1;
+            dictionary_rule_clear(dict);
+            return 0;
+
+        case L'c':
+        {
+            long cost = wcstol(record + 1, &end, 10);
+            if (end == record + 1 || *end != L'\0' || cost < 0) return -1;
+            dictionary_hints_max_cost(dict, cost);
+            return 0;
+        }
+
+        case L'r':
+        {
+            // Strony reguły nie zawierają separatora.
+            wchar_t left[wcslen(record)];
+            wcscpy(left, record + 1);
+
+            wchar_t *right = wcschr(left, L'*');
+            if (right == NULL) return -1;
+            *right++ = L'\0';
+
+            wchar_t *numbers = wcschr(right, L'*');
+            if (numbers == NULL) return -1;
+            *numbers++ = L'\0';
+
+            long cost = wcstol(numbers, &end, 10);
+            if (end == numbers || *end != L'*') return -1;
+            numbers = end + 1;
+            long flag = wcstol(numbers, &end, 10);
+            if (end == numbers || *end != L'\0') return -1;
+
+            dictionary_rule_add(dict, left, right, false, cost, flag);
+            return 0;
+        }
+
+        default:
+            return -1;
+    }
+}
+
+/*
+ Odtwarza dziennik zmian języka w słowniku i dołącza go do słownika.
+ Zwraca słownik lub NULL (niszcząc słownik), jeśli dziennik jest
+ niepoprawny.
+ */
+static struct dictionary * replay_journal(struct dictionary *dict,
+                                          const char *lang)
+{
+    char *path = lang_file_path(dict, lang, JOURNAL_SUFFIX);
+    Journal *journal = journal_new(path);
+    free(path);
+
+    if (journal_replay(journal, replay_record, dict) < 0)
+    {
+        journal_done(journal);
+        dictionary_done(dict);
+        return NULL;
+    }
+
+    dict->journal = journal;
+    dict->journal_lang = malloc(strlen(lang) + 1);
+    if (!dict->journal_lang)
+    {
+        fprintf(stderr, "Failed to allocate memory for dictionary\n");
+        exit(EXIT_FAILURE);
+    }
+    strcpy(dict->journal_lang, lang);
+
+    return dict;
+}
+
+/*
+ Zapisuje dane do pliku. Dane są najpierw zapisywane do pliku
+ tymczasowego, który potem zastępuje plik, więc przerwany zapis nie
+ niszczy poprzedniej wersji.
+ */
+static int save_file_atomically(const char *path, save_func save,
+                                const void *data)
+{
+    char tmp_path[strlen(path) + strlen(TEMPORARY_SUFFIX) + 1];
+    int ret = -1;
+
+    strcpy(tmp_path, path);
+    strcat(tmp_path, TEMPORARY_SUFFIX);
+
+    FILE *file = fopen(tmp_path, "w+");
+    if (file != NULL)
+    {
+        ret = save(data, file);
+        if (ret == 0 && (fflush(file) != 0 || fsync(fileno(file)) != 0))
+            ret = -1;
+        if (fclose(file) != 0) ret = -1;
+
+        if (ret == 0 && rename(tmp_path, path) != 0) ret = -1;
+        if (ret < 0) unlink(tmp_path);
+    }
+
+    return ret;
+}
+
+/*
+ Zapisuje słownik do strumienia; funkcja dla save_file_atomically().
+ */
+static int save_dictionary(const void *data, FILE *stream)
+{
+    return dictionary_save(data, stream);
+}
+
+/*
+ Zapisuje migawkę słownika do strumienia w formacie dictionary_save();
+ funkcja dla save_file_atomically().
+ */
+static int save_snapshot(const void *data, FILE *stream)
+{
+    const struct dictionary_save *save = data;
+    IO *io = io_new(stdin, stream, stderr);
+
+    // Alfabet współdzielonego drzewa się nie zmienia.
+    int ret = alphabet_save(trie_get_alphabet(save->dict->trie), io);
+    if (ret == 0) ret = trie_save_root(save->root, io);
+    if (ret == 0) ret = hints_generator_save(save->hints_generator, io);
+
+    io_done(io);
+
+    return ret;
+}
+
+/*
+ Zapisuje słownik w pamięci w formacie dictionary_save(). Zwraca napis,
+ który należy zwolnić, lub NULL, jeśli zapis się nie powiódł.
+ */
+static wchar_t * save_to_image(const struct dictionary *dict)
+{
+    wchar_t *image = NULL;
+    size_t len;
+
+    FILE *stream = open_wmemstream(&image, &len);
+    if (!stream) return NULL;
+
+    int ret = dictionary_save(dict, stream);
+    if (fclose(stream) != 0) ret = -1;
+
+    if (ret < 0)
+    {
+        free(image);
+        return NULL;
+    }
+
+    return image;
+}
+
+/*
+ Zapisuje do strumienia słownik zapisany wcześniej w pamięci; funkcja dla
+ save_file_atomically().
+ */
+static int save_image(const void *data, FILE *stream)
+{
+    const struct dictionary_save *save = data;
+
+    return fputws(save->image, stream) < 0 ? -1 : 0;
+}
+
+/*
+ Wątek zapisujący do pliku słownik zapisany wcześniej w pamięci.
+ */
+static void * save_image_thread(void *arg)
+{
+    struct dictionary_save *save = arg;
+
+    save->result = save_file_atomically(save->path, save_image, save);
+
+    __atomic_store_n(&save->finished, true, __ATOMIC_RELEASE);
+
+    return NULL;
+}
+
+/*
+ Wątek zapisujący migawkę słownika w tle.
+ */
+static void * save_snapshot_thread(void *arg)
+{
+    struct dictionary_save *save = arg;
+
+    save->result = save_file_atomically(save->path, save_snapshot, save);
+    epoch_exit(save->dict->epoch, save->reader);
+
+    __atomic_store_n(&save->finished, true, __ATOMIC_RELEASE);
+
+    return NULL;
+}
+
+/*
+ Zapisuje cały słownik do pliku dla języka. Dziennik języka jest potem
+ zbędny i jest usuwany.
+ */
+static int save_lang_file(const struct dictionary *dict, const char *lang)
+{
+    char *path = lang_file_path(dict, lang, "");
+    int ret = save_file_atomically(path, save_dictionary, dict);
+
+    if (ret == 0)
+    {
+        if (dict->journal != NULL && strcmp(dict->journal_lang, lang) == 0)
+            ret = journal_clear(dict->journal);
+        else
+        {
+            char *journal_path = lang_file_path(dict, lang, JOURNAL_SUFFIX);
+            Journal *journal = journal_new(journal_path);
+            ret = journal_clear(journal);
+            journal_done(journal);
+            free(journal_path);
+        }
+    }
+
+    free(path);
+
+    return ret;
+}
+
+/*
+ Zaczyna zapis całego słownika do pliku dla języka dziennika w tle,
+ ustawiając w dzienniku punkt kontrolny. Zwraca 0, jeśli zapis się
+ zaczął, -1 w p.p.
+ */
+static int start_compaction(struct dictionary *dict, const char *lang)
+{
+    // Przy migawkach słowo mogłoby trafić do dziennika po punkcie
+    // kontrolnym, a do drzewa przed rozpoczęciem zapisu.
+    if (dict->epoch != NULL) pthread_mutex_lock(&dict->write_lock);
+
+    int ret = journal_checkpoint(dict->journal);
+    if (ret == 0)
+    {
+        char *path = lang_file_path(dict, lang, "");
+        dict->compaction = dictionary_save_async(dict, path);
+        free(path);
+    }
+
+    if (dict->epoch != NULL) pthread_mutex_unlock(&dict->write_lock);
+
+    return ret;
+}
+
+/*
+ Zapisuje nakładkę słownika warstwowego: po jednym słowie w linii,
+ poprzedzonym `+` dla słów wstawionych i `-` dla usuniętych. Jeśli
+ reguły lub maksymalny koszt podpowiedzi zmieniono, po linii `=` są
+ zapisywane w formacie hints_generator_save().
+ */
+static int save_overlay(const struct dictionary *dict, IO *io)
+{
+    struct word_list added, deleted;
+    word_list_init(&added);
+    word_list_init(&deleted);
+    trie_overlay_changes(dict->trie, &added, &deleted);
+
+    int ret = 0;
+    for (size_t i = 0; ret == 0 && i < word_list_size(&added); i++)
+    {
+        if (io_printf(io, L"+%ls\n", word_list_get(&added)[i]) < 0) ret = -1;
+    }
+    for (size_t i = 0; ret == 0 && i < word_list_size(&deleted); i++)
+    {
+        if (io_printf(io, L"-%ls\n", word_list_get(&deleted)[i]) < 0)
+            ret = -1;
+    }
+    if (ret == 0 && dict->rules_changed)
+    {
+        if (io_printf(io, L"=\n") < 0
+            || hints_generator_save(dict->hints_generator, io) < 0)
+            ret = -1;
+    }
+
+    word_list_done(&deleted);
+    word_list_done(&added);
+
+    return ret;
+}
+
+/*
+ Wczytuje słowo z linii nakładki do końca linii.
+ Zwraca NULL, jeśli słowo jest puste lub zawiera znak niebędący literą.
+ */
+static wchar_t * load_overlay_word(IO *io)
+{
+    size_t len = 0, capacity = 0;
+    wchar_t *word = NULL;
+    wint_t c;
+
+    while ((c = io_get_next(io)) != L'\n' && c != WEOF)
+    {
+        if (!iswalpha(c))
+        {
+            free(word);
+            return NULL;
+        }
+
+        if (len + 1 >= capacity)
+        {
+            capacity = capacity > 0 ? 2 * capacity : MINIMAL_WORD_CAPACITY;
+            word = realloc(word, capacity * sizeof(wchar_t));
+            if (!word)
+            {
+                fprintf(stderr, "Failed to allocate memory for overlay\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        word[len++] = c;
+    }
+
+    if (len == 0)
+    {
+        free(word);
+        return NULL;
+    }
+
+    word[len] = L'\0';
+    return word;
+}
+
+/**@}*/
+/** @name Elementy interfejsu
+  @{
+  */
+struct dictionary * dictionary_new()
+{
+    struct dictionary *dict =
+        (struct dictionary *) malloc(sizeof(struct dictionary));
+    if (!dict)
+    {
+        fprintf(stderr, "Failed to allocate memory for dictionary\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Budowa indeksów poniżej zależy od tego, czy migawki są włączone
+    // i czy słownik jest warstwowy.
+    dict->epoch = NULL;
+    pthread_mutex_init(&dict->write_lock, NULL);
+    dict->base = NULL;
+
+    dict->trie = trie_new();
+    dict->hints_generator = hints_generator_new();
+    hints_generator_set_root(dict->hints_generator, trie_get_root(dict->trie));
+
+    dict->qgram_index = NULL;
+    dict->qgram_threshold = DICTIONARY_QGRAM_THRESHOLD;
+    setup_qgram_index(dict);
+
+    dict->reverse_trie = NULL;
+    pthread_mutex_init(&dict->qgram_lock, NULL);
+
+    dict->bloom = NULL;
+    dict->bloom_bits = DICTIONARY_BLOOM_BITS;
+    rebuild_bloom(dict);
+
+    dict->exact_index = NULL;
+    dict->succinct_index = NULL;
+
+    dict->journal = NULL;
+    dict->journal_lang = NULL;
+    dict->journal_enabled = false;
+    dict->rules_changed = false;
+    dict->compaction = NULL;
+    dict->lookup_only = false;
+
+    return dict;
+}
+
+struct dictionary * dictionary_new_layered(const struct dictionary *base)
+{
+    struct dictionary *dict = dictionary_new();
+
+    trie_done(dict->trie);
+    hints_generator_done(dict->hints_generator);
+    dict->base = base;
+    dict->trie = trie_new_overlay(base->trie);
+    dict->hints_generator = hints_generator_copy(base->hints_generator);
+
+    dict->qgram_threshold = base->qgram_threshold;
+    setup_qgram_index(dict);
+    dict->bloom_bits = base->bloom_bits;
+    rebuild_bloom(dict);
+    if (base->reverse_trie != NULL) build_reverse_trie(dict);
+    update_hint_roots(dict);
+
+    return dict;
+}
+
+void dictionary_done(struct dictionary *dict)
+{
+    dictionary_free(dict);
+    free(dict);
+}
+
+int dictionary_insert(struct dictionary *dict, const wchar_t *word)
+{
+    if (dict->lookup_only) return 0;
+    if (dict->epoch != NULL) return insert_shared(dict, word);
+
+    int ret = trie_insert_word(dict->trie, word);
+
+    if (ret == 1) log_word(dict, L'+', word);
+
+    if (ret == 1)
+    {
+        drop_exact_index(dict);
+        drop_succinct_index(dict);
+    }
+
+    if (ret == 1 && dict->qgram_index != NULL
+        && qgram_index_is_valid(dict->qgram_index))
+    {
+        qgram_index_add(dict->qgram_index, word);
+    }
+
+    if (ret == 1 && dict->reverse_trie != NULL)
+    {
+        size_t len = wcslen(word);
+        wchar_t reversed[len + 1];
+        reverse_word(word, reversed, len);
+        trie_insert_word(dict->reverse_trie, reversed);
+    }
+
+    if (ret == 1 && dict->bloom != NULL)
+    {
+        if (bloom_size(dict->bloom) < bloom_capacity(dict->bloom))
+            bloom_add(dict->bloom, word);
+        else
+            rebuild_bloom(dict);
+    }
+
+    if (ret == 1 && dict->base != NULL) update_hint_roots(dict);
+
+    return ret;
+}
+
+int dictionary_delete(struct dictionary *dict, const wchar_t *word)
+{
+    if (dict->lookup_only) return 0;
+    if (dict->epoch != NULL) return delete_shared(dict, word);
+
+    int ret = trie_delete_word(dict->trie, word);
+
+    if (ret == 1) log_word(dict, L'-', word);
+
+    if (ret == 1)
+    {
+        drop_exact_index(dict);
+        drop_succinct_index(dict);
+    }
+
+    if (ret == 1 && dict->qgram_index != NULL)
+    {
+        qgram_index_invalidate(dict->qgram_index);
+    }
+
+    if (ret == 1 && dict->reverse_trie != NULL)
+    {
+        size_t len = wcslen(word);
+        wchar_t reversed[len + 1];
+        reverse_word(word, reversed, len);
+        trie_delete_word(dict->reverse_trie, reversed);
+    }
+
+    // Bity usuniętego słowa zostają w filtrze i tylko zwiększają odsetek
+    // fałszywych trafień, więc filtr jest odbudowywany dopiero, gdy
+    // usunięto ćwierć słów.
+    if (ret == 1 && dict->bloom != NULL
+        && ++dict->bloom_deleted * 4 > bloom_size(dict->bloom))
+    {
+        rebuild_bloom(dict);
+    }
+
+    if (ret == 1 && dict->base != NULL) update_hint_roots(dict);
+
+    return ret;
+}
+
+bool dictionary_find(const struct dictionary *dict, const wchar_t* word)
+{
+    if (dict->epoch != NULL)
+    {
+        int reader = epoch_enter(dict->epoch);
+        bool ret = trie_has_word(dict->trie, word);
+        epoch_exit(dict->epoch, reader);
+        return ret;
+    }
+
+    if (dict->exact_index != NULL)
+        return perfect_hash_contains(dict->exact_index, word);
+
+    if (bloom_usable(dict) && bloom_rejects(dict, word)) return false;
+
+    if (dict->succinct_index != NULL)
+        return louds_has_word(dict->succinct_index, word);
+
+    return trie_has_word(dict->trie, word);
+}
+
+void dictionary_find_batch(const struct dictionary *dict,
+                           const wchar_t * const *words, size_t n,
+                           bool *results)
+{
+    if (dict->epoch != NULL)
+    {
+        int reader = epoch_enter(dict->epoch);
+        trie_has_words(dict->trie, words, n, results);
+        epoch_exit(dict->epoch, reader);
+        return;
+    }
+
+    if (dict->exact_index != NULL)
+    {
+        for (size_t i = 0; i < n; i++)
+            results[i] = perfect_hash_contains(dict->exact_index, words[i]);
+        return;
+    }
+
+    if (dict->succinct_index != NULL)
+    {
+        for (size_t i = 0; i < n; i++)
+            results[i] = dictionary_find(dict, words[i]);
+        return;
+    }
+
+    if (!bloom_usable(dict))
+    {
+        trie_has_words(dict->trie, words, n, results);
+        return;
+    }
+
+    // Drzewo przeszukujemy tylko dla słów przepuszczonych przez filtr.
+    for (size_t start = 0; start < n; start += BATCH_FILTER_WORDS)
+    {
+        const wchar_t *passed[BATCH_FILTER_WORDS];
+        size_t index[BATCH_FILTER_WORDS], n_passed = 0;
+        bool found[BATCH_FILTER_WORDS];
+        size_t end = start + BATCH_FILTER_WORDS < n
+                     ? start + BATCH_FILTER_WORDS : n;
+
+        for (size_t i = start; i < end; i++)
+        {
+            results[i] = false;
+            if (!bloom_rejects(dict, words[i]))
+            {
+                index[n_passed] = i;
+                passed[n_passed++] = words[i];
+            }
+        }
+
+        trie_has_words(dict->trie, passed, n_passed, found);
+        for (size_t j = 0; j < n_passed; j++) results[index[j]] = found[j];
+    }
+}
+
+int dictionary_insert_utf8(struct dictionary *dict, const char *word)
+{
+    wchar_t buf[UTF8_STACK_BYTES + 1];
+    wchar_t *wide = decode_utf8_word(word, buf);
+    if (wide == NULL) return 0;
+
+    int ret = dictionary_insert(dict, wide);
+    free_wide_word(wide, buf);
+
+    return ret;
 }
 
-static FILE * open_dict_file(const char *lang, char *permissions)
+int dictionary_delete_utf8(struct dictionary *dict, const char *word)
 {
-    char path[strlen(CONF_PATH) + strlen(lang) + 1];
+    wchar_t buf[UTF8_STACK_BYTES + 1];
+    wchar_t *wide = decode_utf8_word(word, buf);
+    if (wide == NULL) return 0;
 
-    strcpy(path, CONF_PATH);
-    strcat(path, "/");
-    strcat(path, lang);
+    int ret = dictionary_delete(dict, wide);
+    free_wide_word(wide, buf);
 
-    return fopen(path, permissions);
+    return ret;
 }
 
-/**@}*/
-/** @name Elementy interfejsu
-  @{
-  */
-struct dictionary * dictionary_new()
+bool dictionary_find_utf8(const struct dictionary *dict, const char *word)
 {
-    struct dictionary *dict =
-        (struct dictionary *) malloc(sizeof(struct dictionary));
-    if (!dict)
+    if (dict->epoch != NULL)
     {
-        fprintf(stderr, "Failed to allocate memory for dictionary\n");
-        exit(EXIT_FAILURE);
+        int reader = epoch_enter(dict->epoch);
+        bool ret = trie_has_word_utf8(dict->trie, word);
+        epoch_exit(dict->epoch, reader);
+        return ret;
     }
 
-    dict->trie = trie_new();
-    dict->hints_generator = hints_generator_new();
-    hints_generator_set_root(dict->hints_generator, trie_get_root(dict->trie));
+    // Indeks dokładny i drzewo LOUDS są budowane ze znaków.
+    if (dict->exact_index != NULL || dict->succinct_index != NULL)
+    {
+        wchar_t buf[UTF8_STACK_BYTES + 1];
+        wchar_t *wide = decode_utf8_word(word, buf);
+        if (wide == NULL) return false;
 
-    return dict;
+        bool ret = dictionary_find(dict, wide);
+        free_wide_word(wide, buf);
+
+        return ret;
+    }
+
+    if (bloom_usable(dict) && bloom_rejects_utf8(dict, word)) return false;
+
+    return trie_has_word_utf8(dict->trie, word);
 }
 
-void dictionary_done(struct dictionary *dict)
+int dictionary_save(const struct dictionary *dict, FILE* stream)
 {
-    dictionary_free(dict);
-    free(dict);
+    if (dict->lookup_only) return -1;
+
+    IO *io = io_new(stdin, stream, stderr);
+    int reader = dict->epoch ? epoch_enter(dict->epoch) : 0;
+    int ret;
+
+    if (dict->base != NULL) ret = save_overlay(dict, io);
+    else
+    {
+        ret = alphabet_save(trie_get_alphabet(dict->trie), io);
+        if (ret == 0) ret = trie_save(dict->trie, io);
+        if (ret == 0 && dict->exact_index != NULL)
+            ret = perfect_hash_save(dict->exact_index, io);
+        if (ret == 0) ret = hints_generator_save(dict->hints_generator, io);
+    }
+
+    if (dict->epoch) epoch_exit(dict->epoch, reader);
+    io_done(io);
+
+    return ret;
 }
 
-int dictionary_insert(struct dictionary *dict, const wchar_t *word)
+int dictionary_publish(const struct dictionary *dict, const char *path)
 {
-    return trie_insert_word(dict->trie, word);
+    if (dict->lookup_only) return -1;
+
+    int reader = dict->epoch ? epoch_enter(dict->epoch) : 0;
+
+    int ret = image_publish(trie_get_root(dict->trie), path);
+
+    if (dict->epoch) epoch_exit(dict->epoch, reader);
+
+    return ret;
 }
 
-int dictionary_delete(struct dictionary *dict, const wchar_t *word)
+struct dictionary_save * dictionary_save_async(
+    const struct dictionary *dict, const char *path)
 {
-    return trie_delete_word(dict->trie, word);
+    struct dictionary_save *save = malloc(sizeof(struct dictionary_save));
+    if (!save || !(save->path = malloc(strlen(path) + 1)))
+    {
+        fprintf(stderr, "Failed to allocate memory for dictionary\n");
+        exit(EXIT_FAILURE);
+    }
+    strcpy(save->path, path);
+
+    save->dict = dict;
+    save->hints_generator = NULL;
+    save->image = NULL;
+    save->threaded = false;
+    save->finished = false;
+
+    if (dict->lookup_only)
+    {
+        save->result = -1;
+        save->finished = true;
+        return save;
+    }
+
+    if (dict->epoch != NULL)
+    {
+        // Migawka z chwili wywołania: węzły osiągalne z tego korzenia nie
+        // są zmieniane ani zwalniane, dopóki czytelnik jest aktywny.
+        save->reader = epoch_enter(dict->epoch);
+        save->root = trie_get_root(dict->trie);
+        save->hints_generator = hints_generator_copy(dict->hints_generator);
+
+        if (pthread_create(&save->thread, NULL, save_snapshot_thread,
+                           save) == 0)
+        {
+            save->threaded = true;
+            return save;
+        }
+
+        epoch_exit(dict->epoch, save->reader);
+        save->result = save_file_atomically(path, save_dictionary, dict);
+        save->finished = true;
+
+        return save;
+    }
+
+    // Bez migawek słownik jest od razu zapisywany w pamięci, a w tle
+    // zapisywany jest tylko ten obraz, więc słownik można dalej zmieniać.
+    save->image = save_to_image(dict);
+    if (save->image == NULL)
+    {
+        save->result = -1;
+        save->finished = true;
+    }
+    else if (pthread_create(&save->thread, NULL, save_image_thread,
+                            save) == 0)
+    {
+        save->threaded = true;
+    }
+    else
+    {
+        save->result = save_file_atomically(path, save_image, save);
+        save->finished = true;
+    }
+
+    return save;
 }
 
-bool dictionary_find(const struct dictionary *dict, const wchar_t* word)
+bool dictionary_save_finished(const struct dictionary_save *save)
 {
-    return trie_has_word(dict->trie, word);
+    return __atomic_load_n(&save->finished, __ATOMIC_ACQUIRE);
 }
 
-int dictionary_save(const struct dictionary *dict, FILE* stream)
+int dictionary_save_wait(struct dictionary_save *save)
 {
-    IO *io = io_new(stdin, stream, stderr);
+    if (save->threaded) pthread_join(save->thread, NULL);
 
-    int ret = trie_save(dict->trie, io);
-    if (ret == 0) ret = hints_generator_save(dict->hints_generator, io);
+    int ret = save->result;
 
-    io_done(io);
+    if (save->hints_generator) hints_generator_done(save->hints_generator);
+    free(save->image);
+    free(save->path);
+    free(save);
 
     return ret;
 }
@@ -124,12 +1419,37 @@ struct dictionary * dictionary_load(FILE* stream)
 {
     IO *io = io_new(stream, stdout, stderr);
 
-    Trie *trie = trie_load(io);
+    // Opcjonalny alfabet drzewa.
+    Alphabet *alphabet = NULL;
+    if (io_peek_next(io) == L'@' && (alphabet = alphabet_load(io)) == NULL)
+        return NULL;
+
+    Trie *trie = alphabet ? trie_load_with_alphabet(io, alphabet)
+                          : trie_load(io);
     if (trie == NULL) return NULL;
 
+    // Opcjonalny indeks wyszukiwania dokładnego.
+    Perfect_Hash *exact_index = NULL;
+    if (io_peek_next(io) == L'#')
+    {
+        struct word_list words;
+        word_list_init(&words);
+        trie_to_word_list(trie, &words);
+        exact_index = perfect_hash_load(io, word_list_get(&words),
+                                        word_list_size(&words));
+        word_list_done(&words);
+
+        if (exact_index == NULL)
+        {
+            trie_done(trie);
+            return NULL;
+        }
+    }
+
     Hints_Generator *generator = hints_generator_load(io);
     if (generator == NULL)
     {
+        if (exact_index) perfect_hash_done(exact_index);
         trie_done(trie);
         return NULL;
     }
@@ -143,6 +1463,135 @@ struct dictionary * dictionary_load(FILE* stream)
     dict->trie = trie;
     dict->hints_generator = generator;
     hints_generator_set_root(dict->hints_generator, trie_get_root(dict->trie));
+    if (dict->qgram_index) qgram_index_invalidate(dict->qgram_index);
+    setup_qgram_index(dict);
+    rebuild_bloom(dict);
+    dict->exact_index = exact_index;
+
+    return dict;
+}
+
+struct dictionary * dictionary_load_lookup(FILE* stream)
+{
+    IO *io = io_new(stream, stdout, stderr);
+
+    // Alfabet służy tylko do budowy węzłów drzewa.
+    if (io_peek_next(io) == L'@')
+    {
+        Alphabet *alphabet = alphabet_load(io);
+        if (alphabet == NULL)
+        {
+            io_done(io);
+            return NULL;
+        }
+        alphabet_done(alphabet);
+    }
+
+    size_t length;
+    wchar_t *text = trie_load_text(io, &length);
+    if (text == NULL)
+    {
+        io_done(io);
+        return NULL;
+    }
+
+    struct dictionary *dict = dictionary_new();
+    dict->lookup_only = true;
+    dict->succinct_index = louds_load(text, length);
+
+    // Słowa zapisu są przeglądane bez budowy drzewa słownika.
+    size_t longest = text_longest(text, length), n_words = 0;
+    wchar_t prefix[longest + 1];
+    size_t pos = 0, depth = 0;
+    while (text_next_word(text, length, &pos, prefix, &depth)) n_words++;
+
+    if (dict->bloom != NULL)
+    {
+        bloom_done(dict->bloom);
+        new_bloom(dict, n_words);
+        pos = depth = 0;
+        while (text_next_word(text, length, &pos, prefix, &depth))
+            bloom_add(dict->bloom, prefix);
+    }
+
+    // Opcjonalny indeks wyszukiwania dokładnego.
+    if (io_peek_next(io) == L'#')
+    {
+        struct word_list words;
+        word_list_init(&words);
+        pos = depth = 0;
+        while (text_next_word(text, length, &pos, prefix, &depth))
+            word_list_add(&words, prefix);
+        dict->exact_index = perfect_hash_load(io, word_list_get(&words),
+                                              word_list_size(&words));
+        word_list_done(&words);
+
+        if (dict->exact_index == NULL)
+        {
+            free(text);
+            io_done(io);
+            dictionary_done(dict);
+            return NULL;
+        }
+    }
+    free(text);
+
+    Hints_Generator *generator = hints_generator_load(io);
+    if (generator == NULL)
+    {
+        io_done(io);
+        dictionary_done(dict);
+        return NULL;
+    }
+
+    io_done(io);
+
+    hints_generator_done(dict->hints_generator);
+    dict->hints_generator = generator;
+    hints_generator_set_root(dict->hints_generator, trie_get_root(dict->trie));
+    setup_qgram_index(dict);
+
+    return dict;
+}
+
+struct dictionary * dictionary_load_layered(const struct dictionary *base,
+                                            FILE* stream)
+{
+    IO *io = io_new(stream, stdout, stderr);
+    struct dictionary *dict = dictionary_new_layered(base);
+    wint_t c;
+
+    while ((c = io_get_next(io)) != WEOF)
+    {
+        // Reguły i koszt zajmują resztę nakładki.
+        if (c == L'=')
+        {
+            if (io_get_next(io) != L'\n'
+                || hints_generator_load_rules(dict->hints_generator, io) < 0)
+            {
+                io_done(io);
+                dictionary_done(dict);
+                return NULL;
+            }
+            dict->rules_changed = true;
+            break;
+        }
+
+        wchar_t *word = NULL;
+        if (c == L'+' || c == L'-') word = load_overlay_word(io);
+        if (word == NULL)
+        {
+            io_done(io);
+            dictionary_done(dict);
+            return NULL;
+        }
+
+        if (c == L'+') dictionary_insert(dict, word);
+        else dictionary_delete(dict, word);
+        free(word);
+    }
+
+    io_done(io);
 
     return dict;
 }
@@ -152,9 +1601,46 @@ void dictionary_hints(const struct dictionary *dict, const wchar_t* word,
 {
     word_list_init(list);
 
+    if (dict->epoch != NULL)
+    {
+        int reader = epoch_enter(dict->epoch);
+        hints_generator_hints_from(dict->hints_generator,
+            trie_get_root(dict->trie),
+            dict->reverse_trie ? trie_get_root(dict->reverse_trie) : NULL,
+            word, list);
+        epoch_exit(dict->epoch, reader);
+        return;
+    }
+
+    if (hints_generator_uses_qgram(dict->hints_generator))
+    {
+        // Indeks jest pamięcią podręczną, jego odbudowa nie zmienia słownika.
+        refresh_qgram_index((struct dictionary *) dict);
+    }
+
     hints_generator_hints(dict->hints_generator, word, list);
 }
 
+void dictionary_hints_utf8(const struct dictionary *dict, const char *word,
+                           struct utf8_word_list *list)
+{
+    utf8_word_list_init(list);
+
+    wchar_t buf[UTF8_STACK_BYTES + 1];
+    wchar_t *wide = decode_utf8_word(word, buf);
+    if (wide == NULL) return;
+
+    struct word_list hints;
+    dictionary_hints(dict, wide, &hints);
+    free_wide_word(wide, buf);
+
+    const wchar_t * const *a = word_list_get(&hints);
+    for (size_t i = 0; i < word_list_size(&hints); i++)
+        utf8_word_list_add_wide(list, a[i]);
+
+    word_list_done(&hints);
+}
+
 int dictionary_lang_list(char **list, size_t *list_len)
 {
     *list = NULL;
@@ -169,6 +1655,7 @@ int dictionary_lang_list(char **list, size_t *list_len)
 
     while ((dirent = readdir(dir)) != NULL) {
         if (!file_is_current_or_parent_dir(dirent->d_name)
+            && !file_is_auxiliary(dirent->d_name)
             && argz_add(list, list_len, dirent->d_name) != 0)
         {
             free(*list);
@@ -193,31 +1680,253 @@ struct dictionary * dictionary_load_lang(const char *lang)
 
     fclose(dict_file);
 
-    return dict;
+    if (dict == NULL) return NULL;
+
+    return replay_journal(dict, lang);
 }
 
-int dictionary_save_lang(const struct dictionary *dict, const char *lang)
+struct dictionary * dictionary_load_lang_layered(
+    const struct dictionary *base, const char *lang)
 {
-    mkdir(CONF_PATH, 0700);
+    FILE *overlay_file;
 
-    FILE *dict_file;
+    struct dictionary *dict;
 
-    if (!(dict_file = open_dict_file(lang, "w+"))) return -1;
+    // Użytkownik mógł jeszcze nic nie zmienić.
+    if (!(overlay_file = open_overlay_file(lang, "r")))
+        dict = dictionary_new_layered(base);
+    else
+    {
+        dict = dictionary_load_layered(base, overlay_file);
+        fclose(overlay_file);
+    }
 
-    int ret = dictionary_save(dict, dict_file);
+    if (dict == NULL) return NULL;
 
-    fclose(dict_file);
+    return replay_journal(dict, lang);
+}
 
-    return ret;
+int dictionary_save_lang(struct dictionary *dict, const char *lang)
+{
+    mkdir(CONF_PATH, 0700);
+
+    // Zmiany są już w dzienniku, wystarczy go utrwalić. Długi dziennik
+    // zastępujemy zapisem całego słownika w tle.
+    if (journaling(dict) && strcmp(dict->journal_lang, lang) == 0)
+    {
+        finish_compaction(dict, false);
+
+        if (journal_size(dict->journal) < JOURNAL_COMPACT_RECORDS
+            || dict->compaction != NULL)
+        {
+            if (journal_sync(dict->journal) == 0) return 0;
+        }
+        else if (start_compaction(dict, lang) == 0) return 0;
+    }
+
+    // Nieudany zapis dziennika nadrabiamy zapisaniem całego słownika, ale
+    // nie równolegle z zapisem w tle do tego samego pliku.
+    finish_compaction(dict, true);
+
+    return save_lang_file(dict, lang);
 }
 
 int dictionary_hints_max_cost(struct dictionary *dict, int new_cost)
 {
+    if (journaling(dict)) journal_append(dict->journal, L"c%d", new_cost);
+    dict->rules_changed = true;
+
     return hints_generator_max_cost(dict->hints_generator, new_cost);
 }
 
+int dictionary_hints_qgram_threshold(struct dictionary *dict, int threshold)
+{
+    int old_threshold = dict->qgram_threshold;
+
+    dict->qgram_threshold = threshold;
+    setup_qgram_index(dict);
+
+    return old_threshold;
+}
+
+int dictionary_hints_max_words(struct dictionary *dict, int max_words)
+{
+    return hints_generator_max_words(dict->hints_generator, max_words);
+}
+
+int dictionary_bloom_bits(struct dictionary *dict, int bits)
+{
+    int old_bits = dict->bloom_bits;
+
+    // Filtr byłby budowany z pustego drzewa słownika.
+    if (dict->lookup_only) return old_bits;
+
+    dict->bloom_bits = bits;
+    if (bits != old_bits) rebuild_bloom(dict);
+
+    return old_bits;
+}
+
+bool dictionary_exact_index(struct dictionary *dict, bool enabled)
+{
+    bool was_enabled = (dict->exact_index != NULL);
+
+    // Słownik wczytany tylko do sprawdzania nie ma innego drzewa.
+    if (dict->lookup_only) return was_enabled;
+    // Indeks nie jest zmieniany razem z migawkami.
+    if (enabled && !was_enabled && dict->epoch == NULL)
+    {
+        struct word_list words;
+        word_list_init(&words);
+        trie_to_word_list(dict->trie, &words);
+        dict->exact_index = perfect_hash_build(word_list_get(&words),
+                                               word_list_size(&words));
+        word_list_done(&words);
+    }
+    else if (!enabled) drop_exact_index(dict);
+
+    return was_enabled;
+}
+
+bool dictionary_succinct_index(struct dictionary *dict, bool enabled)
+{
+    bool was_enabled = (dict->succinct_index != NULL);
+
+    // Słownik wczytany tylko do sprawdzania nie ma innego drzewa.
+    if (dict->lookup_only) return was_enabled;
+    // Drzewo nie jest zmieniane razem z migawkami.
+    if (enabled && !was_enabled && dict->epoch == NULL)
+        dict->succinct_index = louds_build(trie_get_root(dict->trie));
+    else if (!enabled) drop_succinct_index(dict);
+
+    return was_enabled;
+}
+
+bool dictionary_compiled_rules(struct dictionary *dict, bool enabled)
+{
+    return hints_generator_compiled_rules(dict->hints_generator, enabled);
+}
+
+const struct hints_generator * dictionary_get_hints_generator(
+    const struct dictionary *dict)
+{
+    return dict->hints_generator;
+}
+
+void dictionary_stats(const struct dictionary *dict,
+                      struct dictionary_stats *stats)
+{
+    stats->bloom_memory = 0;
+    stats->bloom_words = 0;
+    stats->bloom_false_positive_rate = 0.0;
+    stats->exact_index_memory = 0;
+    stats->succinct_index_memory = 0;
+    stats->succinct_index_nodes = 0;
+
+    if (dict->exact_index != NULL)
+        stats->exact_index_memory = perfect_hash_memory(dict->exact_index);
+
+    if (dict->succinct_index != NULL)
+    {
+        stats->succinct_index_memory = louds_memory(dict->succinct_index);
+        stats->succinct_index_nodes = louds_node_count(dict->succinct_index);
+    }
+
+    if (dict->bloom != NULL)
+    {
+        stats->bloom_memory = bloom_memory(dict->bloom);
+        stats->bloom_words = bloom_size(dict->bloom);
+        stats->bloom_false_positive_rate =
+            bloom_false_positive_rate(dict->bloom);
+    }
+}
+
+bool dictionary_compact(struct dictionary *dict)
+{
+    // Migawki i nakładki współdzielą węzły drzewa.
+    if (dict->epoch != NULL || dict->base != NULL || dict->lookup_only)
+        return false;
+
+    trie_compact(dict->trie);
+    if (dict->reverse_trie) trie_compact(dict->reverse_trie);
+
+    hints_generator_set_root(dict->hints_generator, trie_get_root(dict->trie));
+    hints_generator_set_reverse_root(dict->hints_generator,
+        dict->reverse_trie ? trie_get_root(dict->reverse_trie) : NULL);
+
+    return true;
+}
+
+bool dictionary_reverse_index(struct dictionary *dict, bool enabled)
+{
+    bool was_enabled = (dict->reverse_trie != NULL);
+
+    if (enabled && !was_enabled)
+    {
+        build_reverse_trie(dict);
+    }
+    else if (!enabled && was_enabled)
+    {
+        trie_done(dict->reverse_trie);
+        dict->reverse_trie = NULL;
+    }
+
+    hints_generator_set_reverse_root(dict->hints_generator,
+        dict->reverse_trie ? trie_get_root(dict->reverse_trie) : NULL);
+
+    return was_enabled;
+}
+
+bool dictionary_snapshots(struct dictionary *dict, bool enabled)
+{
+    bool was_enabled = (dict->epoch != NULL);
+
+    // Kopiowanie ścieżek zwalniałoby węzły słownika bazowego.
+    if (dict->base != NULL || dict->lookup_only) return false;
+
+    if (enabled && !was_enabled)
+    {
+        dict->epoch = epoch_new();
+        drop_exact_index(dict);
+        drop_succinct_index(dict);
+        rebuild_bloom(dict);
+        setup_qgram_index(dict);
+    }
+    else if (!enabled && was_enabled)
+    {
+        // Zapis w tle może czytać migawkę.
+        finish_compaction(dict, true);
+        epoch_done(dict->epoch);
+        dict->epoch = NULL;
+        rebuild_bloom(dict);
+        setup_qgram_index(dict);
+
+        // Korzenie zmieniły się od włączenia migawek.
+        hints_generator_set_root(dict->hints_generator,
+                                 trie_get_root(dict->trie));
+        hints_generator_set_reverse_root(dict->hints_generator,
+            dict->reverse_trie ? trie_get_root(dict->reverse_trie) : NULL);
+    }
+
+    return was_enabled;
+}
+
+bool dictionary_journal(struct dictionary *dict, bool enabled)
+{
+    bool was_enabled = dict->journal_enabled;
+
+    // Bez dziennika słownik nie wie, do którego języka należy.
+    dict->journal_enabled = enabled && dict->journal != NULL;
+    if (was_enabled && !enabled) journal_sync(dict->journal);
+
+    return was_enabled;
+}
+
 void dictionary_rule_clear(struct dictionary *dict)
 {
+    if (journaling(dict)) journal_append(dict->journal, L"!");
+    dict->rules_changed = true;
+
     hints_generator_rule_clear(dict->hints_generator);
 }
 
@@ -250,7 +1959,16 @@ int dictionary_rule_add(struct dictionary *dict,
     if (!rule_is_legal(rule))
     {
         rule_done(rule);
+        return 0;
+    }
+
+    // Do dziennika trafiają tylko reguły przyjęte do słownika.
+    if (journaling(dict))
+    {
+        journal_append(dict->journal, L"r%ls*%ls*%d*%d", left, right, cost,
+                       flag);
     }
+    dict->rules_changed = true;
 
     hints_generator_rule_add(dict->hints_generator, rule);
 
@@ -68,6 +68,55 @@ int dictionary_delete(struct dictionary *dict, const wchar_t* word);
 bool dictionary_find(const struct dictionary *dict, const wchar_t* word);
 
 
+/**
+  Sprawdza, czy dane słowa znajdują się w słowniku.
+  Wynik jest taki sam jak przy wywołaniu dictionary_find() dla każdego
+  słowa, ale słowa są szukane jednocześnie, więc dla paczek od kilkudziesięciu
+  słów wzwyż oczekiwanie na pamięć dla różnych słów się nakłada.
+  @param[in] dict Słownik.
+  @param[in] words Szukane słowa.
+  @param[in] n Liczba słów.
+  @param[out] results Tablica `n` wartości logicznych: czy słowo o danym
+  indeksie jest w słowniku.
+  */
+void dictionary_find_batch(const struct dictionary *dict,
+                           const wchar_t * const *words, size_t n,
+                           bool *results);
+
+
+/**
+  Wstawia do słownika słowo zakodowane w UTF-8.
+  @param[in,out] dict Słownik.
+  @param[in] word Słowo, które należy wstawić do słownika.
+  @return 0 jeśli słowo było już w słowniku lub jest błędnie zakodowane,
+  1 jeśli udało się wstawić.
+  */
+int dictionary_insert_utf8(struct dictionary *dict, const char *word);
+
+
+/**
+  Usuwa ze słownika słowo zakodowane w UTF-8, jeśli istnieje.
+  @param[in,out] dict Słownik.
+  @param[in] word Słowo, które należy usunąć ze słownika.
+  @return 1 jeśli udało się usunąć, zero jeśli nie.
+  */
+int dictionary_delete_utf8(struct dictionary *dict, const char *word);
+
+
+/**
+  Sprawdza, czy dane słowo zakodowane w UTF-8 znajduje się w słowniku.
+  Wynik jest taki sam jak dla dictionary_find() i zdekodowanego słowa.
+  Filtr Blooma i drzewo czytają bajty słowa bezpośrednio, a dla indeksów
+  działających na znakach słowo jest dekodowane do bufora na stosie, więc
+  sprawdzenie nie przydziela pamięci.
+  @param[in] dict Słownik.
+  @param[in] word Szukane słowo.
+  @return Wartość logiczna czy `word` jest w słowniku (false dla słowa
+  błędnie zakodowanego).
+  */
+bool dictionary_find_utf8(const struct dictionary *dict, const char *word);
+
+
 /**
   Zapisuje słownik.
   @param[in] dict Słownik.
@@ -77,6 +126,58 @@ bool dictionary_find(const struct dictionary *dict, const wchar_t* word);
 int dictionary_save(const struct dictionary *dict, FILE* stream);
 
 
+/**
+  Publikuje słownik jako obraz współdzielony między procesami.
+  Obraz można dołączyć za pomocą image_attach() (zob. image.h) i sprawdzać
+  w nim słowa bez wczytywania słownika.
+  @param[in] dict Słownik.
+  @param[in] path Ścieżka pliku obrazu.
+  @return <0 jeśli operacja się nie powiedzie, 0 w p.p.
+  */
+int dictionary_publish(const struct dictionary *dict, const char *path);
+
+
+/**
+  Stan zapisu słownika w tle.
+  */
+struct dictionary_save;
+
+
+/**
+  Rozpoczyna zapis słownika do pliku w formacie dictionary_save().
+  Zapisywany jest stan słownika z chwili wywołania, w osobnym wątku,
+  a słownik można w tym czasie czytać i zmieniać. Gdy słownik używa
+  migawek (dictionary_snapshots()), zapisywana jest migawka. W p.p.
+  słownik jest od razu zapisywany w pamięci, a w tle ten obraz trafia do
+  pliku. Słownik jest zapisywany do pliku tymczasowego, który po udanym
+  zapisie zastępuje plik, więc plik zawsze zawiera cały słownik.
+  Przed dictionary_save_wait() nie można zniszczyć słownika ani wyłączyć
+  w nim migawek.
+  @param[in] dict Słownik.
+  @param[in] path Ścieżka pliku.
+  @return Stan zapisu, który należy zwolnić za pomocą
+          dictionary_save_wait().
+  */
+struct dictionary_save * dictionary_save_async(
+    const struct dictionary *dict, const char *path);
+
+
+/**
+  Sprawdza bez czekania, czy zapis w tle się zakończył.
+  @param[in] save Stan zapisu.
+  @return Czy zapis się zakończył.
+  */
+bool dictionary_save_finished(const struct dictionary_save *save);
+
+
+/**
+  Czeka na zakończenie zapisu w tle i zwalnia jego stan.
+  @param[in,out] save Stan zapisu.
+  @return <0 jeśli zapis się nie powiódł, 0 w p.p.
+  */
+int dictionary_save_wait(struct dictionary_save *save);
+
+
 /**
   Inicjuje i wczytuje słownik.
   Słownik ten należy zniszczyć za pomocą dictionary_done().
@@ -86,11 +187,62 @@ int dictionary_save(const struct dictionary *dict, FILE* stream);
 struct dictionary * dictionary_load(FILE* stream);
 
 
+/**
+  Inicjuje i wczytuje słownik tylko do sprawdzania słów.
+  Zwięzłe drzewo (zob. dictionary_succinct_index()) i filtr Blooma są
+  budowane wprost z zapisu drzewa, bez budowy węzłów drzewa słownika, więc
+  słownik zajmuje znacznie mniej pamięci niż wczytany przez
+  dictionary_load(). Słownika nie można zmieniać ani zapisywać:
+  dictionary_insert() i dictionary_delete() zwracają 0, funkcje zapisu
+  zgłaszają błąd, a dictionary_hints() nie zwraca podpowiedzi.
+  Słownik ten należy zniszczyć za pomocą dictionary_done().
+  @param[in,out] stream Strumień, skąd ma być wczytany słownik.
+  @return Wczytany słownik lub NULL, jeśli operacja się nie powiedzie.
+  */
+struct dictionary * dictionary_load_lookup(FILE* stream);
+
+
+/**
+  Inicjalizacja słownika warstwowego: pustej nakładki na słownik bazowy.
+  Słownik warstwowy zawiera słowa słownika bazowego oraz słowa do niego
+  wstawione, bez słów z niego usuniętych. Współdzieli drzewo ze słownikiem
+  bazowym i przechowuje tylko kopie węzłów na ścieżkach zmienionych słów,
+  więc wiele słowników warstwowych (np. słowniki użytkowników) może
+  korzystać z jednego dużego słownika bazowego. dictionary_find()
+  i dictionary_hints() przeszukują jedno drzewo złożone z obu warstw.
+  Reguły i parametry podpowiedzi są kopiowane ze słownika bazowego.
+  dictionary_save() i dictionary_save_lang() zapisują tylko nakładkę:
+  słowa wstawione i słowa usunięte ze słownika bazowego oraz reguły
+  i maksymalny koszt podpowiedzi, jeśli je zmieniono.
+  Słownik bazowy nie może być zmieniany ani zniszczony przed słownikiem
+  warstwowym. Słownik warstwowy nie może używać migawek
+  (dictionary_snapshots()).
+  Słownik ten należy zniszczyć za pomocą dictionary_done().
+  @param[in] base Słownik bazowy.
+  @return Nowy słownik.
+  */
+struct dictionary * dictionary_new_layered(const struct dictionary *base);
+
+
+/**
+  Inicjuje słownik warstwowy i wczytuje jego nakładkę zapisaną przez
+  dictionary_save().
+  Słownik ten należy zniszczyć za pomocą dictionary_done().
+  @param[in] base Słownik bazowy, patrz dictionary_new_layered().
+  @param[in,out] stream Strumień, skąd ma być wczytana nakładka.
+  @return Wczytany słownik lub NULL, jeśli operacja się nie powiedzie.
+  */
+struct dictionary * dictionary_load_layered(const struct dictionary *base,
+                                            FILE* stream);
+
+
 /**
   Tworzy możliwe podpowiedzi dla zadanego słowa.
   Jeżeli pojedyncza podpowiedź składa się z kilku słów,
   wtedy powinien być to jeden łańcuch znaków,
   w którym słowa są pooddzielane pojedynczymi spacjami.
+  Funkcję, podobnie jak dictionary_find(), można wywoływać jednocześnie
+  z wielu wątków, o ile w tym czasie słownik nie jest modyfikowany.
   @param[in] dict Słownik.
   @param[in] word Szukane słowo.
   @param[in,out] list Lista, w której zostaną umieszczone podpowiedzi.
@@ -99,6 +251,19 @@ void dictionary_hints(const struct dictionary *dict, const wchar_t* word,
                       struct word_list *list);
 
 
+/**
+  Tworzy możliwe podpowiedzi dla zadanego słowa zakodowanego w UTF-8.
+  Podpowiedzi są takie same jak dla dictionary_hints(), ale lista pamięta
+  je w UTF-8.
+  @param[in] dict Słownik.
+  @param[in] word Szukane słowo.
+  @param[in,out] list Lista, w której zostaną umieszczone podpowiedzi
+  (pusta dla słowa błędnie zakodowanego).
+  */
+void dictionary_hints_utf8(const struct dictionary *dict, const char *word,
+                           struct utf8_word_list *list);
+
+
 /**
   Zwraca nazwy języków, dla których dostępne są słowniki.
   Powinny to być nazwy lokali bez kodowania. np.
@@ -121,6 +286,8 @@ int dictionary_lang_list(char **list, size_t *list_len);
 
 /**
   Inicjuje i wczytuje słownik dla zadanego języka.
+  Po wczytaniu pliku słownika odtwarzane są zmiany z dziennika języka,
+  patrz dictionary_journal().
   Słownik ten należy zniszczyć za pomocą dictionary_done().
   @param[in] lang Nazwa języka, patrz dictionary_lang_list().
   @return Słownik dla danego języka lub NULL, jeśli operacja się nie powiedzie.
@@ -128,13 +295,34 @@ int dictionary_lang_list(char **list, size_t *list_len);
 struct dictionary * dictionary_load_lang(const char *lang);
 
 
+/**
+  Inicjuje słownik warstwowy dla zadanego języka i wczytuje jego nakładkę
+  zapisaną przez dictionary_save_lang(). Jeśli nakładki nie zapisano,
+  słownik zawiera tylko słowa słownika bazowego. Zmiany z dziennika
+  nakładki są odtwarzane jak w dictionary_load_lang().
+  Słownik ten należy zniszczyć za pomocą dictionary_done().
+  @param[in] base Słownik bazowy, patrz dictionary_new_layered().
+  @param[in] lang Nazwa języka, patrz dictionary_lang_list().
+  @return Słownik dla danego języka lub NULL, jeśli operacja się nie powiedzie.
+  */
+struct dictionary * dictionary_load_lang_layered(
+    const struct dictionary *base, const char *lang);
+
+
 /**
   Zapisuje słownik jak słownik dla ustalonego języka.
-  @param[in] dict Słownik.
+  Słownik warstwowy zapisuje tylko nakładkę, w osobnym pliku, więc plik
+  słownika dla języka się nie zmienia. Słownik jest zapisywany do pliku
+  tymczasowego, który zastępuje plik słownika, a dziennik języka jest
+  usuwany. Jeśli słownik dopisuje zmiany do dziennika tego języka, tylko
+  utrwala dziennik. Gdy dziennik urośnie, cały słownik jest zapisywany
+  w tle (dictionary_save_async()), a po udanym zapisie kolejne wywołanie
+  lub dictionary_done() usuwa z dziennika zapisane już rekordy.
+  @param[in,out] dict Słownik.
   @param[in] lang Nazwa języka, patrz dictionary_lang_list().
   @return <0 jeśli operacja się nie powiedzie, 0 w p.p.
   */
-int dictionary_save_lang(const struct dictionary *dict, const char *lang);
+int dictionary_save_lang(struct dictionary *dict, const char *lang);
 
 
 /**
@@ -146,6 +334,203 @@ int dictionary_save_lang(const struct dictionary *dict, const char *lang);
 int dictionary_hints_max_cost(struct dictionary *dict, int new_cost);
 
 
+/**
+  Ustawia maksymalną liczbę słów w podpowiedzi.
+  Każde kolejne słowo powstaje przez zastosowanie reguły z flagą `s`, więc
+  podpowiedzi dla tekstu z brakującymi spacjami mogą mieć wiele słów.
+  Domyślna wartość to DICTIONARY_MAX_HINT_WORDS.
+  @param[in,out] dict Słownik.
+  @param[in] max_words Nowa maksymalna liczba słów (co najmniej 1).
+  @return Zwraca dotychczasową maksymalną liczbę słów.
+  */
+int dictionary_hints_max_words(struct dictionary *dict, int max_words);
+
+/**
+  Ustawia próg kosztu, powyżej którego podpowiedzi są generowane z użyciem
+  indeksu q-gramów.
+  Gdy maksymalny koszt przekracza próg, kandydaci na podpowiedzi są
+  wybierani z indeksu q-gramów słów słownika, a dopiero potem sprawdzani
+  regułami. Podpowiedzi są takie same jak bez indeksu. Jeśli reguły
+  z flagą `s` mogą tworzyć podpowiedzi wielowyrazowe, indeks nie jest
+  używany, bo słowa takich podpowiedzi odpowiadają tylko fragmentom
+  słowa. Wartość 0 wyłącza indeks. Domyślny próg to
+  DICTIONARY_QGRAM_THRESHOLD.
+  @param[in,out] dict Słownik.
+  @param[in] threshold Nowy próg.
+  @return Zwraca dotychczasowy próg.
+  */
+int dictionary_hints_qgram_threshold(struct dictionary *dict, int threshold);
+
+
+/**
+  Ustawia liczbę bitów filtru Blooma na słowo.
+  Filtr jest sprawdzany przed przeszukaniem drzewa, więc większość słów
+  spoza słownika jest odrzucana po odczycie jednej linii pamięci. Pełny
+  filtr o 10 bitach na słowo przepuszcza około 1% takich słów. Filtr jest
+  aktualizowany razem ze słownikiem i odbudowywany przy wczytaniu
+  słownika, po zapełnieniu się oraz po usunięciu wielu słów.
+  @param[in,out] dict Słownik.
+  @param[in] bits Liczba bitów na słowo; 0 wyłącza filtr.
+  @return Poprzednia liczba bitów na słowo.
+  */
+int dictionary_bloom_bits(struct dictionary *dict, int bits);
+
+
+/**
+  Włącza lub wyłącza indeks wyszukiwania dokładnego.
+  Indeks jest minimalną funkcją haszującą doskonałą nad wszystkimi słowami
+  słownika, więc dictionary_find() liczy skrót słowa raz i odczytuje
+  z pamięci dwa lub trzy miejsca zamiast przechodzić drzewo. Indeks jest
+  przeznaczony dla słowników tylko do odczytu: wstawienie lub usunięcie
+  słowa go wyłącza. Włączony indeks jest zapisywany przez
+  dictionary_save() i wczytywany przez dictionary_load() bez ponownej
+  budowy. Podpowiedzi są wyznaczane jak dotąd na podstawie drzewa.
+  @param[in,out] dict Słownik.
+  @param[in] enabled Czy indeks ma być używany.
+  @return Czy indeks był dotychczas używany.
+  */
+bool dictionary_exact_index(struct dictionary *dict, bool enabled);
+
+
+/**
+  Włącza lub wyłącza zwięzłe drzewo słownika (LOUDS, zob. louds.h).
+  Drzewo ma te same węzły co drzewo słownika, ale zajmuje mniej niż
+  2 bajty na węzeł, i jest przeznaczone dla dużych słowników tylko do
+  odczytu: dictionary_find() przechodzi je zamiast drzewa słownika,
+  a wstawienie lub usunięcie słowa je wyłącza. Nie jest zapisywane przez
+  dictionary_save(). Podpowiedzi są wyznaczane jak dotąd na podstawie
+  drzewa słownika. Zwięzłe drzewo jest budowane obok drzewa słownika, więc
+  zwiększa zajmowaną pamięć; słownik bez drzewa słownika wczytuje
+  dictionary_load_lookup().
+  @param[in,out] dict Słownik.
+  @param[in] enabled Czy zwięzłe drzewo ma być używane.
+  @return Czy zwięzłe drzewo było dotychczas używane.
+  */
+bool dictionary_succinct_index(struct dictionary *dict, bool enabled);
+
+
+/**
+  Statystyki słownika.
+  */
+struct dictionary_stats
+{
+    /// Pamięć zajmowana przez filtr Blooma w bajtach (0 bez filtru).
+    size_t bloom_memory;
+    /// Liczba słów w filtrze, razem z usuniętymi od jego odbudowy.
+    size_t bloom_words;
+    /// Szacowany odsetek słów spoza słownika przepuszczanych przez filtr.
+    double bloom_false_positive_rate;
+    /// Pamięć zajmowana przez indeks wyszukiwania dokładnego w bajtach.
+    size_t exact_index_memory;
+    /// Pamięć zajmowana przez zwięzłe drzewo w bajtach.
+    size_t succinct_index_memory;
+    /// Liczba węzłów zwięzłego drzewa (0, jeśli nie jest używane).
+    size_t succinct_index_nodes;
+};
+
+
+/**
+  Zagęszcza drzewo słownika: układa jego węzły na nowo w jednym bloku
+  pamięci, w kolejności przyjaznej dla pamięci podręcznej, i zwalnia
+  węzły rozrzucone po stercie przez wstawianie i usuwanie słów (zob.
+  trie_compact()). Przyspiesza dictionary_find() i dictionary_hints()
+  w słownikach, które były długo zmieniane. dictionary_load() tworzy
+  od razu zagęszczone drzewo. Słowa słownika się nie zmieniają.
+  @param[in,out] dict Słownik.
+  @return false, jeśli słownik ma włączone migawki lub jest warstwowy
+  i nie został zagęszczony, true w p.p.
+  */
+bool dictionary_compact(struct dictionary *dict);
+
+
+/**
+  Wyznacza statystyki słownika.
+  @param[in] dict Słownik.
+  @param[out] stats Statystyki.
+  */
+void dictionary_stats(const struct dictionary *dict,
+                      struct dictionary_stats *stats);
+
+
+/**
+  Włącza lub wyłącza wykonywanie reguł podpowiedzi przez kod wygenerowany
+  przez rule-compiler (zob. hints_generator_compiled_rules()). Podpowiedzi
+  są takie same, zmienia się tylko czas ich generowania.
+  @param[in,out] dict Słownik.
+  @param[in] enabled Czy kod reguł ma być używany.
+  @return Czy reguły były dotychczas wykonywane przez wygenerowany kod.
+  */
+bool dictionary_compiled_rules(struct dictionary *dict, bool enabled);
+
+
+/**
+  Struktura przechowująca generator podpowiedzi (zob. hints_generator.h).
+  */
+struct hints_generator;
+
+
+/**
+  Zwraca generator podpowiedzi słownika razem z jego regułami, np. dla
+  generatora kodu reguł. Generator należy do słownika.
+  @param[in] dict Słownik.
+  @return Generator podpowiedzi.
+  */
+const struct hints_generator * dictionary_get_hints_generator(
+    const struct dictionary *dict);
+
+
+/**
+  Włącza lub wyłącza drzewo odwróconych słów.
+  Drzewo jest aktualizowane razem ze słownikiem. Gdy jest włączone, dla
+  każdego słowa podpowiedzi są szukane od tego końca słowa, od którego
+  dłuższa jego część występuje w słowniku bez zmian. Przyspiesza to
+  szukanie podpowiedzi dla słów z błędem na początku, kosztem pamięci.
+  Podpowiedzi nie zmieniają się.
+  @param[in,out] dict Słownik.
+  @param[in] enabled Czy drzewo ma być używane.
+  @return Czy drzewo było dotychczas używane.
+  */
+bool dictionary_reverse_index(struct dictionary *dict, bool enabled);
+
+
+/**
+  Włącza lub wyłącza migawki drzewa dla czytelników bez blokad.
+  Gdy migawki są włączone, dictionary_insert() i dictionary_delete()
+  kopiują zmieniane węzły i atomowo publikują nowy korzeń, a
+  dictionary_find(), dictionary_find_batch(), dictionary_hints(),
+  dictionary_save() i dictionary_publish() działają na spójnej migawce bez
+  blokad, więc można je wywoływać z wielu wątków jednocześnie ze zmianami.
+  Zmiany są wzajemnie wykluczane przez słownik. Zastąpione węzły są
+  zwalniane, gdy żaden czytelnik nie może ich już widzieć.
+  Filtr Blooma, indeks wyszukiwania dokładnego i indeks q-gramów nie są
+  wtedy używane; po wyłączeniu migawek są odbudowywane. Włączanie
+  i wyłączanie migawek oraz pozostałe ustawienia słownika nie mogą być
+  wykonywane równolegle z innymi operacjami.
+  @param[in,out] dict Słownik.
+  @param[in] enabled Czy migawki mają być używane.
+  @return Czy migawki były dotychczas używane.
+  */
+bool dictionary_snapshots(struct dictionary *dict, bool enabled);
+
+
+/**
+  Włącza lub wyłącza dopisywanie zmian do dziennika języka, z którego
+  wczytano słownik (dictionary_load_lang()
+  lub dictionary_load_lang_layered()).
+  Gdy dziennik jest włączony, wstawienie i usunięcie słowa oraz zmiany
+  reguł i maksymalnego kosztu podpowiedzi są dopisywane do pliku obok
+  pliku słownika, a na dysk utrwalane paczkami. dictionary_save_lang() dla
+  tego języka tylko utrwala wtedy dziennik, zamiast zapisywać cały
+  słownik. Zmiany z dziennika są odtwarzane przy wczytywaniu słownika,
+  więc trafiają do niego także bez wywołania dictionary_save_lang().
+  Słownika, którego nie wczytano dla języka, nie da się przełączyć.
+  @param[in,out] dict Słownik.
+  @param[in] enabled Czy zmiany mają być dopisywane do dziennika.
+  @return Czy zmiany były dotychczas dopisywane do dziennika.
+  */
+bool dictionary_journal(struct dictionary *dict, bool enabled);
+
+
 /**
   Usuwa wszystkie reguły ze słownika
   @param[in,out] dict Słownik.
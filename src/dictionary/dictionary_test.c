@@ -122,6 +122,252 @@ static void dictionary_delete_test(void** state)
     dictionary_teardown(state);
 }
 
+/**
+  Sprawdza, czy podpowiedzi z drzewem odwróconych słów i bez niego są
+  takie same.
+  @param[in,out] dict Słownik.
+  @param[in] word Słowo.
+  */
+static void assert_same_hints(struct dictionary *dict, const wchar_t *word)
+{
+    struct word_list forward, reversed;
+
+    dictionary_reverse_index(dict, false);
+    dictionary_hints(dict, word, &forward);
+    dictionary_reverse_index(dict, true);
+    dictionary_hints(dict, word, &reversed);
+
+    assert_int_equal(word_list_size(&forward), word_list_size(&reversed));
+    for (size_t i = 0; i < word_list_size(&forward); i++)
+    {
+        assert_true(wcscmp(word_list_get(&forward)[i],
+                           word_list_get(&reversed)[i]) == 0);
+    }
+
+    word_list_done(&reversed);
+    word_list_done(&forward);
+}
+
+/**
+  Testuje podpowiedzi z użyciem drzewa odwróconych słów.
+  @param state Środowisko testowe.
+  */
+static void dictionary_reverse_index_test(void** state)
+{
+    dictionary_setup(state);
+
+    struct dictionary *dict = *state;
+
+    dictionary_hints_max_cost(dict, 3);
+    dictionary_rule_add(dict, L"1", L"2", false, 1, RULE_NORMAL);
+    dictionary_rule_add(dict, L"1", L"", false, 1, RULE_NORMAL);
+    dictionary_rule_add(dict, L"", L"1", false, 1, RULE_NORMAL);
+    dictionary_rule_add(dict, L"x", L"f", false, 1, RULE_BEGIN);
+    dictionary_rule_add(dict, L"y", L"n", false, 1, RULE_END);
+    dictionary_rule_add(dict, L"", L"", false, 1, RULE_SPLIT);
+
+    assert_false(dictionary_reverse_index(dict, true));
+    assert_true(dictionary_reverse_index(dict, true));
+
+    assert_same_hints(dict, L"felim");
+    assert_same_hints(dict, L"xelin");
+    assert_same_hints(dict, L"feliy");
+    assert_same_hints(dict, L"fenfin");
+    assert_same_hints(dict, L"tei");
+
+    dictionary_insert(dict, L"felik");
+    dictionary_delete(dict, L"felin");
+    assert_same_hints(dict, L"felim");
+
+    dictionary_teardown(state);
+}
+
+/**
+  Sprawdza, czy lista słów zawiera słowo.
+  @param[in] list Lista słów.
+  @param[in] word Słowo.
+  @return Czy słowo jest na liście.
+  */
+static bool list_has(const struct word_list *list, const wchar_t *word)
+{
+    for (size_t i = 0; i < word_list_size(list); i++)
+    {
+        if (wcscmp(word_list_get(list)[i], word) == 0) return true;
+    }
+
+    return false;
+}
+
+/**
+  Sprawdza, czy podpowiedzi z indeksem q-gramów i bez niego są takie same.
+  @param[in,out] dict Słownik.
+  @param[in] word Słowo.
+  */
+static void assert_qgram_hints(struct dictionary *dict, const wchar_t *word)
+{
+    struct word_list trie, qgram;
+
+    dictionary_hints_qgram_threshold(dict, 0);
+    dictionary_hints(dict, word, &trie);
+    dictionary_hints_qgram_threshold(dict, 1);
+    dictionary_hints(dict, word, &qgram);
+
+    assert_int_equal(word_list_size(&trie), word_list_size(&qgram));
+    for (size_t i = 0; i < word_list_size(&trie); i++)
+    {
+        assert_true(wcscmp(word_list_get(&trie)[i],
+                           word_list_get(&qgram)[i]) == 0);
+    }
+
+    word_list_done(&qgram);
+    word_list_done(&trie);
+}
+
+/**
+  Testuje podpowiedzi z indeksem q-gramów.
+  @param state Środowisko testowe.
+  */
+static void dictionary_qgram_test(void** state)
+{
+    dictionary_setup(state);
+
+    struct dictionary *dict = *state;
+
+    dictionary_hints_max_cost(dict, 2);
+    dictionary_rule_add(dict, L"1", L"2", false, 1, RULE_NORMAL);
+    dictionary_rule_add(dict, L"1", L"", false, 1, RULE_NORMAL);
+    dictionary_rule_add(dict, L"", L"1", false, 1, RULE_NORMAL);
+    dictionary_rule_add(dict, L"y", L"n", false, 1, RULE_END);
+
+    assert_qgram_hints(dict, L"felim");
+    assert_qgram_hints(dict, L"feliy");
+    assert_qgram_hints(dict, L"fenfin");
+    assert_qgram_hints(dict, L"tei");
+
+    struct word_list list;
+    dictionary_insert(dict, L"felik");
+    dictionary_hints(dict, L"felim", &list);
+    assert_true(list_has(&list, L"felik"));
+    word_list_done(&list);
+    assert_qgram_hints(dict, L"felim");
+
+    // Słowa podpowiedzi wielowyrazowych nie są podobne do całego słowa.
+    dictionary_insert(dict, L"ala");
+    dictionary_insert(dict, L"alarm");
+    dictionary_insert(dict, L"makota");
+    dictionary_insert(dict, L"kota");
+    dictionary_hints_max_cost(dict, 3);
+    dictionary_rule_add(dict, L"", L"", false, 1, RULE_SPLIT);
+    dictionary_hints_qgram_threshold(dict, 1);
+    dictionary_hints(dict, L"alamakota", &list);
+    assert_true(list_has(&list, L"ala makota"));
+    assert_true(list_has(&list, L"alarm kota"));
+    word_list_done(&list);
+    assert_qgram_hints(dict, L"alamakota");
+
+    dictionary_teardown(state);
+}
+
+/**
+  Testuje wyszukiwanie słów z filtrem Blooma przy zmianach słownika.
+  @param state Środowisko testowe.
+  */
+static void dictionary_bloom_test(void** state)
+{
+    struct dictionary *dict = dictionary_new();
+    struct dictionary_stats stats;
+    wchar_t word[16];
+
+    dictionary_bloom_bits(dict, 0);
+    dictionary_stats(dict, &stats);
+    assert_int_equal(stats.bloom_memory, 0);
+
+    // Słowa wstawione ponad pojemność filtru wymuszają jego odbudowę.
+    assert_int_equal(dictionary_bloom_bits(dict, 8), 0);
+    for (int i = 0; i < 3000; i++)
+    {
+        swprintf(word, 16, L"słowo%d", i);
+        dictionary_insert(dict, word);
+    }
+
+    dictionary_stats(dict, &stats);
+    assert_true(stats.bloom_memory > 0);
+    assert_int_equal(stats.bloom_words, 3000);
+    assert_true(stats.bloom_false_positive_rate < 0.1);
+
+    // Usunięcie ćwierci słów wymusza odbudowę filtru.
+    for (int i = 0; i < 1000; i++)
+    {
+        swprintf(word, 16, L"słowo%d", i);
+        dictionary_delete(dict, word);
+    }
+
+    dictionary_stats(dict, &stats);
+    assert_true(stats.bloom_words < 3000);
+
+    for (int i = 0; i < 3000; i++)
+    {
+        swprintf(word, 16, L"słowo%d", i);
+        assert_int_equal(dictionary_find(dict, word), i >= 1000);
+    }
+
+    const wchar_t *words[] = {L"słowo0", L"słowo1000", L"słowo", L"słowo2999"};
+    bool results[4];
+    dictionary_find_batch(dict, words, 4, results);
+    assert_false(results[0]);
+    assert_true(results[1]);
+    assert_false(results[2]);
+    assert_true(results[3]);
+
+    assert_int_equal(dictionary_bloom_bits(dict, 0), 8);
+    assert_true(dictionary_find(dict, L"słowo1000"));
+    assert_false(dictionary_find(dict, L"słowo0"));
+
+    dictionary_done(dict);
+}
+
+/**
+  Testuje podpowiedzi złożone z wielu słów.
+  @param state Środowisko testowe.
+  */
+static void dictionary_hints_max_words_test(void** state)
+{
+    struct dictionary *dict = dictionary_new();
+    struct word_list list;
+
+    dictionary_insert(dict, L"kot");
+    dictionary_insert(dict, L"pies");
+    dictionary_insert(dict, L"piesek");
+    dictionary_insert(dict, L"dom");
+    dictionary_hints_max_cost(dict, 3);
+    dictionary_rule_add(dict, L"", L"", false, 1, RULE_SPLIT);
+    dictionary_rule_add(dict, L"1", L"", false, 1, RULE_NORMAL);
+
+    assert_int_equal(dictionary_hints_max_words(dict, 3), 2);
+    dictionary_hints(dict, L"kotpiesdom", &list);
+    assert_int_equal(word_list_size(&list), 1);
+    assert_true(wcscmp(word_list_get(&list)[0], L"kot pies dom") == 0);
+    word_list_done(&list);
+
+    dictionary_hints(dict, L"kotpiesekdomx", &list);
+    assert_int_equal(word_list_size(&list), 1);
+    assert_true(wcscmp(word_list_get(&list)[0], L"kot piesek dom") == 0);
+    word_list_done(&list);
+
+    dictionary_hints_max_words(dict, 2);
+    dictionary_hints(dict, L"kotpiesdom", &list);
+    assert_int_equal(word_list_size(&list), 0);
+    word_list_done(&list);
+
+    dictionary_hints(dict, L"kotpies", &list);
+    assert_int_equal(word_list_size(&list), 2);
+    assert_true(wcscmp(word_list_get(&list)[0], L"kot pies") == 0);
+    assert_true(wcscmp(word_list_get(&list)[1], L"pies") == 0);
+    word_list_done(&list);
+
+    dictionary_done(dict);
+}
+
 /**
   Testuje zapisywanie słownika.
   @param state Środowisko testowe.
@@ -144,7 +390,7 @@ static void dictionary_save_test(void** state)
     dictionary_insert(dict, L"ciupaga");
     assert_true(dictionary_save(dict, stream) == 0);
     fflush(stream);
-    assert_true(wcscmp(L"ciupaga*^^^^^^^\n0\n", buf) == 0);
+    assert_true(wcscmp(L"@acgipu\nciupaga*^^^^^^^\n0\n", buf) == 0);
     fseek(stream, 0, SEEK_SET);
 
     fclose(stream);
@@ -215,6 +461,581 @@ static void dictionary_load_test(void** state)
     assert_true(dictionary_find(dict, L"ciupagą"));
     assert_int_equal(dictionary_hints_max_cost(dict, 2), 13);
     dictionary_done(dict);
+
+    // Zapis z alfabetem, w którym brakuje znaku drzewa.
+    push_word_to_io_mock(L"@acgipu\nciupagą*^^^^^^^\n13\na*b*3*2\n");
+    dict = dictionary_load(stdin);
+    pop_remaining_chars();
+    assert_non_null(dict);
+    assert_true(dictionary_find(dict, L"ciupagą"));
+    assert_false(dictionary_find(dict, L"ciupaga"));
+    dictionary_insert(dict, L"ąa");
+    assert_true(dictionary_find(dict, L"ąa"));
+    assert_true(dictionary_find(dict, L"ciupagą"));
+    dictionary_done(dict);
+
+    // Błędny alfabet.
+    push_word_to_io_mock(L"@ca\nciupagą*^^^^^^^\n13\na*b*3*2\n");
+    assert_null(dictionary_load(stdin));
+    pop_remaining_chars();
+}
+
+/**
+  Testuje zagęszczanie słownika.
+  @param state Środowisko testowe.
+  */
+static void dictionary_compact_test(void** state)
+{
+    const wchar_t *words[] = {L"kot", L"kotek", L"koty", L"żółw", L"żuk",
+                              L"pies", L"piesek", L"ryba"};
+    const size_t n = sizeof(words) / sizeof(words[0]);
+    struct dictionary *dict = dictionary_new();
+    struct word_list before, after;
+
+    for (size_t i = 0; i < n; i++) dictionary_insert(dict, words[i]);
+    dictionary_delete(dict, L"koty");
+    dictionary_reverse_index(dict, true);
+    dictionary_hints(dict, L"kotk", &before);
+
+    assert_true(dictionary_compact(dict));
+    for (size_t i = 0; i < n; i++)
+        assert_int_equal(dictionary_find(dict, words[i]), i != 2);
+
+    dictionary_hints(dict, L"kotk", &after);
+    assert_int_equal(word_list_size(&before), word_list_size(&after));
+    for (size_t i = 0; i < word_list_size(&before); i++)
+    {
+        assert_true(wcscmp(word_list_get(&before)[i],
+                           word_list_get(&after)[i]) == 0);
+    }
+    word_list_done(&after);
+    word_list_done(&before);
+
+    // Zagęszczony słownik można dalej zmieniać i zagęszczać.
+    dictionary_delete(dict, L"piesek");
+    dictionary_delete(dict, L"ryba");
+    dictionary_insert(dict, L"rybka");
+    assert_true(dictionary_compact(dict));
+    assert_true(dictionary_find(dict, L"pies"));
+    assert_false(dictionary_find(dict, L"piesek"));
+    assert_false(dictionary_find(dict, L"ryba"));
+    assert_true(dictionary_find(dict, L"rybka"));
+
+    // Migawki współdzielą węzły z czytelnikami.
+    dictionary_snapshots(dict, true);
+    assert_false(dictionary_compact(dict));
+    dictionary_delete(dict, L"kot");
+    assert_false(dictionary_find(dict, L"kot"));
+
+    dictionary_done(dict);
+}
+
+/**
+  Testuje indeks wyszukiwania dokładnego.
+  @param state Środowisko testowe.
+  */
+static void dictionary_exact_index_test(void** state)
+{
+    struct dictionary *dict = dictionary_new();
+    struct dictionary_stats stats;
+
+    dictionary_insert(dict, L"kot");
+    dictionary_insert(dict, L"kotek");
+    dictionary_insert(dict, L"żółw");
+
+    assert_false(dictionary_exact_index(dict, true));
+    assert_true(dictionary_exact_index(dict, true));
+    dictionary_stats(dict, &stats);
+    assert_true(stats.exact_index_memory > 0);
+
+    assert_true(dictionary_find(dict, L"kotek"));
+    assert_true(dictionary_find(dict, L"żółw"));
+    assert_false(dictionary_find(dict, L"kote"));
+    assert_false(dictionary_find(dict, L"pies"));
+
+    // Zapisany indeks jest wczytywany razem ze słownikiem.
+    wchar_t *buf = NULL;
+    size_t len;
+    FILE *stream = open_wmemstream(&buf, &len);
+    assert_true(dictionary_save(dict, stream) == 0);
+    fclose(stream);
+    assert_non_null(wcschr(buf, L'#'));
+
+    push_word_to_io_mock(buf);
+#   undef free
+    free(buf);
+#   define free(ptr) _test_free(ptr, __FILE__, __LINE__)
+    struct dictionary *loaded = dictionary_load(stdin);
+    pop_remaining_chars();
+    assert_non_null(loaded);
+    assert_true(dictionary_exact_index(loaded, true));
+    assert_true(dictionary_find(loaded, L"kot"));
+    assert_false(dictionary_find(loaded, L"ko"));
+    dictionary_done(loaded);
+
+    // Zmiana słownika wyłącza indeks.
+    dictionary_insert(dict, L"pies");
+    assert_false(dictionary_exact_index(dict, false));
+    assert_true(dictionary_find(dict, L"pies"));
+
+    dictionary_done(dict);
+}
+
+/**
+  Testuje słownik wczytany tylko do sprawdzania słów.
+  @param state Środowisko testowe.
+  */
+static void dictionary_load_lookup_test(void** state)
+{
+    struct dictionary *dict = NULL;
+    struct dictionary_stats stats;
+    struct word_list hints;
+
+    push_word_to_io_mock(L"@acgikptuąż\nciupa*gą*^^^^^^^tak*^^^ż*\n"
+                         L"1\na*b*3*2\n");
+    dict = dictionary_load_lookup(stdin);
+    pop_remaining_chars();
+    assert_non_null(dict);
+    dictionary_stats(dict, &stats);
+    assert_int_equal(stats.succinct_index_nodes, 12);
+    assert_int_equal(stats.bloom_words, 4);
+
+    assert_true(dictionary_find(dict, L"ciupagą"));
+    assert_true(dictionary_find(dict, L"ciupa"));
+    assert_true(dictionary_find(dict, L"ż"));
+    assert_false(dictionary_find(dict, L"ciup"));
+    assert_false(dictionary_find(dict, L"taki"));
+    assert_true(dictionary_find_utf8(dict, "tak"));
+
+    // Słownika nie można zmieniać ani zapisywać.
+    assert_int_equal(dictionary_insert(dict, L"kot"), 0);
+    assert_int_equal(dictionary_delete(dict, L"tak"), 0);
+    assert_true(dictionary_find(dict, L"tak"));
+    assert_true(dictionary_save(dict, stdout) < 0);
+    assert_true(dictionary_succinct_index(dict, false));
+    assert_false(dictionary_snapshots(dict, true));
+    assert_false(dictionary_compact(dict));
+    dictionary_hints(dict, L"tal", &hints);
+    assert_int_equal(word_list_size(&hints), 0);
+    word_list_done(&hints);
+    dictionary_done(dict);
+
+    // Zapis z indeksem wyszukiwania dokładnego.
+    dict = dictionary_new();
+    dictionary_insert(dict, L"kot");
+    dictionary_insert(dict, L"kotek");
+    dictionary_insert(dict, L"żółw");
+    dictionary_exact_index(dict, true);
+
+    wchar_t *buf = NULL;
+    size_t len;
+    FILE *stream = open_wmemstream(&buf, &len);
+    assert_true(dictionary_save(dict, stream) == 0);
+    fclose(stream);
+    dictionary_done(dict);
+
+    push_word_to_io_mock(buf);
+#   undef free
+    free(buf);
+#   define free(ptr) _test_free(ptr, __FILE__, __LINE__)
+    dict = dictionary_load_lookup(stdin);
+    pop_remaining_chars();
+    assert_non_null(dict);
+    assert_true(dictionary_exact_index(dict, true));
+    assert_true(dictionary_find(dict, L"kotek"));
+    assert_false(dictionary_find(dict, L"kote"));
+    dictionary_done(dict);
+
+    // Błędny zapis drzewa.
+    push_word_to_io_mock(L"^a*\n1\na*b*3*2\n");
+    assert_null(dictionary_load_lookup(stdin));
+    pop_remaining_chars();
+}
+
+/**
+  Sprawdza, czy podpowiedzi z migawkami i bez nich są takie same.
+  @param[in,out] dict Słownik z włączonymi migawkami.
+  @param[in] word Słowo.
+  */
+static void assert_same_snapshot_hints(struct dictionary *dict,
+                                       const wchar_t *word)
+{
+    struct word_list plain, snapshot;
+
+    dictionary_hints(dict, word, &snapshot);
+    assert_true(dictionary_snapshots(dict, false));
+    dictionary_hints(dict, word, &plain);
+    assert_false(dictionary_snapshots(dict, true));
+
+    assert_int_equal(word_list_size(&plain), word_list_size(&snapshot));
+    for (size_t i = 0; i < word_list_size(&plain); i++)
+    {
+        assert_true(wcscmp(word_list_get(&plain)[i],
+                           word_list_get(&snapshot)[i]) == 0);
+    }
+
+    word_list_done(&snapshot);
+    word_list_done(&plain);
+}
+
+/**
+  Testuje funkcje słownika działające na słowach w UTF-8.
+  @param state Środowisko testowe.
+  */
+static void dictionary_utf8_test(void** state)
+{
+    struct dictionary *dict = dictionary_new();
+
+    assert_int_equal(dictionary_insert_utf8(dict, "żółw"), 1);
+    assert_int_equal(dictionary_insert_utf8(dict, "żółw"), 0);
+    assert_int_equal(dictionary_insert_utf8(dict, "ko\xC5"), 0);
+
+    // Długie słowa są dekodowane na stercie.
+    char long_word[2 * UTF8_STACK_BYTES + 2];
+    for (int i = 0; i < UTF8_STACK_BYTES; i++) strcpy(long_word + 2 * i, "ż");
+    assert_int_equal(dictionary_insert_utf8(dict, long_word), 1);
+    strcat(long_word, "\xC5");
+    assert_int_equal(dictionary_insert_utf8(dict, long_word), 0);
+    long_word[2 * UTF8_STACK_BYTES] = '\0';
+
+    dictionary_insert(dict, L"kot");
+    dictionary_insert(dict, L"kotek");
+    assert_true(dictionary_find(dict, L"żółw"));
+
+    // Te same wyniki z filtrem Blooma i bez, z indeksami i z migawkami.
+    for (int variant = 0; variant < 5; variant++)
+    {
+        if (variant == 1) dictionary_bloom_bits(dict, 0);
+        if (variant == 2) dictionary_exact_index(dict, true);
+        if (variant == 3) dictionary_succinct_index(dict, true);
+        if (variant == 4) dictionary_snapshots(dict, true);
+
+        assert_true(dictionary_find_utf8(dict, "żółw"));
+        assert_true(dictionary_find_utf8(dict, "kotek"));
+        assert_false(dictionary_find_utf8(dict, "kote"));
+        assert_false(dictionary_find_utf8(dict, "żółwie"));
+        assert_false(dictionary_find_utf8(dict, ""));
+        assert_false(dictionary_find_utf8(dict, "ko\xC5"));
+        assert_true(dictionary_find_utf8(dict, long_word));
+        assert_false(dictionary_find_utf8(dict, long_word + 2));
+    }
+
+    assert_int_equal(dictionary_delete_utf8(dict, long_word), 1);
+    assert_int_equal(dictionary_delete_utf8(dict, "ko\xC5"), 0);
+    assert_int_equal(dictionary_delete_utf8(dict, "żółw"), 1);
+    assert_int_equal(dictionary_delete_utf8(dict, "żółw"), 0);
+    assert_false(dictionary_find(dict, L"żółw"));
+
+    struct word_list hints;
+    struct utf8_word_list utf8_hints;
+    dictionary_insert_utf8(dict, "kąt");
+    dictionary_hints_max_cost(dict, 1);
+    dictionary_rule_add(dict, L"1", L"2", false, 1, RULE_NORMAL);
+    dictionary_hints(dict, L"kat", &hints);
+    dictionary_hints_utf8(dict, "kat", &utf8_hints);
+    assert_true(word_list_size(&hints) > 0);
+    assert_int_equal(utf8_word_list_size(&utf8_hints),
+                     word_list_size(&hints));
+    for (size_t i = 0; i < word_list_size(&hints); i++)
+    {
+        wchar_t wide[strlen(utf8_word_list_get(&utf8_hints)[i]) + 1];
+        utf8_to_wide(utf8_word_list_get(&utf8_hints)[i], wide);
+        assert_true(wcscmp(wide, word_list_get(&hints)[i]) == 0);
+    }
+    word_list_done(&hints);
+    utf8_word_list_done(&utf8_hints);
+
+    dictionary_hints_utf8(dict, "ko\xC5", &utf8_hints);
+    assert_int_equal(utf8_word_list_size(&utf8_hints), 0);
+    utf8_word_list_done(&utf8_hints);
+
+    dictionary_done(dict);
+}
+
+/**
+  Testuje zwięzłe drzewo słownika.
+  @param state Środowisko testowe.
+  */
+static void dictionary_succinct_index_test(void** state)
+{
+    struct dictionary *dict = dictionary_new();
+    struct dictionary_stats stats;
+
+    dictionary_insert(dict, L"kot");
+    dictionary_insert(dict, L"kotek");
+    dictionary_insert(dict, L"żółw");
+
+    assert_false(dictionary_succinct_index(dict, true));
+    assert_true(dictionary_succinct_index(dict, true));
+    dictionary_stats(dict, &stats);
+    assert_int_equal(stats.succinct_index_nodes, 10);
+    assert_true(stats.succinct_index_memory > 0);
+
+    assert_true(dictionary_find(dict, L"kotek"));
+    assert_true(dictionary_find(dict, L"żółw"));
+    assert_false(dictionary_find(dict, L"kote"));
+    assert_false(dictionary_find(dict, L"pies"));
+
+    const wchar_t *words[] = {L"kot", L"ko", L"żółw"};
+    bool results[3];
+    dictionary_find_batch(dict, words, 3, results);
+    assert_true(results[0]);
+    assert_false(results[1]);
+    assert_true(results[2]);
+
+    // Zmiana słownika wyłącza zwięzłe drzewo.
+    dictionary_delete(dict, L"kot");
+    assert_false(dictionary_succinct_index(dict, false));
+    assert_false(dictionary_find(dict, L"kot"));
+    assert_true(dictionary_find(dict, L"kotek"));
+
+    dictionary_done(dict);
+}
+
+/**
+  Testuje zmiany i wyszukiwanie przy włączonych migawkach.
+  @param state Środowisko testowe.
+  */
+static void dictionary_snapshots_test(void** state)
+{
+    dictionary_setup(state);
+
+    struct dictionary *dict = *state;
+    struct dictionary_stats stats;
+
+    dictionary_hints_max_cost(dict, 3);
+    dictionary_rule_add(dict, L"1", L"2", false, 1, RULE_NORMAL);
+    dictionary_rule_add(dict, L"", L"1", false, 1, RULE_NORMAL);
+    dictionary_rule_add(dict, L"", L"", false, 1, RULE_SPLIT);
+    dictionary_reverse_index(dict, true);
+
+    assert_false(dictionary_snapshots(dict, true));
+    assert_true(dictionary_snapshots(dict, true));
+    dictionary_stats(dict, &stats);
+    assert_int_equal(stats.bloom_memory, 0);
+    assert_false(dictionary_exact_index(dict, true));
+
+    assert_int_equal(dictionary_insert(dict, L"felik"), 1);
+    assert_int_equal(dictionary_insert(dict, L"felik"), 0);
+    assert_int_equal(dictionary_insert(dict, L"fe"), 1);
+    assert_int_equal(dictionary_delete(dict, L"felin"), 1);
+    assert_int_equal(dictionary_delete(dict, L"felin"), 0);
+    assert_int_equal(dictionary_delete(dict, L"tein"), 1);
+
+    assert_true(dictionary_find(dict, L"felik"));
+    assert_true(dictionary_find(dict, L"fe"));
+    assert_true(dictionary_find(dict, L"fen"));
+    assert_false(dictionary_find(dict, L"felin"));
+    assert_false(dictionary_find(dict, L"tein"));
+    assert_false(dictionary_find(dict, L"tei"));
+
+    const wchar_t *words[] = {L"felik", L"felin", L"mein", L"fel"};
+    bool results[4];
+    dictionary_find_batch(dict, words, 4, results);
+    assert_true(results[0]);
+    assert_false(results[1]);
+    assert_true(results[2]);
+    assert_false(results[3]);
+
+    assert_same_snapshot_hints(dict, L"felim");
+    assert_same_snapshot_hints(dict, L"fenfin");
+    assert_same_snapshot_hints(dict, L"tei");
+
+    // Po wyłączeniu migawek słownik działa jak zwykle.
+    assert_true(dictionary_snapshots(dict, false));
+    dictionary_stats(dict, &stats);
+    assert_true(stats.bloom_memory > 0);
+    assert_true(dictionary_find(dict, L"felik"));
+    assert_false(dictionary_find(dict, L"tein"));
+    assert_int_equal(dictionary_delete(dict, L"felik"), 1);
+    assert_false(dictionary_find(dict, L"felik"));
+
+    dictionary_teardown(state);
+}
+
+/**
+  Testuje słownik warstwowy.
+  @param state Środowisko testowe.
+  */
+static void dictionary_layered_test(void** state)
+{
+    dictionary_setup(state);
+
+    struct dictionary *base = *state;
+    dictionary_hints_max_cost(base, 2);
+    dictionary_rule_add(base, L"", L"", false, 1, RULE_SPLIT);
+    dictionary_rule_add(base, L"k", L"n", false, 1, RULE_NORMAL);
+
+    struct dictionary *dict = dictionary_new_layered(base);
+    assert_true(dictionary_find(dict, L"felin"));
+
+    assert_int_equal(dictionary_insert(dict, L"felik"), 1);
+    assert_int_equal(dictionary_delete(dict, L"felin"), 1);
+    assert_int_equal(dictionary_delete(dict, L"fen"), 1);
+
+    assert_true(dictionary_find(dict, L"felik"));
+    assert_false(dictionary_find(dict, L"felin"));
+    assert_false(dictionary_find(dict, L"fen"));
+    assert_true(dictionary_find(dict, L"fin"));
+    assert_true(dictionary_find(base, L"felin"));
+    assert_false(dictionary_find(base, L"felik"));
+
+    // Podpowiedzi ze słowami obu warstw.
+    struct word_list hints;
+    dictionary_hints(dict, L"fek", &hints);
+    assert_int_equal(word_list_size(&hints), 0);
+    word_list_done(&hints);
+    dictionary_hints(dict, L"felikfin", &hints);
+    assert_int_equal(word_list_size(&hints), 1);
+    assert_true(wcscmp(word_list_get(&hints)[0], L"felik fin") == 0);
+    word_list_done(&hints);
+
+    // Zapisywana jest tylko nakładka.
+    wchar_t *buf = NULL;
+    size_t len;
+    FILE *stream = open_wmemstream(&buf, &len);
+    assert_true(dictionary_save(dict, stream) == 0);
+    fclose(stream);
+    assert_true(wcscmp(buf, L"+felik\n-felin\n-fen\n") == 0);
+
+    push_word_to_io_mock(buf);
+#   undef free
+    free(buf);
+#   define free(ptr) _test_free(ptr, __FILE__, __LINE__)
+    struct dictionary *loaded = dictionary_load_layered(base, stdin);
+    assert_non_null(loaded);
+    assert_true(dictionary_find(loaded, L"felik"));
+    assert_false(dictionary_find(loaded, L"felin"));
+    assert_true(dictionary_find(loaded, L"mein"));
+    dictionary_done(loaded);
+
+    push_word_to_io_mock(L"*felik\n");
+    assert_null(dictionary_load_layered(base, stdin));
+    pop_remaining_chars();
+
+    // Zmienione reguły i koszt są zapisywane w nakładce, a odrzucona
+    // reguła nie jest dodawana.
+    assert_int_equal(dictionary_rule_add(dict, L"", L"", false, 1,
+                                         RULE_NORMAL), 0);
+    assert_int_equal(dictionary_rule_add(dict, L"f", L"m", false, 1,
+                                         RULE_NORMAL), 1);
+    dictionary_hints_max_cost(dict, 3);
+    stream = open_wmemstream(&buf, &len);
+    assert_true(dictionary_save(dict, stream) == 0);
+    fclose(stream);
+    const wchar_t *expected =
+        L"+felik\n-felin\n-fen\n=\n3\n**1*3\nk*n*1*0\nf*m*1*0\n";
+    assert_true(wcscmp(buf, expected) == 0);
+
+    push_word_to_io_mock(buf);
+#   undef free
+    free(buf);
+#   define free(ptr) _test_free(ptr, __FILE__, __LINE__)
+    loaded = dictionary_load_layered(base, stdin);
+    assert_non_null(loaded);
+    pop_remaining_chars();
+    stream = open_wmemstream(&buf, &len);
+    assert_true(dictionary_save(loaded, stream) == 0);
+    fclose(stream);
+    assert_true(wcscmp(buf, expected) == 0);
+#   undef free
+    free(buf);
+#   define free(ptr) _test_free(ptr, __FILE__, __LINE__)
+    dictionary_done(loaded);
+
+    push_word_to_io_mock(L"+felik\n=\nx\n");
+    assert_null(dictionary_load_layered(base, stdin));
+    pop_remaining_chars();
+
+    dictionary_done(dict);
+    dictionary_teardown(state);
+}
+
+/**
+  Zapisuje słownik do bufora w pamięci.
+  @param[in] dict Słownik.
+  @return Bufor, który należy zwolnić.
+  */
+static wchar_t * save_to_buffer(const struct dictionary *dict)
+{
+    wchar_t *buf = NULL;
+    size_t len;
+
+    FILE *stream = open_wmemstream(&buf, &len);
+    assert_non_null(stream);
+    assert_int_equal(dictionary_save(dict, stream), 0);
+    fclose(stream);
+
+    return buf;
+}
+
+/**
+  Sprawdza, czy plik zawiera dany tekst.
+  @param[in] path Ścieżka pliku.
+  @param[in] expected Oczekiwany tekst.
+  */
+static void assert_file_contents(const char *path, const wchar_t *expected)
+{
+    FILE *file = fopen(path, "r");
+    assert_non_null(file);
+
+    size_t i = 0;
+    wint_t c;
+    while ((c = fgetwc(file)) != WEOF)
+    {
+        assert_true(expected[i] != L'\0');
+        assert_int_equal(c, expected[i]);
+        i++;
+    }
+    assert_true(expected[i] == L'\0');
+
+    fclose(file);
+}
+
+/**
+  Testuje zapis słownika w tle.
+  @param state Środowisko testowe.
+  */
+static void dictionary_save_async_test(void** state)
+{
+    dictionary_setup(state);
+
+    struct dictionary *dict = *state;
+    char path[] = "/tmp/dictionary_testXXXXXX";
+    int fd = mkstemp(path);
+    assert_true(fd >= 0);
+    close(fd);
+
+    dictionary_rule_add(dict, L"k", L"n", false, 1, RULE_NORMAL);
+    dictionary_snapshots(dict, true);
+
+    // Zapisywana jest migawka z chwili rozpoczęcia zapisu.
+#   undef free
+    wchar_t *expected = save_to_buffer(dict);
+    struct dictionary_save *save = dictionary_save_async(dict, path);
+    assert_int_equal(dictionary_insert(dict, L"felik"), 1);
+    assert_int_equal(dictionary_delete(dict, L"felin"), 1);
+    dictionary_rule_clear(dict);
+    assert_int_equal(dictionary_save_wait(save), 0);
+    assert_file_contents(path, expected);
+    free(expected);
+
+    // Bez migawek zapisywany jest obraz słownika z chwili rozpoczęcia.
+    dictionary_snapshots(dict, false);
+    expected = save_to_buffer(dict);
+    save = dictionary_save_async(dict, path);
+    assert_int_equal(dictionary_insert(dict, L"felis"), 1);
+    dictionary_rule_add(dict, L"f", L"g", false, 1, RULE_NORMAL);
+    assert_int_equal(dictionary_save_wait(save), 0);
+    assert_file_contents(path, expected);
+    free(expected);
+#   define free(ptr) _test_free(ptr, __FILE__, __LINE__)
+
+    save = dictionary_save_async(dict, "/nonexistent/dictionary");
+    assert_true(dictionary_save_wait(save) < 0);
+
+    unlink(path);
+    dictionary_teardown(state);
 }
 
 /**
@@ -230,8 +1051,20 @@ int main(void)
         cmocka_unit_test(dictionary_insert_test),
         cmocka_unit_test(dictionary_find_test),
         cmocka_unit_test(dictionary_delete_test),
+        cmocka_unit_test(dictionary_reverse_index_test),
+        cmocka_unit_test(dictionary_qgram_test),
+        cmocka_unit_test(dictionary_bloom_test),
+        cmocka_unit_test(dictionary_hints_max_words_test),
         cmocka_unit_test(dictionary_save_test),
         cmocka_unit_test(dictionary_load_test),
+        cmocka_unit_test(dictionary_compact_test),
+        cmocka_unit_test(dictionary_exact_index_test),
+        cmocka_unit_test(dictionary_utf8_test),
+        cmocka_unit_test(dictionary_succinct_index_test),
+        cmocka_unit_test(dictionary_load_lookup_test),
+        cmocka_unit_test(dictionary_snapshots_test),
+        cmocka_unit_test(dictionary_layered_test),
+        cmocka_unit_test(dictionary_save_async_test),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,233 @@
+/** @file
+    Implementacja odzyskiwania pamięci opartego na epokach.
+
+    Aktywny czytelnik zajmuje miejsce w tablicy i ogłasza w nim epokę,
+    którą zastał. Pisarz przesuwa epokę globalną, gdy wszyscy aktywni
+    czytelnicy ogłosili bieżącą. Obiekt odłączony w epoce e nie jest już
+    osiągalny dla czytelników, którzy weszli w epoce e + 1, więc można go
+    zwolnić, gdy epoka globalna osiągnie e + 2.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#include "epoch.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+  Liczba miejsc czytelników.
+  */
+#define N_READERS 64
+
+/**
+  Rozmiar linii pamięci podręcznej.
+  */
+#define CACHE_LINE 64
+
+/**
+  Początkowa pojemność listy oczekujących obiektów.
+  */
+#define MINIMAL_CAPACITY 16
+
+/**
+  Najmniejsza liczba oczekujących obiektów, przy której próbujemy je
+  zwolnić.
+  */
+#define RECLAIM_BATCH 64
+
+/**
+  Miejsce czytelnika; każde zajmuje osobną linię pamięci podręcznej.
+  */
+struct reader
+{
+    /// Ogłoszona epoka lub 0, jeśli miejsce jest wolne.
+    uint64_t epoch;
+    /// Wypełnienie do rozmiaru linii.
+    char padding[CACHE_LINE - sizeof(uint64_t)];
+};
+
+/**
+  Obiekt oczekujący na zwolnienie.
+  */
+struct retired
+{
+    /// Obiekt.
+    void *ptr;
+    /// Funkcja zwalniająca.
+    epoch_free_func free_fn;
+    /// Epoka, w której obiekt został odłączony.
+    uint64_t epoch;
+};
+
+/**
+  Struktura przechowująca stan odzyskiwania pamięci.
+  */
+struct epoch
+{
+    /// Miejsca czytelników.
+    struct reader readers[N_READERS];
+    /// Epoka globalna (od 1).
+    uint64_t global;
+    /// Obiekty oczekujące na zwolnienie, od najstarszych.
+    struct retired *retired;
+    /// Liczba oczekujących obiektów.
+    size_t n_retired;
+    /// Pojemność listy oczekujących obiektów.
+    size_t capacity;
+    /// Liczba oczekujących obiektów, przy której próbujemy je zwolnić.
+    size_t threshold;
+};
+
+/** @name Funkcje pomocnicze
+  @{
+  */
+
+/**
+  Przesuwa epokę globalną, jeśli wszyscy aktywni czytelnicy ją ogłosili.
+  @param[in,out] epoch Stan.
+  */
+static void try_advance(Epoch *epoch)
+{
+    uint64_t global = __atomic_load_n(&epoch->global, __ATOMIC_SEQ_CST);
+
+    for (int i = 0; i < N_READERS; i++)
+    {
+        uint64_t e = __atomic_load_n(&epoch->readers[i].epoch,
+                                     __ATOMIC_SEQ_CST);
+        if (e != 0 && e != global) return;
+    }
+
+    __atomic_store_n(&epoch->global, global + 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+  Zwalnia obiekty, których nie może już widzieć żaden czytelnik.
+  @param[in,out] epoch Stan.
+  */
+static void reclaim(Epoch *epoch)
+{
+    uint64_t global = __atomic_load_n(&epoch->global, __ATOMIC_SEQ_CST);
+    size_t freed = 0;
+
+    while (freed < epoch->n_retired
+           && epoch->retired[freed].epoch + 2 <= global)
+    {
+        epoch->retired[freed].free_fn(epoch->retired[freed].ptr);
+        freed++;
+    }
+
+    for (size_t i = freed; i < epoch->n_retired; i++)
+        epoch->retired[i - freed] = epoch->retired[i];
+    epoch->n_retired -= freed;
+}
+
+/**@}*/
+/** @name Elementy interfejsu
+  @{
+  */
+
+Epoch * epoch_new(void)
+{
+    Epoch *epoch;
+    if (posix_memalign((void **) &epoch, CACHE_LINE, sizeof(Epoch)) != 0)
+    {
+        fprintf(stderr, "Failed to allocate memory for epoch\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < N_READERS; i++) epoch->readers[i].epoch = 0;
+    epoch->global = 1;
+    epoch->retired = NULL;
+    epoch->n_retired = 0;
+    epoch->capacity = 0;
+    epoch->threshold = RECLAIM_BATCH;
+
+    return epoch;
+}
+
+void epoch_done(Epoch *epoch)
+{
+    for (size_t i = 0; i < epoch->n_retired; i++)
+        epoch->retired[i].free_fn(epoch->retired[i].ptr);
+
+    free(epoch->retired);
+    free(epoch);
+}
+
+int epoch_enter(Epoch *epoch)
+{
+    // Różne wątki zaczynają szukanie wolnego miejsca w różnych miejscach.
+    uintptr_t self = (uintptr_t) pthread_self();
+    int start = (self ^ (self >> 12)) % N_READERS;
+
+    for (;;)
+    {
+        for (int i = 0; i < N_READERS; i++)
+        {
+            int slot = (start + i) % N_READERS;
+            uint64_t expected = 0;
+            uint64_t global = __atomic_load_n(&epoch->global,
+                                              __ATOMIC_SEQ_CST);
+
+            if (__atomic_compare_exchange_n(&epoch->readers[slot].epoch,
+                                            &expected, global, false,
+                                            __ATOMIC_SEQ_CST,
+                                            __ATOMIC_RELAXED))
+                return slot;
+        }
+
+        sched_yield();
+    }
+}
+
+void epoch_exit(Epoch *epoch, int reader)
+{
+    __atomic_store_n(&epoch->readers[reader].epoch, 0, __ATOMIC_RELEASE);
+}
+
+void epoch_retire(Epoch *epoch, void *ptr, epoch_free_func free_fn)
+{
+    if (epoch->n_retired == epoch->capacity)
+    {
+        epoch->capacity = epoch->capacity > 0 ? 2 * epoch->capacity
+                                              : MINIMAL_CAPACITY;
+        epoch->retired = realloc(epoch->retired,
+                                 epoch->capacity * sizeof(struct retired));
+        if (!epoch->retired)
+        {
+            fprintf(stderr, "Failed to allocate memory for epoch\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    struct retired *r = &epoch->retired[epoch->n_retired++];
+    r->ptr = ptr;
+    r->free_fn = free_fn;
+    r->epoch = __atomic_load_n(&epoch->global, __ATOMIC_SEQ_CST);
+
+    // Przeglądanie czytelników i przesuwanie listy kosztuje tyle, co
+    // kilkadziesiąt przekazań, więc zwalniamy obiekty paczkami. Próg
+    // rośnie razem z liczbą obiektów, których nie udało się zwolnić,
+    // żeby długo aktywny czytelnik nie powodował kosztu kwadratowego.
+    if (epoch->n_retired < epoch->threshold) return;
+
+    try_advance(epoch);
+    reclaim(epoch);
+
+    epoch->threshold = 2 * epoch->n_retired;
+    if (epoch->threshold < RECLAIM_BATCH) epoch->threshold = RECLAIM_BATCH;
+}
+
+size_t epoch_pending(const Epoch *epoch)
+{
+    return epoch->n_retired;
+}
+
+/**@}*/
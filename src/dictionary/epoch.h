@@ -0,0 +1,78 @@
+/** @file
+    Interfejs odzyskiwania pamięci opartego na epokach.
+
+    Czytelnicy przeglądają strukturę bez blokad między epoch_enter()
+    a epoch_exit(). Pisarz, który odłączył obiekt od struktury, przekazuje
+    go do epoch_retire() zamiast zwalniać; obiekt jest zwalniany dopiero,
+    gdy żaden czytelnik, który mógł go zobaczyć, nie jest już aktywny.
+
+    Pisarze muszą być wzajemnie wykluczeni przez wywołującego.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#ifndef __EPOCH_H__
+#define __EPOCH_H__
+
+#include <stddef.h>
+
+/**
+  Struktura przechowująca stan odzyskiwania pamięci.
+  */
+typedef struct epoch Epoch;
+
+/**
+  Funkcja zwalniająca obiekt.
+  */
+typedef void (*epoch_free_func)(void *);
+
+/**
+  Inicjalizacja.
+  Należy ją zniszczyć za pomocą epoch_done().
+  @return Nowy stan.
+  */
+Epoch * epoch_new(void);
+
+/**
+  Destrukcja; zwalnia wszystkie oczekujące obiekty.
+  Żaden czytelnik nie może być wtedy aktywny.
+  @param[in,out] epoch Stan.
+  */
+void epoch_done(Epoch *epoch);
+
+/**
+  Rozpoczyna czytanie.
+  Obiekty widoczne po wywołaniu nie zostaną zwolnione przed
+  odpowiadającym mu epoch_exit().
+  @param[in,out] epoch Stan.
+  @return Identyfikator czytelnika do przekazania do epoch_exit().
+  */
+int epoch_enter(Epoch *epoch);
+
+/**
+  Kończy czytanie.
+  @param[in,out] epoch Stan.
+  @param[in] reader Identyfikator zwrócony przez epoch_enter().
+  */
+void epoch_exit(Epoch *epoch, int reader);
+
+/**
+  Przekazuje odłączony obiekt do zwolnienia, gdy będzie to bezpieczne.
+  Obiekty są zwalniane paczkami, przy kolejnych wywołaniach.
+  @param[in,out] epoch Stan.
+  @param[in] ptr Obiekt.
+  @param[in] free_fn Funkcja zwalniająca obiekt.
+  */
+void epoch_retire(Epoch *epoch, void *ptr, epoch_free_func free_fn);
+
+/**
+  Zwraca liczbę obiektów oczekujących na zwolnienie.
+  @param[in] epoch Stan.
+  @return Liczba obiektów.
+  */
+size_t epoch_pending(const Epoch *epoch);
+
+#endif /* __EPOCH_H__ */
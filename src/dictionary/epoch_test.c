@@ -0,0 +1,201 @@
+/** @file
+    Testy odzyskiwania pamięci opartego na epokach.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwerstet Warszawski
+    @date 2026-10-19
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <cmocka.h>
+#include "epoch.c"
+#include "utils.h"
+
+/**
+  Liczba obiektów używanych w testach.
+  */
+#define N_OBJECTS 2000
+
+/**
+  Liczba czytelników w teście współbieżnym.
+  */
+#define N_THREADS 4
+
+/**
+  Obiekt używany w testach.
+  */
+struct object
+{
+    /// Czy obiekt został zwolniony.
+    bool freed;
+};
+
+/**
+  Obiekty używane w testach.
+  */
+static struct object objects[N_OBJECTS];
+
+/**
+  Obiekt widoczny dla czytelników w teście współbieżnym.
+  */
+static struct object *current;
+
+/**
+  Czy pisarz w teście współbieżnym skończył.
+  */
+static bool finished;
+
+/**
+  Liczba czytelników, którzy zobaczyli zwolniony obiekt.
+  */
+static int violations;
+
+/**
+  Oznacza obiekt jako zwolniony.
+  @param[in,out] ptr Obiekt.
+  */
+static void mark_freed(void *ptr)
+{
+    __atomic_store_n(&((struct object *) ptr)->freed, true, __ATOMIC_SEQ_CST);
+}
+
+/**
+  Przygotowuje obiekty.
+  */
+static void reset_objects(void)
+{
+    for (int i = 0; i < N_OBJECTS; i++) objects[i].freed = false;
+}
+
+/**
+  Testuje zwalnianie obiektów bez aktywnych czytelników.
+  @param state Środowisko testowe.
+  */
+static void epoch_retire_test(void** state)
+{
+    reset_objects();
+    Epoch *epoch = epoch_new();
+
+    int n = 10 * RECLAIM_BATCH;
+    for (int i = 0; i < n; i++) epoch_retire(epoch, &objects[i], mark_freed);
+
+    // Bez czytelników epoka przesuwa się przy każdej paczce.
+    assert_true(objects[0].freed);
+    assert_true(epoch_pending(epoch) <= 2 * RECLAIM_BATCH);
+
+    epoch_done(epoch);
+    for (int i = 0; i < n; i++) assert_true(objects[i].freed);
+}
+
+/**
+  Testuje wstrzymanie zwalniania przez aktywnego czytelnika.
+  @param state Środowisko testowe.
+  */
+static void epoch_reader_test(void** state)
+{
+    reset_objects();
+    Epoch *epoch = epoch_new();
+
+    int reader = epoch_enter(epoch);
+    for (int i = 0; i < 10; i++) epoch_retire(epoch, &objects[i], mark_freed);
+
+    // Czytelnik mógł widzieć obiekty odłączone po jego wejściu.
+    for (int i = 0; i < 10; i++) assert_false(objects[i].freed);
+    assert_int_equal(epoch_pending(epoch), 10);
+
+    epoch_exit(epoch, reader);
+    for (int i = 10; i < 3 * RECLAIM_BATCH; i++)
+        epoch_retire(epoch, &objects[i], mark_freed);
+    for (int i = 0; i < 10; i++) assert_true(objects[i].freed);
+
+    // Wiele czytelników naraz.
+    int readers[N_THREADS];
+    for (int i = 0; i < N_THREADS; i++) readers[i] = epoch_enter(epoch);
+    for (int i = 0; i < N_THREADS; i++)
+        for (int j = 0; j < i; j++)
+            assert_true(readers[i] != readers[j]);
+    for (int i = 0; i < N_THREADS; i++) epoch_exit(epoch, readers[i]);
+
+    epoch_done(epoch);
+}
+
+/**
+  Czytelnik w teście współbieżnym.
+  @param[in,out] arg Stan.
+  @return NULL.
+  */
+static void * reader_thread(void *arg)
+{
+    Epoch *epoch = arg;
+
+    while (!__atomic_load_n(&finished, __ATOMIC_SEQ_CST))
+    {
+        int reader = epoch_enter(epoch);
+        struct object *object = __atomic_load_n(&current, __ATOMIC_SEQ_CST);
+
+        for (int i = 0; i < 100; i++)
+        {
+            if (__atomic_load_n(&object->freed, __ATOMIC_SEQ_CST))
+            {
+                __atomic_add_fetch(&violations, 1, __ATOMIC_SEQ_CST);
+                break;
+            }
+        }
+
+        epoch_exit(epoch, reader);
+    }
+
+    return NULL;
+}
+
+/**
+  Testuje zwalnianie obiektów przy współbieżnych czytelnikach.
+  @param state Środowisko testowe.
+  */
+static void epoch_concurrent_test(void** state)
+{
+    reset_objects();
+    Epoch *epoch = epoch_new();
+    pthread_t threads[N_THREADS];
+
+    current = &objects[0];
+    finished = false;
+    violations = 0;
+
+    for (int i = 0; i < N_THREADS; i++)
+        assert_int_equal(pthread_create(&threads[i], NULL, reader_thread,
+                                        epoch), 0);
+
+    for (int i = 1; i < N_OBJECTS; i++)
+    {
+        __atomic_store_n(&current, &objects[i], __ATOMIC_SEQ_CST);
+        epoch_retire(epoch, &objects[i - 1], mark_freed);
+    }
+
+    __atomic_store_n(&finished, true, __ATOMIC_SEQ_CST);
+    for (int i = 0; i < N_THREADS; i++) pthread_join(threads[i], NULL);
+
+    assert_int_equal(violations, 0);
+    assert_false(objects[N_OBJECTS - 1].freed);
+
+    epoch_done(epoch);
+}
+
+/**
+  Główna funkcja uruchamiająca testy.
+  */
+int main(void)
+{
+    const struct CMUnitTest tests[] =
+    {
+        cmocka_unit_test(epoch_retire_test),
+        cmocka_unit_test(epoch_reader_test),
+        cmocka_unit_test(epoch_concurrent_test),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -8,9 +8,9 @@
  */
 
 #include "hints_generator.h"
+#include "compiled_rules.h"
 #include "state.h"
 #include "node.h"
-#include "set.h"
 #include "vector.h"
 #include <stdlib.h>
 #include <stdbool.h>
@@ -19,6 +19,22 @@
 #include <stdint.h>
 #include <assert.h>
 #include <limits.h>
+#include <pthread.h>
+
+/**
+  Początkowa pojemność tablicy kandydatów (potęga dwójki).
+  */
+#define MINIMAL_MARKS_CAPACITY 64
+
+/**
+  Mnożnik rozpraszający adresy pozycji w tablicy kandydatów.
+  */
+#define MARK_HASH UINT64_C(0x9E3779B97F4A7C15)
+
+/**
+  Przesunięcie wybierające z iloczynu najlepiej wymieszane bity.
+  */
+#define MARK_HASH_SHIFT 32
 
 /**
   Struktura przechowująca gen podpowiedzi.
@@ -33,12 +49,126 @@ struct hints_generator
     Node *root;
     /// Reguły tworzenia podpowiedzi.
     Vector *rules;
-    /// Reguły wg. kosztu i sufiksu do którego pasują.
-    Vector ***word_rules;
+    /// Maksymalna liczba słów w podpowiedzi.
+    int max_words;
+    /// Czy reguły zostały powiązane ze skompilowanym zestawem reguł.
+    bool compiled_bound;
+    /// Czy reguły mogą być wiązane ze skompilowanym zestawem reguł.
+    bool compiled_enabled;
+    /// Czy przy ostatnim wiązaniu odcisk zestawu reguł się zgadzał.
+    bool compiled_used;
+    /// Indeks q-gramów słownika (NULL, jeśli niedostępny).
+    Qgram_Index *qgram_index;
+    /// Koszt, powyżej którego korzysta się z indeksu q-gramów (0 - nigdy).
+    int qgram_threshold;
+    /// Korzeń drzewa odwróconych słów (NULL, jeśli niedostępne).
+    Node *reverse_root;
+    /// Odwrócone reguły (NULL, jeśli jeszcze nie zostały utworzone).
+    Vector *reversed_rules;
+    /// Blokada leniwej inicjalizacji reguł przy szukaniu podpowiedzi.
+    pthread_mutex_t lock;
+};
+
+/**
+  Koniec słowa znaleziony przy przeszukiwaniu fragmentu słowa.
+  */
+struct segment_end
+{
+    /// Węzeł kończący słowo.
+    Node *node;
+    /// Pozycja w słowie, od której zaczyna się następne słowo.
+    size_t next;
+    /// Koszt fragmentu.
+    int cost;
+    /// Czy to ostatnie słowo podpowiedzi (w p.p. nastąpił rozdział).
+    bool last;
+};
+
+/**
+  Przeszukiwanie fragmentu słowa od korzenia drzewa aż do końca słowa lub
+  rozdziału. Wyniki są zapamiętywane dla pozycji początku fragmentu.
+  */
+struct segment
+{
     /// Stany.
     Vector *states;
-    /// Stany będące unikalnymi podpowiedziami
-    Set *hint_states;
+    /// Znalezione końce słów.
+    Vector *ends;
+    /// Największy koszt, do którego przeszukano stany.
+    int cost;
+};
+
+/**
+  Podpowiedź złożona z jednego lub więcej słów.
+  */
+struct hint
+{
+    /// Koszt.
+    int cost;
+    /// Liczba słów.
+    int n_words;
+    /// Napis podpowiedzi.
+    wchar_t *string;
+    /// Węzły kończące kolejne słowa.
+    Node *words[];
+};
+
+/**
+  Pozycja drzewa leżąca na ścieżce od korzenia do słowa kandydata.
+  */
+struct mark
+{
+    /// Pozycja (NULL - wolne miejsce w tablicy).
+    const Node *node;
+    /// Czy w pozycji kończy się słowo kandydata.
+    bool word;
+};
+
+/**
+  Kandydaci na podpowiedzi wyznaczeni indeksem q-gramów, jako tablica
+  haszująca pozycji przeszukiwanego drzewa.
+  */
+struct candidates
+{
+    /// Tablica haszująca pozycji.
+    struct mark *marks;
+    /// Rozmiar tablicy (potęga dwójki).
+    size_t capacity;
+    /// Liczba zaznaczonych pozycji.
+    size_t size;
+};
+
+/**
+  Stan szukania podpowiedzi dla jednego słowa.
+  Cały stan zapytania jest tutaj, więc generator może obsługiwać wiele
+  zapytań jednocześnie.
+  */
+struct search
+{
+    /// Generator podpowiedzi.
+    Hints_Generator *gen;
+    /// Korzeń przeszukiwanego drzewa.
+    Node *root;
+    /// Stosowane reguły.
+    Vector *rules;
+    /// Czy przeszukiwane jest drzewo odwróconych słów.
+    bool reversed;
+    /// Kandydaci, do których zawęża się przeszukiwanie (NULL - wszystkie).
+    const struct candidates *candidates;
+    /// Reguły wg. kosztu i sufiksu do którego pasują.
+    Vector ***word_rules;
+    /// Słowo.
+    const wchar_t *word;
+    /// Długość słowa.
+    size_t len;
+    /// Fragment zaczynający podpowiedź.
+    struct segment *first;
+    /// Fragmenty po rozdziale wg. pozycji początku (NULL - nieprzeszukane).
+    struct segment **segments;
+    /// Węzły kończące słowa bieżącej podpowiedzi.
+    Node **words;
+    /// Znalezione podpowiedzi.
+    Vector *hints;
 };
 
 /** @name Funkcje pomocnicze
@@ -60,6 +190,21 @@ static void * emalloc(size_t el_size)
     return ret;
 }
 
+/*
+ calloc opakowany w obsługę błędu
+ */
+static void * ecalloc(size_t n, size_t el_size)
+{
+    void *ret = calloc(n, el_size);
+    if (!ret)
+    {
+        fprintf(stderr, "Failed to allocate memory for hint candidates\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return ret;
+}
+
 static int compare_state(const void *_a, const void *_b)
 {
     State *a = (State*) _a;
@@ -110,29 +255,30 @@ static int compare_state_cost(const void *_a, const void *_b)
     return 0;
 }
 
-static int compare_hint_states(void *_a, void *_b)
+static int compare_hint_words(const void *_a, const void *_b)
 {
-    State *a = (State*) _a;
-    State *b = (State*) _b;
+    const struct hint *a = *(const struct hint**) _a;
+    const struct hint *b = *(const struct hint**) _b;
 
-    if ((uintptr_t)a->node < (uintptr_t)b->node) return -1;
-    if ((uintptr_t)a->node > (uintptr_t)b->node) return 1;
+    if (a->n_words < b->n_words) return -1;
+    if (a->n_words > b->n_words) return 1;
 
-    if (!a->prev && b->prev) return -1;
-    if (a->prev && !b->prev) return 1;
-    if (a->prev && b->prev)
+    for (int i = 0; i < a->n_words; i++)
     {
-        if ((uintptr_t)a->prev < (uintptr_t)b->prev) return -1;
-        if ((uintptr_t)a->prev > (uintptr_t)b->prev) return 1;
+        if ((uintptr_t)a->words[i] < (uintptr_t)b->words[i]) return -1;
+        if ((uintptr_t)a->words[i] > (uintptr_t)b->words[i]) return 1;
     }
 
+    if (a->cost < b->cost) return -1;
+    if (a->cost > b->cost) return 1;
+
     return 0;
 }
 
 static int compare_hint_strings(const void *_a, const void *_b)
 {
-    State *a = *(State**) _a;
-    State *b = *(State**) _b;
+    const struct hint *a = *(const struct hint**) _a;
+    const struct hint *b = *(const struct hint**) _b;
 
     if (a->cost < b->cost) return -1;
     if (a->cost > b->cost) return 1;
@@ -156,98 +302,241 @@ static void free_rule(void *rule)
     rule_done(rule);
 }
 
-static void init_word_rules(Hints_Generator *gen, int word_len)
+/*
+ Zwraca miejsce w tablicy kandydatów dla pozycji (wolne lub zajęte przez
+ tę pozycję).
+ */
+static struct mark * find_mark(const struct mark *marks, size_t capacity,
+                               const Node *node)
 {
-    gen->word_rules = emalloc(sizeof(Vector**) * (gen->max_rule_cost + 1));
+    size_t i = ((uint64_t) (uintptr_t) node * MARK_HASH) >> MARK_HASH_SHIFT;
+    i &= capacity - 1;
+
+    while (marks[i].node != NULL && marks[i].node != node)
+    {
+        i = (i + 1) & (capacity - 1);
+    }
 
-    for (size_t i = 0; i <= gen->max_rule_cost; i++)
+    return (struct mark *) &marks[i];
+}
+
+/*
+ Zaznacza pozycję w tablicy kandydatów, w razie potrzeby podwajając jej
+ pojemność.
+ */
+static struct mark * add_mark(struct candidates *candidates, const Node *node)
+{
+    if (4 * (candidates->size + 1) > 3 * candidates->capacity)
     {
-        gen->word_rules[i] = emalloc(sizeof(Vector*) * (word_len + 1));
-        for (size_t j = 0; j <= word_len; j++)
+        size_t capacity = 2 * candidates->capacity;
+        struct mark *marks = ecalloc(capacity, sizeof(struct mark));
+
+        for (size_t i = 0; i < candidates->capacity; i++)
         {
-            gen->word_rules[i][j] = vector_new(free_rule);
+            if (candidates->marks[i].node == NULL) continue;
+            *find_mark(marks, capacity, candidates->marks[i].node) =
+                candidates->marks[i];
         }
+
+        free(candidates->marks);
+        candidates->marks = marks;
+        candidates->capacity = capacity;
+    }
+
+    struct mark *mark = find_mark(candidates->marks, candidates->capacity,
+                                  node);
+    if (mark->node == NULL)
+    {
+        mark->node = node;
+        candidates->size++;
     }
+
+    return mark;
 }
 
-static void match_rules_to_word(Hints_Generator *gen, const wchar_t *word)
+/*
+ Sprawdza, czy pozycja leży na ścieżce do słowa któregoś z kandydatów.
+ Zbiór takich pozycji jest zamknięty na przedrostki, więc stan spoza
+ niego nie prowadzi już do żadnego kandydata.
+ */
+static bool is_candidate_prefix(const struct search *search,
+                                const Node *node)
 {
-    size_t len = wcslen(word);
+    const struct candidates *candidates = search->candidates;
 
-    for (size_t i = 0; i < vector_size(gen->rules); i++)
+    return candidates == NULL
+           || find_mark(candidates->marks, candidates->capacity,
+                        node)->node != NULL;
+}
+
+/*
+ Sprawdza, czy w pozycji kończy się słowo, które może być podpowiedzią.
+ */
+static bool is_candidate_word(const struct search *search, const Node *node)
+{
+    const struct candidates *candidates = search->candidates;
+
+    return node_is_word(node)
+           && (candidates == NULL
+               || find_mark(candidates->marks, candidates->capacity,
+                            node)->word);
+}
+
+static void init_word_rules(struct search *search)
+{
+    int max_rule_cost = search->gen->max_rule_cost;
+
+    search->word_rules = emalloc(sizeof(Vector**) * (max_rule_cost + 1));
+
+    for (size_t i = 0; i <= max_rule_cost; i++)
     {
-        Rule *rule = vector_get_by_index(gen->rules, i);
+        search->word_rules[i] = emalloc(sizeof(Vector*) * (search->len + 1));
+        for (size_t j = 0; j <= search->len; j++)
+        {
+            search->word_rules[i][j] = vector_new(free_rule);
+        }
+    }
+}
+
+static void match_rules_to_word(struct search *search)
+{
+    size_t len = search->len;
+
+    for (size_t i = 0; i < vector_size(search->rules); i++)
+    {
+        Rule *rule = vector_get_by_index(search->rules, i);
         for (size_t j = 0; j <= len; j++)
         {
-            if (rule_matches_prefix(rule, (j == 0), word+j, len-j))
+            if (rule_matches_prefix(rule, (j == 0), search->word+j, len-j))
             {
                 int cost = rule_get_cost(rule);
-                vector_push_back(gen->word_rules[cost][len-j], rule);
+                vector_push_back(search->word_rules[cost][len-j], rule);
             }
         }
     }
 }
 
-static void free_word_rules(Hints_Generator *gen, int word_len)
+static void free_word_rules(struct search *search)
 {
-    for (size_t i = 0; i <= gen->max_rule_cost; i++)
+    for (size_t i = 0; i <= search->gen->max_rule_cost; i++)
     {
-        for (size_t j = 0; j <= word_len; j++)
+        for (size_t j = 0; j <= search->len; j++)
         {
-            vector_done(gen->word_rules[i][j]);
+            vector_done(search->word_rules[i][j]);
         }
-        free(gen->word_rules[i]);
+        free(search->word_rules[i]);
     }
-    free(gen->word_rules);
+    free(search->word_rules);
 }
 
-static void add_state(Hints_Generator *gen, State *state)
+/*
+ Odwraca napis w miejscu.
+ */
+static void reverse_string(wchar_t *string)
 {
-    vector_push_back(gen->states, state);
+    size_t len = wcslen(string);
 
-    if (node_is_word(state->node) && state->sufix_len == 0)
+    for (size_t i = 0; i < len / 2; i++)
     {
-        set_insert(gen->hint_states, state);
+        wchar_t tmp = string[i];
+        string[i] = string[len - 1 - i];
+        string[len - 1 - i] = tmp;
+    }
+}
+
+static void add_end(struct segment *seg, Node *node, size_t next, int cost,
+                    bool last)
+{
+    struct segment_end *end = emalloc(sizeof(struct segment_end));
+
+    end->node = node;
+    end->next = next;
+    end->cost = cost;
+    end->last = last;
+
+    vector_push_back(seg->ends, end);
+}
+
+static void add_state(struct search *search, struct segment *seg,
+                      State *state)
+{
+    vector_push_back(seg->states, state);
+
+    if (state->sufix_len == 0 && is_candidate_word(search, state->node))
+    {
+        add_end(seg, state->node, 0, state->cost, true);
     }
 }
 
 /*
- Dodaje stan i jego pochodne.
+ Dodaje stan i jego pochodne. Stany, które nie prowadzą do żadnego
+ kandydata, są od razu usuwane, tak jak gdyby przeszukiwane drzewo
+ zawierało tylko kandydatów.
  */
-static void add_extended_states(Hints_Generator *gen, State *state)
+static void add_extended_states(struct search *search, struct segment *seg,
+                                State *state)
 {
-    add_state(gen, state);
+    if (!is_candidate_prefix(search, state->node)
+        || (!state->expandable && !is_candidate_word(search, state->node)))
+    {
+        state_done(state);
+        return;
+    }
+
+    add_state(search, seg, state);
 
     if (!state->expandable) return;
 
     Node *child;
     while (state->sufix_len > 0
-           && (child = node_get_child(state->node, state->sufix[0])) != NULL)
+           && (child = node_get_child(state->node, state->sufix[0])) != NULL
+           && is_candidate_prefix(search, child))
     {
         state = state_new(child, state->prev, state->sufix+1, state->cost,
                           state->sufix_len-1, state->expandable);
-        add_state(gen, state);
+        add_state(search, seg, state);
     }
 }
 
-static void add_states(Hints_Generator *gen, int cost)
+/*
+ Stosuje reguły o danym koszcie. Zastosowanie reguły z flagą `s` kończy
+ słowo: zamiast stanu zapamiętywany jest koniec słowa i pozycja, od której
+ przeszukiwany jest następny fragment.
+ */
+static void add_states(struct search *search, struct segment *seg, int cost)
 {
-    size_t n_states = vector_size(gen->states);
+    size_t n_states = vector_size(seg->states);
+    size_t len = search->len;
 
     for (size_t i = 0; i < n_states; i++)
     {
-        State *state = vector_get_by_index(gen->states, i);
-        if (state->expandable && cost - state->cost <= gen->max_rule_cost)
+        State *state = vector_get_by_index(seg->states, i);
+        if (state->expandable
+            && cost - state->cost <= search->gen->max_rule_cost)
         {
-            Vector *rules = gen->word_rules[cost - state->cost][state->sufix_len];
+            Vector *rules =
+                search->word_rules[cost - state->cost][state->sufix_len];
             for (size_t j = 0; j < vector_size(rules); j++)
             {
                 Rule *rule = vector_get_by_index(rules, j);
-                Vector *new_states = rule_apply(rule, state, gen->root);
+                Vector *new_states = rule_apply(rule, state, search->root);
                 for (size_t k = 0; k < vector_size(new_states); k++)
                 {
                     State *new_state = vector_get_by_index(new_states, k);
-                    add_extended_states(gen, new_state);
+                    if (rule_get_flag(rule) == RULE_SPLIT)
+                    {
+                        if (is_candidate_word(search, new_state->prev))
+                        {
+                            add_end(seg, new_state->prev,
+                                    len - new_state->sufix_len,
+                                    new_state->cost, false);
+                        }
+                        state_done(new_state);
+                    }
+                    else
+                    {
+                        add_extended_states(search, seg, new_state);
+                    }
                 }
                 vector_done(new_states);
             }
@@ -255,16 +544,16 @@ static void add_states(Hints_Generator *gen, int cost)
     }
 }
 
-static void remove_duplicates(Hints_Generator *gen)
+static void remove_duplicates(struct segment *seg)
 {
     Vector *deduplicated = vector_new(free_state);
 
-    vector_sort(gen->states, compare_state_cost);
+    vector_sort(seg->states, compare_state_cost);
 
     State *cur, *prev = NULL;
-    for (size_t i = 0; i < vector_size(gen->states); i++)
+    for (size_t i = 0; i < vector_size(seg->states); i++)
     {
-        cur = vector_get_by_index(gen->states, i);
+        cur = vector_get_by_index(seg->states, i);
         if (prev != NULL && compare_state(cur, prev) == 0)
         {
             if (prev->expandable == cur->expandable)
@@ -289,46 +578,471 @@ static void remove_duplicates(Hints_Generator *gen)
         }
     }
 
-    vector_done(gen->states);
+    vector_done(seg->states);
+
+    seg->states = deduplicated;
+}
+
+/*
+ Tworzy przeszukiwanie fragmentu słowa od danej pozycji.
+ Stany fragmentu następującego po rozdziale mają ustawiony węzeł
+ poprzedniego słowa na korzeń, co wyklucza reguły z flagą `b`.
+ */
+static struct segment * segment_new(struct search *search, size_t offset,
+                                    bool first)
+{
+    struct segment *seg = emalloc(sizeof(struct segment));
+    Node *root = search->root;
+
+    seg->states = vector_new(free_state);
+    seg->ends = vector_new(free);
+    seg->cost = 0;
+
+    add_extended_states(search, seg,
+                        state_new(root, first ? NULL : root,
+                                  search->word + offset, 0,
+                                  search->len - offset, true));
+    remove_duplicates(seg);
+
+    return seg;
+}
+
+static void segment_done(struct segment *seg)
+{
+    vector_clear(seg->states);
+    vector_done(seg->states);
+    vector_clear(seg->ends);
+    vector_done(seg->ends);
+    free(seg);
+}
+
+/*
+ Przeszukuje stany fragmentu do danego kosztu.
+ */
+static void segment_advance(struct search *search, struct segment *seg,
+                            int cost)
+{
+    while (seg->cost < cost)
+    {
+        seg->cost++;
+        add_states(search, seg, seg->cost);
+        remove_duplicates(seg);
+    }
+}
+
+/*
+ Zwraca fragment zaczynający się po rozdziale na danej pozycji.
+ */
+static struct segment * get_segment(struct search *search, size_t offset)
+{
+    if (search->segments[offset] == NULL)
+    {
+        search->segments[offset] = segment_new(search, offset, false);
+    }
+
+    return search->segments[offset];
+}
+
+static void add_hint(struct search *search, int n_words, int cost)
+{
+    struct hint *hint = emalloc(sizeof(struct hint)
+                                + sizeof(Node*) * n_words);
+
+    hint->cost = cost;
+    hint->n_words = n_words;
+    hint->string = NULL;
+    for (int i = 0; i < n_words; i++) hint->words[i] = search->words[i];
+
+    vector_push_back(search->hints, hint);
+}
+
+/*
+ Zbiera podpowiedzi o koszcie nie większym niż `max_cost`, których kolejne
+ słowa zaczynają się od danego fragmentu.
+ */
+static void collect_hints(struct search *search, struct segment *seg,
+                          int depth, int cost, int max_cost)
+{
+    segment_advance(search, seg, max_cost - cost);
+
+    size_t n_ends = vector_size(seg->ends);
+    for (size_t i = 0; i < n_ends; i++)
+    {
+        struct segment_end *end = vector_get_by_index(seg->ends, i);
+        if (cost + end->cost > max_cost) continue;
+
+        search->words[depth] = end->node;
+
+        if (end->last)
+        {
+            add_hint(search, depth + 1, cost + end->cost);
+        }
+        else if (depth + 1 < search->gen->max_words)
+        {
+            collect_hints(search, get_segment(search, end->next), depth + 1,
+                          cost + end->cost, max_cost);
+        }
+    }
+}
+
+static void free_hint(void *_hint)
+{
+    struct hint *hint = _hint;
+    free(hint->string);
+    free(hint);
+}
+
+/*
+ Zostawia dla każdej podpowiedzi tylko wystąpienie o najmniejszym koszcie.
+ */
+static void remove_duplicate_hints(struct search *search)
+{
+    Vector *deduplicated = vector_new(free_hint);
+
+    vector_sort(search->hints, compare_hint_words);
+
+    struct hint *prev = NULL;
+    for (size_t i = 0; i < vector_size(search->hints); i++)
+    {
+        struct hint *cur = vector_get_by_index(search->hints, i);
+        if (prev != NULL && prev->n_words == cur->n_words
+            && memcmp(prev->words, cur->words,
+                      sizeof(Node*) * cur->n_words) == 0)
+        {
+            free_hint(cur);
+        }
+        else
+        {
+            vector_push_back(deduplicated, cur);
+            prev = cur;
+        }
+    }
 
-    gen->states = deduplicated;
+    vector_done(search->hints);
+    search->hints = deduplicated;
 }
 
 /*
- Zlicza już znalezione podpowiedzi.
+ Zwraca długość słowa kończącego się w węźle.
  */
-static int count_hints(Hints_Generator *gen)
+static size_t word_length(const Node *node)
 {
-    return set_size(gen->hint_states);
+    size_t len = 0;
+
+    for (; node_get_key(node) != L'\0'; node = node_get_parent(node)) len++;
+
+    return len;
 }
 
-static void get_hints(Hints_Generator *gen, struct word_list *list)
+static wchar_t * hint_to_string(const struct hint *hint)
 {
-    Vector *all_hints = vector_new(free_state);
+    size_t len = hint->n_words - 1;
+    for (int i = 0; i < hint->n_words; i++) len += word_length(hint->words[i]);
+
+    wchar_t *string = emalloc(sizeof(wchar_t) * (len + 1));
+    string[len] = L'\0';
 
-    for (size_t i = 0; i < vector_size(gen->states); i++)
+    for (int i = hint->n_words - 1; i >= 0; i--)
     {
-        State *state = vector_get_by_index(gen->states, i);
-        if (!state->ignore && node_is_word(state->node) && state->sufix_len == 0)
+        const Node *node = hint->words[i];
+        for (; node_get_key(node) != L'\0'; node = node_get_parent(node))
         {
-            state->string = state_to_string(state);
-            vector_push_back(all_hints, state);
+            string[--len] = node_get_key(node);
         }
+        if (i > 0) string[--len] = L' ';
+    }
+
+    return string;
+}
+
+static void get_hints(struct search *search, struct word_list *list)
+{
+    for (size_t i = 0; i < vector_size(search->hints); i++)
+    {
+        struct hint *hint = vector_get_by_index(search->hints, i);
+        hint->string = hint_to_string(hint);
+        if (search->reversed) reverse_string(hint->string);
     }
 
-    vector_sort(all_hints, compare_hint_strings);
+    vector_sort(search->hints, compare_hint_strings);
 
-    size_t count = vector_size(all_hints);
+    size_t count = vector_size(search->hints);
     if (count > DICTIONARY_MAX_HINTS) count = DICTIONARY_MAX_HINTS;
     for (size_t i = 0; i < count; i++)
     {
-        State *state = vector_get_by_index(all_hints, i);
-        word_list_add(list, state->string);
+        struct hint *hint = vector_get_by_index(search->hints, i);
+        word_list_add(list, hint->string);
+    }
+}
+
+/*
+ Wiąże reguły z wygenerowanym przez rule-compiler zestawem, jeśli odciski się
+ zgadzają. W p.p. reguły będą interpretowane.
+ */
+static void bind_compiled_rules(Hints_Generator *gen)
+{
+    const Compiled_Rule_Set *set = &compiled_rule_set;
+    bool matches = (gen->compiled_enabled && set != NULL
+                    && set->n_rules == vector_size(gen->rules)
+                    && set->fingerprint == hints_generator_fingerprint(gen));
+
+    for (size_t i = 0; i < vector_size(gen->rules); i++)
+    {
+        bool compiled = matches && set->rules[i].match != NULL;
+        rule_set_compiled(vector_get_by_index(gen->rules, i),
+                          compiled ? &set->rules[i] : NULL);
+    }
+
+    gen->compiled_used = matches;
+    gen->compiled_bound = true;
+}
+
+/*
+ Szuka podpowiedzi programowaniem dynamicznym po pozycjach w słowie.
+ Podpowiedź to ciąg fragmentów: pierwszy zaczyna się na początku słowa,
+ a każdy następny w miejscu rozdziału poprzedniego. Przeszukanie fragmentu
+ zależy tylko od pozycji jego początku, więc jest wykonywane raz i
+ rozszerzane o kolejne koszty tylko w miarę potrzeby.
+ */
+static void search_hints(Hints_Generator *gen, Node *root, Vector *rules,
+                         bool reversed, const struct candidates *candidates,
+                         const wchar_t* word, struct word_list *list)
+{
+    struct search search;
+    size_t len = wcslen(word);
+
+    search.gen = gen;
+    search.root = root;
+    search.rules = rules;
+    search.reversed = reversed;
+    search.candidates = candidates;
+    search.word = word;
+    search.len = len;
+
+    init_word_rules(&search);
+    match_rules_to_word(&search);
+
+    search.first = segment_new(&search, 0, true);
+    search.segments = emalloc(sizeof(struct segment*) * (len + 1));
+    for (size_t i = 0; i <= len; i++) search.segments[i] = NULL;
+    search.words = emalloc(sizeof(Node*) * gen->max_words);
+    search.hints = vector_new(free_hint);
+
+    int k = 0;
+    while (true)
+    {
+        vector_clear(search.hints);
+        collect_hints(&search, search.first, 0, 0, k);
+        remove_duplicate_hints(&search);
+
+        if (vector_size(search.hints) >= DICTIONARY_MAX_HINTS
+            || k >= gen->max_cost) break;
+        k++;
+    }
+
+    get_hints(&search, list);
+
+    vector_clear(search.hints);
+    vector_done(search.hints);
+    free(search.words);
+    for (size_t i = 0; i <= len; i++)
+    {
+        if (search.segments[i] != NULL) segment_done(search.segments[i]);
+    }
+    free(search.segments);
+    segment_done(search.first);
+
+    free_word_rules(&search);
+}
+
+/*
+ Zwraca głębokość, na jaką słowo da się przejść w drzewie bez żadnej zmiany.
+ */
+static size_t anchor_depth(const Node *root, const wchar_t *word, size_t len,
+                           bool reversed)
+{
+    size_t depth = 0;
+
+    while (depth < len)
+    {
+        wchar_t c = reversed ? word[len - 1 - depth] : word[depth];
+        if ((root = node_get_child(root, c)) == NULL) break;
+        depth++;
+    }
+
+    return depth;
+}
+
+/*
+ Sprawdza, czy przeszukiwanie od końca słowa będzie tańsze.
+ Każdy stan o koszcie 0 (ścieżka słowa w drzewie bez zmian) jest
+ rozwijany wszystkimi regułami, a po pierwszej zmianie większość stanów
+ szybko ginie. Wybierany jest więc kierunek, w którym słowo przestaje
+ pasować do drzewa wcześniej.
+ */
+static bool prefer_reversed(const Node *root, const Node *reverse_root,
+                            const wchar_t *word)
+{
+    if (reverse_root == NULL) return false;
+
+    size_t len = wcslen(word);
+
+    return anchor_depth(reverse_root, word, len, true)
+           < anchor_depth(root, word, len, false);
+}
+
+/*
+ Tworzy odwrócone reguły.
+ */
+static void build_reversed_rules(Hints_Generator *gen)
+{
+    gen->reversed_rules = vector_new(free_rule);
+    for (size_t i = 0; i < vector_size(gen->rules); i++)
+    {
+        vector_push_back(gen->reversed_rules,
+                         rule_reversed(vector_get_by_index(gen->rules, i)));
+    }
+}
+
+/*
+ Przeszukuje drzewo odwróconych słów odwróconymi regułami.
+ */
+static void search_reversed_hints(Hints_Generator *gen, Node *reverse_root,
+                                  const wchar_t* word, struct word_list *list)
+{
+    size_t len = wcslen(word);
+    wchar_t reversed_word[len + 1];
+    wcscpy(reversed_word, word);
+    reverse_string(reversed_word);
+
+    search_hints(gen, reverse_root, gen->reversed_rules, true, NULL,
+                 reversed_word, list);
+}
+
+/*
+ Usuwa odwrócone reguły (np. po zmianie reguł).
+ */
+static void clear_reversed_rules(Hints_Generator *gen)
+{
+    if (gen->reversed_rules == NULL) return;
+
+    vector_clear(gen->reversed_rules);
+    vector_done(gen->reversed_rules);
+    gen->reversed_rules = NULL;
+}
+
+/*
+ Wyznacza słowa, które mogą być podpowiedziami, na podstawie indeksu
+ q-gramów i zaznacza ich pozycje w drzewie. Zastosowanie reguły zmienia
+ ciąg co najwyżej `span` znaków słowa, więc psuje co najwyżej
+ span + q - 1 jego q-gramów i zmienia długość słowa o co najwyżej `delta`.
+ Reguł da się zastosować co najwyżej max_cost / min_cost, co ogranicza
+ liczbę brakujących q-gramów i różnicę długości. Podpowiedzi są więc takie
+ same jak przy przeszukiwaniu całego drzewa. Słowa podpowiedzi
+ wielowyrazowych odpowiadają tylko fragmentom słowa, więc z regułami
+ z flagą `s` indeks nie jest używany (zob. hints_generator_uses_qgram()).
+ Zwraca false, jeśli kandydatów nie da się ograniczyć.
+ */
+static bool find_candidates(Hints_Generator *gen, const Node *root,
+                            const wchar_t *word,
+                            struct candidates *candidates)
+{
+    int min_cost = INT_MAX;
+    size_t span = 0, delta = 0;
+    size_t q = qgram_index_q(gen->qgram_index);
+
+    for (size_t i = 0; i < vector_size(gen->rules); i++)
+    {
+        Rule *rule = vector_get_by_index(gen->rules, i);
+        size_t left = wcslen(rule_get_left(rule));
+        size_t right = wcslen(rule_get_right(rule));
+
+        if (rule_get_cost(rule) < min_cost) min_cost = rule_get_cost(rule);
+        if (left > span) span = left;
+        if (right > span) span = right;
+        if (left > right && left - right > delta) delta = left - right;
+        if (right > left && right - left > delta) delta = right - left;
+    }
+
+    // Reguły o zerowym koszcie można stosować dowolnie wiele razy.
+    if (min_cost == 0) return false;
+
+    size_t max_edits = gen->max_cost / min_cost;
+
+    struct word_list list;
+    word_list_init(&list);
+    qgram_index_candidates(gen->qgram_index, word, max_edits * delta,
+                           max_edits * (span + q - 1), &list);
+
+    candidates->capacity = MINIMAL_MARKS_CAPACITY;
+    while (candidates->capacity < 4 * word_list_size(&list))
+        candidates->capacity *= 2;
+    candidates->marks = ecalloc(candidates->capacity, sizeof(struct mark));
+    candidates->size = 0;
+
+    const wchar_t * const *a = word_list_get(&list);
+    size_t longest = 0;
+    for (size_t i = 0; i < word_list_size(&list); i++)
+    {
+        size_t len = wcslen(a[i]);
+        if (len > longest) longest = len;
+    }
+
+    // Pozycje są zaznaczane przy schodzeniu od korzenia, bo wskaźniki
+    // na ojców w nakładce mogą prowadzić do węzłów drzewa bazowego.
+    // Początek ścieżki wspólny z poprzednim kandydatem jest już przebyty.
+    const Node *path[longest + 1];
+    const wchar_t *prev = L"";
+    size_t depth = 0;
+
+    path[0] = root;
+    add_mark(candidates, root);
+    for (size_t i = 0; i < word_list_size(&list); i++)
+    {
+        const wchar_t *w = a[i];
+        size_t common = 0;
+        while (common < depth && w[common] == prev[common]) common++;
+
+        for (depth = common; w[depth] != L'\0'; depth++)
+        {
+            const Node *child = node_get_child(path[depth], w[depth]);
+            if (child == NULL) break;
+
+            path[depth + 1] = child;
+            add_mark(candidates, child);
+        }
 
-        free(state->string);
+        if (w[depth] == L'\0' && node_is_word(path[depth]))
+            add_mark(candidates, path[depth])->word = true;
+        prev = w;
     }
 
-    vector_done(all_hints);
+    word_list_done(&list);
+
+    return true;
+}
+
+/*
+ Usuwa kandydatów na podpowiedzi.
+ */
+static void candidates_done(struct candidates *candidates)
+{
+    free(candidates->marks);
+}
+
+/*
+ Sprawdza, czy generator ma reguły z flagą `s`, tworzące podpowiedzi
+ wielowyrazowe.
+ */
+static bool has_split_rules(const Hints_Generator *gen)
+{
+    for (size_t i = 0; i < vector_size(gen->rules); i++)
+    {
+        if (rule_get_flag(vector_get_by_index(gen->rules, i)) == RULE_SPLIT)
+            return true;
+    }
+
+    return false;
 }
 
 /*
@@ -369,52 +1083,123 @@ Hints_Generator * hints_generator_new()
     gen->max_rule_cost = 0;
     gen->root = NULL;
     gen->rules = vector_new(free_rule);
-    gen->states = NULL;
+    gen->max_words = DICTIONARY_MAX_HINT_WORDS;
+    gen->compiled_bound = false;
+    gen->compiled_enabled = true;
+    gen->compiled_used = false;
+    gen->qgram_index = NULL;
+    gen->qgram_threshold = 0;
+    gen->reverse_root = NULL;
+    gen->reversed_rules = NULL;
+    pthread_mutex_init(&gen->lock, NULL);
 
     return gen;
 }
 
 void hints_generator_done(Hints_Generator *gen)
 {
+    clear_reversed_rules(gen);
     vector_clear(gen->rules);
     vector_done(gen->rules);
+    pthread_mutex_destroy(&gen->lock);
     free(gen);
 }
 
+Hints_Generator * hints_generator_copy(const Hints_Generator *gen)
+{
+    Hints_Generator *copy = hints_generator_new();
+
+    copy->max_cost = gen->max_cost;
+    copy->max_words = gen->max_words;
+    copy->compiled_enabled = gen->compiled_enabled;
+
+    for (size_t i = 0; i < vector_size(gen->rules); i++)
+    {
+        Rule *rule = vector_get_by_index(gen->rules, i);
+        hints_generator_rule_add(copy, rule_new(rule_get_left(rule),
+                                                rule_get_right(rule),
+                                                rule_get_cost(rule),
+                                                rule_get_flag(rule)));
+    }
+
+    return copy;
+}
+
 void hints_generator_set_root(Hints_Generator *gen, Node *root)
 {
     gen->root = root;
 }
 
+void hints_generator_set_reverse_root(Hints_Generator *gen, Node *root)
+{
+    gen->reverse_root = root;
+}
+
+void hints_generator_set_qgram_index(Hints_Generator *gen, Qgram_Index *index)
+{
+    gen->qgram_index = index;
+}
+
+int hints_generator_qgram_threshold(Hints_Generator *gen, int threshold)
+{
+    int old_threshold = gen->qgram_threshold;
+    gen->qgram_threshold = threshold;
+    return old_threshold;
+}
+
+bool hints_generator_uses_qgram(const Hints_Generator *gen)
+{
+    return gen->qgram_index != NULL
+           && gen->qgram_threshold > 0
+           && gen->max_cost > gen->qgram_threshold
+           && vector_size(gen->rules) > 0
+           && !(gen->max_words > 1 && has_split_rules(gen));
+}
+
 void hints_generator_hints(Hints_Generator *gen, const wchar_t* word,
                            struct word_list *list)
 {
-    int len = wcslen(word);
-    init_word_rules(gen, len);
-    match_rules_to_word(gen, word);
+    hints_generator_hints_from(gen, gen->root, gen->reverse_root, word, list);
+}
 
-    gen->states = vector_new(free_state);
-    gen->hint_states = set_new(compare_hint_states, free_state);
+void hints_generator_hints_from(Hints_Generator *gen, Node *root,
+                                Node *reverse_root, const wchar_t* word,
+                                struct word_list *list)
+{
+    pthread_mutex_lock(&gen->lock);
+    if (!gen->compiled_bound) bind_compiled_rules(gen);
+    if (reverse_root != NULL && gen->reversed_rules == NULL)
+    {
+        build_reversed_rules(gen);
+    }
+    pthread_mutex_unlock(&gen->lock);
 
-    add_extended_states(gen, state_new(gen->root, NULL, word, 0, len, true));
-    remove_duplicates(gen);
+    if (!hints_generator_uses_qgram(gen))
+    {
+        if (prefer_reversed(root, reverse_root, word))
+            search_reversed_hints(gen, reverse_root, word, list);
+        else search_hints(gen, root, gen->rules, false, NULL, word, list);
+        return;
+    }
 
-    int k = 1;
-    while (count_hints(gen) < DICTIONARY_MAX_HINTS
-           && k <= gen->max_cost)
+    // Przeszukiwane jest drzewo słownika, ale tylko ścieżki kandydatów.
+    struct candidates candidates;
+    if (!find_candidates(gen, root, word, &candidates))
     {
-        add_states(gen, k);
-        remove_duplicates(gen);
-        k++;
+        search_hints(gen, root, gen->rules, false, NULL, word, list);
+        return;
     }
 
-    get_hints(gen, list);
+    search_hints(gen, root, gen->rules, false, &candidates, word, list);
 
-    set_done(gen->hint_states);
-    vector_clear(gen->states);
-    vector_done(gen->states);
+    candidates_done(&candidates);
+}
 
-    free_word_rules(gen, len);
+int hints_generator_max_words(Hints_Generator *gen, int max_words)
+{
+    int old_max_words = gen->max_words;
+    gen->max_words = max_words > 0 ? max_words : 1;
+    return old_max_words;
 }
 
 int hints_generator_max_cost(Hints_Generator *gen, int new_cost)
@@ -427,13 +1212,17 @@ int hints_generator_max_cost(Hints_Generator *gen, int new_cost)
 void hints_generator_rule_clear(Hints_Generator *gen)
 {
     vector_clear(gen->rules);
+    clear_reversed_rules(gen);
 
     gen->max_rule_cost = 0;
+    gen->compiled_bound = false;
 }
 
 void hints_generator_rule_add(Hints_Generator *gen, Rule *rule)
 {
     vector_push_back(gen->rules, rule);
+    clear_reversed_rules(gen);
+    gen->compiled_bound = false;
 
     if (rule_get_cost(rule) > gen->max_rule_cost)
     {
@@ -441,6 +1230,41 @@ void hints_generator_rule_add(Hints_Generator *gen, Rule *rule)
     }
 }
 
+size_t hints_generator_rule_count(const Hints_Generator *gen)
+{
+    return vector_size(gen->rules);
+}
+
+Rule * hints_generator_rule_get(const Hints_Generator *gen, size_t index)
+{
+    return vector_get_by_index(gen->rules, index);
+}
+
+bool hints_generator_compiled_rules(Hints_Generator *gen, bool enabled)
+{
+    pthread_mutex_lock(&gen->lock);
+    if (!gen->compiled_bound) bind_compiled_rules(gen);
+    bool was_used = gen->compiled_used;
+
+    gen->compiled_enabled = enabled;
+    bind_compiled_rules(gen);
+    pthread_mutex_unlock(&gen->lock);
+
+    return was_used;
+}
+
+uint64_t hints_generator_fingerprint(const Hints_Generator *gen)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (size_t i = 0; i < vector_size(gen->rules); i++)
+    {
+        hash = rule_fingerprint(vector_get_by_index(gen->rules, i), hash);
+    }
+
+    return hash;
+}
+
 int hints_generator_save(const Hints_Generator *gen, IO *io)
 {
     if (io_printf(io, L"%d\n", gen->max_cost) < 0) return -1;
@@ -455,33 +1279,42 @@ int hints_generator_save(const Hints_Generator *gen, IO *io)
     return 0;
 }
 
-Hints_Generator * hints_generator_load(IO *io)
+int hints_generator_load_rules(Hints_Generator *gen, IO *io)
 {
     int cost = -1;
     wint_t c;
     while ((c = io_get_next(io)) != L'\n' && c != WEOF)
     {
-        if (!is_decimal(c)) return NULL;
+        if (!is_decimal(c)) return -1;
         if (cost == -1) cost = 0;
         cost *= 10;
         cost += decimal_to_int(c);
     }
-    if (cost == -1) return NULL;
+    if (cost == -1) return -1;
 
-    Hints_Generator *gen = hints_generator_new();
+    hints_generator_rule_clear(gen);
     hints_generator_max_cost(gen, cost);
 
     while (io_peek_next(io) != WEOF)
     {
         Rule *rule = rule_load(io);
-        if (!rule)
-        {
-            hints_generator_done(gen);
-            return NULL;
-        }
+        if (!rule) return -1;
         hints_generator_rule_add(gen, rule);
     }
 
+    return 0;
+}
+
+Hints_Generator * hints_generator_load(IO *io)
+{
+    Hints_Generator *gen = hints_generator_new();
+
+    if (hints_generator_load_rules(gen, io) < 0)
+    {
+        hints_generator_done(gen);
+        return NULL;
+    }
+
     return gen;
 }
 
@@ -13,6 +13,8 @@
 #include "rule.h"
 #include "node.h"
 #include "word_list.h"
+#include "qgram_index.h"
+#include <stdint.h>
 
 /**
   Struktura przechowująca regułę.
@@ -32,6 +34,16 @@ Hints_Generator * hints_generator_new();
   */
 void hints_generator_done(Hints_Generator *gen);
 
+/**
+  Tworzy generator z takimi samymi regułami, maksymalnym kosztem
+  i maksymalną liczbą słów w podpowiedzi.
+  Korzenie drzew i indeks q-gramów nie są kopiowane.
+  Należy go zniszczyć za pomocą hints_generator_done()
+  @param[in] gen Generator podpowiedzi.
+  @return Nowy generator podpowiedzi.
+  */
+Hints_Generator * hints_generator_copy(const Hints_Generator *gen);
+
 /**
   Ustawia wierzchołek od którego zaczynają się podpowiedzi.
   @param[in,out] gen Generator podpowiedzi.
@@ -47,11 +59,60 @@ void hints_generator_set_root(Hints_Generator *gen, Node *root);
   */
 int hints_generator_max_cost(Hints_Generator *gen, int new_cost);
 
+/**
+  Ustawia maksymalną liczbę słów w podpowiedzi.
+  Słowa podpowiedzi powstają przez zastosowanie reguł z flagą `s`.
+  @param[in,out] gen Generator podpowiedzi.
+  @param[in] max_words Nowa maksymalna liczba słów (co najmniej 1).
+  @return Zwraca dotychczasową maksymalną liczbę słów.
+  */
+int hints_generator_max_words(Hints_Generator *gen, int max_words);
+
+/**
+  Ustawia korzeń drzewa odwróconych słów.
+  Jeśli jest ustawiony, dla każdego słowa wybierany jest kierunek
+  przeszukiwania: od początku słowa w zwykłym drzewie albo od końca słowa
+  w drzewie odwróconych słów. Podpowiedzi nie zależą od kierunku.
+  @param[in,out] gen Generator podpowiedzi.
+  @param[in] root Korzeń drzewa odwróconych słów lub NULL.
+  */
+void hints_generator_set_reverse_root(Hints_Generator *gen, Node *root);
+
+/**
+  Ustawia indeks q-gramów słownika, z którego są brani kandydaci na
+  podpowiedzi przy dużym maksymalnym koszcie.
+  Generator nie przejmuje indeksu na własność.
+  @param[in,out] gen Generator podpowiedzi.
+  @param[in] index Indeks q-gramów lub NULL.
+  */
+void hints_generator_set_qgram_index(Hints_Generator *gen, Qgram_Index *index);
+
+/**
+  Ustawia próg kosztu, powyżej którego podpowiedzi są generowane z użyciem
+  indeksu q-gramów. Wartość 0 wyłącza korzystanie z indeksu.
+  @param[in,out] gen Generator podpowiedzi.
+  @param[in] threshold Nowy próg.
+  @return Dotychczasowy próg.
+  */
+int hints_generator_qgram_threshold(Hints_Generator *gen, int threshold);
+
+/**
+  Sprawdza, czy dla bieżącego maksymalnego kosztu generator korzysta
+  z indeksu q-gramów. Indeks ogranicza tylko słowa podobne do całego
+  szukanego słowa, więc nie jest używany, gdy reguły z flagą `s` mogą
+  tworzyć podpowiedzi wielowyrazowe.
+  @param[in] gen Generator podpowiedzi.
+  @return Czy generator korzysta z indeksu q-gramów.
+  */
+bool hints_generator_uses_qgram(const Hints_Generator *gen);
+
 /**
   Tworzy możliwe podpowiedzi dla zadanego słowa.
   Jeżeli pojedyncza podpowiedź składa się z kilku słów,
   wtedy powinien być to jeden łańcuch znaków,
   w którym słowa są pooddzielane pojedynczymi spacjami.
+  Funkcję można wywoływać jednocześnie z wielu wątków, o ile w tym czasie
+  generator, reguły ani drzewo nie są modyfikowane.
   @param[in] gen Generator podpowiedzi.
   @param[in] word Szukane słowo.
   @param[in,out] list Lista, w której zostaną umieszczone podpowiedzi.
@@ -59,6 +120,21 @@ int hints_generator_max_cost(Hints_Generator *gen, int new_cost);
 void hints_generator_hints(Hints_Generator *gen, const wchar_t* word,
                            struct word_list *list);
 
+/**
+  Tworzy możliwe podpowiedzi dla zadanego słowa w podanych drzewach
+  zamiast ustawionych w generatorze.
+  Pozwala szukać w migawce drzewa, którego korzeń zmienia się przy
+  modyfikacjach.
+  @param[in] gen Generator podpowiedzi.
+  @param[in] root Korzeń drzewa słów.
+  @param[in] reverse_root Korzeń drzewa odwróconych słów lub NULL.
+  @param[in] word Szukane słowo.
+  @param[in,out] list Lista, w której zostaną umieszczone podpowiedzi.
+  */
+void hints_generator_hints_from(Hints_Generator *gen, Node *root,
+                                Node *reverse_root, const wchar_t* word,
+                                struct word_list *list);
+
 /**
   Usuwa wszystkie reguły.
   @param[in,out] gen Generator podpowiedzi.
@@ -72,6 +148,40 @@ void hints_generator_rule_clear(Hints_Generator *gen);
   */
 void hints_generator_rule_add(Hints_Generator *gen, Rule *rule);
 
+/**
+  Zwraca liczbę reguł generatora.
+  @param[in] gen Generator podpowiedzi.
+  @return Liczba reguł.
+  */
+size_t hints_generator_rule_count(const Hints_Generator *gen);
+
+/**
+  Zwraca regułę o danym indeksie.
+  @param[in] gen Generator podpowiedzi.
+  @param[in] index Indeks reguły.
+  @return Reguła.
+  */
+Rule * hints_generator_rule_get(const Hints_Generator *gen, size_t index);
+
+/**
+  Zwraca odcisk zestawu reguł.
+  Odcisk zależy od reguł i ich kolejności, ale nie od maksymalnego kosztu.
+  @param[in] gen Generator podpowiedzi.
+  @return Odcisk reguł.
+  */
+uint64_t hints_generator_fingerprint(const Hints_Generator *gen);
+
+/**
+  Włącza lub wyłącza wykonywanie reguł przez kod wygenerowany przez
+  rule-compiler (zob. compiled_rules.h). Domyślnie jest włączone, ale
+  reguły są wykonywane przez ten kod tylko wtedy, gdy odcisk dołączonego
+  do programu zestawu reguł zgadza się z odciskiem reguł generatora.
+  @param[in,out] gen Generator podpowiedzi.
+  @param[in] enabled Czy kod reguł ma być używany.
+  @return Czy reguły były dotychczas wykonywane przez wygenerowany kod.
+  */
+bool hints_generator_compiled_rules(Hints_Generator *gen, bool enabled);
+
 /**
   Zapisuje generator podpowiedzi.
   @param[in] gen Generator podpowiedzi.
@@ -80,6 +190,15 @@ void hints_generator_rule_add(Hints_Generator *gen, Rule *rule);
  */
 int hints_generator_save(const Hints_Generator *gen, IO *io);
 
+/**
+  Wczytuje maksymalny koszt i reguły zapisane przez hints_generator_save()
+  do istniejącego generatora, zastępując jego reguły.
+  @param[in,out] gen Generator podpowiedzi.
+  @param[in,out] io We/wy.
+  @return <0 jeśli operacja się nie powiedzie, 0 w p.p.
+  */
+int hints_generator_load_rules(Hints_Generator *gen, IO *io);
+
 /**
   Inicjuje i wczytuje generator podpowiedzi.
   Regułę tę należy zniszczyć za pomocą hints_generator_done().
@@ -0,0 +1,267 @@
+/** @file
+    Implementacja obrazu słownika współdzielonego między procesami.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#include "image.h"
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+  Wersja formatu obrazu.
+  Obraz zapisany na maszynie o innej kolejności bajtów ma inną wersję.
+  */
+#define IMAGE_VERSION 1
+
+/**
+  Bit liczby dzieci oznaczający, że w węźle kończy się słowo.
+  */
+#define IMAGE_WORD (UINT32_C(1) << 31)
+
+/**
+  Początek pliku obrazu.
+  */
+static const char image_magic[8] = "DICTIMG";
+
+/**
+  Nagłówek pliku obrazu.
+  */
+struct image_header
+{
+    /// Napis identyfikujący plik obrazu.
+    char magic[8];
+    /// Wersja formatu.
+    uint32_t version;
+    /// Liczba węzłów.
+    uint32_t n_nodes;
+};
+
+/**
+  Węzeł obrazu.
+  */
+struct image_node
+{
+    /// Znak węzła.
+    uint32_t key;
+    /// Indeks pierwszego dziecka.
+    uint32_t first_child;
+    /// Liczba dzieci i bit IMAGE_WORD.
+    uint32_t children;
+};
+
+/**
+  Struktura przechowująca dołączony obraz.
+  */
+struct image
+{
+    /// Zmapowany plik.
+    void *data;
+    /// Rozmiar zmapowanego pliku.
+    size_t size;
+    /// Węzły; korzeń ma indeks 0.
+    const struct image_node *nodes;
+    /// Liczba węzłów.
+    uint32_t n_nodes;
+};
+
+/** @name Funkcje pomocnicze
+  @{
+  */
+
+/**
+  Zlicza węzły poddrzewa.
+  @param[in] node Korzeń poddrzewa.
+  @return Liczba węzłów.
+  */
+static size_t count_nodes(const Node *node)
+{
+    size_t count = 1;
+
+    for (int i = 0; i < node_children_count(node); i++)
+        count += count_nodes(node_get_child_by_index(node, i));
+
+    return count;
+}
+
+/**
+  Zamienia drzewo na tablicę węzłów ułożonych wszerz.
+  @param[in] root Korzeń drzewa.
+  @param[in] n_nodes Liczba węzłów drzewa.
+  @return Tablica węzłów (do zwolnienia przez free()) lub NULL.
+  */
+static struct image_node * flatten(const Node *root, size_t n_nodes)
+{
+    struct image_node *nodes = malloc(n_nodes * sizeof(struct image_node));
+    const Node **order = malloc(n_nodes * sizeof(Node *));
+    if (!nodes || !order)
+    {
+        free(nodes);
+        free(order);
+        return NULL;
+    }
+
+    // Tablica `order` jest zarazem kolejką przeszukiwania wszerz.
+    size_t tail = 1;
+    order[0] = root;
+
+    for (size_t head = 0; head < n_nodes; head++)
+    {
+        const Node *node = order[head];
+        int n_children = node_children_count(node);
+
+        nodes[head].key = node_get_key(node);
+        nodes[head].first_child = tail;
+        nodes[head].children = n_children;
+        if (node_is_word(node)) nodes[head].children |= IMAGE_WORD;
+
+        for (int i = 0; i < n_children; i++)
+            order[tail++] = node_get_child_by_index(node, i);
+    }
+
+    free(order);
+    return nodes;
+}
+
+/**
+  Szuka dziecka węzła o danym znaku.
+  @param[in] image Obraz.
+  @param[in] node Węzeł.
+  @param[in] c Znak.
+  @return Dziecko lub NULL, jeśli nie istnieje.
+  */
+static const struct image_node * find_child(const Image *image,
+                                            const struct image_node *node,
+                                            wchar_t c)
+{
+    uint32_t lo = node->first_child;
+    uint32_t hi = lo + (node->children & ~IMAGE_WORD);
+
+    // Uszkodzony obraz nie może wyprowadzić poza zmapowany plik.
+    if (hi > image->n_nodes || hi < lo) return NULL;
+
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        uint32_t key = image->nodes[mid].key;
+
+        if (key == (uint32_t) c) return &image->nodes[mid];
+        if (key < (uint32_t) c) lo = mid + 1;
+        else hi = mid;
+    }
+
+    return NULL;
+}
+
+/**@}*/
+/** @name Elementy interfejsu
+  @{
+  */
+
+int image_publish(const Node *root, const char *path)
+{
+    size_t n_nodes = count_nodes(root);
+    if (n_nodes > UINT32_MAX / 2) return -1;
+
+    struct image_node *nodes = flatten(root, n_nodes);
+    if (!nodes) return -1;
+
+    struct image_header header;
+    memcpy(header.magic, image_magic, sizeof(header.magic));
+    header.version = IMAGE_VERSION;
+    header.n_nodes = n_nodes;
+
+    char tmp_path[strlen(path) + 5];
+    strcpy(tmp_path, path);
+    strcat(tmp_path, ".tmp");
+
+    int ret = -1;
+    FILE *f = fopen(tmp_path, "w");
+    if (f)
+    {
+        if (fwrite(&header, sizeof(header), 1, f) == 1
+            && fwrite(nodes, sizeof(struct image_node), n_nodes, f) == n_nodes)
+            ret = 0;
+        if (fclose(f) != 0) ret = -1;
+
+        if (ret == 0 && rename(tmp_path, path) != 0) ret = -1;
+        if (ret < 0) unlink(tmp_path);
+    }
+
+    free(nodes);
+    return ret;
+}
+
+Image * image_attach(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size >= sizeof(struct image_header))
+        data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) return NULL;
+
+    const struct image_header *header = data;
+    if (memcmp(header->magic, image_magic, sizeof(header->magic)) != 0
+        || header->version != IMAGE_VERSION || header->n_nodes == 0
+        || st.st_size != sizeof(struct image_header)
+                         + (size_t) header->n_nodes
+                           * sizeof(struct image_node))
+    {
+        munmap(data, st.st_size);
+        return NULL;
+    }
+
+    Image *image = malloc(sizeof(Image));
+    if (!image)
+    {
+        fprintf(stderr, "Failed to allocate memory for image\n");
+        exit(EXIT_FAILURE);
+    }
+
+    image->data = data;
+    image->size = st.st_size;
+    image->nodes = (const struct image_node *) (header + 1);
+    image->n_nodes = header->n_nodes;
+
+    return image;
+}
+
+void image_detach(Image *image)
+{
+    munmap(image->data, image->size);
+    free(image);
+}
+
+bool image_has_word(const Image *image, const wchar_t *word)
+{
+    const struct image_node *node = &image->nodes[0];
+
+    for (; *word != L'\0'; word++)
+    {
+        node = find_child(image, node, *word);
+        if (node == NULL) return false;
+    }
+
+    return (node->children & IMAGE_WORD) != 0;
+}
+
+size_t image_node_count(const Image *image)
+{
+    return image->n_nodes;
+}
+
+/**@}*/
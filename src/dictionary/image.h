@@ -0,0 +1,76 @@
+/** @file
+    Interfejs obrazu słownika współdzielonego między procesami.
+
+    Obraz to plik zawierający drzewo słownika w postaci tablicy węzłów
+    tylko do odczytu, w której zamiast wskaźników są indeksy. Węzły są
+    zapisane wszerz, więc dzieci każdego węzła zajmują spójny przedział
+    posortowany według znaków. Obraz jest mapowany w pamięci
+    (MAP_SHARED), więc wszystkie procesy, które go dołączyły, korzystają
+    z tych samych stron pamięci fizycznej, a dołączenie nie wymaga
+    wczytywania słownika. Plik umieszczony w `/dev/shm` jest nazwanym
+    segmentem pamięci współdzielonej.
+
+    Obraz pozwala tylko sprawdzać, czy słowo jest w słowniku; do
+    wyznaczania podpowiedzi potrzebny jest wczytany słownik.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#ifndef __IMAGE_H__
+#define __IMAGE_H__
+
+#include "node.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <wchar.h>
+
+/**
+  Struktura przechowująca dołączony obraz.
+  */
+typedef struct image Image;
+
+/**
+  Zapisuje obraz drzewa do pliku.
+  Obraz jest najpierw zapisywany do pliku tymczasowego, a potem
+  przemianowywany, więc procesy, które dołączyły poprzedni obraz, nadal
+  mogą z niego korzystać.
+  @param[in] root Korzeń drzewa.
+  @param[in] path Ścieżka pliku obrazu.
+  @return <0 jeśli operacja się nie powiedzie, 0 w p.p.
+  */
+int image_publish(const Node *root, const char *path);
+
+/**
+  Dołącza obraz zapisany w pliku.
+  Obraz należy odłączyć za pomocą image_detach().
+  @param[in] path Ścieżka pliku obrazu.
+  @return Obraz lub NULL, jeśli plik nie istnieje lub nie jest obrazem.
+  */
+Image * image_attach(const char *path);
+
+/**
+  Odłącza obraz.
+  @param[in,out] image Obraz.
+  */
+void image_detach(Image *image);
+
+/**
+  Sprawdza, czy obraz zawiera dane słowo.
+  Funkcję można wywoływać jednocześnie z wielu wątków.
+  @param[in] image Obraz.
+  @param[in] word Sprawdzane słowo.
+  @return Wartość logiczna określająca czy słowo istnieje.
+  */
+bool image_has_word(const Image *image, const wchar_t *word);
+
+/**
+  Zwraca liczbę węzłów obrazu.
+  @param[in] image Obraz.
+  @return Liczba węzłów (razem z korzeniem).
+  */
+size_t image_node_count(const Image *image);
+
+#endif /* __IMAGE_H__ */
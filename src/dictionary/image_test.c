@@ -0,0 +1,123 @@
+/** @file
+    Testy obrazu słownika.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwerstet Warszawski
+    @date 2026-10-19
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <cmocka.h>
+#include <locale.h>
+#include "image.c"
+#include "trie.h"
+#include "utils.h"
+
+/**
+  Ścieżka pliku obrazu używanego w testach.
+  */
+static char image_path[] = "/tmp/image_testXXXXXX";
+
+/**
+  Testuje publikowanie i dołączanie obrazu.
+  @param state Środowisko testowe.
+  */
+static void image_publish_test(void** state)
+{
+    Trie *trie = trie_new();
+    wchar_t *words[] = {L"wątły", L"wątlejszy", L"łódka", L"a"};
+
+    for (size_t i = 0; i < 4; i++) trie_insert_word(trie, words[i]);
+
+    assert_int_equal(image_publish(trie_get_root(trie), image_path), 0);
+
+    Image *image = image_attach(image_path);
+    assert_non_null(image);
+    assert_int_equal(image_node_count(image),
+                     count_nodes(trie_get_root(trie)));
+
+    for (size_t i = 0; i < 4; i++)
+        assert_true(image_has_word(image, words[i]));
+
+    assert_false(image_has_word(image, L""));
+    assert_false(image_has_word(image, L"wąt"));
+    assert_false(image_has_word(image, L"łódki"));
+    assert_false(image_has_word(image, L"wątłyy"));
+
+    image_detach(image);
+    trie_done(trie);
+}
+
+/**
+  Testuje podmianę obrazu przy dołączonym poprzednim.
+  @param state Środowisko testowe.
+  */
+static void image_republish_test(void** state)
+{
+    Trie *trie = trie_new();
+    trie_insert_word(trie, L"kot");
+    assert_int_equal(image_publish(trie_get_root(trie), image_path), 0);
+
+    Image *old = image_attach(image_path);
+    assert_non_null(old);
+
+    trie_insert_word(trie, L"pies");
+    assert_int_equal(image_publish(trie_get_root(trie), image_path), 0);
+
+    Image *image = image_attach(image_path);
+    assert_non_null(image);
+
+    assert_true(image_has_word(old, L"kot"));
+    assert_false(image_has_word(old, L"pies"));
+    assert_true(image_has_word(image, L"pies"));
+
+    image_detach(old);
+    image_detach(image);
+    trie_done(trie);
+}
+
+/**
+  Testuje dołączanie plików niebędących obrazami.
+  @param state Środowisko testowe.
+  */
+static void image_attach_invalid_test(void** state)
+{
+    assert_null(image_attach("/nonexistent/image"));
+
+    FILE *f = fopen(image_path, "w");
+    fprintf(f, "DICTIMG but not an image");
+    fclose(f);
+    assert_null(image_attach(image_path));
+
+    f = fopen(image_path, "w");
+    fclose(f);
+    assert_null(image_attach(image_path));
+}
+
+/**
+  Główna funkcja uruchamiająca testy.
+  */
+int main(void)
+{
+    setlocale(LC_ALL, "pl_PL.UTF-8");
+
+    int fd = mkstemp(image_path);
+    if (fd < 0) return EXIT_FAILURE;
+    close(fd);
+
+    const struct CMUnitTest tests[] =
+    {
+        cmocka_unit_test(image_publish_test),
+        cmocka_unit_test(image_republish_test),
+        cmocka_unit_test(image_attach_invalid_test),
+    };
+
+    int ret = cmocka_run_group_tests(tests, NULL, NULL);
+    unlink(image_path);
+
+    return ret;
+}
@@ -0,0 +1,338 @@
+/** @file
+    Implementacja dziennika zmian dopisywanego na koniec pliku.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#include "journal.h"
+#include "io.h"
+#include <errno.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+  Liczba rekordów, po których dopisaniu dziennik jest utrwalany na dysku.
+  */
+#define JOURNAL_SYNC_RECORDS 64
+
+/**
+  Początkowa długość bufora na wczytywany rekord.
+  */
+#define MINIMAL_RECORD_CAPACITY 64
+
+/**
+  Przyrostek pliku tymczasowego, do którego przepisywane są rekordy
+  dopisane po punkcie kontrolnym.
+  */
+#define TEMPORARY_SUFFIX ".tmp"
+
+/**
+  Rozmiar bufora przy przepisywaniu rekordów.
+  */
+#define COPY_BUFFER_SIZE 4096
+
+/**
+  Struktura przechowująca dziennik.
+  */
+struct journal
+{
+    /// Ścieżka pliku.
+    char *path;
+    /// Plik otwarty do dopisywania (NULL przed pierwszym rekordem).
+    FILE *file;
+    /// Liczba rekordów w dzienniku.
+    size_t n_records;
+    /// Liczba rekordów dopisanych od ostatniego utrwalenia.
+    size_t n_unsynced;
+    /// Czy któryś zapis od ostatniego utrwalenia się nie powiódł.
+    bool failed;
+    /// Rozmiar pliku w punkcie kontrolnym (-1, jeśli go nie ma).
+    long checkpoint;
+    /// Liczba rekordów przed punktem kontrolnym.
+    size_t checkpoint_records;
+};
+
+/** @name Funkcje pomocnicze
+  @{
+  */
+
+/**
+  Otwiera plik dziennika do dopisywania, jeśli nie jest jeszcze otwarty.
+  @param[in,out] journal Dziennik.
+  @return 0, jeśli się udało, -1 w p.p.
+  */
+static int open_for_append(Journal *journal)
+{
+    if (journal->file != NULL) return 0;
+
+    journal->file = fopen(journal->path, "a");
+
+    return journal->file != NULL ? 0 : -1;
+}
+
+/**
+  Zamyka plik dziennika, jeśli jest otwarty.
+  @param[in,out] journal Dziennik.
+  @return 0, jeśli się udało, -1 w p.p.
+  */
+static int close_file(Journal *journal)
+{
+    if (journal->file == NULL) return 0;
+
+    int ret = fclose(journal->file);
+    journal->file = NULL;
+
+    return ret == 0 ? 0 : -1;
+}
+
+/**
+  Wczytuje rekord do końca linii.
+  @param[in,out] io Wejście.
+  @param[in,out] record Bufor na rekord, powiększany w razie potrzeby.
+  @param[in,out] capacity Pojemność bufora.
+  @return Długość rekordu lub -1, jeśli linia nie ma końca.
+  */
+static long read_record(IO *io, wchar_t **record, size_t *capacity)
+{
+    size_t len = 0;
+    wint_t c;
+
+    while ((c = io_get_next(io)) != L'\n')
+    {
+        if (c == WEOF) return -1;
+
+        if (len + 1 >= *capacity)
+        {
+            *capacity = *capacity > 0 ? 2 * *capacity
+                                      : MINIMAL_RECORD_CAPACITY;
+            *record = realloc(*record, *capacity * sizeof(wchar_t));
+            if (!*record)
+            {
+                fprintf(stderr, "Failed to allocate memory for journal\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        (*record)[len++] = c;
+    }
+
+    if (*capacity == 0)
+    {
+        *capacity = MINIMAL_RECORD_CAPACITY;
+        *record = malloc(*capacity * sizeof(wchar_t));
+        if (!*record)
+        {
+            fprintf(stderr, "Failed to allocate memory for journal\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    (*record)[len] = L'\0';
+
+    return len;
+}
+
+/**
+  Przepisuje rekordy dopisane po punkcie kontrolnym do nowego pliku
+  dziennika, który zastępuje stary.
+  @param[in] journal Dziennik z zamkniętym plikiem.
+  @return 0, jeśli się udało, -1 w p.p.
+  */
+static int copy_after_checkpoint(const Journal *journal)
+{
+    char tmp_path[strlen(journal->path) + strlen(TEMPORARY_SUFFIX) + 1];
+    char buffer[COPY_BUFFER_SIZE];
+    int ret = 0;
+
+    strcpy(tmp_path, journal->path);
+    strcat(tmp_path, TEMPORARY_SUFFIX);
+
+    FILE *in = fopen(journal->path, "r");
+    if (!in) return -1;
+    FILE *out = fopen(tmp_path, "w");
+    if (!out)
+    {
+        fclose(in);
+        return -1;
+    }
+
+    if (fseek(in, journal->checkpoint, SEEK_SET) != 0) ret = -1;
+    while (ret == 0)
+    {
+        size_t n = fread(buffer, 1, COPY_BUFFER_SIZE, in);
+        if (n > 0 && fwrite(buffer, 1, n, out) != n) ret = -1;
+        if (n < COPY_BUFFER_SIZE) break;
+    }
+    if (ferror(in)) ret = -1;
+    if (ret == 0 && (fflush(out) != 0 || fsync(fileno(out)) != 0)) ret = -1;
+    if (fclose(out) != 0) ret = -1;
+    fclose(in);
+
+    if (ret == 0 && rename(tmp_path, journal->path) != 0) ret = -1;
+    if (ret < 0) unlink(tmp_path);
+
+    return ret;
+}
+
+/**@}*/
+/** @name Elementy interfejsu
+  @{
+  */
+
+Journal * journal_new(const char *path)
+{
+    Journal *journal = malloc(sizeof(Journal));
+    if (!journal || !(journal->path = malloc(strlen(path) + 1)))
+    {
+        fprintf(stderr, "Failed to allocate memory for journal\n");
+        exit(EXIT_FAILURE);
+    }
+    strcpy(journal->path, path);
+
+    journal->file = NULL;
+    journal->n_records = 0;
+    journal->n_unsynced = 0;
+    journal->failed = false;
+    journal->checkpoint = -1;
+    journal->checkpoint_records = 0;
+
+    return journal;
+}
+
+void journal_done(Journal *journal)
+{
+    journal_sync(journal);
+    close_file(journal);
+    free(journal->path);
+    free(journal);
+}
+
+int journal_replay(Journal *journal, journal_replay_func fn, void *data)
+{
+    FILE *file = fopen(journal->path, "r");
+    if (!file) return errno == ENOENT ? 0 : -1;
+
+    IO *io = io_new(file, stdout, stderr);
+    wchar_t *record = NULL;
+    size_t capacity = 0;
+    long end = 0;
+    int ret = 0;
+
+    while (ret == 0 && read_record(io, &record, &capacity) >= 0)
+    {
+        if (fn(data, record) < 0) ret = -1;
+        else journal->n_records++;
+        end = ftell(file);
+    }
+
+    // Ostatni rekord bez końca linii został przerwany w trakcie zapisu.
+    // Obcinamy go, żeby nie skleił się z następnym dopisanym rekordem.
+    if (ret == 0 && ftell(file) > end && truncate(journal->path, end) != 0)
+        ret = -1;
+
+    free(record);
+    io_done(io);
+    fclose(file);
+
+    return ret;
+}
+
+int journal_append(Journal *journal, const wchar_t *fmt, ...)
+{
+    if (open_for_append(journal) < 0)
+    {
+        journal->failed = true;
+        return -1;
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    int written = vfwprintf(journal->file, fmt, args);
+    va_end(args);
+
+    if (written < 0 || fputwc(L'\n', journal->file) == WEOF)
+    {
+        journal->failed = true;
+        return -1;
+    }
+
+    journal->n_records++;
+    if (++journal->n_unsynced >= JOURNAL_SYNC_RECORDS)
+        return journal_sync(journal);
+
+    return 0;
+}
+
+int journal_sync(Journal *journal)
+{
+    if (journal->file != NULL && journal->n_unsynced > 0
+        && (fflush(journal->file) != 0 || fsync(fileno(journal->file)) != 0))
+    {
+        journal->failed = true;
+    }
+    journal->n_unsynced = 0;
+
+    int ret = journal->failed ? -1 : 0;
+    journal->failed = false;
+
+    return ret;
+}
+
+int journal_clear(Journal *journal)
+{
+    int ret = close_file(journal);
+
+    if (unlink(journal->path) != 0 && errno != ENOENT) ret = -1;
+
+    journal->n_records = 0;
+    journal->n_unsynced = 0;
+    journal->failed = false;
+    journal->checkpoint = -1;
+
+    return ret;
+}
+
+int journal_checkpoint(Journal *journal)
+{
+    if (journal_sync(journal) < 0) return -1;
+
+    struct stat st;
+    if (stat(journal->path, &st) == 0) journal->checkpoint = st.st_size;
+    else if (errno == ENOENT) journal->checkpoint = 0;
+    else return -1;
+
+    journal->checkpoint_records = journal->n_records;
+
+    return 0;
+}
+
+int journal_clear_checkpoint(Journal *journal)
+{
+    if (journal->checkpoint < 0) return 0;
+
+    // Później dopisane rekordy muszą być w pliku przed jego przepisaniem.
+    if (journal_sync(journal) < 0 || close_file(journal) < 0) return -1;
+
+    if (journal->n_records == journal->checkpoint_records)
+        return journal_clear(journal);
+
+    if (copy_after_checkpoint(journal) < 0) return -1;
+
+    journal->n_records -= journal->checkpoint_records;
+    journal->checkpoint = -1;
+
+    return 0;
+}
+
+size_t journal_size(const Journal *journal)
+{
+    return journal->n_records;
+}
+
+/**@}*/
@@ -0,0 +1,109 @@
+/** @file
+    Interfejs dziennika zmian dopisywanego na koniec pliku.
+
+    Dziennik przechowuje rekordy, po jednym w linii. Rekordy są dopisywane
+    do bufora pliku, a na dysk utrwalane paczkami, co określoną liczbę
+    rekordów lub na żądanie. Rekord przerwany w połowie zapisu (bez końca
+    linii) jest pomijany przy odtwarzaniu.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#ifndef __JOURNAL_H__
+#define __JOURNAL_H__
+
+#include <stddef.h>
+#include <wchar.h>
+
+/**
+  Struktura przechowująca dziennik.
+  */
+typedef struct journal Journal;
+
+/**
+  Funkcja odtwarzająca rekord.
+  Zwraca 0, jeśli rekord jest poprawny, -1 w p.p.
+  */
+typedef int (*journal_replay_func)(void *data, const wchar_t *record);
+
+/**
+  Inicjalizacja dziennika w danym pliku.
+  Plik jest tworzony dopiero przy dopisaniu pierwszego rekordu.
+  Należy go zniszczyć za pomocą journal_done().
+  @param[in] path Ścieżka pliku.
+  @return Nowy dziennik.
+  */
+Journal * journal_new(const char *path);
+
+/**
+  Destrukcja dziennika; utrwala dopisane rekordy.
+  @param[in,out] journal Dziennik.
+  */
+void journal_done(Journal *journal);
+
+/**
+  Odtwarza rekordy zapisane w pliku dziennika.
+  Należy ją wywołać przed dopisaniem pierwszego rekordu.
+  @param[in,out] journal Dziennik.
+  @param[in] fn Funkcja wywoływana dla kolejnych rekordów.
+  @param[in,out] data Dane przekazywane do funkcji.
+  @return 0, jeśli wszystkie rekordy są poprawne lub pliku nie ma,
+          -1 w p.p.
+  */
+int journal_replay(Journal *journal, journal_replay_func fn, void *data);
+
+/**
+  Dopisuje rekord do dziennika.
+  Rekord nie może zawierać końca linii.
+  @param[in,out] journal Dziennik.
+  @param[in] fmt Format rekordu jak dla wprintf().
+  @return 0, jeśli się udało, -1 w p.p.
+  */
+int journal_append(Journal *journal, const wchar_t *fmt, ...);
+
+/**
+  Utrwala na dysku wszystkie dopisane rekordy.
+  @param[in,out] journal Dziennik.
+  @return 0, jeśli się udało i żaden wcześniejszy zapis nie zawiódł,
+          -1 w p.p.
+  */
+int journal_sync(Journal *journal);
+
+/**
+  Usuwa plik dziennika wraz z rekordami.
+  Wywołuje się ją, gdy zmiany zostały zapisane w inny sposób.
+  @param[in,out] journal Dziennik.
+  @return 0, jeśli się udało, -1 w p.p.
+  */
+int journal_clear(Journal *journal);
+
+/**
+  Utrwala dziennik i ustawia punkt kontrolny za ostatnim rekordem.
+  Wywołuje się ją, gdy zaczyna się zapis zmian w inny sposób, np. zapis
+  całego słownika w tle. Nowy punkt kontrolny zastępuje poprzedni.
+  @param[in,out] journal Dziennik.
+  @return 0, jeśli się udało, -1 w p.p.
+  */
+int journal_checkpoint(Journal *journal);
+
+/**
+  Usuwa z dziennika rekordy sprzed punktu kontrolnego, zostawiając
+  rekordy dopisane później. Wywołuje się ją, gdy zmiany sprzed punktu
+  kontrolnego zostały zapisane w inny sposób. Bez punktu kontrolnego nic
+  nie robi.
+  @param[in,out] journal Dziennik.
+  @return 0, jeśli się udało, -1 w p.p.
+  */
+int journal_clear_checkpoint(Journal *journal);
+
+/**
+  Zwraca liczbę rekordów w dzienniku, wraz z odtworzonymi.
+  @param[in] journal Dziennik.
+  @return Liczba rekordów.
+  */
+size_t journal_size(const Journal *journal);
+
+#endif /* __JOURNAL_H__ */
@@ -0,0 +1,252 @@
+/** @file
+    Testy dziennika zmian.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwerstet Warszawski
+    @date 2026-10-19
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <cmocka.h>
+#include <locale.h>
+#include "journal.c"
+#include "utils.h"
+
+/**
+  Maksymalna liczba rekordów zapamiętywanych przy odtwarzaniu.
+  */
+#define MAX_RECORDS 200
+
+/**
+  Odtworzone rekordy.
+  */
+struct records
+{
+    /// Rekordy.
+    wchar_t records[MAX_RECORDS][16];
+    /// Liczba rekordów.
+    int n_records;
+};
+
+/**
+  Ścieżka pliku dziennika używanego w testach.
+  */
+static char path[] = "/tmp/journal_testXXXXXX";
+
+/**
+  Zapamiętuje odtworzony rekord.
+  @param[in,out] data Odtworzone rekordy.
+  @param[in] record Rekord.
+  @return 0, jeśli rekord nie zaczyna się od `?`, -1 w p.p.
+  */
+static int remember_record(void *data, const wchar_t *record)
+{
+    struct records *records = data;
+
+    if (record[0] == L'?') return -1;
+
+    wcscpy(records->records[records->n_records++], record);
+
+    return 0;
+}
+
+/**
+  Dopisuje do pliku dziennika tekst z pominięciem dziennika.
+  @param[in] text Tekst.
+  */
+static void append_raw(const char *text)
+{
+    FILE *file = fopen(path, "a");
+    assert_non_null(file);
+    fputs(text, file);
+    fclose(file);
+}
+
+/**
+  Testuje dopisywanie i odtwarzanie rekordów.
+  @param state Środowisko testowe.
+  */
+static void journal_append_replay_test(void** state)
+{
+    unlink(path);
+    Journal *journal = journal_new(path);
+    struct records records = {.n_records = 0};
+
+    // Bez pliku nie ma czego odtwarzać.
+    assert_int_equal(journal_replay(journal, remember_record, &records), 0);
+    assert_int_equal(records.n_records, 0);
+
+    for (int i = 0; i < 2 * JOURNAL_SYNC_RECORDS; i++)
+        assert_int_equal(journal_append(journal, L"+żółw%d", i), 0);
+    assert_int_equal(journal_append(journal, L"!"), 0);
+    assert_int_equal(journal_size(journal), 2 * JOURNAL_SYNC_RECORDS + 1);
+    assert_int_equal(journal_sync(journal), 0);
+    journal_done(journal);
+
+    journal = journal_new(path);
+    assert_int_equal(journal_replay(journal, remember_record, &records), 0);
+    assert_int_equal(records.n_records, 2 * JOURNAL_SYNC_RECORDS + 1);
+    assert_int_equal(journal_size(journal), 2 * JOURNAL_SYNC_RECORDS + 1);
+    assert_true(wcscmp(records.records[0], L"+żółw0") == 0);
+    assert_true(wcscmp(records.records[2 * JOURNAL_SYNC_RECORDS], L"!") == 0);
+
+    // Kolejne rekordy trafiają na koniec dziennika.
+    assert_int_equal(journal_append(journal, L"-żółw0"), 0);
+    journal_done(journal);
+
+    records.n_records = 0;
+    journal = journal_new(path);
+    assert_int_equal(journal_replay(journal, remember_record, &records), 0);
+    assert_int_equal(records.n_records, 2 * JOURNAL_SYNC_RECORDS + 2);
+    assert_true(wcscmp(records.records[2 * JOURNAL_SYNC_RECORDS + 1],
+                       L"-żółw0") == 0);
+    journal_done(journal);
+
+    unlink(path);
+}
+
+/**
+  Testuje odtwarzanie dziennika z przerwanym i błędnym rekordem.
+  @param state Środowisko testowe.
+  */
+static void journal_damaged_test(void** state)
+{
+    unlink(path);
+    append_raw("+kot\n+pies");
+
+    Journal *journal = journal_new(path);
+    struct records records = {.n_records = 0};
+
+    // Przerwany rekord jest pomijany i obcinany.
+    assert_int_equal(journal_replay(journal, remember_record, &records), 0);
+    assert_int_equal(records.n_records, 1);
+    assert_true(wcscmp(records.records[0], L"+kot") == 0);
+
+    assert_int_equal(journal_append(journal, L"+mysz"), 0);
+    journal_done(journal);
+
+    records.n_records = 0;
+    journal = journal_new(path);
+    assert_int_equal(journal_replay(journal, remember_record, &records), 0);
+    assert_int_equal(records.n_records, 2);
+    assert_true(wcscmp(records.records[1], L"+mysz") == 0);
+    journal_done(journal);
+
+    // Błędny rekord.
+    append_raw("?\n+ryba\n");
+    records.n_records = 0;
+    journal = journal_new(path);
+    assert_int_equal(journal_replay(journal, remember_record, &records), -1);
+    journal_done(journal);
+
+    unlink(path);
+}
+
+/**
+  Testuje usuwanie dziennika.
+  @param state Środowisko testowe.
+  */
+static void journal_clear_test(void** state)
+{
+    unlink(path);
+    Journal *journal = journal_new(path);
+    struct records records = {.n_records = 0};
+
+    // Usunięcie nieistniejącego dziennika się udaje.
+    assert_int_equal(journal_clear(journal), 0);
+
+    assert_int_equal(journal_append(journal, L"+kot"), 0);
+    assert_int_equal(journal_clear(journal), 0);
+    assert_int_equal(journal_size(journal), 0);
+    assert_int_equal(access(path, F_OK), -1);
+
+    assert_int_equal(journal_append(journal, L"+pies"), 0);
+    journal_done(journal);
+
+    journal = journal_new(path);
+    assert_int_equal(journal_replay(journal, remember_record, &records), 0);
+    assert_int_equal(records.n_records, 1);
+    assert_true(wcscmp(records.records[0], L"+pies") == 0);
+    journal_done(journal);
+
+    unlink(path);
+}
+
+/**
+  Testuje usuwanie rekordów sprzed punktu kontrolnego.
+  @param state Środowisko testowe.
+  */
+static void journal_checkpoint_test(void** state)
+{
+    unlink(path);
+    Journal *journal = journal_new(path);
+    struct records records = {.n_records = 0};
+
+    // Bez punktu kontrolnego dziennik się nie zmienia.
+    assert_int_equal(journal_append(journal, L"+kot"), 0);
+    assert_int_equal(journal_clear_checkpoint(journal), 0);
+    assert_int_equal(journal_size(journal), 1);
+
+    // Rekordy dopisane po punkcie kontrolnym zostają.
+    assert_int_equal(journal_append(journal, L"+pies"), 0);
+    assert_int_equal(journal_checkpoint(journal), 0);
+    assert_int_equal(journal_append(journal, L"-kot"), 0);
+    assert_int_equal(journal_append(journal, L"+mysz"), 0);
+    assert_int_equal(journal_clear_checkpoint(journal), 0);
+    assert_int_equal(journal_size(journal), 2);
+    assert_int_equal(journal_append(journal, L"+ryba"), 0);
+    journal_done(journal);
+
+    journal = journal_new(path);
+    assert_int_equal(journal_replay(journal, remember_record, &records), 0);
+    assert_int_equal(records.n_records, 3);
+    assert_true(wcscmp(records.records[0], L"-kot") == 0);
+    assert_true(wcscmp(records.records[1], L"+mysz") == 0);
+    assert_true(wcscmp(records.records[2], L"+ryba") == 0);
+
+    // Bez późniejszych rekordów plik jest usuwany.
+    assert_int_equal(journal_checkpoint(journal), 0);
+    assert_int_equal(journal_clear_checkpoint(journal), 0);
+    assert_int_equal(journal_size(journal), 0);
+    assert_int_equal(access(path, F_OK), -1);
+
+    // Usunięcie dziennika usuwa też punkt kontrolny.
+    assert_int_equal(journal_append(journal, L"+kot"), 0);
+    assert_int_equal(journal_checkpoint(journal), 0);
+    assert_int_equal(journal_clear(journal), 0);
+    assert_int_equal(journal_append(journal, L"+pies"), 0);
+    assert_int_equal(journal_clear_checkpoint(journal), 0);
+    assert_int_equal(journal_size(journal), 1);
+    journal_done(journal);
+
+    unlink(path);
+}
+
+/**
+  Główna funkcja uruchamiająca testy.
+  */
+int main(void)
+{
+    setlocale(LC_ALL, "pl_PL.UTF-8");
+
+    int fd = mkstemp(path);
+    if (fd < 0) return EXIT_FAILURE;
+    close(fd);
+
+    const struct CMUnitTest tests[] =
+    {
+        cmocka_unit_test(journal_append_replay_test),
+        cmocka_unit_test(journal_damaged_test),
+        cmocka_unit_test(journal_clear_test),
+        cmocka_unit_test(journal_checkpoint_test),
+    };
+
+    int ret = cmocka_run_group_tests(tests, NULL, NULL);
+    unlink(path);
+
+    return ret;
+}
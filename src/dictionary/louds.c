@@ -0,0 +1,626 @@
+/** @file
+    Implementacja zwięzłego drzewa LOUDS tylko do odczytu.
+
+    Ciąg bitów zaczyna się od `10` sztucznego węzła nad korzeniem, więc
+    jedynka na pozycji p odpowiada węzłowi o numerze rank1(p), a dzieci
+    węzła k zajmują jedynki między zerem numer k + 1 i zerem numer k + 2
+    (numerując zera od 1).
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#include "louds.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+  Liczba bitów w bloku katalogu zliczeń.
+  */
+#define BLOCK_BITS 512
+
+/**
+  Liczba słów 64-bitowych w bloku katalogu zliczeń.
+  */
+#define BLOCK_WORDS (BLOCK_BITS / 64)
+
+/**
+  Co ile jedynek (i zer) zapamiętywany jest blok, w którym leżą.
+  */
+#define SELECT_SAMPLE 512
+
+/**
+  Największy alfabet, którego znaki są kodowane jednym bajtem.
+  */
+#define MAX_CODED_ALPHABET 256
+
+/**
+  Struktura przechowująca drzewo.
+  */
+struct louds
+{
+    /// Ciąg bitów LOUDS.
+    uint64_t *bits;
+    /// Długość ciągu bitów.
+    size_t n_bits;
+    /// Liczba jedynek przed kolejnymi blokami (o jeden więcej niż bloków).
+    uint32_t *block_ranks;
+    /// Liczba bloków.
+    size_t n_blocks;
+    /// Bloki, w których leżą co SELECT_SAMPLE-te jedynki.
+    uint32_t *one_samples;
+    /// Liczba zapamiętanych bloków jedynek.
+    size_t n_one_samples;
+    /// Bloki, w których leżą co SELECT_SAMPLE-te zera.
+    uint32_t *zero_samples;
+    /// Liczba zapamiętanych bloków zer.
+    size_t n_zero_samples;
+    /// Czy w węźle kończy się słowo, po bicie na węzeł.
+    uint64_t *words;
+    /// Posortowane znaki występujące w drzewie.
+    wchar_t *alphabet;
+    /// Liczba znaków alfabetu.
+    size_t alphabet_size;
+    /// Numery znaków węzłów w alfabecie (NULL, jeśli alfabet jest duży).
+    uint8_t *codes;
+    /// Znaki węzłów, jeśli alfabet jest za duży na kody (lub NULL).
+    wchar_t *keys;
+    /// Liczba węzłów.
+    size_t n_nodes;
+};
+
+/** @name Funkcje pomocnicze
+  @{
+  */
+
+/**
+  malloc opakowany w obsługę błędu.
+  @param[in] size Rozmiar.
+  @return Zaalokowana pamięć.
+  */
+static void * emalloc(size_t size)
+{
+    void *ret = malloc(size > 0 ? size : 1);
+    if (!ret)
+    {
+        fprintf(stderr, "Failed to allocate memory for louds\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return ret;
+}
+
+/**
+  Zwraca bit ciągu.
+  @param[in] bits Ciąg bitów.
+  @param[in] pos Pozycja.
+  @return Bit.
+  */
+static inline bool get_bit(const uint64_t *bits, size_t pos)
+{
+    return (bits[pos / 64] >> (pos % 64)) & 1;
+}
+
+/**
+  Ustawia bit ciągu.
+  @param[in,out] bits Ciąg bitów.
+  @param[in] pos Pozycja.
+  */
+static inline void set_bit(uint64_t *bits, size_t pos)
+{
+    bits[pos / 64] |= (uint64_t) 1 << (pos % 64);
+}
+
+/**
+  Zwraca liczbę jedynek przed pozycją.
+  @param[in] louds Drzewo.
+  @param[in] pos Pozycja.
+  @return Liczba jedynek na pozycjach mniejszych niż `pos`.
+  */
+static size_t rank1(const Louds *louds, size_t pos)
+{
+    size_t block = pos / BLOCK_BITS;
+    size_t rank = louds->block_ranks[block];
+
+    for (size_t i = block * BLOCK_WORDS; i < pos / 64; i++)
+        rank += __builtin_popcountll(louds->bits[i]);
+    if (pos % 64 != 0)
+    {
+        uint64_t mask = ((uint64_t) 1 << (pos % 64)) - 1;
+        rank += __builtin_popcountll(louds->bits[pos / 64] & mask);
+    }
+
+    return rank;
+}
+
+/**
+  Zwraca liczbę jedynek lub zer przed blokiem.
+  @param[in] louds Drzewo.
+  @param[in] block Numer bloku.
+  @param[in] ones Czy liczone są jedynki.
+  @return Liczba jedynek lub zer.
+  */
+static inline size_t block_rank(const Louds *louds, size_t block, bool ones)
+{
+    size_t rank = louds->block_ranks[block];
+
+    return ones ? rank : block * BLOCK_BITS - rank;
+}
+
+/**
+  Zwraca pozycję jedynki lub zera o danym numerze.
+  @param[in] louds Drzewo.
+  @param[in] n Numer jedynki lub zera (od 1).
+  @param[in] ones Czy szukana jest jedynka.
+  @return Pozycja.
+  */
+static size_t select_bit(const Louds *louds, size_t n, bool ones)
+{
+    const uint32_t *samples = ones ? louds->one_samples : louds->zero_samples;
+    size_t n_samples = ones ? louds->n_one_samples : louds->n_zero_samples;
+    size_t sample = (n - 1) / SELECT_SAMPLE;
+
+    // Ostatni blok, przed którym jest mniej niż n szukanych bitów.
+    size_t lo = samples[sample];
+    size_t hi = sample + 1 < n_samples ? samples[sample + 1]
+                                       : louds->n_blocks - 1;
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi + 1) / 2;
+        if (block_rank(louds, mid, ones) < n) lo = mid;
+        else hi = mid - 1;
+    }
+
+    size_t rest = n - block_rank(louds, lo, ones);
+    size_t i = lo * BLOCK_WORDS;
+    uint64_t word;
+    for (;; i++)
+    {
+        word = ones ? louds->bits[i] : ~louds->bits[i];
+        size_t count = __builtin_popcountll(word);
+        if (count >= rest) break;
+        rest -= count;
+    }
+
+    for (; rest > 1; rest--) word &= word - 1;
+
+    return i * 64 + __builtin_ctzll(word);
+}
+
+/**
+  Zwraca liczbę kolejnych jedynek od danej pozycji.
+  @param[in] louds Drzewo.
+  @param[in] pos Pozycja.
+  @return Liczba jedynek.
+  */
+static size_t count_ones_from(const Louds *louds, size_t pos)
+{
+    size_t count = 0;
+
+    for (;;)
+    {
+        size_t offset = pos % 64;
+        uint64_t word = ~(louds->bits[pos / 64] >> offset);
+        size_t ones = word != 0 ? (size_t) __builtin_ctzll(word) : 64;
+
+        if (ones < 64 - offset) return count + ones;
+        count += 64 - offset;
+        pos += 64 - offset;
+    }
+}
+
+/**
+  Zwraca pozycję pierwszego dziecka węzła w ciągu bitów.
+  @param[in] louds Drzewo.
+  @param[in] node Numer węzła.
+  @return Pozycja.
+  */
+static inline size_t children_pos(const Louds *louds, size_t node)
+{
+    return select_bit(louds, node + 1, false) + 1;
+}
+
+/**
+  Zwraca numer znaku w alfabecie drzewa.
+  @param[in] louds Drzewo.
+  @param[in] character Znak.
+  @return Numer znaku lub -1, jeśli znaku nie ma w alfabecie.
+  */
+static int find_code(const Louds *louds, wchar_t character)
+{
+    size_t lo = 0, hi = louds->alphabet_size;
+
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (louds->alphabet[mid] < character) lo = mid + 1;
+        else hi = mid;
+    }
+
+    if (lo < louds->alphabet_size && louds->alphabet[lo] == character)
+        return lo;
+
+    return -1;
+}
+
+/**
+  Porównuje znaki na potrzeby sortowania alfabetu.
+  @param[in] a Pierwszy znak.
+  @param[in] b Drugi znak.
+  @return Wynik porównania.
+  */
+static int compare_chars(const void *a, const void *b)
+{
+    wchar_t _a = *(const wchar_t *) a;
+    wchar_t _b = *(const wchar_t *) b;
+
+    if (_a < _b) return -1;
+    if (_a > _b) return 1;
+    return 0;
+}
+
+/**
+  Zlicza węzły drzewa.
+  @param[in] node Korzeń poddrzewa.
+  @return Liczba węzłów poddrzewa.
+  */
+static size_t count_nodes(const Node *node)
+{
+    size_t count = 1;
+
+    for (int i = 0; i < node_children_count(node); i++)
+        count += count_nodes(node_get_child_by_index(node, i));
+
+    return count;
+}
+
+/**
+  Buduje katalog zliczeń i próbki dla operacji select.
+  @param[in,out] louds Drzewo z ustawionym ciągiem bitów.
+  */
+static void build_directory(Louds *louds)
+{
+    size_t n_words = (louds->n_bits + 63) / 64;
+    size_t ones = 0, zeros = 0;
+
+    louds->n_blocks = (louds->n_bits + BLOCK_BITS - 1) / BLOCK_BITS;
+    louds->block_ranks = emalloc(sizeof(uint32_t) * (louds->n_blocks + 1));
+
+    // Ciąg ma n jedynek i n + 1 zer.
+    louds->n_one_samples = (louds->n_nodes - 1) / SELECT_SAMPLE + 1;
+    louds->n_zero_samples = louds->n_nodes / SELECT_SAMPLE + 1;
+    louds->one_samples = emalloc(sizeof(uint32_t) * louds->n_one_samples);
+    louds->zero_samples = emalloc(sizeof(uint32_t) * louds->n_zero_samples);
+
+    size_t next_one = 0, next_zero = 0;
+    for (size_t i = 0; i < n_words; i++)
+    {
+        size_t block = i / BLOCK_WORDS;
+        if (i % BLOCK_WORDS == 0) louds->block_ranks[block] = ones;
+
+        // Bity za końcem ciągu nie są zerami ciągu.
+        size_t valid = louds->n_bits - 64 * i < 64 ? louds->n_bits - 64 * i
+                                                   : 64;
+        size_t word_ones = __builtin_popcountll(louds->bits[i]);
+        size_t word_zeros = valid - word_ones;
+
+        while (next_one < louds->n_one_samples
+               && next_one * SELECT_SAMPLE < ones + word_ones)
+        {
+            louds->one_samples[next_one++] = block;
+        }
+        while (next_zero < louds->n_zero_samples
+               && next_zero * SELECT_SAMPLE < zeros + word_zeros)
+        {
+            louds->zero_samples[next_zero++] = block;
+        }
+
+        ones += word_ones;
+        zeros += word_zeros;
+    }
+    louds->block_ranks[louds->n_blocks] = ones;
+}
+
+/**
+  Zapisuje znaki węzłów: kody w alfabecie, jeśli jest mały, albo same
+  znaki.
+  @param[in,out] louds Drzewo.
+  @param[in] keys Znaki węzłów wg. numerów (znak korzenia jest pomijany).
+  */
+static void build_labels(Louds *louds, const wchar_t *keys)
+{
+    size_t n = louds->n_nodes;
+
+    louds->alphabet = emalloc(sizeof(wchar_t) * n);
+    memcpy(louds->alphabet, keys + 1, sizeof(wchar_t) * (n - 1));
+    qsort(louds->alphabet, n - 1, sizeof(wchar_t), compare_chars);
+
+    size_t size = 0;
+    for (size_t i = 0; i + 1 < n; i++)
+    {
+        if (size == 0 || louds->alphabet[size - 1] != louds->alphabet[i])
+            louds->alphabet[size++] = louds->alphabet[i];
+    }
+    louds->alphabet_size = size;
+    louds->alphabet = realloc(louds->alphabet,
+                              sizeof(wchar_t) * (size > 0 ? size : 1));
+
+    louds->codes = NULL;
+    louds->keys = NULL;
+
+    if (size <= MAX_CODED_ALPHABET)
+    {
+        louds->codes = emalloc(n);
+        louds->codes[0] = 0;
+        for (size_t i = 1; i < n; i++)
+            louds->codes[i] = find_code(louds, keys[i]);
+    }
+    else
+    {
+        louds->keys = emalloc(sizeof(wchar_t) * n);
+        memcpy(louds->keys, keys, sizeof(wchar_t) * n);
+    }
+}
+
+/**
+  Tworzy drzewo o danej liczbie węzłów z wyzerowanym ciągiem bitów.
+  @param[in] n Liczba węzłów.
+  @return Nowe drzewo.
+  */
+static Louds * new_louds(size_t n)
+{
+    Louds *louds = emalloc(sizeof(Louds));
+
+    louds->n_nodes = n;
+    louds->n_bits = 2 * n + 1;
+    louds->bits = calloc((louds->n_bits + 63) / 64, sizeof(uint64_t));
+    louds->words = calloc((n + 63) / 64, sizeof(uint64_t));
+    if (!louds->bits || !louds->words)
+    {
+        fprintf(stderr, "Failed to allocate memory for louds\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return louds;
+}
+
+/**@}*/
+/** @name Elementy interfejsu
+  @{
+  */
+
+Louds * louds_build(const Node *root)
+{
+    Louds *louds = new_louds(count_nodes(root));
+    size_t n = louds->n_nodes;
+
+    // Kolejka przeglądania wszerz jest zarazem numeracją węzłów.
+    const Node **queue = emalloc(sizeof(Node *) * n);
+    wchar_t *keys = emalloc(sizeof(wchar_t) * n);
+    size_t head = 0, tail = 0, pos = 0;
+
+    set_bit(louds->bits, pos++);
+    pos++;
+    queue[tail++] = root;
+
+    while (head < tail)
+    {
+        const Node *node = queue[head];
+
+        keys[head] = node_get_key(node);
+        if (node_is_word(node)) set_bit(louds->words, head);
+        head++;
+
+        for (int i = 0; i < node_children_count(node); i++)
+        {
+            queue[tail++] = node_get_child_by_index(node, i);
+            set_bit(louds->bits, pos++);
+        }
+        pos++;
+    }
+
+    build_labels(louds, keys);
+    build_directory(louds);
+
+    free(keys);
+    free(queue);
+
+    return louds;
+}
+
+Louds * louds_load(const wchar_t *text, size_t length)
+{
+    // Głębokość drzewa, potem liczba węzłów na kolejnych poziomach.
+    size_t depth = 0, levels = 1, n = 1;
+    for (size_t i = 0; i < length; i++)
+    {
+        if (text[i] == L'^') depth--;
+        else if (text[i] != L'*')
+        {
+            n++;
+            if (++depth >= levels) levels = depth + 1;
+        }
+    }
+
+    size_t *level_start = emalloc(sizeof(size_t) * (levels + 1));
+    memset(level_start, 0, sizeof(size_t) * (levels + 1));
+    level_start[1] = 1;
+    depth = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        if (text[i] == L'^') depth--;
+        else if (text[i] != L'*') level_start[++depth + 1]++;
+    }
+    for (size_t d = 1; d <= levels; d++)
+        level_start[d] += level_start[d - 1];
+
+    // Poziom drzewa w kolejności zapisu (wzdłużnej) jest uporządkowany tak
+    // samo jak wszerz, więc numer węzła to kolejne miejsce na jego poziomie.
+    Louds *louds = new_louds(n);
+    wchar_t *keys = emalloc(sizeof(wchar_t) * n);
+    uint32_t *children = emalloc(sizeof(uint32_t) * n);
+    size_t *path = emalloc(sizeof(size_t) * levels);
+
+    memset(children, 0, sizeof(uint32_t) * n);
+    keys[0] = L'\0';
+    path[0] = level_start[0]++;
+    depth = 0;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        if (text[i] == L'^') depth--;
+        else if (text[i] == L'*') set_bit(louds->words, path[depth]);
+        else
+        {
+            size_t node = level_start[depth + 1]++;
+            keys[node] = text[i];
+            children[path[depth]]++;
+            path[++depth] = node;
+        }
+    }
+
+    size_t pos = 0;
+    set_bit(louds->bits, pos++);
+    pos++;
+    for (size_t i = 0; i < n; i++)
+    {
+        for (uint32_t j = 0; j < children[i]; j++)
+            set_bit(louds->bits, pos++);
+        pos++;
+    }
+
+    build_labels(louds, keys);
+    build_directory(louds);
+
+    free(path);
+    free(children);
+    free(keys);
+    free(level_start);
+
+    return louds;
+}
+
+void louds_done(Louds *louds)
+{
+    free(louds->bits);
+    free(louds->block_ranks);
+    free(louds->one_samples);
+    free(louds->zero_samples);
+    free(louds->words);
+    free(louds->alphabet);
+    free(louds->codes);
+    free(louds->keys);
+    free(louds);
+}
+
+size_t louds_get_child(const Louds *louds, size_t node, wchar_t character)
+{
+    size_t pos = children_pos(louds, node);
+    size_t count = count_ones_from(louds, pos);
+    if (count == 0) return LOUDS_NONE;
+
+    // Dzieci są posortowane według znaków, a kody zachowują ich porządek.
+    size_t lo = rank1(louds, pos), hi = lo + count, end = hi;
+
+    if (louds->codes != NULL)
+    {
+        int code = find_code(louds, character);
+        if (code < 0) return LOUDS_NONE;
+
+        while (lo < hi)
+        {
+            size_t mid = (lo + hi) / 2;
+            if (louds->codes[mid] < code) lo = mid + 1;
+            else hi = mid;
+        }
+
+        return lo < end && louds->codes[lo] == code ? lo : LOUDS_NONE;
+    }
+
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (louds->keys[mid] < character) lo = mid + 1;
+        else hi = mid;
+    }
+
+    return lo < end && louds->keys[lo] == character ? lo : LOUDS_NONE;
+}
+
+size_t louds_get_child_by_index(const Louds *louds, size_t node,
+                                size_t index)
+{
+    size_t pos = children_pos(louds, node);
+
+    if (index >= count_ones_from(louds, pos)) return LOUDS_NONE;
+
+    return rank1(louds, pos) + index;
+}
+
+size_t louds_children_count(const Louds *louds, size_t node)
+{
+    return count_ones_from(louds, children_pos(louds, node));
+}
+
+size_t louds_get_parent(const Louds *louds, size_t node)
+{
+    if (node == LOUDS_ROOT) return LOUDS_NONE;
+
+    // Przed jedynką węzła jest tyle zer, ile węzłów zakończyło już listę
+    // dzieci, razem ze sztucznym węzłem nad korzeniem.
+    size_t pos = select_bit(louds, node + 1, true);
+
+    return pos - node - 1;
+}
+
+wchar_t louds_get_key(const Louds *louds, size_t node)
+{
+    if (node == LOUDS_ROOT) return L'\0';
+    if (louds->codes != NULL) return louds->alphabet[louds->codes[node]];
+
+    return louds->keys[node];
+}
+
+bool louds_is_word(const Louds *louds, size_t node)
+{
+    return get_bit(louds->words, node);
+}
+
+bool louds_has_word(const Louds *louds, const wchar_t *word)
+{
+    size_t node = LOUDS_ROOT;
+
+    for (; *word != L'\0'; word++)
+    {
+        node = louds_get_child(louds, node, *word);
+        if (node == LOUDS_NONE) return false;
+    }
+
+    return louds_is_word(louds, node);
+}
+
+size_t louds_node_count(const Louds *louds)
+{
+    return louds->n_nodes;
+}
+
+size_t louds_memory(const Louds *louds)
+{
+    size_t memory = sizeof(Louds);
+
+    memory += sizeof(uint64_t) * ((louds->n_bits + 63) / 64);
+    memory += sizeof(uint32_t) * (louds->n_blocks + 1);
+    memory += sizeof(uint32_t)
+              * (louds->n_one_samples + louds->n_zero_samples);
+    memory += sizeof(uint64_t) * ((louds->n_nodes + 63) / 64);
+    memory += sizeof(wchar_t) * louds->alphabet_size;
+    if (louds->codes != NULL) memory += louds->n_nodes;
+    else memory += sizeof(wchar_t) * louds->n_nodes;
+
+    return memory;
+}
+
+/**@}*/
@@ -0,0 +1,144 @@
+/** @file
+    Interfejs zwięzłego drzewa LOUDS tylko do odczytu.
+
+    Drzewo jest zapisane wszerz jako ciąg bitów LOUDS (Level-Order Unary
+    Degree Sequence): dla każdego węzła tyle jedynek, ile ma dzieci,
+    i zero. Węzły są numerowane wszerz, od korzenia o numerze 0, więc
+    dzieci węzła mają kolejne numery. Dziecko, rodzica i liczbę dzieci
+    wyznacza się operacjami rank i select na ciągu bitów, wspieranymi
+    katalogiem zliczeń. Znaki węzłów są kodowane numerami w alfabecie
+    drzewa, po jednym bajcie na węzeł, jeśli alfabet ma co najwyżej 256
+    znaków. Razem drzewo zajmuje mniej niż 2 bajty na węzeł.
+
+    Drzewo udostępnia operacje, których generator podpowiedzi używa na
+    węzłach (zob. node.h): dziecko o danym znaku, dziecko o danym numerze,
+    liczbę dzieci, rodzica, znak i to, czy w węźle kończy się słowo.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#ifndef __LOUDS_H__
+#define __LOUDS_H__
+
+#include "node.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <wchar.h>
+
+/**
+  Numer korzenia.
+  */
+#define LOUDS_ROOT 0
+
+/**
+  Numer oznaczający brak węzła.
+  */
+#define LOUDS_NONE SIZE_MAX
+
+/**
+  Struktura przechowująca drzewo.
+  */
+typedef struct louds Louds;
+
+/**
+  Buduje drzewo LOUDS o tych samych węzłach co drzewo o danym korzeniu.
+  Należy je zniszczyć za pomocą louds_done().
+  @param[in] root Korzeń drzewa.
+  @return Nowe drzewo.
+  */
+Louds * louds_build(const Node *root);
+
+/**
+  Buduje drzewo LOUDS z zapisu drzewa w formacie trie_save() (zob.
+  trie_load_text()), bez budowania węzłów drzewa. Należy je zniszczyć za
+  pomocą louds_done().
+  @param[in] text Poprawny zapis drzewa.
+  @param[in] length Długość zapisu.
+  @return Nowe drzewo.
+  */
+Louds * louds_load(const wchar_t *text, size_t length);
+
+/**
+  Destrukcja drzewa.
+  @param[in,out] louds Drzewo.
+  */
+void louds_done(Louds *louds);
+
+/**
+  Zwraca dziecko węzła o danym znaku.
+  @param[in] louds Drzewo.
+  @param[in] node Numer węzła.
+  @param[in] character Znak.
+  @return Numer dziecka lub LOUDS_NONE, jeśli go nie ma.
+  */
+size_t louds_get_child(const Louds *louds, size_t node, wchar_t character);
+
+/**
+  Zwraca dziecko węzła o danym numerze w kolejności znaków.
+  @param[in] louds Drzewo.
+  @param[in] node Numer węzła.
+  @param[in] index Numer dziecka (od 0).
+  @return Numer dziecka lub LOUDS_NONE, jeśli go nie ma.
+  */
+size_t louds_get_child_by_index(const Louds *louds, size_t node,
+                                size_t index);
+
+/**
+  Zwraca liczbę dzieci węzła.
+  @param[in] louds Drzewo.
+  @param[in] node Numer węzła.
+  @return Liczba dzieci.
+  */
+size_t louds_children_count(const Louds *louds, size_t node);
+
+/**
+  Zwraca rodzica węzła.
+  @param[in] louds Drzewo.
+  @param[in] node Numer węzła.
+  @return Numer rodzica lub LOUDS_NONE dla korzenia.
+  */
+size_t louds_get_parent(const Louds *louds, size_t node);
+
+/**
+  Zwraca znak węzła.
+  @param[in] louds Drzewo.
+  @param[in] node Numer węzła.
+  @return Znak węzła lub L'\0' dla korzenia.
+  */
+wchar_t louds_get_key(const Louds *louds, size_t node);
+
+/**
+  Sprawdza, czy w węźle kończy się słowo.
+  @param[in] louds Drzewo.
+  @param[in] node Numer węzła.
+  @return Czy w węźle kończy się słowo.
+  */
+bool louds_is_word(const Louds *louds, size_t node);
+
+/**
+  Sprawdza, czy słowo jest w drzewie.
+  @param[in] louds Drzewo.
+  @param[in] word Słowo.
+  @return Czy słowo jest w drzewie.
+  */
+bool louds_has_word(const Louds *louds, const wchar_t *word);
+
+/**
+  Zwraca liczbę węzłów drzewa, razem z korzeniem.
+  @param[in] louds Drzewo.
+  @return Liczba węzłów.
+  */
+size_t louds_node_count(const Louds *louds);
+
+/**
+  Zwraca pamięć zajmowaną przez drzewo.
+  @param[in] louds Drzewo.
+  @return Liczba bajtów.
+  */
+size_t louds_memory(const Louds *louds);
+
+#endif /* __LOUDS_H__ */
@@ -0,0 +1,224 @@
+/** @file
+    Testy zwięzłego drzewa LOUDS.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwerstet Warszawski
+    @date 2026-10-19
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <cmocka.h>
+#include <locale.h>
+#include "louds.c"
+#include "trie.h"
+#include "io.h"
+#include "utils.h"
+
+/**
+  Liczba słów używanych w testach.
+  */
+#define N_WORDS 20000
+
+/**
+  Maksymalna długość słowa używanego w testach.
+  */
+#define MAX_LENGTH 12
+
+/**
+  Słowa używane w testach.
+  */
+static wchar_t words[N_WORDS][MAX_LENGTH + 1];
+
+/**
+  Sprawdza, czy poddrzewo LOUDS ma te same węzły co poddrzewo drzewa.
+  @param[in] louds Drzewo LOUDS.
+  @param[in] node Węzeł drzewa.
+  @param[in] id Numer odpowiadającego mu węzła drzewa LOUDS.
+  */
+static void assert_same_subtree(const Louds *louds, const Node *node,
+                                size_t id)
+{
+    assert_int_equal(louds_get_key(louds, id), node_get_key(node));
+    assert_int_equal(louds_is_word(louds, id), node_is_word(node));
+    assert_int_equal(louds_children_count(louds, id),
+                     node_children_count(node));
+    assert_true(louds_get_child_by_index(louds, id,
+                                         node_children_count(node))
+                == LOUDS_NONE);
+
+    for (int i = 0; i < node_children_count(node); i++)
+    {
+        const Node *child = node_get_child_by_index(node, i);
+        size_t child_id = louds_get_child_by_index(louds, id, i);
+
+        assert_true(child_id != LOUDS_NONE);
+        assert_int_equal(louds_get_child(louds, id, node_get_key(child)),
+                         child_id);
+        assert_int_equal(louds_get_parent(louds, child_id), id);
+        assert_same_subtree(louds, child, child_id);
+    }
+}
+
+/**
+  Wypełnia słowa losowymi znakami z danego alfabetu.
+  @param[in] first Pierwszy znak alfabetu.
+  @param[in] size Liczba znaków alfabetu.
+  */
+static void make_words(wchar_t first, int size)
+{
+    srand(42);
+
+    for (int i = 0; i < N_WORDS; i++)
+    {
+        int len = 1 + rand() % MAX_LENGTH;
+        for (int j = 0; j < len; j++) words[i][j] = first + rand() % size;
+        words[i][len] = L'\0';
+    }
+}
+
+/**
+  Testuje drzewo słów nad małym alfabetem.
+  @param state Środowisko testowe.
+  */
+static void louds_build_test(void** state)
+{
+    make_words(L'a', 32);
+
+    Trie *trie = trie_new();
+    for (int i = 0; i < N_WORDS; i++) trie_insert_word(trie, words[i]);
+
+    Louds *louds = louds_build(trie_get_root(trie));
+    assert_same_subtree(louds, trie_get_root(trie), LOUDS_ROOT);
+    assert_true(louds_get_parent(louds, LOUDS_ROOT) == LOUDS_NONE);
+
+    for (int i = 0; i < N_WORDS; i++)
+        assert_true(louds_has_word(louds, words[i]));
+    assert_false(louds_has_word(louds, L""));
+    assert_false(louds_has_word(louds, L"żółw"));
+    assert_false(louds_has_word(louds, L"aaaaaaaaaaaaaaaaaaaaaaaa"));
+    assert_true(louds_get_child(louds, LOUDS_ROOT, L'ż') == LOUDS_NONE);
+
+    // Znaki są kodowane jednym bajtem.
+    size_t n_nodes = louds_node_count(louds);
+    assert_true(n_nodes > N_WORDS);
+    assert_true(louds_memory(louds) < 2 * n_nodes);
+
+    louds_done(louds);
+    trie_done(trie);
+}
+
+/**
+  Testuje drzewo słów nad alfabetem za dużym na kody jednobajtowe.
+  @param state Środowisko testowe.
+  */
+static void louds_large_alphabet_test(void** state)
+{
+    make_words(L'a', 1000);
+
+    Trie *trie = trie_new();
+    for (int i = 0; i < N_WORDS; i++) trie_insert_word(trie, words[i]);
+
+    Louds *louds = louds_build(trie_get_root(trie));
+    assert_same_subtree(louds, trie_get_root(trie), LOUDS_ROOT);
+    for (int i = 0; i < N_WORDS; i++)
+        assert_true(louds_has_word(louds, words[i]));
+    assert_false(louds_has_word(louds, L"\u4e00"));
+
+    louds_done(louds);
+    trie_done(trie);
+}
+
+/**
+  Testuje budowę drzewa z zapisu drzewa.
+  @param state Środowisko testowe.
+  */
+static void louds_load_test(void** state)
+{
+    make_words(L'a', 32);
+
+    Trie *trie = trie_new();
+    for (int i = 0; i < N_WORDS; i++) trie_insert_word(trie, words[i]);
+
+    wchar_t *buf = NULL;
+    size_t len;
+    FILE *stream = open_wmemstream(&buf, &len);
+    IO *io = io_new(stdin, stream, stderr);
+    assert_int_equal(trie_save(trie, io), 0);
+    io_done(io);
+    fclose(stream);
+
+    // Zapis kończy się znakiem nowej linii.
+    Louds *loaded = louds_load(buf, len - 1);
+    Louds *built = louds_build(trie_get_root(trie));
+#   undef free
+    free(buf);
+#   define free(ptr) _test_free(ptr, __FILE__, __LINE__)
+
+    assert_int_equal(loaded->n_bits, built->n_bits);
+    assert_int_equal(memcmp(loaded->bits, built->bits,
+                            (built->n_bits + 63) / 64 * sizeof(uint64_t)), 0);
+    assert_int_equal(memcmp(loaded->words, built->words,
+                            (built->n_nodes + 63) / 64 * sizeof(uint64_t)),
+                     0);
+    assert_same_subtree(loaded, trie_get_root(trie), LOUDS_ROOT);
+    for (int i = 0; i < N_WORDS; i++)
+        assert_true(louds_has_word(loaded, words[i]));
+
+    louds_done(built);
+    louds_done(loaded);
+
+    loaded = louds_load(L"", 0);
+    assert_int_equal(louds_node_count(loaded), 1);
+    assert_false(louds_has_word(loaded, L"a"));
+    louds_done(loaded);
+
+    trie_done(trie);
+}
+
+/**
+  Testuje drzewo bez słów.
+  @param state Środowisko testowe.
+  */
+static void louds_empty_test(void** state)
+{
+    Trie *trie = trie_new();
+    Louds *louds = louds_build(trie_get_root(trie));
+
+    assert_int_equal(louds_node_count(louds), 1);
+    assert_int_equal(louds_children_count(louds, LOUDS_ROOT), 0);
+    assert_true(louds_get_child(louds, LOUDS_ROOT, L'a') == LOUDS_NONE);
+    assert_false(louds_has_word(louds, L""));
+    assert_false(louds_has_word(louds, L"a"));
+
+    louds_done(louds);
+
+    trie_insert_word(trie, L"a");
+    louds = louds_build(trie_get_root(trie));
+    assert_true(louds_has_word(louds, L"a"));
+    assert_int_equal(louds_get_parent(louds, 1), LOUDS_ROOT);
+    louds_done(louds);
+
+    trie_done(trie);
+}
+
+/**
+  Główna funkcja uruchamiająca testy.
+  */
+int main(void)
+{
+    setlocale(LC_ALL, "pl_PL.UTF-8");
+
+    const struct CMUnitTest tests[] =
+    {
+        cmocka_unit_test(louds_build_test),
+        cmocka_unit_test(louds_large_alphabet_test),
+        cmocka_unit_test(louds_load_test),
+        cmocka_unit_test(louds_empty_test),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
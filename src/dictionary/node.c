@@ -9,35 +9,157 @@
 
 #include "node.h"
 #include "set.h"
+#include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 /**
-  Struktura przechowująca węzeł.
+  Liczba słów szukanych jednocześnie przez node_has_words().
   */
-struct node
+#define LOCKSTEP_WORDS 32
+
+/**
+  Liczba znaków etykiety porównywanych naraz, bez rozgałęzień.
+  */
+#define LABEL_BLOCK 8
+
+/**
+  Pozycja w drzewie: węzeł albo znak wewnątrz etykiety krawędzi.
+  Wskaźnik na pozycję wewnątrz krawędzi jest wskaźnikiem na węzeł
+  widzianym przez interfejs, więc pola rozróżniające są w obu rodzajach
+  pozycji tam samo.
+  */
+struct position
 {
-    /// Wartość w węźle.
+    /// Znak pozycji.
     wchar_t value;
+    /// Numer pozycji w etykiecie licząc od 1, a w węźle długość etykiety.
+    uint16_t index;
+    /// Czy pozycja jest węzłem.
+    bool node : 1;
     /// Czy w węźle kończy się słowo.
-    bool is_word;
+    bool is_word : 1;
+    /// Czy każde dziecko węzła ma bit w masce kodów.
+    bool coded : 1;
+    /// Czy węzeł należy do bloku utworzonego przez node_relayout().
+    bool in_block : 1;
+    /// Bit węzła w masce kodów ojca (NODE_NO_CODE, jeśli go nie ma).
+    signed char bit;
+};
+
+/**
+  Struktura przechowująca węzeł.
+  */
+struct node
+{
+    /// Znak i flagi węzła; musi być pierwszym polem.
+    struct position head;
+    /// Maska kodów pierwszych znaków krawędzi dzieci.
+    uint64_t codes;
 
-    /// Rodzic węzła.
+    /// Rodzic węzła, czyli węzeł na początku jego krawędzi.
     Node *parent;
-    /// Dzieci węzła.
+    /// Jedyne dziecko węzła (NULL, jeśli węzeł ma inną liczbę dzieci).
+    Node *child;
+    /// Dzieci węzła, jeśli ma ich więcej niż jedno (NULL w p.p.).
     Set *children;
+    /// Znaki krawędzi prowadzącej do węzła, poprzedzające jego znak.
+    struct position label[];
+};
+
+/**
+  Flaga pozycji wczytywanego zapisu, w której kończy się słowo.
+  */
+#define LOAD_WORD 1
+
+/**
+  Przyrost flag pozycji zapisu o jednego syna.
+  */
+#define LOAD_CHILD 2
+
+/**
+  Maska liczby synów pozycji zapisu, liczonej do dwóch.
+  */
+#define LOAD_CHILDREN 6
+
+/**
+  Węzeł bloku wyznaczony w zapisie przez node_load_block().
+  */
+struct load_node
+{
+    /// Indeks pierwszego znaku krawędzi w zapisie.
+    size_t start;
+    /// Długość etykiety krawędzi.
+    size_t length;
+    /// Numer ojca w kolejności zapisu.
+    size_t parent;
+    /// Poziom węzła w bloku.
+    size_t level;
 };
 
 /** @name Funkcje pomocnicze
   @{
   */
 
+/*
+ Zwraca pozycję, na którą wskazuje węzeł interfejsu.
+ */
+static const struct position * as_position(const Node *node)
+{
+    return (const struct position *) node;
+}
+
+/*
+ Zwraca węzeł kończący krawędź, na której leży pozycja.
+ */
+static Node * edge_end(const Node *node)
+{
+    const struct position *position = as_position(node);
+    if (position->node) return (Node *) node;
+
+    const struct position *label = position - (position->index - 1);
+    return (Node *) ((const char *) label - offsetof(Node, label));
+}
+
+/*
+ Zwraca pierwszą pozycję krawędzi węzła.
+ */
+static Node * edge_entry(const Node *node)
+{
+    if (node->head.index == 0) return (Node *) node;
+    return (Node *) &node->label[0];
+}
+
+/*
+ Zwraca pierwszy znak krawędzi węzła, po którym jest on szukany u ojca.
+ */
+static wchar_t edge_key(const Node *node)
+{
+    // Wybór adresu zamiast wartości kompiluje się bez skoku.
+    return (node->head.index == 0 ? &node->head : node->label)->value;
+}
+
+/*
+ Zwraca pozycję następną po pozycji wewnątrz krawędzi.
+ */
+static Node * next_position(const Node *node)
+{
+    const struct position *position = as_position(node);
+    Node *end = edge_end(node);
+
+    if (position->index < end->head.index)
+        return (Node *) &end->label[position->index];
+    return end;
+}
+
 /*
  Porównuje dwa węzły
  */
 static int compare_nodes(void *a, void *b)
 {
-    wchar_t _a = node_get_key(a);
-    wchar_t _b = node_get_key(b);
+    wchar_t _a = edge_key(a);
+    wchar_t _b = edge_key(b);
 
     if (_a > _b) return 1;
     if (_a == _b) return 0;
@@ -52,106 +174,852 @@ static void free_node(void *node)
     node_done((Node*)node);
 }
 
-/**@}*/
-/** @name Elementy interfejsu
-  @{
-  */
+/*
+ Zwraca bit maski dla kodu znaku lub NODE_NO_CODE, jeśli kod go nie ma.
+ */
+static signed char code_bit(const int code)
+{
+    return code >= 0 && code < NODE_CODED_CHILDREN ? code : NODE_NO_CODE;
+}
 
-Node * node_new(const wchar_t character)
+/*
+ Tworzy węzeł o etykiecie danej długości; znaki etykiety ustawia
+ wywołujący.
+ */
+static Node * node_alloc(const wchar_t character, const size_t length)
 {
-    Node *node = (Node *) malloc(sizeof(Node));
+    Node *node = (Node *) malloc(sizeof(Node)
+                                 + length * sizeof(struct position));
     if (!node)
     {
         fprintf(stderr, "Failed to allocate memory for node\n");
         exit(EXIT_FAILURE);
     }
 
-    node->value = character;
+    node->head = (struct position) {
+        .value = character, .index = length, .node = true, .coded = true,
+        .bit = NODE_NO_CODE
+    };
+    node->codes = 0;
     node->parent = NULL;
-    node->children = set_new(compare_nodes, free_node);
-    node->is_word = false;
+    node->child = NULL;
+    node->children = NULL;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        node->label[i] = (struct position) {
+            .index = i + 1, .bit = NODE_NO_CODE
+        };
+    }
 
     return node;
 }
 
-void node_done(Node *node)
+/*
+ Zwraca liczbę dzieci węzła.
+ */
+static int child_count(const Node *node)
 {
+    if (node->children == NULL) return node->child != NULL;
+    return set_size(node->children);
+}
+
+/*
+ Zwraca dziecko węzła o danym indeksie.
+ */
+static Node * child_at(const Node *node, const int index)
+{
+    if (node->children == NULL) return node->child;
+    return set_get_by_index(node->children, index);
+}
+
+/*
+ Zwraca dziecko węzła, którego krawędź zaczyna się od danego znaku.
+ */
+static Node * find_child(const Node *node, const wchar_t character)
+{
+    if (node->children == NULL)
+    {
+        Node *child = node->child;
+        return child != NULL && edge_key(child) == character ? child : NULL;
+    }
+
+    // Do porównań wystarczy klucz, więc nie trzeba alokować węzła.
+    Node key = { .head = { .value = character } };
+    return set_find(node->children, &key);
+}
+
+/*
+ Zwraca dziecko węzła o danym pierwszym znaku krawędzi, korzystając
+ z maski kodów.
+ */
+static Node * coded_child(const Node *node, const wchar_t character,
+                          const int code)
+{
+    if (!node->head.coded) return find_child(node, character);
+
+    // Każde dziecko ma bit, więc znak bez bitu nie jest znakiem dziecka.
+    if (code_bit(code) == NODE_NO_CODE) return NULL;
+
+    uint64_t bit = UINT64_C(1) << code;
+    if (!(node->codes & bit)) return NULL;
+
+    // Dzieci są posortowane po znakach, a więc i po kodach.
+    return child_at(node, __builtin_popcountll(node->codes & (bit - 1)));
+}
+
+/*
+ Dodaje syna do węzła, na koniec lub zgodnie z kolejnością znaków.
+ Zbiór dzieci jest tworzony dopiero dla drugiego syna, więc węzły
+ z jednym synem go nie mają.
+ Zwraca 0, jeśli węzeł ma już syna o tym znaku.
+ */
+static int insert_child(Node *node, Node *child, bool at_end)
+{
+    if (node->children == NULL)
+    {
+        if (node->child == NULL)
+        {
+            node->child = child;
+            return 1;
+        }
+        if (!at_end && edge_key(node->child) == edge_key(child)) return 0;
+
+        node->children = set_new(compare_nodes, free_node);
+        set_insert_at_end(node->children, node->child);
+        node->child = NULL;
+    }
+
+    if (at_end) return set_insert_at_end(node->children, child);
+    return set_insert(node->children, child);
+}
+
+/*
+ Zaznacza w masce kodów węzła nowe dziecko.
+ */
+static void mark_child(Node *node, const Node *child)
+{
+    if (child->head.bit == NODE_NO_CODE) node->head.coded = false;
+    else node->codes |= UINT64_C(1) << child->head.bit;
+}
+
+/*
+ Sprawdza, czy etykieta zgadza się z początkiem słowa o co najmniej
+ length znakach. Znaki są porównywane blokami bez rozgałęzień, które
+ kompilator zamienia na porównania wektorowe.
+ */
+static bool label_matches(const struct position *label, const wchar_t *word,
+                          const size_t length)
+{
+    uint32_t diff = 0;
+    size_t i = 0;
+
+    for (; i + LABEL_BLOCK <= length; i += LABEL_BLOCK)
+    {
+        for (size_t j = 0; j < LABEL_BLOCK; j++)
+            diff |= label[i + j].value ^ word[i + j];
+        if (diff != 0) return false;
+    }
+    for (; i < length; i++) diff |= label[i].value ^ word[i];
+
+    return diff == 0;
+}
+
+/*
+ Zwraca pozycję, w której kończy się krawędź bloku zaczynająca się
+ w danej pozycji: pierwszą, w której kończy się słowo albo która nie ma
+ dokładnie jednego dziecka. Zapisuje liczbę pozycji przed nią.
+ */
+static const Node * chain_end(const Node *node, size_t *length)
+{
+    *length = 0;
+    while (!node_is_word(node) && node_children_count(node) == 1
+           && *length < NODE_MAX_LABEL)
+    {
+        node = node_get_child_by_index(node, 0);
+        (*length)++;
+    }
+
+    return node;
+}
+
+/*
+ Zwraca bit w masce kodów ojca krawędzi bloku zaczynającej się w danej
+ pozycji lub NODE_NO_CODE, jeśli pozycja nie zaczyna krawędzi węzła.
+ */
+static signed char entry_bit(const Node *node)
+{
+    Node *end = edge_end(node);
+    return edge_entry(end) == node ? end->head.bit : NODE_NO_CODE;
+}
+
+/*
+ Zlicza węzły bloku w poddrzewie pozycji, która będzie węzłem bloku.
+ */
+static size_t count_nodes(const Node *node)
+{
+    size_t count = 1, length;
+
     for (int i = 0; i < node_children_count(node); i++)
+        count += count_nodes(chain_end(node_get_child_by_index(node, i),
+                                       &length));
+
+    return count;
+}
+
+/*
+ Dopisuje krawędź bloku do kolejności węzłów, zapamiętując jej początek,
+ długość etykiety i numer ojca.
+ */
+static size_t add_to_order(const Node *start, size_t parent,
+                           const Node **order, const Node **starts,
+                           size_t *lengths, size_t *parents, size_t *n)
+{
+    size_t index = (*n)++;
+
+    starts[index] = start;
+    order[index] = chain_end(start, &lengths[index]);
+    parents[index] = parent;
+
+    return index;
+}
+
+/*
+ Dopisuje potomków węzła o danym numerze do kolejności węzłów w głąb.
+ */
+static void order_depth_first(size_t index, const Node **order,
+                              const Node **starts, size_t *lengths,
+                              size_t *parents, size_t *n)
+{
+    const Node *node = order[index];
+
+    for (int i = 0; i < node_children_count(node); i++)
+    {
+        size_t child = add_to_order(node_get_child_by_index(node, i), index,
+                                    order, starts, lengths, parents, n);
+        order_depth_first(child, order, starts, lengths, parents, n);
+    }
+}
+
+/*
+ Inicjuje węzeł bloku o etykiecie danej długości i dodaje go na koniec
+ synów ojca; znaki etykiety ustawia wywołujący.
+ */
+static void init_block_node(Node *node, const wchar_t character,
+                            const size_t length, const bool is_word,
+                            const signed char bit, Node *parent)
+{
+    node->head = (struct position) {
+        .value = character, .index = length, .node = true,
+        .is_word = is_word, .coded = true, .in_block = true, .bit = bit
+    };
+    node->codes = 0;
+    node->parent = parent;
+    node->child = NULL;
+    node->children = NULL;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        node->label[i] = (struct position) {
+            .index = i + 1, .bit = NODE_NO_CODE
+        };
+    }
+
+    if (parent)
+    {
+        insert_child(parent, node, true);
+        mark_child(parent, node);
+    }
+}
+
+/*
+ Oznacza w flagach pozycji zapisu, w których kończy się słowo, i zlicza
+ (do dwóch) ich synów. Flagi korzenia są pod indeksem length.
+ */
+static void mark_positions(const wchar_t *text, const size_t length,
+                           unsigned char *flags, size_t *path)
+{
+    size_t depth = 0;
+    path[0] = length;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        if (text[i] == L'*') flags[path[depth]] |= LOAD_WORD;
+        else if (text[i] == L'^') depth--;
+        else
+        {
+            if ((flags[path[depth]] & LOAD_CHILDREN) < 2 * LOAD_CHILD)
+                flags[path[depth]] += LOAD_CHILD;
+            path[++depth] = i;
+        }
+    }
+}
+
+/*
+ Wyznacza w zapisie węzły bloku w kolejności zapisu: początek i długość
+ etykiety, ojca i poziom każdego z nich. Zwraca liczbę węzłów.
+ Jeśli nodes jest NULL, węzły są tylko zliczane.
+ */
+static size_t find_block_nodes(const wchar_t *text, const size_t length,
+                               const unsigned char *flags, size_t *path,
+                               struct load_node *nodes)
+{
+    size_t n = 1, depth = 0;
+    path[0] = 0;
+    if (nodes) nodes[0] = (struct load_node) { .start = length };
+
+    for (size_t i = 0; i < length; i++)
     {
-        node_done(set_get_by_index(node->children, i));
+        if (text[i] == L'^') depth--;
+        if (text[i] == L'^' || text[i] == L'*') continue;
+
+        // Pozycja bez końca słowa z jednym synem ciągnie się do następnego
+        // znaku zapisu, więc etykieta jest spójnym fragmentem zapisu.
+        size_t start = i, label = 0;
+        while (!(flags[i] & LOAD_WORD)
+               && (flags[i] & LOAD_CHILDREN) == LOAD_CHILD
+               && label < NODE_MAX_LABEL)
+        {
+            path[++depth] = SIZE_MAX;
+            i++;
+            label++;
+        }
+
+        if (nodes)
+        {
+            size_t parent = path[depth - label];
+            nodes[n] = (struct load_node) {
+                .start = start, .length = label, .parent = parent,
+                .level = nodes[parent].level + 1
+            };
+        }
+        path[++depth] = n++;
     }
 
-    set_done(node->children);
-    free(node);
+    return n;
+}
+
+/**@}*/
+/** @name Elementy interfejsu
+  @{
+  */
+
+Node * node_new(const wchar_t character)
+{
+    return node_alloc(character, 0);
+}
+
+void node_done(Node *node)
+{
+    node = edge_end(node);
+
+    for (int i = 0; i < child_count(node); i++)
+    {
+        node_done(child_at(node, i));
+    }
+
+    node_done_shallow(node);
+}
+
+Node * node_copy(const Node *node)
+{
+    const Node *end = edge_end(node);
+    size_t length = end->head.index;
+
+    Node *copy = node_alloc(end->head.value, length);
+    for (size_t i = 0; i < length; i++)
+        copy->label[i].value = end->label[i].value;
+    copy->head.is_word = end->head.is_word;
+    copy->head.coded = end->head.coded;
+    copy->head.bit = end->head.bit;
+    copy->codes = end->codes;
+    copy->parent = __atomic_load_n(&end->parent, __ATOMIC_ACQUIRE);
+
+    for (int i = 0; i < child_count(end); i++)
+    {
+        insert_child(copy, child_at(end, i), true);
+    }
+
+    if (end == node) return copy;
+    return (Node *) &copy->label[as_position(node)->index - 1];
+}
+
+void node_done_shallow(Node *node)
+{
+    node = edge_end(node);
+
+    if (node->children) set_done(node->children);
+    if (!node->head.in_block) free(node);
+}
+
+Node * node_relayout(const Node *node, size_t levels)
+{
+    size_t n_nodes = count_nodes(node);
+    const Node **order = malloc(n_nodes * sizeof(Node *));
+    const Node **starts = malloc(n_nodes * sizeof(Node *));
+    size_t *lengths = malloc(n_nodes * sizeof(size_t));
+    size_t *parents = malloc(n_nodes * sizeof(size_t));
+    size_t *offsets = malloc(n_nodes * sizeof(size_t));
+    if (!order || !starts || !lengths || !parents || !offsets)
+    {
+        fprintf(stderr, "Failed to allocate memory for node block\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Górne poziomy wszerz.
+    size_t head = 0, n = 1, level_end = 1;
+    order[0] = starts[0] = node;
+    lengths[0] = 0;
+    while (head < n && levels > 0)
+    {
+        const Node *current = order[head];
+        for (int i = 0; i < node_children_count(current); i++)
+        {
+            add_to_order(node_get_child_by_index(current, i), head, order,
+                         starts, lengths, parents, &n);
+        }
+
+        if (++head == level_end)
+        {
+            levels--;
+            level_end = n;
+        }
+    }
+
+    // Poddrzewa węzłów najniższego z nich w głąb, jedno po drugim.
+    for (size_t end = n; head < end; head++)
+        order_depth_first(head, order, starts, lengths, parents, &n);
+
+    // Węzły mają różne długości etykiet, więc są układane jeden za drugim.
+    size_t size = 0;
+    for (size_t i = 0; i < n_nodes; i++)
+    {
+        offsets[i] = size;
+        size += sizeof(Node) + lengths[i] * sizeof(struct position);
+    }
+
+    char *block = malloc(size);
+    if (!block)
+    {
+        fprintf(stderr, "Failed to allocate memory for node block\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Ojciec jest przed synami, a synowie każdego węzła są w kolejności
+    // znaków, więc można ich dodawać na koniec. Maski kodów są wyznaczane
+    // od nowa, bo pierwsze znaki krawędzi się nie zmieniają.
+    for (size_t i = 0; i < n_nodes; i++)
+    {
+        Node *copy = (Node *) (block + offsets[i]);
+        const Node *old = order[i];
+
+        init_block_node(copy, node_get_key(old), lengths[i],
+                        node_is_word(old),
+                        i > 0 ? entry_bit(starts[i]) : NODE_NO_CODE,
+                        i > 0 ? (Node *) (block + offsets[parents[i]])
+                              : NULL);
+
+        const Node *position = starts[i];
+        for (size_t j = 0; j < lengths[i]; j++)
+        {
+            copy->label[j].value = node_get_key(position);
+            position = node_get_child_by_index(position, 0);
+        }
+    }
+
+    free(offsets);
+    free(parents);
+    free(lengths);
+    free(starts);
+    free(order);
+
+    return (Node *) block;
+}
+
+Node * node_load_block(const wchar_t character, const wchar_t *text,
+                       const size_t length, const Alphabet *alphabet,
+                       const size_t levels)
+{
+    size_t depth = 0, longest = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        if (text[i] == L'^') depth--;
+        else if (text[i] != L'*' && ++depth > longest) longest = depth;
+    }
+
+    unsigned char *flags = calloc(length + 1, sizeof(unsigned char));
+    size_t *path = malloc((longest + 1) * sizeof(size_t));
+    if (!flags || !path)
+    {
+        fprintf(stderr, "Failed to allocate memory for node block\n");
+        exit(EXIT_FAILURE);
+    }
+
+    mark_positions(text, length, flags, path);
+
+    size_t n_nodes = find_block_nodes(text, length, flags, path, NULL);
+    struct load_node *nodes = malloc(n_nodes * sizeof(struct load_node));
+    size_t *order = malloc(n_nodes * sizeof(size_t));
+    size_t *offsets = malloc(n_nodes * sizeof(size_t));
+    size_t *firsts = calloc(levels + 3, sizeof(size_t));
+    if (!nodes || !order || !offsets || !firsts)
+    {
+        fprintf(stderr, "Failed to allocate memory for node block\n");
+        exit(EXIT_FAILURE);
+    }
+    find_block_nodes(text, length, flags, path, nodes);
+
+    // Kolejność zapisu to kolejność w głąb, a w niej węzły każdego poziomu
+    // są w kolejności wszerz. Układ node_relayout() to więc górne poziomy
+    // po kolei, a za nimi pozostałe węzły w kolejności zapisu.
+    for (size_t i = 0; i < n_nodes; i++)
+    {
+        size_t level = nodes[i].level <= levels ? nodes[i].level : levels + 1;
+        firsts[level + 1]++;
+    }
+    for (size_t level = 0; level <= levels; level++)
+        firsts[level + 1] += firsts[level];
+    for (size_t i = 0; i < n_nodes; i++)
+    {
+        size_t level = nodes[i].level <= levels ? nodes[i].level : levels + 1;
+        order[firsts[level]++] = i;
+    }
+
+    size_t size = 0;
+    for (size_t i = 0; i < n_nodes; i++)
+    {
+        offsets[order[i]] = size;
+        size += sizeof(Node) + nodes[order[i]].length * sizeof(struct position);
+    }
+
+    char *block = malloc(size);
+    if (!block)
+    {
+        fprintf(stderr, "Failed to allocate memory for node block\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Ojciec jest przed synami, a synowie każdego węzła są w kolejności
+    // zapisu, więc można ich dodawać na koniec.
+    for (size_t i = 0; i < n_nodes; i++)
+    {
+        const struct load_node *load = &nodes[order[i]];
+        Node *node = (Node *) (block + offsets[order[i]]);
+
+        if (i == 0)
+        {
+            init_block_node(node, character, 0, flags[length] & LOAD_WORD,
+                            NODE_NO_CODE, NULL);
+            continue;
+        }
+
+        size_t end = load->start + load->length;
+        init_block_node(node, text[end], load->length, flags[end] & LOAD_WORD,
+                        code_bit(alphabet_find(alphabet, text[load->start])),
+                        (Node *) (block + offsets[load->parent]));
+        for (size_t j = 0; j < load->length; j++)
+            node->label[j].value = text[load->start + j];
+    }
+
+    free(firsts);
+    free(offsets);
+    free(order);
+    free(nodes);
+    free(path);
+    free(flags);
+
+    return (Node *) block;
+}
+
+void node_free_block(Node *block)
+{
+    free(block);
+}
+
+void node_adopt_children(Node *node)
+{
+    if (!as_position(node)->node) return;
+
+    for (int i = 0; i < child_count(node); i++)
+    {
+        Node *child = child_at(node, i);
+        __atomic_store_n(&child->parent, node, __ATOMIC_RELEASE);
+    }
+}
+
+Node * node_replace_child(Node *node, Node *child)
+{
+    child = edge_end(child);
+    if (node->children) return set_replace(node->children, child);
+
+    Node *old = node->child;
+    if (old == NULL || edge_key(old) != edge_key(child)) return NULL;
+    node->child = child;
+
+    return old;
 }
 
 Node * node_add_child(Node *node, const wchar_t character)
+{
+    return node_add_coded_child(node, character, NODE_NO_CODE);
+}
+
+Node * node_add_child_at_end(Node *node, const wchar_t character)
+{
+    return node_add_coded_child_at_end(node, character, NODE_NO_CODE);
+}
+
+Node * node_add_coded_child(Node *node, const wchar_t character,
+                            const int code)
 {
     Node *child = node_new(character);
     child->parent = node;
+    child->head.bit = code_bit(code);
 
-    if (!set_insert(node->children, child))
+    if (!insert_child(node, child, false))
     {
         node_done(child);
         return node_get_child(node, character);
     }
+    mark_child(node, child);
 
     return child;
 }
 
-Node * node_add_child_at_end(Node *node, const wchar_t character)
+Node * node_add_coded_child_at_end(Node *node, const wchar_t character,
+                                   const int code)
 {
     Node *child = node_new(character);
     child->parent = node;
+    child->head.bit = code_bit(code);
 
-    set_insert_at_end(node->children, child);
+    insert_child(node, child, true);
+    mark_child(node, child);
 
     return child;
 }
 
+Node * node_add_coded_edge(Node *node, const wchar_t *label, size_t length,
+                           const int code)
+{
+    // Dłuższa krawędź jest dzielona na krawędzie o najdłuższej etykiecie.
+    size_t n = length - 1 < NODE_MAX_LABEL ? length - 1 : NODE_MAX_LABEL;
+
+    Node *child = node_alloc(label[n], n);
+    for (size_t i = 0; i < n; i++) child->label[i].value = label[i];
+    child->parent = node;
+    child->head.bit = code_bit(code);
+
+    if (!insert_child(node, child, false))
+    {
+        node_done(child);
+        return NULL;
+    }
+    mark_child(node, child);
+
+    if (n + 1 == length) return child;
+    return node_add_coded_edge(child, label + n + 1, length - n - 1,
+                               NODE_NO_CODE);
+}
+
 Node * node_get_child(const Node *node, const wchar_t character)
 {
-    Node *tmp = node_new(character);
-    Node *ret = set_find(node->children, tmp);
-    node_done(tmp);
+    if (!as_position(node)->node)
+    {
+        Node *next = next_position(node);
+        return node_get_key(next) == character ? next : NULL;
+    }
+
+    Node *child = find_child(node, character);
+    return child != NULL ? edge_entry(child) : NULL;
+}
+
+Node * node_get_coded_child(const Node *node, const wchar_t character,
+                            const int code)
+{
+    if (!as_position(node)->node) return node_get_child(node, character);
+
+    Node *child = coded_child(node, character, code);
+    return child != NULL ? edge_entry(child) : NULL;
+}
+
+void node_recode(Node *node, const Alphabet *alphabet)
+{
+    node->head.coded = true;
+    node->codes = 0;
+
+    for (int i = 0; i < child_count(node); i++)
+    {
+        Node *child = child_at(node, i);
+        child->head.bit = code_bit(alphabet_find(alphabet, edge_key(child)));
+        mark_child(node, child);
+        node_recode(child, alphabet);
+    }
+}
+
+bool node_is_inner(const Node *node)
+{
+    return !as_position(node)->node;
+}
+
+Node * node_get_edge_end(const Node *node)
+{
+    return edge_end(node);
+}
+
+Node * node_split(Node *parent, Node *node, const int code)
+{
+    const struct position *position = as_position(node);
+    if (position->node) return node;
+
+    Node *end = edge_end(node);
+    size_t at = position->index - 1;
+    size_t rest = end->head.index - at - 1;
+
+    Node *split = node_alloc(position->value, at);
+    for (size_t i = 0; i < at; i++)
+        split->label[i].value = end->label[i].value;
+    split->head.bit = end->head.bit;
+    split->parent = end->parent;
+    split->child = end;
+
+    // Ojciec szuka syna po pierwszym znaku krawędzi, więc trzeba go zastąpić
+    // przed skróceniem krawędzi.
+    node_replace_child(parent, split);
+
+    // Węzeł krawędzi zostaje w tym samym miejscu pamięci, więc jego synowie
+    // nie zmieniają ojca.
+    memmove(end->label, end->label + at + 1, rest * sizeof(struct position));
+    for (size_t i = 0; i < rest; i++) end->label[i].index = i + 1;
+    end->head.index = rest;
+    end->head.bit = code_bit(code);
+    end->parent = split;
+    mark_child(split, end);
+
+    return split;
+}
+
+Node * node_merge_child(Node *node)
+{
+    Node *child = node->child;
+    if (child == NULL || node->head.is_word || node->parent == NULL)
+        return node;
+
+    size_t length = node->head.index + 1 + child->head.index;
+    if (length > NODE_MAX_LABEL) return node;
+
+    Node *merged = node_alloc(child->head.value, length);
+    for (size_t i = 0; i < node->head.index; i++)
+        merged->label[i].value = node->label[i].value;
+    merged->label[node->head.index].value = node->head.value;
+    for (size_t i = 0; i < child->head.index; i++)
+        merged->label[node->head.index + 1 + i].value = child->label[i].value;
+
+    merged->head.is_word = child->head.is_word;
+    merged->head.coded = child->head.coded;
+    merged->head.bit = node->head.bit;
+    merged->codes = child->codes;
+    merged->parent = node->parent;
+
+    // Synowie przechodzą do nowego węzła razem ze zbiorem.
+    merged->child = child->child;
+    merged->children = child->children;
+    child->child = NULL;
+    child->children = NULL;
+    node->child = NULL;
+    node_adopt_children(merged);
+
+    node_replace_child(node->parent, merged);
+    node_done_shallow(child);
+    node_done_shallow(node);
+
+    return merged;
+}
+
+Node * node_get_descendant(const Node *node, const wchar_t *str, size_t len)
+{
+    Node *ret = (Node *) node;
+
+    for (size_t i = 0; i < len && ret != NULL; i++)
+    {
+        ret = node_get_child(ret, str[i]);
+    }
+
     return ret;
 }
 
 Node * node_get_parent(const Node *node)
 {
-    return node->parent;
+    const struct position *position = as_position(node);
+
+    if (!position->node)
+    {
+        if (position->index > 1) return (Node *) (position - 1);
+        node = edge_end(node);
+    }
+    else if (position->index > 0)
+    {
+        return (Node *) &node->label[position->index - 1];
+    }
+
+    // Ojciec współdzielonego węzła może być zmieniany przez
+    // node_adopt_children() podczas czytania.
+    return __atomic_load_n(&node->parent, __ATOMIC_ACQUIRE);
 }
 
 wchar_t node_get_key(const Node *node) {
-    return node->value;
+    return as_position(node)->value;
 }
 
 int node_remove_child(Node *node, const wchar_t character)
 {
-    Node *tmp = node_new(character);
-    int ret = set_delete(node->children, tmp);
-    node_done(tmp);
-    return ret;
+    Node *child = find_child(node, character);
+    if (child == NULL) return 0;
+
+    if (child->head.bit != NODE_NO_CODE)
+        node->codes &= ~(UINT64_C(1) << child->head.bit);
+
+    if (node->children == NULL)
+    {
+        node->child = NULL;
+        node_done(child);
+        return 1;
+    }
+
+    Node key = { .head = { .value = character } };
+    set_delete(node->children, &key);
+
+    // Jedyny pozostały syn wraca do węzła, a zbiór jest zwalniany.
+    if (set_size(node->children) == 1)
+    {
+        node->child = set_get_by_index(node->children, 0);
+        set_done(node->children);
+        node->children = NULL;
+    }
+
+    return 1;
 }
 
 bool node_is_word(const Node *node)
 {
-    return node->is_word;
+    return as_position(node)->is_word;
 }
 
 void node_set_is_word(Node *node, const bool is_word)
 {
-    node->is_word = is_word;
+    node->head.is_word = is_word;
 }
 
 const int node_children_count(const Node *node)
 {
-    return set_size(node->children);
+    if (!as_position(node)->node) return 1;
+    return child_count(node);
 }
 
 Node * node_get_child_by_index(const Node *node, const int index)
 {
-    return set_get_by_index(node->children, index);
+    if (!as_position(node)->node) return next_position(node);
+    return edge_entry(child_at(node, index));
 }
 
 bool node_has_word(const Node *node, const wchar_t *word)
@@ -170,19 +1038,115 @@ bool node_has_word(const Node *node, const wchar_t *word)
     return node_is_word(node);
 }
 
+void node_has_words(const Node *node, const Alphabet *alphabet,
+                    const wchar_t * const *words, size_t n, bool *results)
+{
+    for (size_t start = 0; start < n; start += LOCKSTEP_WORDS)
+    {
+        const Node *nodes[LOCKSTEP_WORDS];
+        size_t active[LOCKSTEP_WORDS], n_active = 0;
+        size_t depths[LOCKSTEP_WORDS], lengths[LOCKSTEP_WORDS];
+
+        for (size_t i = start; i < n && i < start + LOCKSTEP_WORDS; i++)
+        {
+            if (words[i][0] == L'\0') results[i] = node_is_word(node);
+            else
+            {
+                nodes[n_active] = node;
+                depths[n_active] = 0;
+                lengths[n_active] = wcslen(words[i]);
+                active[n_active++] = i;
+            }
+        }
+
+        while (n_active > 0)
+        {
+            // Każdy krok wczytuje to, na co wskazuje wczytane w poprzednim,
+            // a między krokami przechodzimy przez wszystkie słowa. Jedyne
+            // dziecko jest wskazywane wprost, więc wczytujemy je od razu.
+            for (size_t j = 0; j < n_active; j++)
+            {
+                if (nodes[j]->children) __builtin_prefetch(nodes[j]->children);
+                else __builtin_prefetch(nodes[j]->child);
+            }
+            for (size_t j = 0; j < n_active; j++)
+            {
+                if (nodes[j]->children) set_prefetch(nodes[j]->children, false);
+            }
+            for (size_t j = 0; j < n_active; j++)
+            {
+                if (nodes[j]->children) set_prefetch(nodes[j]->children, true);
+            }
+
+            size_t kept = 0;
+            for (size_t j = 0; j < n_active; j++)
+            {
+                const wchar_t *word = words[active[j]] + depths[j];
+                size_t rest = lengths[j] - depths[j];
+                wchar_t c = word[0];
+                Node *child = alphabet
+                    ? coded_child(nodes[j], c, alphabet_find(alphabet, c))
+                    : find_child(nodes[j], c);
+
+                // Słowo musi przejść całą krawędź, bo wewnątrz niej nie
+                // kończą się słowa.
+                size_t length = child ? child->head.index : 0;
+                if (child == NULL || rest <= length
+                    || !label_matches(child->label, word, length)
+                    || word[length] != child->head.value)
+                    results[active[j]] = false;
+                else if (rest == length + 1)
+                    results[active[j]] = child->head.is_word;
+                else
+                {
+                    __builtin_prefetch(child);
+                    nodes[kept] = child;
+                    depths[kept] = depths[j] + length + 1;
+                    lengths[kept] = lengths[j];
+                    active[kept++] = active[j];
+                }
+            }
+            n_active = kept;
+        }
+    }
+}
+
 void node_add_words_to_list(const Node *node, wchar_t *prefix,
                             const size_t depth, struct word_list *list)
 {
-    prefix[depth+1] = L'\0';
+    const struct position *position = as_position(node);
 
-    for (size_t i = 0; i < node_children_count(node); i++)
+    if (!position->node)
     {
-        Node *child = set_get_by_index(node->children, i);
-        prefix[depth] = node_get_key(child);
+        // Słowa pozycji to słowa węzła kończącego jej krawędź.
+        const Node *end = edge_end(node);
+        size_t length = depth;
 
-        if (node_is_word(child)) word_list_add(list, prefix);
+        for (size_t i = position->index; i < end->head.index; i++)
+            prefix[length++] = end->label[i].value;
+        prefix[length++] = end->head.value;
+        prefix[length] = L'\0';
 
-        node_add_words_to_list(child, prefix, depth + 1, list);
+        if (end->head.is_word) word_list_add(list, prefix);
+        node_add_words_to_list(end, prefix, length, list);
+
+        prefix[depth] = L'\0';
+        return;
+    }
+
+    for (size_t i = 0; i < child_count(node); i++)
+    {
+        const Node *child = child_at(node, i);
+        size_t length = depth;
+
+        for (size_t j = 0; j < child->head.index; j++)
+            prefix[length++] = child->label[j].value;
+        prefix[length++] = child->head.value;
+        prefix[length] = L'\0';
+
+        if (child->head.is_word) word_list_add(list, prefix);
+
+        node_add_words_to_list(child, prefix, length, list);
     }
 
     prefix[depth] = L'\0';
@@ -190,14 +1154,23 @@ void node_add_words_to_list(const Node *node, wchar_t *prefix,
 
 int node_save(const Node *node, IO *io)
 {
-    for (int i = 0; i < node_children_count(node); i++)
+    for (int i = 0; i < child_count(node); i++)
     {
-        Node *child = set_get_by_index(node->children, i);
+        const Node *child = child_at(node, i);
 
-        if (io_printf(io, L"%lc", child->value) < 0) return -1;
-        if (node_is_word(child) && io_printf(io, L"%lc", L'*') < 0) return -1;
+        // Etykieta jest zapisywana tak jak łańcuch węzłów o jednym synu.
+        for (size_t j = 0; j < child->head.index; j++)
+        {
+            if (io_printf(io, L"%lc", child->label[j].value) < 0) return -1;
+        }
+        if (io_printf(io, L"%lc", child->head.value) < 0) return -1;
+        if (child->head.is_word && io_printf(io, L"%lc", L'*') < 0)
+            return -1;
         if (node_save(child, io) < 0) return -1;
-        if (io_printf(io, L"%lc", L'^') < 0) return -1;
+        for (size_t j = 0; j <= child->head.index; j++)
+        {
+            if (io_printf(io, L"%lc", L'^') < 0) return -1;
+        }
     }
 
     return 0;
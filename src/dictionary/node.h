@@ -14,10 +14,46 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include "word_list.h"
+#include "alphabet.h"
 #include "io.h"
 
+/**
+  Kod znaku, który nie ma bitu w masce dzieci węzła.
+  */
+#define NODE_NO_CODE ALPHABET_NONE
+
+/**
+  Liczba kodów znaków, które mają bit w masce dzieci węzła.
+  */
+#define NODE_CODED_CHILDREN 64
+
+/**
+  Największa liczba znaków etykiety krawędzi poprzedzających znak węzła.
+  */
+#define NODE_MAX_LABEL 65535
+
 /**
   Struktura przechowująca węzeł.
+
+  Drzewo jest skompresowane: krawędź prowadzi od ojca do węzła przez
+  etykietę, czyli ciąg znaków, a jej ostatnim znakiem jest znak węzła.
+  Łańcuch znaków bez rozgałęzień i końców słów, np. końcówka długiego
+  słowa, zajmuje więc jeden blok pamięci.
+
+  Interfejs przechodzi jednak po drzewie znak po znaku: znakom etykiety
+  odpowiadają pozycje wewnątrz krawędzi, które są widoczne jako węzły
+  o jednym dziecku, w których nie kończy się słowo. Funkcje przechodzenia
+  (node_get_child(), node_get_parent(), node_get_key() i podobne) działają
+  na pozycjach tak samo jak na węzłach, a wskaźnik na pozycję jest stały,
+  dopóki drzewo się nie zmienia. Funkcje zmieniające drzewo przyjmują tylko
+  węzły (zob. node_is_inner() i node_split()).
+
+  Węzeł pamięta maskę bitową kodów pierwszych znaków krawędzi swoich dzieci
+  (zob. alphabet.h). Jeśli każde dziecko ma kod mniejszy niż
+  NODE_CODED_CHILDREN, dziecko o danym kodzie jest wyznaczane bez
+  przeszukiwania: jego indeksem jest liczba ustawionych bitów maski przed
+  bitem kodu. W p.p. dzieci są przeszukiwane binarnie po znakach.
+  Jedyne dziecko węzła jest wskazywane wprost, bez zbioru dzieci.
   */
 typedef struct node Node;
 
@@ -31,10 +67,90 @@ Node * node_new(const wchar_t character);
 
 /**
   Destrukcja węzła.
+  Pozycja wewnątrz krawędzi oznacza tu węzeł kończący krawędź.
   @param[in,out] node Węzeł.
   */
 void node_done(Node *node);
 
+/**
+  Tworzy płytką kopię węzła.
+  Kopia ma ten sam klucz, etykietę, ojca i synów co węzeł; synowie nie są
+  kopiowani i ich ojcem nadal jest węzeł. Dla pozycji wewnątrz krawędzi
+  kopiowany jest węzeł kończący krawędź.
+  Kopię współdzielącą synów należy zniszczyć za pomocą node_done_shallow().
+  @param[in] node Węzeł lub pozycja wewnątrz krawędzi.
+  @return Nowy węzeł lub odpowiadająca pozycji pozycja w kopii.
+  */
+Node * node_copy(const Node *node);
+
+/**
+  Destrukcja węzła bez jego synów.
+  Pozycja wewnątrz krawędzi oznacza tu węzeł kończący krawędź.
+  @param[in,out] node Węzeł.
+  */
+void node_done_shallow(Node *node);
+
+/**
+  Tworzy kopię poddrzewa węzła w jednym bloku pamięci, w kolejności
+  przyjaznej dla pamięci podręcznej: węzły z danej liczby górnych poziomów
+  są ułożone wszerz, a poddrzewa węzłów z poziomu pod nimi w głąb, jedno
+  po drugim. Przejście od korzenia do słowa czyta więc najpierw zwarty
+  początek bloku, a potem kolejne węzły jednego poddrzewa.
+  W kopii każdy łańcuch pozycji bez rozgałęzień i końców słów jest
+  etykietą jednej krawędzi, niezależnie od podziału krawędzi w oryginale.
+  Kopia korzenia jest początkiem bloku i nie ma ojca. Węzłów bloku nie
+  zwalnia node_done() ani node_done_shallow() (zwalniają one tylko ich
+  zbiory dzieci), więc po zniszczeniu poddrzewa blok należy zwolnić za
+  pomocą node_free_block().
+  @param[in] node Korzeń poddrzewa.
+  @param[in] levels Liczba górnych poziomów, których synowie są układani
+  wszerz.
+  @return Korzeń kopii.
+  */
+Node * node_relayout(const Node *node, size_t levels);
+
+/**
+  Tworzy drzewo z zapisu w formacie node_save() od razu w jednym bloku
+  pamięci, ułożonym tak jak przez node_relayout(). Zapis musi być
+  poprawny: '^' nie może wychodzić ponad korzeń, a '*' oznacza koniec
+  słowa w bieżącej pozycji, także w korzeniu.
+  @param[in] character Znak korzenia.
+  @param[in] text Zapis drzewa.
+  @param[in] length Długość zapisu.
+  @param[in] alphabet Alfabet kodujący znaki węzłów.
+  @param[in] levels Liczba górnych poziomów, których synowie są układani
+  wszerz.
+  @return Korzeń bloku.
+  */
+Node * node_load_block(const wchar_t character, const wchar_t *text,
+                       const size_t length, const Alphabet *alphabet,
+                       const size_t levels);
+
+/**
+  Zwalnia blok węzłów utworzony przez node_relayout() lub
+  node_load_block().
+  @param[in,out] block Korzeń bloku.
+  */
+void node_free_block(Node *block);
+
+/**
+  Ustawia węzeł jako ojca wszystkich jego synów.
+  Zmiana jest atomowa, więc równoległe node_get_parent() zwraca
+  poprzedniego albo nowego ojca. Pozycja wewnątrz krawędzi nie ma synów
+  będących węzłami, więc nic się wtedy nie zmienia.
+  @param[in,out] node Węzeł.
+  */
+void node_adopt_children(Node *node);
+
+/**
+  Zastępuje syna węzła synem, którego krawędź zaczyna się od tego samego
+  znaku. Zastąpiony syn nie jest zwalniany.
+  @param[in,out] node Węzeł.
+  @param[in] child Nowy syn lub pozycja na jego krawędzi.
+  @return Zastąpiony syn lub NULL jeśli nie istniał.
+  */
+Node * node_replace_child(Node *node, Node *child);
+
 /**
   Tworzy syna węzła dla określonego znaku.
   @param[in,out] node Węzeł.
@@ -51,6 +167,40 @@ Node * node_add_child(Node *node, const wchar_t character);
   */
 Node * node_add_child_at_end(Node *node, const wchar_t character);
 
+/**
+  Tworzy syna węzła dla określonego znaku o danym kodzie.
+  @param[in,out] node Węzeł.
+  @param[in] character Znak dodawanego węzła.
+  @param[in] code Kod znaku w alfabecie drzewa lub NODE_NO_CODE.
+  @return Dodany syn.
+  */
+Node * node_add_coded_child(Node *node, const wchar_t character,
+                            const int code);
+
+/**
+  Tworzy syna węzła dla określonego znaku o danym kodzie zakładając, że ma
+  być ostatni.
+  @param[in,out] node Węzeł.
+  @param[in] character Znak dodawanego węzła.
+  @param[in] code Kod znaku w alfabecie drzewa lub NODE_NO_CODE.
+  @return Dodany syn.
+  */
+Node * node_add_coded_child_at_end(Node *node, const wchar_t character,
+                                   const int code);
+
+/**
+  Tworzy syna węzła, do którego prowadzi krawędź o danej etykiecie.
+  Krawędź dłuższa niż NODE_MAX_LABEL + 1 znaków jest dzielona na kilka.
+  @param[in,out] node Węzeł.
+  @param[in] label Znaki krawędzi (nie musi być zakończona znakiem L'\0').
+  @param[in] length Liczba znaków krawędzi, co najmniej 1.
+  @param[in] code Kod pierwszego znaku w alfabecie drzewa lub NODE_NO_CODE.
+  @return Węzeł na końcu krawędzi lub NULL, jeśli węzeł ma już syna
+  o pierwszym znaku krawędzi.
+  */
+Node * node_add_coded_edge(Node *node, const wchar_t *label, size_t length,
+                           const int code);
+
 /**
   Zwraca syna węzła o określonym znaku.
   @param[in] node Węzeł.
@@ -59,6 +209,72 @@ Node * node_add_child_at_end(Node *node, const wchar_t character);
   */
 Node * node_get_child(const Node *node, const wchar_t character);
 
+/**
+  Zwraca syna węzła o określonym znaku, korzystając z maski kodów dzieci.
+  @param[in] node Węzeł.
+  @param[in] character Znak szukanego węzła.
+  @param[in] code Kod znaku w alfabecie drzewa lub NODE_NO_CODE, jeśli
+  znaku nie ma w alfabecie.
+  @return Wskaźnik na syna lub NULL jeśli nie istnieje.
+  */
+Node * node_get_coded_child(const Node *node, const wchar_t character,
+                            const int code);
+
+/**
+  Wyznacza na nowo maski kodów dzieci w poddrzewie węzła.
+  Należy ją wywołać po zmianie kodów znaków alfabetu drzewa.
+  @param[in,out] node Węzeł.
+  @param[in] alphabet Alfabet drzewa.
+  */
+void node_recode(Node *node, const Alphabet *alphabet);
+
+/**
+  Sprawdza, czy pozycja leży wewnątrz krawędzi, czyli nie jest węzłem.
+  @param[in] node Węzeł lub pozycja.
+  @return Wartość logiczna określająca czy pozycja nie jest węzłem.
+  */
+bool node_is_inner(const Node *node);
+
+/**
+  Zwraca węzeł kończący krawędź, na której leży pozycja.
+  @param[in] node Węzeł lub pozycja wewnątrz krawędzi.
+  @return Węzeł kończący krawędź (dla węzła on sam).
+  */
+Node * node_get_edge_end(const Node *node);
+
+/**
+  Dzieli krawędź w pozycji wewnątrz niej: pozycja staje się nowym węzłem,
+  którego jedynym synem jest węzeł kończący krawędź, a u ojca krawędzi
+  zastępuje ten węzeł. Węzeł kończący krawędź zostaje w tym samym miejscu
+  pamięci, ale pozycje przed nią przestają być ważne. Ojciec jest podawany
+  wprost, bo w kopiach ścieżki ojciec węzła może być nieaktualny.
+  @param[in,out] parent Węzeł na początku krawędzi.
+  @param[in] node Pozycja; dla węzła nic się nie zmienia.
+  @param[in] code Kod znaku następnego po pozycji w alfabecie drzewa lub
+  NODE_NO_CODE.
+  @return Węzeł w miejscu pozycji.
+  */
+Node * node_split(Node *parent, Node *node, const int code);
+
+/**
+  Łączy krawędź węzła z krawędzią jego jedynego syna, jeśli węzeł ma
+  ojca, jednego syna i nie kończy się w nim słowo. Nowy węzeł zastępuje
+  węzeł u jego ojca i przejmuje synów syna; węzeł i syn są zwalniane.
+  Drzewo nie może być współdzielone, bo ojciec węzła musi być aktualny.
+  @param[in,out] node Węzeł.
+  @return Nowy węzeł lub węzeł, jeśli nie dało się go połączyć.
+  */
+Node * node_merge_child(Node *node);
+
+/**
+  Zwraca potomka węzła, do którego prowadzi dany ciąg znaków.
+  @param[in] node Węzeł.
+  @param[in] str Ciąg znaków (nie musi być zakończony znakiem L'\0').
+  @param[in] len Długość ciągu.
+  @return Wskaźnik na potomka lub NULL jeśli nie istnieje.
+  */
+Node * node_get_descendant(const Node *node, const wchar_t *str, size_t len);
+
 /**
   Zwraca ojca węzła.
   @param[in] node Węzeł.
@@ -90,7 +306,7 @@ bool node_is_word(const Node *node);
 
 /**
   Definiuje, czy w węzle kończy się słowo.
-  @param[in,out] node Węzeł.
+  @param[in,out] node Węzeł (nie pozycja wewnątrz krawędzi).
   @param[in] is_word Wartość logiczna określająca czy w węźle kończy się słowo
   */
 void node_set_is_word(Node *node, const bool is_word);
@@ -118,6 +334,20 @@ Node * node_get_child_by_index(const Node *node, const int index);
   */
 bool node_has_word(const Node *node, const wchar_t *word);
 
+/**
+  Sprawdza, czy poddrzewo zawiera dane słowa.
+  Słowa są szukane równolegle, krawędź po krawędzi, a dzieci węzłów
+  z następnej krawędzi są wczytywane z wyprzedzeniem, więc oczekiwanie na
+  pamięć dla różnych słów się nakłada.
+  @param[in] node Węzeł (nie pozycja wewnątrz krawędzi).
+  @param[in] alphabet Alfabet, którym zakodowano znaki dzieci, lub NULL.
+  @param[in] words Sprawdzane słowa.
+  @param[in] n Liczba słów.
+  @param[out] results Wartości logiczne określające czy słowa istnieją.
+  */
+void node_has_words(const Node *node, const Alphabet *alphabet,
+                    const wchar_t * const *words, size_t n, bool *results);
+
 /**
   Dodaje słowa kończące się w dzieciach węzła do listy słów.
   @param[in] node Węzeł.
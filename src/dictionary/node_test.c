@@ -165,6 +165,281 @@ static void node_remove_child_test(void** state)
     node_teardown(state);
 }
 
+/**
+  Testuje przechodzenie między jednym a wieloma dziećmi.
+  @param state Środowisko testowe.
+  */
+static void node_single_child_test(void** state)
+{
+    Node *node = node_new(L'ą');
+
+    Node *b = node_add_child(node, L'b');
+    assert_ptr_equal(node_add_child(node, L'b'), b);
+    assert_int_equal(node_children_count(node), 1);
+    assert_ptr_equal(node_get_child_by_index(node, 0), b);
+    assert_null(node_get_child(node, L'a'));
+
+    Node *copy = node_copy(b);
+    assert_ptr_equal(node_replace_child(node, copy), b);
+    node_done(b);
+    b = node_new(L'c');
+    assert_null(node_replace_child(node, b));
+    node_done(b);
+    b = copy;
+
+    // Drugie dziecko trafia przed pierwsze.
+    Node *a = node_add_child(node, L'a');
+    assert_int_equal(node_children_count(node), 2);
+    assert_ptr_equal(node_get_child_by_index(node, 0), a);
+    assert_ptr_equal(node_get_child_by_index(node, 1), b);
+
+    // Po usunięciu zostaje jedno dziecko.
+    assert_int_equal(node_remove_child(node, L'b'), 1);
+    assert_int_equal(node_remove_child(node, L'b'), 0);
+    assert_int_equal(node_children_count(node), 1);
+    assert_ptr_equal(node_get_child(node, L'a'), a);
+    assert_ptr_equal(node_get_parent(a), node);
+
+    assert_int_equal(node_remove_child(node, L'a'), 1);
+    assert_int_equal(node_children_count(node), 0);
+    assert_null(node_get_child(node, L'a'));
+
+    node_done(node);
+}
+
+/**
+  Testuje krawędzie z etykietami, ich podział i łączenie.
+  @param state Środowisko testowe.
+  */
+static void node_edge_test(void** state)
+{
+    Node *root = node_new(L'\0');
+    Node *end = node_add_coded_edge(root, L"kotek", 5, NODE_NO_CODE);
+    node_set_is_word(end, true);
+    assert_null(node_add_coded_edge(root, L"kot", 3, NODE_NO_CODE));
+
+    // Znaki etykiety są widoczne jako pozycje o jednym dziecku.
+    Node *position = node_get_child(root, L'k');
+    assert_true(node_is_inner(position));
+    assert_false(node_is_inner(end));
+    assert_ptr_equal(node_get_edge_end(position), end);
+    assert_int_equal(node_children_count(position), 1);
+    assert_false(node_is_word(position));
+    assert_null(node_get_child(position, L'x'));
+    assert_ptr_equal(node_get_descendant(root, L"kotek", 5), end);
+    assert_ptr_equal(node_get_parent(position), root);
+    assert_true(node_has_word(root, L"kotek"));
+    assert_false(node_has_word(root, L"kot"));
+
+    const wchar_t *words[] = {L"kotek", L"kot", L"kotki", L"kotekk"};
+    bool results[4];
+    node_has_words(root, NULL, words, 4, results);
+    assert_true(results[0]);
+    assert_false(results[1] || results[2] || results[3]);
+
+    // Podział krawędzi w pozycji zostawia węzeł krawędzi na miejscu.
+    Node *t = node_split(root, node_get_descendant(root, L"kot", 3),
+                         NODE_NO_CODE);
+    assert_false(node_is_inner(t));
+    assert_int_equal(node_get_key(t), L't');
+    assert_ptr_equal(node_get_descendant(root, L"kot", 3), t);
+    assert_ptr_equal(node_get_descendant(root, L"kotek", 5), end);
+    assert_true(node_is_inner(node_get_parent(end)));
+    assert_ptr_equal(node_get_parent(node_get_parent(end)), t);
+
+    // Węzeł, w którym kończy się słowo, nie jest łączony z synem.
+    node_set_is_word(t, true);
+    assert_ptr_equal(node_merge_child(t), t);
+    node_set_is_word(t, false);
+    end = node_merge_child(t);
+    assert_ptr_equal(node_get_descendant(root, L"kotek", 5), end);
+    assert_true(node_is_inner(node_get_descendant(root, L"kot", 3)));
+    assert_true(node_is_word(end));
+
+    // Słowa pozycji to słowa węzła kończącego jej krawędź.
+    wchar_t prefix[10] = L"ko";
+    struct word_list list;
+    word_list_init(&list);
+    node_add_words_to_list(node_get_descendant(root, L"ko", 2), prefix, 2,
+                           &list);
+    assert_int_equal(word_list_size(&list), 1);
+    assert_true(wcscmp(word_list_get(&list)[0], L"kotek") == 0);
+    word_list_done(&list);
+
+    node_done(root);
+}
+
+/**
+  Testuje układanie poddrzewa w jednym bloku pamięci.
+  @param state Środowisko testowe.
+  */
+static void node_relayout_test(void** state)
+{
+    node_setup(state);
+
+    Node *node = *state;
+    Node *copy = node_relayout(node, 1);
+    wchar_t prefix[10];
+    struct word_list list, reference;
+    word_list_init(&list);
+    word_list_init(&reference);
+
+    node_add_words_to_list(node, prefix, 0, &reference);
+    node_add_words_to_list(copy, prefix, 0, &list);
+    assert_int_equal(word_list_size(&list), word_list_size(&reference));
+    for (size_t i = 0; i < word_list_size(&list); i++)
+    {
+        assert_true(wcscmp(word_list_get(&list)[i],
+                           word_list_get(&reference)[i]) == 0);
+    }
+
+    // Synowie korzenia wszerz, a dalej poddrzewa jedno po drugim.
+    assert_null(node_get_parent(copy));
+    for (int i = 0; i < 5; i++)
+    {
+        Node *child = node_get_child_by_index(copy, i);
+        assert_ptr_equal(child, copy + 1 + i);
+        assert_ptr_equal(node_get_parent(child), copy);
+        assert_ptr_equal(node_get_child_by_index(child, 0), copy + 6 + 5 * i);
+    }
+
+    // Węzły bloku można usuwać.
+    node_remove_child(copy, L'b');
+    assert_null(node_get_child(copy, L'b'));
+    assert_non_null(node_get_child(copy, L'x'));
+
+    node_done(copy);
+    node_free_block(copy);
+    word_list_done(&list);
+    word_list_done(&reference);
+    node_teardown(state);
+}
+
+/**
+  Sprawdza, czy dwa bloki węzłów mają ten sam układ i te same węzły.
+  @param[in] a Węzeł pierwszego bloku.
+  @param[in] block_a Początek pierwszego bloku.
+  @param[in] b Odpowiadający mu węzeł drugiego bloku.
+  @param[in] block_b Początek drugiego bloku.
+  */
+static void assert_same_block(const Node *a, const Node *block_a,
+                              const Node *b, const Node *block_b)
+{
+    assert_int_equal((const char *) a - (const char *) block_a,
+                     (const char *) b - (const char *) block_b);
+    assert_int_equal(a->head.value, b->head.value);
+    assert_int_equal(a->head.index, b->head.index);
+    assert_int_equal(a->head.is_word, b->head.is_word);
+    assert_int_equal(a->head.coded, b->head.coded);
+    assert_int_equal(a->head.bit, b->head.bit);
+    assert_true(a->codes == b->codes);
+    for (size_t i = 0; i < a->head.index; i++)
+        assert_int_equal(a->label[i].value, b->label[i].value);
+
+    assert_int_equal(child_count(a), child_count(b));
+    for (int i = 0; i < child_count(a); i++)
+    {
+        assert_ptr_equal(child_at(b, i)->parent, b);
+        assert_same_block(child_at(a, i), block_a, child_at(b, i), block_b);
+    }
+}
+
+/**
+  Testuje tworzenie bloku węzłów wprost z zapisu.
+  @param state Środowisko testowe.
+  */
+static void node_load_block_test(void** state)
+{
+    (void) state;
+    const wchar_t *words[] = {L"ab", L"ac", L"acd", L"xyz", L"xyzzy"};
+    const wchar_t text[] = L"*ab*^c*d*^^^xyz*zy*^^^^^";
+    Alphabet *alphabet = alphabet_new();
+    Node *node = node_new(L'\0');
+    node_set_is_word(node, true);
+
+    for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); i++)
+    {
+        Node *position = node;
+        for (const wchar_t *c = words[i]; *c; c++)
+        {
+            alphabet_add(alphabet, *c);
+            position = node_add_child(position, *c);
+        }
+        node_set_is_word(position, true);
+    }
+    node_recode(node, alphabet);
+
+    Node *copy = node_relayout(node, 1);
+    Node *block = node_load_block(L'\0', text, wcslen(text), alphabet, 1);
+    assert_same_block(copy, copy, block, block);
+
+    node_done(block);
+    node_free_block(block);
+    node_done(copy);
+    node_free_block(copy);
+    node_done(node);
+    alphabet_done(alphabet);
+}
+
+/**
+  Sprawdza, czy dzieci węzła są wyszukiwane tak samo z kodami i bez nich.
+  @param[in] node Węzeł.
+  @param[in] alphabet Alfabet, którym zakodowano znaki dzieci.
+  @param[in] chars Sprawdzane znaki.
+  */
+static void assert_same_children(const Node *node, const Alphabet *alphabet,
+                                 const wchar_t *chars)
+{
+    for (; *chars != L'\0'; chars++)
+    {
+        assert_ptr_equal(node_get_coded_child(node, *chars,
+                                              alphabet_find(alphabet, *chars)),
+                         node_get_child(node, *chars));
+    }
+}
+
+/**
+  Testuje wyszukiwanie dzieci po kodach znaków.
+  @param state Środowisko testowe.
+  */
+static void node_coded_child_test(void** state)
+{
+    const wchar_t *chars = L"źabcćdeęfghijklłmnńoópqrsśtuvwxyzżABCDEFGHIJKL"
+                           L"MNOPQRSTUVWXYZ";
+    Alphabet *alphabet = alphabet_new();
+    for (const wchar_t *c = chars; *c != L'\0'; c++)
+        alphabet_add(alphabet, *c);
+
+    // Dzieci dodawane w dowolnej kolejności.
+    Node *node = node_new(L'\0');
+    for (const wchar_t *c = L"żazłćBę"; *c != L'\0'; c++)
+        node_add_coded_child(node, *c, alphabet_find(alphabet, *c));
+    assert_same_children(node, alphabet, chars);
+    assert_same_children(node, alphabet, L"ą\u4e00");
+
+    node_remove_child(node, L'z');
+    node_remove_child(node, L'B');
+    assert_null(node_get_coded_child(node, L'z',
+                                     alphabet_find(alphabet, L'z')));
+    assert_same_children(node, alphabet, chars);
+
+    // Znak bez kodu wyłącza maskę, a więc i zmienia sposób wyszukiwania.
+    node_add_coded_child(node, L'ą', NODE_NO_CODE);
+    assert_same_children(node, alphabet, L"ążazłćBę\u4e00");
+
+    // Po dodaniu znaku kody większych znaków się zmieniają.
+    assert_int_equal(alphabet_add(alphabet, L'Ą'), 1);
+    assert_int_equal(alphabet_add(alphabet, L'ą'), 1);
+    node_recode(node, alphabet);
+    assert_same_children(node, alphabet, chars);
+    assert_same_children(node, alphabet, L"ąĄ");
+    assert_non_null(node_get_coded_child(node, L'ą',
+                                         alphabet_find(alphabet, L'ą')));
+
+    node_done(node);
+    alphabet_done(alphabet);
+}
+
 /**
   Testuje wyszukiwanie słowa.
   @param state Środowisko testowe.
@@ -186,6 +461,35 @@ static void node_has_word_test(void** state)
     node_teardown(state);
 }
 
+/**
+  Testuje wyszukiwanie wielu słów naraz.
+  @param state Środowisko testowe.
+  */
+static void node_has_words_test(void** state)
+{
+    node_setup(state);
+
+    Node *node = *state;
+    const wchar_t *samples[] = {L"ą", L"x", L"ł", L"xą", L"ąx", L"xx", L"źł",
+                                L""};
+    const size_t n_samples = sizeof(samples) / sizeof(samples[0]);
+
+    // Więcej słów niż mieści jedna grupa przeszukiwana naraz.
+    const size_t n = 5 * n_samples;
+    const wchar_t *words[n];
+    bool results[n];
+
+    for (size_t i = 0; i < n; i++) words[i] = samples[i % n_samples];
+
+    node_has_words(node, NULL, words, n, results);
+    for (size_t i = 0; i < n; i++)
+        assert_int_equal(results[i], node_has_word(node, words[i]));
+
+    node_has_words(node, NULL, words, 0, results);
+
+    node_teardown(state);
+}
+
 /**
   Testuje zapisanie słów do listy słów.
   @param state Środowisko testowe.
@@ -291,7 +595,13 @@ int main(void)
         cmocka_unit_test(node_get_child_test),
         cmocka_unit_test(node_get_parent_test),
         cmocka_unit_test(node_remove_child_test),
+        cmocka_unit_test(node_coded_child_test),
+        cmocka_unit_test(node_single_child_test),
+        cmocka_unit_test(node_edge_test),
+        cmocka_unit_test(node_relayout_test),
+        cmocka_unit_test(node_load_block_test),
         cmocka_unit_test(node_has_word_test),
+        cmocka_unit_test(node_has_words_test),
         cmocka_unit_test(node_add_words_to_list_test),
         cmocka_unit_test(node_save_test)
     };
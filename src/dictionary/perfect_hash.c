@@ -0,0 +1,519 @@
+/** @file
+    Implementacja indeksu słów opartego na minimalnym haszowaniu doskonałym.
+
+    Kubełki są przetwarzane od największych; dla każdego szukany jest
+    najmniejszy pilot, przy którym słowa kubełka trafiają na różne wolne
+    miejsca. Kubełki jednoelementowe, obsługiwane na końcu, dostają
+    bezpośrednio numer wolnego miejsca (pilot z bitem DIRECT_PILOT), więc
+    ostatnie miejsca nie wymagają długiego szukania.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#include "perfect_hash.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+  Bit pilota oznaczający, że pozostałe bity są numerem miejsca.
+  */
+#define DIRECT_PILOT (UINT32_C(1) << 31)
+
+/**
+  Liczba pilotów sprawdzanych dla jednego kubełka przed zmianą ziarna.
+  */
+#define MAX_PILOT (UINT32_C(1) << 20)
+
+/**
+  Liczba ziaren sprawdzanych przed uznaniem budowy za niemożliwą.
+  */
+#define MAX_SEEDS 64
+
+/**
+  Oznaczenie wolnego miejsca podczas wypełniania indeksu.
+  */
+#define EMPTY_SLOT UINT32_MAX
+
+/**
+  Miejsce tablicy indeksu.
+  */
+struct slot
+{
+    /// Odcisk słowa.
+    uint32_t fingerprint;
+    /// Pozycja zapisu słowa w UTF-8 w puli.
+    uint32_t offset;
+};
+
+/**
+  Struktura przechowująca indeks.
+  */
+struct perfect_hash
+{
+    /// Ziarno funkcji haszującej.
+    uint64_t seed;
+    /// Liczba słów (i miejsc).
+    size_t n_words;
+    /// Liczba kubełków.
+    size_t n_buckets;
+    /// Piloty kubełków.
+    uint32_t *pilots;
+    /// Miejsca.
+    struct slot *slots;
+    /// Zapisy słów w UTF-8 zakończone zerem.
+    char *pool;
+    /// Rozmiar puli.
+    size_t pool_size;
+};
+
+/** @name Funkcje pomocnicze
+  @{
+  */
+
+/*
+ malloc opakowany w obsługę błędu
+ */
+static void * emalloc(size_t size)
+{
+    void *ptr = malloc(size > 0 ? size : 1);
+    if (!ptr)
+    {
+        fprintf(stderr, "Failed to allocate memory for perfect hash\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return ptr;
+}
+
+/**
+  Miesza bity 64-bitowej liczby.
+  @param[in] x Liczba.
+  @return Przemieszana liczba.
+  */
+static uint64_t mix(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+
+    return x;
+}
+
+/**
+  Wyznacza skrót słowa.
+  Wyższa połowa skrótu wybiera kubełek, a niższa jest odciskiem słowa.
+  @param[in] word Słowo.
+  @param[in] seed Ziarno.
+  @return Skrót.
+  */
+static uint64_t hash_word(const wchar_t *word, uint64_t seed)
+{
+    uint64_t hash = 14695981039346656037ULL ^ mix(seed);
+
+    for (; *word != L'\0'; word++)
+    {
+        hash ^= (uint32_t) *word;
+        hash *= 1099511628211ULL;
+    }
+
+    return mix(hash);
+}
+
+/**
+  Wyznacza liczbę z przedziału [0, n) z wyższej połowy liczby 64-bitowej.
+  @param[in] x Liczba.
+  @param[in] n Rozmiar przedziału.
+  @return Liczba z przedziału.
+  */
+static size_t reduce(uint64_t x, size_t n)
+{
+    return ((x >> 32) * n) >> 32;
+}
+
+/**
+  Wyznacza miejsce słowa przy danym pilocie kubełka.
+  @param[in] hash Indeks.
+  @param[in] h Skrót słowa.
+  @param[in] pilot Pilot.
+  @return Numer miejsca.
+  */
+static size_t position(const Perfect_Hash *hash, uint64_t h, uint32_t pilot)
+{
+    if (pilot & DIRECT_PILOT) return pilot & ~DIRECT_PILOT;
+
+    return reduce(mix(h ^ ((uint64_t) (pilot + 1) * 0x9e3779b97f4a7c15ULL)),
+                  hash->n_words);
+}
+
+/**
+  Wyznacza miejsce słowa.
+  @param[in] hash Indeks.
+  @param[in] h Skrót słowa.
+  @return Numer miejsca.
+  */
+static size_t slot_of(const Perfect_Hash *hash, uint64_t h)
+{
+    return position(hash, h, hash->pilots[reduce(h, hash->n_buckets)]);
+}
+
+/**
+  Zapisuje znak w UTF-8.
+  @param[in] c Znak.
+  @param[out] buf Bufor na co najmniej 4 bajty lub NULL.
+  @return Liczba bajtów zapisu.
+  */
+static size_t encode_utf8(wchar_t c, char *buf)
+{
+    uint32_t u = (uint32_t) c;
+    char tmp[4];
+    if (buf == NULL) buf = tmp;
+
+    if (u < 0x80)
+    {
+        buf[0] = u;
+        return 1;
+    }
+    if (u < 0x800)
+    {
+        buf[0] = 0xC0 | (u >> 6);
+        buf[1] = 0x80 | (u & 0x3F);
+        return 2;
+    }
+    if (u < 0x10000)
+    {
+        buf[0] = 0xE0 | (u >> 12);
+        buf[1] = 0x80 | ((u >> 6) & 0x3F);
+        buf[2] = 0x80 | (u & 0x3F);
+        return 3;
+    }
+
+    buf[0] = 0xF0 | ((u >> 18) & 0x07);
+    buf[1] = 0x80 | ((u >> 12) & 0x3F);
+    buf[2] = 0x80 | ((u >> 6) & 0x3F);
+    buf[3] = 0x80 | (u & 0x3F);
+    return 4;
+}
+
+/**
+  Porównuje słowo z zapisem w UTF-8.
+  @param[in] utf8 Zapis zakończony zerem.
+  @param[in] word Słowo.
+  @return Czy zapis jest zapisem słowa.
+  */
+static bool equals_utf8(const char *utf8, const wchar_t *word)
+{
+    char buf[4];
+
+    for (; *word != L'\0'; word++)
+    {
+        size_t len = encode_utf8(*word, buf);
+        if (memcmp(utf8, buf, len) != 0) return false;
+        utf8 += len;
+    }
+
+    return *utf8 == '\0';
+}
+
+/**
+  Tworzy pusty indeks.
+  @param[in] n Liczba słów.
+  @param[in] seed Ziarno.
+  @param[in] n_buckets Liczba kubełków.
+  @return Indeks bez miejsc i puli.
+  */
+static Perfect_Hash * hash_new(size_t n, uint64_t seed, size_t n_buckets)
+{
+    Perfect_Hash *hash = emalloc(sizeof(Perfect_Hash));
+
+    hash->seed = seed;
+    hash->n_words = n;
+    hash->n_buckets = n_buckets;
+    hash->pilots = emalloc(n_buckets * sizeof(uint32_t));
+    memset(hash->pilots, 0, n_buckets * sizeof(uint32_t));
+    hash->slots = NULL;
+    hash->pool = NULL;
+    hash->pool_size = 0;
+
+    return hash;
+}
+
+/**
+  Szuka pilotów kubełków.
+  @param[in,out] hash Indeks z ziarnem i liczbą kubełków.
+  @param[in] hashes Skróty słów.
+  @return Czy znaleziono piloty dla wszystkich kubełków.
+  */
+static bool find_pilots(Perfect_Hash *hash, const uint64_t *hashes)
+{
+    size_t n = hash->n_words, n_buckets = hash->n_buckets;
+    size_t *start = emalloc((n_buckets + 1) * sizeof(size_t));
+    size_t *members = emalloc(n * sizeof(size_t));
+    size_t *order = emalloc(n_buckets * sizeof(size_t));
+    size_t *fill = emalloc(n_buckets * sizeof(size_t));
+    bool *taken = emalloc(n * sizeof(bool));
+    size_t max_size = 0;
+
+    // Sortowanie słów po kubełkach przez zliczanie.
+    memset(start, 0, (n_buckets + 1) * sizeof(size_t));
+    for (size_t i = 0; i < n; i++) start[reduce(hashes[i], n_buckets) + 1]++;
+    for (size_t b = 0; b < n_buckets; b++)
+    {
+        if (start[b + 1] > max_size) max_size = start[b + 1];
+        start[b + 1] += start[b];
+    }
+
+    memcpy(fill, start, n_buckets * sizeof(size_t));
+    for (size_t i = 0; i < n; i++)
+        members[fill[reduce(hashes[i], n_buckets)]++] = i;
+
+    // Kubełki od największych, stabilnie.
+    size_t n_ordered = 0;
+    for (size_t size = max_size; size > 0; size--)
+    {
+        for (size_t b = 0; b < n_buckets; b++)
+        {
+            if (start[b + 1] - start[b] == size) order[n_ordered++] = b;
+        }
+    }
+
+    memset(taken, 0, n * sizeof(bool));
+    bool ok = true;
+    size_t next_free = 0;
+
+    for (size_t k = 0; k < n_ordered && ok; k++)
+    {
+        size_t b = order[k];
+        const size_t *bucket = members + start[b];
+        size_t size = start[b + 1] - start[b];
+
+        if (size == 1)
+        {
+            while (taken[next_free]) next_free++;
+            taken[next_free] = true;
+            hash->pilots[b] = DIRECT_PILOT | next_free;
+            continue;
+        }
+
+        size_t pos[size];
+        uint32_t pilot;
+        for (pilot = 0; pilot < MAX_PILOT; pilot++)
+        {
+            size_t j;
+            for (j = 0; j < size; j++)
+            {
+                pos[j] = position(hash, hashes[bucket[j]], pilot);
+                if (taken[pos[j]]) break;
+
+                size_t l;
+                for (l = 0; l < j && pos[l] != pos[j]; l++);
+                if (l < j) break;
+            }
+
+            if (j == size) break;
+        }
+
+        if (pilot == MAX_PILOT)
+        {
+            ok = false;
+            break;
+        }
+
+        hash->pilots[b] = pilot;
+        for (size_t j = 0; j < size; j++) taken[pos[j]] = true;
+    }
+
+    free(taken);
+    free(fill);
+    free(order);
+    free(members);
+    free(start);
+
+    return ok;
+}
+
+/**
+  Wypełnia indeks słowami.
+  @param[in,out] hash Indeks z pilotami.
+  @param[in] words Słowa.
+  @return Czy każde słowo trafiło na inne miejsce.
+  */
+static bool fill_slots(Perfect_Hash *hash, const wchar_t * const *words)
+{
+    size_t n = hash->n_words;
+
+    hash->pool_size = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        for (const wchar_t *c = words[i]; *c != L'\0'; c++)
+            hash->pool_size += encode_utf8(*c, NULL);
+        hash->pool_size++;
+    }
+
+    if (hash->pool_size >= EMPTY_SLOT) return false;
+
+    hash->slots = emalloc(n * sizeof(struct slot));
+    hash->pool = emalloc(hash->pool_size);
+    for (size_t i = 0; i < n; i++) hash->slots[i].offset = EMPTY_SLOT;
+
+    size_t offset = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t h = hash_word(words[i], hash->seed);
+        size_t s = slot_of(hash, h);
+        if (s >= n || hash->slots[s].offset != EMPTY_SLOT) return false;
+
+        hash->slots[s].fingerprint = (uint32_t) h;
+        hash->slots[s].offset = offset;
+
+        for (const wchar_t *c = words[i]; *c != L'\0'; c++)
+            offset += encode_utf8(*c, hash->pool + offset);
+        hash->pool[offset++] = '\0';
+    }
+
+    return true;
+}
+
+/**
+  Wczytuje liczbę zakończoną spacją lub końcem linii.
+  @param[in,out] io Wejście/wyjście.
+  @param[out] value Liczba.
+  @param[out] end Znak kończący liczbę.
+  @return Czy wczytano liczbę.
+  */
+static bool read_number(IO *io, uint64_t *value, wint_t *end)
+{
+    bool any = false;
+    wint_t c;
+
+    *value = 0;
+    while ((c = io_get_next(io)) >= L'0' && c <= L'9')
+    {
+        if (*value > (UINT64_MAX - 9) / 10) return false;
+        *value = *value * 10 + (c - L'0');
+        any = true;
+    }
+
+    *end = c;
+    return any && (c == L' ' || c == L'\n');
+}
+
+/**@}*/
+/** @name Elementy interfejsu
+  @{
+  */
+
+Perfect_Hash * perfect_hash_build(const wchar_t * const *words, size_t n)
+{
+    if (n >= DIRECT_PILOT)
+    {
+        fprintf(stderr, "Too many words for perfect hash\n");
+        exit(EXIT_FAILURE);
+    }
+
+    uint64_t *hashes = emalloc(n * sizeof(uint64_t));
+
+    for (uint64_t seed = 0; seed < MAX_SEEDS; seed++)
+    {
+        Perfect_Hash *hash = hash_new(n, seed, n / 2 + 1);
+
+        for (size_t i = 0; i < n; i++) hashes[i] = hash_word(words[i], seed);
+
+        if (find_pilots(hash, hashes) && fill_slots(hash, words))
+        {
+            free(hashes);
+            return hash;
+        }
+
+        perfect_hash_done(hash);
+    }
+
+    fprintf(stderr, "Failed to build perfect hash\n");
+    exit(EXIT_FAILURE);
+}
+
+void perfect_hash_done(Perfect_Hash *hash)
+{
+    free(hash->pool);
+    free(hash->slots);
+    free(hash->pilots);
+    free(hash);
+}
+
+bool perfect_hash_contains(const Perfect_Hash *hash, const wchar_t *word)
+{
+    if (hash->n_words == 0) return false;
+
+    uint64_t h = hash_word(word, hash->seed);
+    const struct slot *slot = &hash->slots[slot_of(hash, h)];
+
+    return slot->fingerprint == (uint32_t) h
+           && equals_utf8(hash->pool + slot->offset, word);
+}
+
+size_t perfect_hash_memory(const Perfect_Hash *hash)
+{
+    return hash->n_buckets * sizeof(uint32_t)
+           + hash->n_words * sizeof(struct slot) + hash->pool_size;
+}
+
+int perfect_hash_save(const Perfect_Hash *hash, IO *io)
+{
+    if (io_printf(io, L"#%llu %zu %zu", (unsigned long long) hash->seed,
+                  hash->n_words, hash->n_buckets) < 0)
+        return -1;
+
+    for (size_t b = 0; b < hash->n_buckets; b++)
+    {
+        if (io_printf(io, L" %lu", (unsigned long) hash->pilots[b]) < 0)
+            return -1;
+    }
+
+    if (io_printf(io, L"\n") < 0) return -1;
+
+    return 0;
+}
+
+Perfect_Hash * perfect_hash_load(IO *io, const wchar_t * const *words,
+                                 size_t n)
+{
+    uint64_t seed, n_words, n_buckets, pilot;
+    wint_t end;
+
+    if (io_get_next(io) != L'#'
+        || !read_number(io, &seed, &end) || end != L' '
+        || !read_number(io, &n_words, &end) || end != L' '
+        || !read_number(io, &n_buckets, &end)
+        || n_words != n || n_buckets == 0 || n_buckets > n + 1)
+        return NULL;
+
+    Perfect_Hash *hash = hash_new(n, seed, n_buckets);
+
+    for (size_t b = 0; b < n_buckets; b++)
+    {
+        if (end != L' ' || !read_number(io, &pilot, &end)
+            || pilot > UINT32_MAX)
+        {
+            perfect_hash_done(hash);
+            return NULL;
+        }
+
+        hash->pilots[b] = pilot;
+    }
+
+    if (end != L'\n' || !fill_slots(hash, words))
+    {
+        perfect_hash_done(hash);
+        return NULL;
+    }
+
+    return hash;
+}
+
+/**@}*/
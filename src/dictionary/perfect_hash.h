@@ -0,0 +1,85 @@
+/** @file
+    Interfejs indeksu słów opartego na minimalnym haszowaniu doskonałym.
+
+    Indeks odpowiada tylko na pytanie, czy słowo należy do zbioru, podanego
+    w całości przy budowie. Słowa są rozrzucane do kubełków, a dla każdego
+    kubełka wybierany jest parametr (pilot) funkcji haszującej, przy którym
+    jego słowa trafiają na wolne miejsca tablicy o rozmiarze równym liczbie
+    słów. Miejsce przechowuje odcisk słowa i jego zapis w UTF-8, więc słowo
+    spoza zbioru jest zwykle odrzucane po odczycie pilota i miejsca,
+    a słowo ze zbioru wymaga dodatkowo porównania z zapisem.
+
+    Zapisane są tylko piloty; przy wczytaniu indeks jest wypełniany słowami
+    bez ponownego szukania pilotów.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#ifndef __PERFECT_HASH_H__
+#define __PERFECT_HASH_H__
+
+#include "io.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <wchar.h>
+
+/**
+  Struktura przechowująca indeks.
+  */
+typedef struct perfect_hash Perfect_Hash;
+
+/**
+  Buduje indeks zbioru słów.
+  Należy go zniszczyć za pomocą perfect_hash_done().
+  @param[in] words Słowa (bez powtórzeń).
+  @param[in] n Liczba słów.
+  @return Nowy indeks.
+  */
+Perfect_Hash * perfect_hash_build(const wchar_t * const *words, size_t n);
+
+/**
+  Destrukcja indeksu.
+  @param[in,out] hash Indeks.
+  */
+void perfect_hash_done(Perfect_Hash *hash);
+
+/**
+  Sprawdza, czy słowo należy do zbioru.
+  Funkcję można wywoływać jednocześnie z wielu wątków.
+  @param[in] hash Indeks.
+  @param[in] word Słowo.
+  @return Czy słowo należy do zbioru.
+  */
+bool perfect_hash_contains(const Perfect_Hash *hash, const wchar_t *word);
+
+/**
+  Zwraca pamięć zajmowaną przez indeks.
+  @param[in] hash Indeks.
+  @return Rozmiar w bajtach.
+  */
+size_t perfect_hash_memory(const Perfect_Hash *hash);
+
+/**
+  Zapisuje parametry indeksu w jednej linii zaczynającej się od `#`.
+  @param[in] hash Indeks.
+  @param[in,out] io Wejście/wyjście.
+  @return <0 jeśli operacja się nie powiedzie, 0 w p.p.
+  */
+int perfect_hash_save(const Perfect_Hash *hash, IO *io);
+
+/**
+  Wczytuje parametry indeksu zapisane przez perfect_hash_save() i wypełnia
+  go słowami.
+  @param[in,out] io Wejście/wyjście.
+  @param[in] words Słowa, dla których zbudowano zapisany indeks.
+  @param[in] n Liczba słów.
+  @return Indeks lub NULL, jeśli zapis jest niepoprawny albo nie pasuje
+  do słów.
+  */
+Perfect_Hash * perfect_hash_load(IO *io, const wchar_t * const *words,
+                                 size_t n);
+
+#endif /* __PERFECT_HASH_H__ */
@@ -0,0 +1,138 @@
+/** @file
+    Testy indeksu opartego na haszowaniu doskonałym.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwerstet Warszawski
+    @date 2026-10-19
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <cmocka.h>
+#include <locale.h>
+#include "perfect_hash.c"
+#include "utils.h"
+
+/**
+  Liczba słów używanych w testach.
+  */
+#define N_WORDS 5000
+
+/**
+  Słowa używane w testach.
+  */
+static wchar_t words[N_WORDS][16];
+
+/**
+  Wskaźniki na słowa używane w testach.
+  */
+static const wchar_t *word_ptrs[N_WORDS];
+
+/**
+  Testuje wyszukiwanie w zbudowanym indeksie.
+  @param state Środowisko testowe.
+  */
+static void perfect_hash_build_test(void** state)
+{
+    Perfect_Hash *hash = perfect_hash_build(word_ptrs, N_WORDS);
+    wchar_t word[16];
+
+    for (int i = 0; i < N_WORDS; i++)
+        assert_true(perfect_hash_contains(hash, words[i]));
+
+    for (int i = 0; i < N_WORDS; i++)
+    {
+        swprintf(word, 16, L"inne%d", i);
+        assert_false(perfect_hash_contains(hash, word));
+    }
+
+    assert_false(perfect_hash_contains(hash, L""));
+    assert_false(perfect_hash_contains(hash, L"żółw"));
+    assert_false(perfect_hash_contains(hash, L"żółw00"));
+    assert_true(perfect_hash_memory(hash) > N_WORDS * sizeof(struct slot));
+
+    perfect_hash_done(hash);
+}
+
+/**
+  Testuje indeks pustego i jednoelementowego zbioru.
+  @param state Środowisko testowe.
+  */
+static void perfect_hash_small_test(void** state)
+{
+    Perfect_Hash *hash = perfect_hash_build(NULL, 0);
+    assert_false(perfect_hash_contains(hash, L""));
+    assert_false(perfect_hash_contains(hash, L"kot"));
+    perfect_hash_done(hash);
+
+    const wchar_t *one[] = {L"kot"};
+    hash = perfect_hash_build(one, 1);
+    assert_true(perfect_hash_contains(hash, L"kot"));
+    assert_false(perfect_hash_contains(hash, L"kto"));
+    perfect_hash_done(hash);
+}
+
+/**
+  Testuje zapisanie i wczytanie indeksu.
+  @param state Środowisko testowe.
+  */
+static void perfect_hash_save_load_test(void** state)
+{
+    Perfect_Hash *hash = perfect_hash_build(word_ptrs, N_WORDS);
+
+    FILE *stream = tmpfile();
+    assert_non_null(stream);
+    IO *io = io_new(stdin, stream, stderr);
+    assert_int_equal(perfect_hash_save(hash, io), 0);
+    io_done(io);
+    perfect_hash_done(hash);
+
+    rewind(stream);
+    io = io_new(stream, stdout, stderr);
+    hash = perfect_hash_load(io, word_ptrs, N_WORDS);
+    io_done(io);
+    assert_non_null(hash);
+
+    for (int i = 0; i < N_WORDS; i++)
+        assert_true(perfect_hash_contains(hash, words[i]));
+    assert_false(perfect_hash_contains(hash, L"inne0"));
+    perfect_hash_done(hash);
+
+    // Zapis nie pasuje do innej liczby słów.
+    rewind(stream);
+    io = io_new(stream, stdout, stderr);
+    assert_null(perfect_hash_load(io, word_ptrs, N_WORDS - 1));
+    io_done(io);
+    fclose(stream);
+
+    // Uszkodzony zapis.
+    io = io_new_buffer("#1 2\n", 5, stdout, stderr);
+    assert_null(perfect_hash_load(io, word_ptrs, 2));
+    io_done(io);
+}
+
+/**
+  Główna funkcja uruchamiająca testy.
+  */
+int main(void)
+{
+    setlocale(LC_ALL, "pl_PL.UTF-8");
+
+    for (int i = 0; i < N_WORDS; i++)
+    {
+        swprintf(words[i], 16, L"żółw%d", i);
+        word_ptrs[i] = words[i];
+    }
+
+    const struct CMUnitTest tests[] =
+    {
+        cmocka_unit_test(perfect_hash_build_test),
+        cmocka_unit_test(perfect_hash_small_test),
+        cmocka_unit_test(perfect_hash_save_load_test),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,369 @@
+/** @file
+    Implementacja indeksu odwróconego q-gramów.
+
+    Słowo długości n ma n + q - 1 q-gramów: przed słowem i po nim dopisuje
+    się po q - 1 znaków brzegowych. Listy słów są kubełkowane po długości
+    słowa, więc kandydaci są wyszukiwani tylko wśród słów o dopuszczalnej
+    długości.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#include "qgram_index.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+  Początkowa pojemność tablicy haszującej (potęga dwójki).
+  */
+#define MINIMAL_TABLE_CAPACITY 64
+
+/**
+  Znak uzupełniający początek słowa.
+  */
+#define PAD_BEGIN ((wchar_t) 1)
+
+/**
+  Znak uzupełniający koniec słowa.
+  */
+#define PAD_END ((wchar_t) 2)
+
+/**
+  Lista słów zawierających dany q-gram.
+  */
+struct posting
+{
+    /// Klucz (skrót q-gramu i długości słowa), 0 oznacza wolne miejsce.
+    uint64_t key;
+    /// Identyfikatory słów.
+    uint32_t *ids;
+    /// Liczba identyfikatorów.
+    uint32_t size;
+    /// Pojemność tablicy identyfikatorów.
+    uint32_t capacity;
+};
+
+/**
+  Struktura przechowująca indeks q-gramów.
+  */
+struct qgram_index
+{
+    /// Długość q-gramów.
+    size_t q;
+    /// Słowa w indeksie; identyfikator słowa to jego pozycja na liście.
+    struct word_list words;
+    /// Długości słów.
+    size_t *lengths;
+    /// Pojemność tablicy długości.
+    size_t lengths_capacity;
+    /// Długość najdłuższego słowa.
+    size_t longest;
+    /// Tablica haszująca list słów (adresowanie otwarte).
+    struct posting *table;
+    /// Pojemność tablicy haszującej.
+    size_t table_capacity;
+    /// Liczba zajętych miejsc w tablicy haszującej.
+    size_t table_size;
+    /// Czy indeks odpowiada zawartości słownika.
+    bool valid;
+};
+
+/** @name Funkcje pomocnicze
+  @{
+  */
+
+/*
+ malloc opakowany w obsługę błedu
+ */
+static void * ecalloc(size_t n, size_t el_size)
+{
+    void *ret = calloc(n, el_size);
+    if (!ret)
+    {
+        fprintf(stderr, "Failed to allocate memory for q-gram index\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return ret;
+}
+
+/*
+ realloc opakowany w obsługę błedu
+ */
+static void * erealloc(void *ptr, size_t size)
+{
+    void *ret = realloc(ptr, size);
+    if (!ret)
+    {
+        fprintf(stderr, "Failed to reallocate memory for q-gram index\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return ret;
+}
+
+/*
+ Zwraca znak słowa uzupełnionego znakami brzegowymi.
+ */
+static wchar_t padded_char(const wchar_t *word, size_t len, size_t q,
+                           size_t pos)
+{
+    if (pos < q - 1) return PAD_BEGIN;
+    if (pos - (q - 1) < len) return word[pos - (q - 1)];
+    return PAD_END;
+}
+
+/*
+ Zwraca klucz q-gramu zaczynającego się na danej pozycji słowa
+ uzupełnionego znakami brzegowymi, dla słów podanej długości.
+ */
+static uint64_t gram_key(const wchar_t *word, size_t len, size_t q,
+                         size_t pos, size_t bucket)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (size_t i = 0; i < q; i++)
+    {
+        hash ^= (uint32_t) padded_char(word, len, q, pos + i);
+        hash *= 1099511628211ULL;
+    }
+
+    hash ^= (uint64_t) bucket * 0x9e3779b97f4a7c15ULL;
+    hash ^= hash >> 29;
+
+    return hash ? hash : 1;
+}
+
+/*
+ Zwraca miejsce w tablicy haszującej dla klucza (wolne lub zajęte przez
+ ten klucz).
+ */
+static struct posting * find_slot(const struct posting *table,
+                                  size_t capacity, uint64_t key)
+{
+    size_t i = key & (capacity - 1);
+
+    while (table[i].key != 0 && table[i].key != key)
+    {
+        i = (i + 1) & (capacity - 1);
+    }
+
+    return (struct posting *) &table[i];
+}
+
+/*
+ Podwaja pojemność tablicy haszującej.
+ */
+static void grow_table(Qgram_Index *index)
+{
+    size_t new_capacity = index->table_capacity * 2;
+    struct posting *new_table = ecalloc(new_capacity, sizeof(struct posting));
+
+    for (size_t i = 0; i < index->table_capacity; i++)
+    {
+        if (index->table[i].key == 0) continue;
+        *find_slot(new_table, new_capacity, index->table[i].key) =
+            index->table[i];
+    }
+
+    free(index->table);
+    index->table = new_table;
+    index->table_capacity = new_capacity;
+}
+
+/*
+ Dodaje identyfikator słowa do listy danego q-gramu.
+ */
+static void posting_add(Qgram_Index *index, uint64_t key, uint32_t id)
+{
+    if (4 * (index->table_size + 1) > 3 * index->table_capacity)
+    {
+        grow_table(index);
+    }
+
+    struct posting *posting = find_slot(index->table, index->table_capacity,
+                                        key);
+    if (posting->key == 0)
+    {
+        posting->key = key;
+        index->table_size++;
+    }
+
+    // q-gram powtarzający się w słowie jest zapisywany raz.
+    if (posting->size > 0 && posting->ids[posting->size - 1] == id) return;
+
+    if (posting->size == posting->capacity)
+    {
+        posting->capacity = posting->capacity ? 2 * posting->capacity : 2;
+        posting->ids = erealloc(posting->ids,
+                                sizeof(uint32_t) * posting->capacity);
+    }
+
+    posting->ids[posting->size++] = id;
+}
+
+/*
+ Zwalnia listy słów.
+ */
+static void free_table(Qgram_Index *index)
+{
+    for (size_t i = 0; i < index->table_capacity; i++)
+    {
+        free(index->table[i].ids);
+    }
+
+    free(index->table);
+}
+
+/*
+ Inicjalizuje puste struktury indeksu.
+ */
+static void init_index(Qgram_Index *index)
+{
+    word_list_init(&index->words);
+    index->lengths = NULL;
+    index->lengths_capacity = 0;
+    index->longest = 0;
+    index->table_capacity = MINIMAL_TABLE_CAPACITY;
+    index->table = ecalloc(index->table_capacity, sizeof(struct posting));
+    index->table_size = 0;
+    index->valid = true;
+}
+
+/**@}*/
+/** @name Elementy interfejsu
+  @{
+  */
+
+Qgram_Index * qgram_index_new(size_t q)
+{
+    Qgram_Index *index = ecalloc(1, sizeof(Qgram_Index));
+
+    index->q = q > 0 ? q : 1;
+    init_index(index);
+
+    return index;
+}
+
+void qgram_index_done(Qgram_Index *index)
+{
+    free_table(index);
+    free(index->lengths);
+    word_list_done(&index->words);
+    free(index);
+}
+
+void qgram_index_clear(Qgram_Index *index)
+{
+    free_table(index);
+    free(index->lengths);
+    word_list_done(&index->words);
+    init_index(index);
+}
+
+void qgram_index_add(Qgram_Index *index, const wchar_t *word)
+{
+    uint32_t id = word_list_size(&index->words);
+    size_t len = wcslen(word);
+
+    word_list_add(&index->words, word);
+
+    if (id == index->lengths_capacity)
+    {
+        index->lengths_capacity = 2 * index->lengths_capacity + 16;
+        index->lengths = erealloc(index->lengths,
+                                  sizeof(size_t) * index->lengths_capacity);
+    }
+    index->lengths[id] = len;
+    if (len > index->longest) index->longest = len;
+
+    for (size_t pos = 0; pos < len + index->q - 1; pos++)
+    {
+        posting_add(index, gram_key(word, len, index->q, pos, len), id);
+    }
+}
+
+void qgram_index_invalidate(Qgram_Index *index)
+{
+    index->valid = false;
+}
+
+bool qgram_index_is_valid(const Qgram_Index *index)
+{
+    return index->valid;
+}
+
+size_t qgram_index_size(const Qgram_Index *index)
+{
+    return word_list_size(&index->words);
+}
+
+size_t qgram_index_q(const Qgram_Index *index)
+{
+    return index->q;
+}
+
+void qgram_index_candidates(const Qgram_Index *index, const wchar_t *word,
+                            size_t max_len_delta, size_t max_missing,
+                            struct word_list *list)
+{
+    size_t len = wcslen(word);
+    size_t n_grams = len + index->q - 1;
+    size_t n_words = word_list_size(&index->words);
+    const wchar_t * const *words = word_list_get(&index->words);
+
+    size_t min_len = len > max_len_delta ? len - max_len_delta : 0;
+    size_t max_len = len + max_len_delta;
+
+    // Filtr nic nie odrzuca: kandydatami są wszystkie słowa o dobrej długości.
+    if (max_missing >= n_grams)
+    {
+        for (size_t id = 0; id < n_words; id++)
+        {
+            if (index->lengths[id] >= min_len && index->lengths[id] <= max_len)
+            {
+                word_list_add(list, words[id]);
+            }
+        }
+        return;
+    }
+
+    uint32_t *counts = ecalloc(n_words + 1, sizeof(uint32_t));
+    uint32_t *touched = ecalloc(n_words + 1, sizeof(uint32_t));
+    size_t n_touched = 0;
+
+    if (max_len > index->longest) max_len = index->longest;
+
+    for (size_t bucket = min_len; bucket <= max_len; bucket++)
+    {
+        for (size_t pos = 0; pos < n_grams; pos++)
+        {
+            uint64_t key = gram_key(word, len, index->q, pos, bucket);
+            const struct posting *posting =
+                find_slot(index->table, index->table_capacity, key);
+
+            for (uint32_t i = 0; i < posting->size; i++)
+            {
+                uint32_t id = posting->ids[i];
+                if (counts[id]++ == 0) touched[n_touched++] = id;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < n_touched; i++)
+    {
+        if (counts[touched[i]] + max_missing >= n_grams)
+        {
+            word_list_add(list, words[touched[i]]);
+        }
+    }
+
+    free(touched);
+    free(counts);
+}
+
+/**@}*/
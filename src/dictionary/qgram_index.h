@@ -0,0 +1,99 @@
+/** @file
+    Interfejs indeksu odwróconego q-gramów.
+
+    Indeks przechowuje dla każdego q-gramu (z uwzględnieniem długości słowa)
+    listę słów, w których on występuje. Służy do wyznaczania kandydatów na
+    podpowiedzi, gdy przeszukiwanie drzewa stan po stanie byłoby zbyt drogie.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#ifndef __QGRAM_INDEX_H__
+#define __QGRAM_INDEX_H__
+
+#include "word_list.h"
+#include <stdbool.h>
+#include <wchar.h>
+
+/**
+  Struktura przechowująca indeks q-gramów.
+  */
+typedef struct qgram_index Qgram_Index;
+
+/**
+  Inicjalizacja indeksu.
+  Należy go zniszczyć za pomocą qgram_index_done()
+  @param[in] q Długość q-gramów.
+  @return Nowy indeks.
+  */
+Qgram_Index * qgram_index_new(size_t q);
+
+/**
+  Destrukcja indeksu.
+  @param[in,out] index Indeks.
+  */
+void qgram_index_done(Qgram_Index *index);
+
+/**
+  Usuwa wszystkie słowa z indeksu i oznacza go jako aktualny.
+  @param[in,out] index Indeks.
+  */
+void qgram_index_clear(Qgram_Index *index);
+
+/**
+  Dodaje słowo do indeksu.
+  @param[in,out] index Indeks.
+  @param[in] word Słowo.
+  */
+void qgram_index_add(Qgram_Index *index, const wchar_t *word);
+
+/**
+  Oznacza indeks jako nieaktualny (np. po usunięciu słowa ze słownika).
+  Nieaktualny indeks należy odbudować przed użyciem.
+  @param[in,out] index Indeks.
+  */
+void qgram_index_invalidate(Qgram_Index *index);
+
+/**
+  Sprawdza, czy indeks jest aktualny.
+  Indeks staje się aktualny po wywołaniu qgram_index_clear().
+  @param[in] index Indeks.
+  @return Czy indeks jest aktualny.
+  */
+bool qgram_index_is_valid(const Qgram_Index *index);
+
+/**
+  Zwraca liczbę słów w indeksie.
+  @param[in] index Indeks.
+  @return Liczba słów.
+  */
+size_t qgram_index_size(const Qgram_Index *index);
+
+/**
+  Zwraca długość q-gramów.
+  @param[in] index Indeks.
+  @return Długość q-gramów.
+  */
+size_t qgram_index_q(const Qgram_Index *index);
+
+/**
+  Wyznacza kandydatów podobnych do słowa.
+  Kandydatem jest każde słowo, którego długość różni się od długości
+  `word` o co najwyżej `max_len_delta` i które ma wspólne ze słowem
+  wszystkie q-gramy (licząc z q-gramami brzegowymi) poza co najwyżej
+  `max_missing`.
+  @param[in] index Indeks.
+  @param[in] word Słowo.
+  @param[in] max_len_delta Maksymalna różnica długości.
+  @param[in] max_missing Maksymalna liczba q-gramów słowa, których może
+  brakować w kandydacie.
+  @param[in,out] list Lista, do której są dodawani kandydaci.
+  */
+void qgram_index_candidates(const Qgram_Index *index, const wchar_t *word,
+                            size_t max_len_delta, size_t max_missing,
+                            struct word_list *list);
+
+#endif /* __QGRAM_INDEX_H__ */
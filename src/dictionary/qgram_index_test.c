@@ -0,0 +1,131 @@
+/** @file
+    Testy indeksu q-gramów.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwerstet Warszawski
+    @date 2026-10-19
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <cmocka.h>
+#include <locale.h>
+#include "qgram_index.c"
+#include "utils.h"
+
+/**
+  Sprawdza, czy słowo jest na liście.
+  @param[in] list Lista słów.
+  @param[in] word Słowo.
+  @return Czy słowo jest na liście.
+  */
+static bool list_has(const struct word_list *list, const wchar_t *word)
+{
+    for (size_t i = 0; i < word_list_size(list); i++)
+    {
+        if (wcscmp(word_list_get(list)[i], word) == 0) return true;
+    }
+
+    return false;
+}
+
+/**
+  Testuje inicjalizację i czyszczenie indeksu.
+  @param state Środowisko testowe.
+  */
+static void qgram_index_init_test(void** state)
+{
+    Qgram_Index *index = qgram_index_new(2);
+
+    assert_int_equal(qgram_index_q(index), 2);
+    assert_int_equal(qgram_index_size(index), 0);
+    assert_true(qgram_index_is_valid(index));
+
+    qgram_index_add(index, L"kot");
+    assert_int_equal(qgram_index_size(index), 1);
+
+    qgram_index_invalidate(index);
+    assert_false(qgram_index_is_valid(index));
+
+    qgram_index_clear(index);
+    assert_int_equal(qgram_index_size(index), 0);
+    assert_true(qgram_index_is_valid(index));
+
+    qgram_index_done(index);
+}
+
+/**
+  Testuje wyznaczanie kandydatów.
+  @param state Środowisko testowe.
+  */
+static void qgram_index_candidates_test(void** state)
+{
+    Qgram_Index *index = qgram_index_new(2);
+    struct word_list list;
+
+    // Wiele słów, żeby tablica haszująca się powiększyła.
+    wchar_t word[] = L"xxxx";
+    for (wchar_t a = L'a'; a <= L'z'; a++)
+    {
+        for (wchar_t b = L'a'; b <= L'e'; b++)
+        {
+            word[2] = a;
+            word[3] = b;
+            qgram_index_add(index, word);
+        }
+    }
+    qgram_index_add(index, L"kot");
+    qgram_index_add(index, L"kat");
+    qgram_index_add(index, L"kotek");
+    qgram_index_add(index, L"pies");
+
+    word_list_init(&list);
+    qgram_index_candidates(index, L"kot", 0, 0, &list);
+    assert_int_equal(word_list_size(&list), 1);
+    assert_true(list_has(&list, L"kot"));
+    word_list_done(&list);
+
+    // Zamiana litery psuje dwa bigramy.
+    word_list_init(&list);
+    qgram_index_candidates(index, L"kot", 0, 2, &list);
+    assert_true(list_has(&list, L"kot"));
+    assert_true(list_has(&list, L"kat"));
+    assert_false(list_has(&list, L"kotek"));
+    word_list_done(&list);
+
+    word_list_init(&list);
+    qgram_index_candidates(index, L"kot", 2, 1, &list);
+    assert_true(list_has(&list, L"kot"));
+    assert_true(list_has(&list, L"kotek"));
+    assert_false(list_has(&list, L"kat"));
+    assert_false(list_has(&list, L"pies"));
+    word_list_done(&list);
+
+    // Filtr, który niczego nie odrzuca, ogranicza tylko długość.
+    word_list_init(&list);
+    qgram_index_candidates(index, L"kot", 1, 4, &list);
+    assert_int_equal(word_list_size(&list), 26 * 5 + 3);
+    assert_false(list_has(&list, L"kotek"));
+    word_list_done(&list);
+
+    qgram_index_done(index);
+}
+
+/**
+  Główna funkcja uruchamiająca testy.
+  */
+int main(void)
+{
+    setlocale(LC_ALL, "pl_PL.UTF-8");
+
+    const struct CMUnitTest tests[] =
+    {
+        cmocka_unit_test(qgram_index_init_test),
+        cmocka_unit_test(qgram_index_candidates_test),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
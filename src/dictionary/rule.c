@@ -16,6 +16,34 @@
 #include <assert.h>
 #include <limits.h>
 
+/**
+  Liczba zmiennych w regułach.
+  */
+#define N_VARS 10
+
+/**
+  Rodzaj instrukcji programu prawej strony reguły.
+  */
+enum rule_op_type
+{
+    OP_LITERALS, ///< Ciąg liter.
+    OP_VAR,      ///< Zmienna ustalona przez lewą stronę.
+    OP_FREE_VAR  ///< Zmienna występująca tylko po prawej stronie.
+};
+
+/**
+  Instrukcja programu prawej strony reguły.
+  */
+struct rule_op
+{
+    /// Rodzaj instrukcji.
+    enum rule_op_type type;
+    /// Początek ciągu liter w prawej stronie lub numer zmiennej.
+    size_t arg;
+    /// Długość ciągu liter.
+    size_t len;
+};
+
 /**
   Struktura przechowująca regułę.
   */
@@ -33,8 +61,14 @@ struct rule
     int cost;
     /// Użyta flaga bądź jej brak.
     enum rule_flag flag;
-    /// Wartości zmiennych.
-    wchar_t vars[10];
+    /// Skompilowana postać reguły (NULL, jeśli reguła jest interpretowana).
+    const Compiled_Rule *compiled;
+    /// Program prawej strony reguły.
+    struct rule_op *program;
+    /// Liczba instrukcji przed pierwszym wystąpieniem zmiennej wolnej.
+    size_t n_prefix_ops;
+    /// Liczba wszystkich instrukcji.
+    size_t n_ops;
 };
 
 /** @name Funkcje pomocnicze
@@ -204,17 +238,50 @@ static const int read_rule_int(IO *io, wchar_t separator)
     return ret;
 }
 
-static bool set_vars(Rule *rule, const wchar_t *word)
+/*
+ Rozszerza odcisk FNV-1a o jeden znak.
+ */
+static uint64_t fnv_add(uint64_t hash, wchar_t wc)
+{
+    uint32_t c = (uint32_t) wc;
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        hash ^= (c >> (8 * i)) & 0xff;
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+/*
+ Rozszerza odcisk FNV-1a o napis.
+ */
+static uint64_t fnv_add_str(uint64_t hash, const wchar_t *str)
+{
+    for (; *str; str++) hash = fnv_add(hash, *str);
+
+    return hash;
+}
+
+/*
+ Dopasowuje lewą stronę reguły do słowa, ustawiając wartości zmiennych.
+ Zmienne są przechowywane przez wywołującego, dzięki czemu reguły można
+ stosować jednocześnie w wielu wątkach.
+ */
+static bool set_vars(const Rule *rule, const wchar_t *word, wchar_t *vars)
 {
-    for (size_t i = 0; i < 10; i++) rule->vars[i] = L'\0';
+    if (rule->compiled != NULL) return rule->compiled->match(word, vars);
+
+    for (size_t i = 0; i < N_VARS; i++) vars[i] = L'\0';
 
     for (size_t i = 0; i < rule->left_len; i++)
     {
         if (is_decimal(rule->left[i]))
         {
             int var = decimal_to_int(rule->left[i]);
-            if (rule->vars[var] == L'\0') rule->vars[var] = word[i];
-            else if (rule->vars[var] != word[i]) return false;
+            if (vars[var] == L'\0') vars[var] = word[i];
+            else if (vars[var] != word[i]) return false;
         }
         else
         {
@@ -226,68 +293,134 @@ static bool set_vars(Rule *rule, const wchar_t *word)
 }
 
 /*
- Zwraca węzły do których dochodzi się po zastosowaniu reguły.
+ Zwraca numer zmiennej występującej tylko po prawej stronie reguły
+ lub -1, jeśli takiej nie ma.
  */
-static Vector * get_next_nodes(Rule *rule, Node *node)
+static int get_free_var(Rule *rule)
 {
-    wchar_t right[rule->right_len];
     int free_var = -1;
-    Vector *nodes = vector_new(fake_free);
 
     for (size_t i = 0; i < rule->right_len; i++)
     {
-        if (is_decimal(rule->right[i]))
+        if (is_decimal(rule->right[i])
+            && wcschr(rule->left, rule->right[i]) == NULL)
         {
-            int var = decimal_to_int(rule->right[i]);
-            if (rule->vars[var] == L'\0')
-            {
-                free_var = var;
-                right[i] = rule->right[i];
-            }
-            else
+            free_var = decimal_to_int(rule->right[i]);
+        }
+    }
+
+    return free_var;
+}
+
+/*
+ Kompiluje prawą stronę reguły do programu złożonego z ciągów liter
+ i odwołań do zmiennych. Instrukcje do pierwszego wystąpienia zmiennej wolnej
+ tworzą wspólny prefiks, wykonywany raz dla każdego zastosowania reguły.
+ */
+static void compile_right(Rule *rule)
+{
+    int free_var = get_free_var(rule);
+
+    rule->program = emalloc(sizeof(struct rule_op) * (rule->right_len + 1));
+    rule->n_ops = 0;
+    rule->n_prefix_ops = 0;
+
+    bool free_var_seen = false;
+    for (size_t i = 0; i < rule->right_len; i++)
+    {
+        struct rule_op *op = &rule->program[rule->n_ops];
+
+        if (!is_decimal(rule->right[i]))
+        {
+            if (rule->n_ops > 0 && op[-1].type == OP_LITERALS)
             {
-                right[i] = rule->vars[var];
+                op[-1].len++;
+                if (!free_var_seen) rule->n_prefix_ops = rule->n_ops;
+                continue;
             }
+
+            op->type = OP_LITERALS;
+            op->arg = i;
+            op->len = 1;
+        }
+        else if (decimal_to_int(rule->right[i]) == free_var)
+        {
+            op->type = OP_FREE_VAR;
+            op->arg = free_var;
+            free_var_seen = true;
         }
         else
         {
-            right[i] = rule->right[i];
+            op->type = OP_VAR;
+            op->arg = decimal_to_int(rule->right[i]);
         }
+
+        rule->n_ops++;
+        if (!free_var_seen) rule->n_prefix_ops = rule->n_ops;
     }
+}
 
-    int j = 0;
-    while (j < rule->right_len && !is_decimal(right[j]))
+/*
+ Wykonuje instrukcje programu od danego węzła.
+ Zwraca węzeł końcowy lub NULL, jeśli ścieżka nie istnieje w drzewie.
+ */
+static Node * run_ops(const Rule *rule, const struct rule_op *ops,
+                      size_t n_ops, Node *node, const wchar_t *vars,
+                      wchar_t free_value)
+{
+    for (size_t i = 0; i < n_ops && node != NULL; i++)
     {
-        node = node_get_child(node, right[j]);
-        if (node == NULL) return nodes;
-        j++;
+        switch (ops[i].type)
+        {
+            case OP_LITERALS:
+                node = node_get_descendant(node, rule->right + ops[i].arg,
+                                           ops[i].len);
+                break;
+            case OP_VAR:
+                node = node_get_child(node, vars[ops[i].arg]);
+                break;
+            case OP_FREE_VAR:
+                node = node_get_child(node, free_value);
+                break;
+        }
     }
 
-    if (free_var == -1)
+    return node;
+}
+
+/*
+ Zwraca węzły do których dochodzi się po zastosowaniu reguły.
+ */
+static Vector * get_next_nodes(const Rule *rule, Node *node,
+                               const wchar_t *vars)
+{
+    Vector *nodes = vector_new(fake_free);
+
+    if (rule->compiled != NULL)
+    {
+        rule->compiled->apply(vars, node, nodes);
+        return nodes;
+    }
+
+    node = run_ops(rule, rule->program, rule->n_prefix_ops, node, vars,
+                   L'\0');
+    if (node == NULL) return nodes;
+
+    if (rule->n_prefix_ops == rule->n_ops)
     {
         vector_push_back(nodes, node);
         return nodes;
     }
 
+    // Zmienna wolna przyjmuje tylko wartości, dla których istnieje syn.
+    const struct rule_op *rest = rule->program + rule->n_prefix_ops + 1;
+    size_t n_rest = rule->n_ops - rule->n_prefix_ops - 1;
+
     for (size_t i = 0; i < node_children_count(node); i++)
     {
-        Node *tmp = node_get_child_by_index(node, i);
-        rule->vars[free_var] = node_get_key(tmp);
-        tmp = node;
-
-        int k = j;
-        while (k < rule->right_len && tmp != NULL)
-        {
-            if (is_decimal(right[k]))
-            {
-                tmp = node_get_child(tmp, rule->vars[free_var]);
-            }
-            else
-            {
-                tmp = node_get_child(tmp, right[k]);
-            }
-            k++;
-        }
+        Node *child = node_get_child_by_index(node, i);
+        Node *tmp = run_ops(rule, rest, n_rest, child, vars,
+                            node_get_key(child));
 
         if (tmp != NULL) vector_push_back(nodes, tmp);
     }
@@ -315,11 +448,38 @@ Rule * rule_new(const wchar_t *left, const wchar_t *right,
     wcscpy(rule->right, right);
     rule->cost = cost;
     rule->flag = flag;
+    rule->compiled = NULL;
+
+    compile_right(rule);
 
     return rule;
 }
 
+Rule * rule_reversed(const Rule *rule)
+{
+    wchar_t left[rule->left_len + 1], right[rule->right_len + 1];
+
+    for (size_t i = 0; i < rule->left_len; i++)
+    {
+        left[i] = rule->left[rule->left_len - 1 - i];
+    }
+    left[rule->left_len] = L'\0';
+
+    for (size_t i = 0; i < rule->right_len; i++)
+    {
+        right[i] = rule->right[rule->right_len - 1 - i];
+    }
+    right[rule->right_len] = L'\0';
+
+    enum rule_flag flag = rule->flag;
+    if (flag == RULE_BEGIN) flag = RULE_END;
+    else if (flag == RULE_END) flag = RULE_BEGIN;
+
+    return rule_new(left, right, rule->cost, flag);
+}
+
 void rule_done(Rule *rule) {
+    free(rule->program);
     free(rule->left);
     free(rule->right);
     free(rule);
@@ -330,6 +490,40 @@ int rule_get_cost(Rule *rule)
     return rule->cost;
 }
 
+const wchar_t * rule_get_left(const Rule *rule)
+{
+    return rule->left;
+}
+
+const wchar_t * rule_get_right(const Rule *rule)
+{
+    return rule->right;
+}
+
+enum rule_flag rule_get_flag(const Rule *rule)
+{
+    return rule->flag;
+}
+
+void rule_set_compiled(Rule *rule, const Compiled_Rule *compiled)
+{
+    rule->compiled = compiled;
+}
+
+uint64_t rule_fingerprint(const Rule *rule, uint64_t hash)
+{
+    wchar_t number[16];
+
+    hash = fnv_add_str(hash, rule->left);
+    hash = fnv_add(hash, L'*');
+    hash = fnv_add_str(hash, rule->right);
+    hash = fnv_add(hash, L'*');
+    swprintf(number, 16, L"%d*%d\n", rule->cost, rule->flag);
+    hash = fnv_add_str(hash, number);
+
+    return hash;
+}
+
 bool rule_matches_prefix(Rule *rule, bool is_start, const wchar_t *word,
                          const size_t word_len)
 {
@@ -337,7 +531,8 @@ bool rule_matches_prefix(Rule *rule, bool is_start, const wchar_t *word,
 
     if (rule->flag == RULE_BEGIN && !is_start) return false;
 
-    return set_vars(rule, word);
+    wchar_t vars[N_VARS];
+    return set_vars(rule, word, vars);
 }
 
 Vector * rule_apply(Rule *rule, State *state, Node *root)
@@ -356,11 +551,10 @@ Vector * rule_apply(Rule *rule, State *state, Node *root)
         return states;
     }
 
-    if (rule->flag == RULE_SPLIT && state->prev != NULL) return states;
-
-    set_vars(rule, state->sufix);
+    wchar_t vars[N_VARS];
+    set_vars(rule, state->sufix, vars);
 
-    Vector *nodes = get_next_nodes(rule, state->node);
+    Vector *nodes = get_next_nodes(rule, state->node, vars);
     for (size_t i = 0; i < vector_size(nodes); i++)
     {
         Node *node = vector_get_by_index(nodes, i);
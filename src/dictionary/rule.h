@@ -14,7 +14,9 @@
 #include "dictionary.h"
 #include "vector.h"
 #include "state.h"
+#include "compiled_rules.h"
 #include <stdbool.h>
+#include <stdint.h>
 #include <wchar.h>
 
 /**
@@ -34,6 +36,17 @@ typedef struct rule Rule;
 Rule * rule_new(const wchar_t *left, const wchar_t *right,
                 int cost, enum rule_flag flag);
 
+/**
+  Tworzy regułę działającą na odwróconych słowach.
+  Obie strony reguły są odwrócone, a flagi b i e zamienione. Zastosowanie
+  odwróconych reguł do odwróconego słowa w drzewie odwróconych słów daje
+  odwrócone podpowiedzi o tych samych kosztach.
+  Należy ją zniszczyć za pomocą rule_done()
+  @param[in] rule Reguła.
+  @return Nowa reguła.
+  */
+Rule * rule_reversed(const Rule *rule);
+
 /**
   Destrukcja reguły.
   @param[in,out] rule Reguła.
@@ -47,6 +60,43 @@ void rule_done(Rule *rule);
   */
 int rule_get_cost(Rule *rule);
 
+/**
+  Zwraca lewą stronę reguły.
+  @param rule Reguła
+  @return Lewa strona reguły.
+  */
+const wchar_t * rule_get_left(const Rule *rule);
+
+/**
+  Zwraca prawą stronę reguły.
+  @param rule Reguła
+  @return Prawa strona reguły.
+  */
+const wchar_t * rule_get_right(const Rule *rule);
+
+/**
+  Zwraca flagę reguły.
+  @param rule Reguła
+  @return Flaga reguły.
+  */
+enum rule_flag rule_get_flag(const Rule *rule);
+
+/**
+  Ustawia skompilowaną postać reguły.
+  @param rule Reguła.
+  @param compiled Skompilowana reguła lub NULL, jeśli reguła ma być
+  interpretowana.
+  */
+void rule_set_compiled(Rule *rule, const Compiled_Rule *compiled);
+
+/**
+  Rozszerza odcisk (FNV-1a) o zapis reguły w formacie rule_save().
+  @param rule Reguła.
+  @param hash Dotychczasowy odcisk.
+  @return Nowy odcisk.
+  */
+uint64_t rule_fingerprint(const Rule *rule, uint64_t hash);
+
 /**
   Stwierdza, czy reguła pasuje do prefiksu słowa.
   @param rule Reguła.
@@ -60,6 +110,9 @@ bool rule_matches_prefix(Rule *rule, bool is_start, const wchar_t *word,
 
 /**
   Stosuje regułę do stanu.
+  Po zastosowaniu reguły z flagą `s` nowe stany zaczynają się w korzeniu,
+  a węzeł zakończonego słowa jest zapisany jako poprzedni. Ograniczenie
+  liczby rozdziałów należy do wywołującego.
 
   @param rule Reguła.
   @param state Stan.
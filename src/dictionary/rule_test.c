@@ -112,6 +112,106 @@ static void rule_save_test(void** state)
     rule_done(normal);
 }
 
+/**
+  Testuje program prawej strony reguły i jego stosowanie.
+  @param state Środowisko testowe.
+  */
+static void rule_apply_program_test(void** state)
+{
+    Node *root = node_new(L'\0');
+    const wchar_t *words[] = { L"abxcd", L"abycd", L"abzce", L"acxcd" };
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        Node *node = root;
+        for (const wchar_t *c = words[i]; *c; c++)
+        {
+            node = node_add_child(node, *c);
+        }
+        node_set_is_word(node, true);
+    }
+
+    Rule *rule = rule_new(L"", L"ab1cd", 1, RULE_NORMAL);
+
+    assert_int_equal(rule->n_prefix_ops, 1);
+    assert_int_equal(rule->n_ops, 3);
+    assert_true(rule->program[0].type == OP_LITERALS);
+    assert_int_equal(rule->program[0].len, 2);
+    assert_true(rule->program[1].type == OP_FREE_VAR);
+    assert_true(rule->program[2].type == OP_LITERALS);
+
+    State *start = state_new(root, NULL, L"", 0, 0, true);
+    assert_true(rule_matches_prefix(rule, true, L"", 0));
+
+    Vector *states = rule_apply(rule, start, root);
+    assert_int_equal(vector_size(states), 2);
+    for (size_t i = 0; i < vector_size(states); i++)
+    {
+        State *next = vector_get_by_index(states, i);
+        assert_true(node_is_word(next->node));
+        assert_int_equal(next->cost, 1);
+        state_done(next);
+    }
+
+    vector_done(states);
+    state_done(start);
+    rule_done(rule);
+    node_done(root);
+}
+
+/**
+  Skompilowane dopasowanie, które nie pasuje do niczego.
+  @param word Słowo.
+  @param vars Wartości zmiennych.
+  @return false
+  */
+static bool never_match(const wchar_t *word, wchar_t *vars)
+{
+    return false;
+}
+
+/**
+  Testuje korzystanie ze skompilowanej postaci reguły.
+  @param state Środowisko testowe.
+  */
+static void rule_compiled_test(void** state)
+{
+    Compiled_Rule compiled = { never_match, NULL };
+    Rule *rule = rule_new(L"a1", L"1b", 1, RULE_NORMAL);
+
+    assert_true(rule_matches_prefix(rule, true, L"ab", 2));
+
+    rule_set_compiled(rule, &compiled);
+    assert_false(rule_matches_prefix(rule, true, L"ab", 2));
+
+    rule_set_compiled(rule, NULL);
+    assert_true(rule_matches_prefix(rule, true, L"ab", 2));
+
+    rule_done(rule);
+}
+
+/**
+  Testuje odcisk reguły.
+  @param state Środowisko testowe.
+  */
+static void rule_fingerprint_test(void** state)
+{
+    Rule *a = rule_new(L"a1", L"1b", 1, RULE_NORMAL);
+    Rule *b = rule_new(L"a1", L"1b", 1, RULE_NORMAL);
+    Rule *c = rule_new(L"a1", L"1b", 2, RULE_NORMAL);
+    Rule *d = rule_new(L"a", L"1b", 1, RULE_NORMAL);
+
+    assert_true(rule_fingerprint(a, 0) == rule_fingerprint(b, 0));
+    assert_false(rule_fingerprint(a, 0) == rule_fingerprint(c, 0));
+    assert_false(rule_fingerprint(a, 0) == rule_fingerprint(d, 0));
+    assert_false(rule_fingerprint(a, 0) == rule_fingerprint(a, 1));
+
+    rule_done(a);
+    rule_done(b);
+    rule_done(c);
+    rule_done(d);
+}
+
 /**
   Atrapa pobierania kolejnego znaku z wejścia.
   */
@@ -202,6 +302,24 @@ static void rule_load_test(void** state)
     io_done(io);
 }
 
+/**
+  Testuje odwracanie reguły.
+  @param state Środowisko testowe.
+  */
+static void rule_reversed_test(void** state)
+{
+    Rule *rule = rule_new(L"ab1", L"1c", 2, RULE_BEGIN);
+    Rule *reversed = rule_reversed(rule);
+
+    assert_true(wcscmp(rule_get_left(reversed), L"1ba") == 0);
+    assert_true(wcscmp(rule_get_right(reversed), L"c1") == 0);
+    assert_int_equal(rule_get_cost(reversed), 2);
+    assert_int_equal(rule_get_flag(reversed), RULE_END);
+
+    rule_done(reversed);
+    rule_done(rule);
+}
+
 /**
   Główna funkcja uruchamiająca testy.
   */
@@ -215,6 +333,10 @@ int main(void)
         cmocka_unit_test(rule_is_legal_test),
         cmocka_unit_test(rule_save_test),
         cmocka_unit_test(rule_load_test),
+        cmocka_unit_test(rule_apply_program_test),
+        cmocka_unit_test(rule_compiled_test),
+        cmocka_unit_test(rule_fingerprint_test),
+        cmocka_unit_test(rule_reversed_test),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -111,6 +111,21 @@ int set_delete(Set *set, void *el) {
     return 1;
 }
 
+void * set_replace(Set *set, void *el)
+{
+    int pos = find_position(set, el);
+
+    if (pos == set_size(set) || set->cmp(set_get_by_index(set, pos), el) != 0)
+    {
+        return NULL;
+    }
+
+    void *old = set_get_by_index(set, pos);
+    vector_set(set->data, pos, el);
+
+    return old;
+}
+
 void * set_find(const Set *set, void *el)
 {
     int pos = find_position(set, el);
@@ -134,4 +149,10 @@ const size_t set_size(const Set *set)
     return vector_size(set->data);
 }
 
+void set_prefetch(const Set *set, bool elements)
+{
+    if (elements) vector_prefetch(set->data);
+    else __builtin_prefetch(set->data);
+}
+
 /**@}*/
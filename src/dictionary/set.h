@@ -10,6 +10,7 @@
 #ifndef __SET_H__
 #define __SET_H__
 
+#include <stdbool.h>
 #include <wchar.h>
 
 /// Typ funkcji porównującej elemnty zbioru
@@ -66,6 +67,14 @@ int set_insert_at_end(Set *set, void *el);
   */
 int set_delete(Set *set, void *el);
 
+/**
+  Zastępuje element zbioru równy danemu, nie zwalniając poprzedniego.
+  @param[in,out] set Zbiór.
+  @param[in] el Nowy element.
+  @return Zastąpiony element lub NULL, jeśli nie istnieje.
+  */
+void * set_replace(Set *set, void *el);
+
 /**
   Zwraca element ze zbioru.
   @param[in] set Zbiór.
@@ -89,4 +98,14 @@ void * set_get_by_index(const Set *set, const int index);
   */
 const size_t set_size(const Set *set);
 
+/**
+  Zleca wczytanie z wyprzedzeniem zbioru do pamięci podręcznej procesora.
+  Wczytanie wymaga dwóch kroków zależnych od siebie: najpierw wektora
+  danych, a gdy ten jest już w pamięci podręcznej, tablicy elementów.
+  Sam zbiór powinien już być w pamięci podręcznej.
+  @param[in] set Zbiór.
+  @param[in] elements Czy wczytać tablicę elementów (drugi krok).
+  */
+void set_prefetch(const Set *set, bool elements);
+
 #endif /* __SET_H__ */
@@ -29,7 +29,7 @@ struct state
     wchar_t *string;
     /// Węzeł.
     Node *node;
-    /// Węzeł pierwszego słowa (jeśli był rozdział).
+    /// Węzeł poprzedniego słowa (jeśli był rozdział; korzeń, jeśli nieznany).
     Node *prev;
     /// Koszt stanu.
     int cost;
@@ -0,0 +1,286 @@
+/** @file
+    Implementacja podziału tekstu na słowa.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#include "tokenizer.h"
+#include "utf8.h"
+#include <langinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+  Ciąg bajtów 0x01.
+  */
+#define ONES 0x0101010101010101ULL
+
+/**
+  Ciąg bajtów 0x80.
+  */
+#define HIGHS (ONES * 0x80)
+
+uint8_t tokenizer_letters[TOKENIZER_TABLE_SIZE / 8];
+
+uint16_t tokenizer_folds[TOKENIZER_TABLE_SIZE];
+
+/**
+  Czy bieżące locale używa kodowania UTF-8.
+  */
+static bool utf8;
+
+/** @name Funkcje pomocnicze
+  @{
+  */
+
+/**
+  Sprawdza, czy w ośmiu bajtach jest litera ASCII lub bajt spoza ASCII.
+  Wszystkie bajty są sprawdzane naraz: po ustawieniu bitu 0x20 litery ASCII
+  to dokładnie bajty z przedziału [a, z].
+  @param[in] block Osiem bajtów.
+  @return Czy blok może zawierać literę.
+  */
+static inline bool may_contain_letter(uint64_t block)
+{
+    if (block & HIGHS) return true;
+
+    uint64_t x = block | (ONES * 0x20);
+    return ((ONES * (127 + 'z' + 1) - x) & ~x
+            & (x + ONES * (127 - ('a' - 1)))) & HIGHS;
+}
+
+/**
+  Dekoduje znak.
+  Znaki ASCII i dwubajtowe znaki UTF-8 (m.in. litery alfabetów łacińskich
+  z Latin-1 i Latin-2) są dekodowane bez wywoływania mbrtowc().
+  @param[in] data Bajty.
+  @param[in] size Liczba bajtów.
+  @param[out] c Znak.
+  @return Liczba bajtów znaku lub 0, jeśli bajty nie są poprawnym znakiem.
+  */
+static inline size_t decode(const char *data, size_t size, wchar_t *c)
+{
+    unsigned char b = data[0];
+
+    if (b < 0x80)
+    {
+        *c = b;
+        return 1;
+    }
+
+    if (utf8 && b >= 0xC2 && b < 0xE0 && size >= 2
+        && ((unsigned char) data[1] & 0xC0) == 0x80)
+    {
+        *c = ((b & 0x1F) << 6) | ((unsigned char) data[1] & 0x3F);
+        return 2;
+    }
+
+    mbstate_t state;
+    memset(&state, 0, sizeof(mbstate_t));
+    size_t n = mbrtowc(c, data, size, &state);
+
+    return (n == (size_t) -1 || n == (size_t) -2) ? 0 : n;
+}
+
+/**
+  Dokańcza zamianę słowa UTF-8 na małe litery, gdy mała litera zajmuje
+  więcej bajtów niż wielka. Reszta słowa jest dekodowana do znaków
+  szerokich, zamieniana na małe litery i kodowana do nowego bufora.
+  @param[in,out] word Wskaźnik na słowo; stary bufor jest zwalniany.
+  @param[in] done Liczba bajtów już zamienionych na początku słowa.
+  @param[in] rest Niezamieniona reszta słowa.
+  @return 0, jeśli reszta słowa nie jest złożona z samych liter lub jest
+  błędnie zakodowana, 1 w p.p.
+  */
+static int fold_longer_utf8(char **word, size_t done, const char *rest)
+{
+    wchar_t *wide = malloc((strlen(rest) + 1) * sizeof(wchar_t));
+    if (!wide)
+    {
+        fprintf(stderr, "Failed to allocate memory for word\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Tak jak w miejscu, zamieniane są litery do pierwszego znaku, który
+    // nie jest literą; dalsza część zostaje bez zmian.
+    size_t length = 0;
+    wchar_t c;
+    size_t n;
+    while (*rest != '\0' && (n = utf8_decode(rest, &c)) != 0
+           && tokenizer_is_letter(c))
+    {
+        char bytes[UTF8_MAX_BYTES];
+        wchar_t folded = tokenizer_fold(c);
+        wide[length++] = utf8_encode(folded, bytes) != 0 ? folded : c;
+        rest += n;
+    }
+    wide[length] = L'\0';
+
+    char *folded = malloc(done + utf8_length(wide) + strlen(rest) + 1);
+    if (!folded)
+    {
+        fprintf(stderr, "Failed to allocate memory for word\n");
+        exit(EXIT_FAILURE);
+    }
+
+    char *out = folded + done;
+    memcpy(folded, *word, done);
+    for (size_t i = 0; i < length; i++) out += utf8_encode(wide[i], out);
+    strcpy(out, rest);
+
+    int ret = *rest == '\0';
+    free(wide);
+    free(*word);
+    *word = folded;
+
+    return ret;
+}
+
+/**
+  Zamienia słowo na złożone z małych liter, w miejscu lub, jeśli mała
+  odpowiedniczka którejś litery zajmuje więcej bajtów, w nowym buforze.
+  @param[in,out] word Wskaźnik na słowo przydzielone przez malloc().
+  @return 0, jeśli słowo nie jest złożone z samych liter lub jest błędnie
+  zakodowane, 1 w p.p.
+  */
+static int fold_word_utf8(char **word)
+{
+    // Zapisane bajty nigdy nie wyprzedzają czytanych.
+    char *in = *word, *out = *word;
+
+    while (*in != '\0')
+    {
+        wchar_t c;
+        size_t n = utf8_decode(in, &c);
+        if (n == 0 || !tokenizer_is_letter(c))
+        {
+            memmove(out, in, strlen(in) + 1);
+            return 0;
+        }
+
+        char folded[UTF8_MAX_BYTES];
+        size_t m = utf8_encode(tokenizer_fold(c), folded);
+        if (m > n) return fold_longer_utf8(word, out - *word, in);
+        if (m == 0) memmove(out, in, m = n);
+        else memcpy(out, folded, m);
+
+        out += m;
+        in += n;
+    }
+
+    *out = '\0';
+    return 1;
+}
+
+/**@}*/
+
+/** @name Elementy interfejsu
+  @{
+  */
+
+void tokenizer_init(void)
+{
+    memset(tokenizer_letters, 0, sizeof(tokenizer_letters));
+
+    for (wint_t c = 0; c < TOKENIZER_TABLE_SIZE; c++)
+    {
+        wint_t folded = towlower(c);
+
+        if (iswalpha(c)) tokenizer_letters[c >> 3] |= 1 << (c & 7);
+        tokenizer_folds[c] = folded < TOKENIZER_TABLE_SIZE ? folded : c;
+    }
+
+    utf8 = (strcmp(nl_langinfo(CODESET), "UTF-8") == 0);
+}
+
+int tokenizer_fold_word(wchar_t *word)
+{
+    for (wchar_t *w = word; *w; ++w)
+        if (!tokenizer_is_letter(*w))
+            return 0;
+        else
+            *w = tokenizer_fold(*w);
+    return 1;
+}
+
+int tokenizer_fold_word_utf8(const char *word, char **folded)
+{
+    *folded = strdup(word);
+    if (!*folded)
+    {
+        fprintf(stderr, "Failed to allocate memory for word\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return fold_word_utf8(folded);
+}
+
+size_t tokenizer_decode(const char *data, size_t size, wchar_t *c)
+{
+    return decode(data, size, c);
+}
+
+size_t tokenizer_skip_text(const char *data, size_t size, size_t pos,
+                           bool *error)
+{
+    wchar_t c;
+    *error = false;
+
+    while (pos < size)
+    {
+        uint64_t block;
+        while (pos + sizeof(block) <= size)
+        {
+            memcpy(&block, data + pos, sizeof(block));
+            if (may_contain_letter(block)) break;
+            pos += sizeof(block);
+        }
+        if (pos == size) break;
+
+        size_t n = decode(data + pos, size - pos, &c);
+        if (n == 0)
+        {
+            *error = true;
+            break;
+        }
+        if (tokenizer_is_letter(c)) break;
+
+        pos += n;
+    }
+
+    return pos;
+}
+
+size_t tokenizer_scan_word(const char *data, size_t size, size_t pos,
+                           wchar_t *folded, size_t max_len, size_t *len,
+                           bool *error)
+{
+    wchar_t c;
+    size_t i = 0;
+    *error = false;
+
+    while (pos < size && i < max_len)
+    {
+        size_t n = decode(data + pos, size - pos, &c);
+        if (n == 0)
+        {
+            *error = true;
+            break;
+        }
+        if (!tokenizer_is_letter(c)) break;
+
+        folded[i++] = tokenizer_fold(c);
+        pos += n;
+    }
+
+    folded[i] = L'\0';
+    *len = i;
+
+    return pos;
+}
+
+/**@}*/
@@ -0,0 +1,129 @@
+/** @file
+    Interfejs podziału tekstu na słowa.
+
+    Klasyfikacja liter i zamiana na małe litery znaków z podstawowej
+    płaszczyzny Unicode korzystają z tablic zbudowanych dla bieżącego
+    locale przez tokenizer_init(). Pozostałe znaki są obsługiwane przez
+    funkcje biblioteki standardowej.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#ifndef __TOKENIZER_H__
+#define __TOKENIZER_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <wchar.h>
+#include <wctype.h>
+
+/**
+  Liczba znaków obsługiwanych przez tablice.
+  */
+#define TOKENIZER_TABLE_SIZE 0x10000
+
+/**
+  Mapa bitowa liter.
+  */
+extern uint8_t tokenizer_letters[TOKENIZER_TABLE_SIZE / 8];
+
+/**
+  Małe odpowiedniki znaków.
+  */
+extern uint16_t tokenizer_folds[TOKENIZER_TABLE_SIZE];
+
+/**
+  Buduje tablice dla bieżącego locale.
+  Należy ją wywołać po setlocale(), a przed użyciem pozostałych funkcji.
+  */
+void tokenizer_init(void);
+
+/**
+  Stwierdza, czy znak jest literą.
+  @param[in] c Znak.
+  @return Czy znak jest literą.
+  */
+static inline
+bool tokenizer_is_letter(wint_t c)
+{
+    if (c < TOKENIZER_TABLE_SIZE)
+        return (tokenizer_letters[c >> 3] >> (c & 7)) & 1;
+
+    return iswalpha(c);
+}
+
+/**
+  Zwraca małą literę odpowiadającą znakowi.
+  @param[in] c Znak.
+  @return Mała litera.
+  */
+static inline
+wchar_t tokenizer_fold(wint_t c)
+{
+    if (c < TOKENIZER_TABLE_SIZE) return tokenizer_folds[c];
+
+    return towlower(c);
+}
+
+/**
+  Zamienia słowo na złożone z małych liter.
+  @param[in,out] word Modyfikowane słowo.
+  @return 0, jeśli słowo nie jest złożone z samych liter, 1 w p.p.
+  */
+int tokenizer_fold_word(wchar_t *word);
+
+/**
+  Tworzy kopię słowa zakodowanego w UTF-8 złożoną z małych liter.
+  Mała odpowiedniczka litery może zajmować więcej bajtów (np. U+023A),
+  więc kopia może być dłuższa od słowa. Jeśli słowo nie jest złożone
+  z samych liter, zamieniane są litery do pierwszego znaku, który nie jest
+  literą, a reszta jest kopiowana bez zmian.
+  @param[in] word Słowo.
+  @param[out] folded Kopia słowa, którą należy zwolnić przez free().
+  @return 0, jeśli słowo nie jest złożone z samych liter lub jest błędnie
+  zakodowane, 1 w p.p.
+  */
+int tokenizer_fold_word_utf8(const char *word, char **folded);
+
+/**
+  Dekoduje znak z tekstu w kodowaniu bieżącego locale.
+  @param[in] data Bajty.
+  @param[in] size Liczba bajtów (co najmniej 1).
+  @param[out] c Znak.
+  @return Liczba bajtów znaku lub 0, jeśli bajty nie są poprawnym znakiem.
+  */
+size_t tokenizer_decode(const char *data, size_t size, wchar_t *c);
+
+/**
+  Przesuwa pozycję w tekście za ciąg znaków niebędących literami.
+  @param[in] data Tekst.
+  @param[in] size Długość tekstu w bajtach.
+  @param[in] pos Pozycja początkowa.
+  @param[out] error Czy ciąg kończy się niepoprawnym znakiem.
+  @return Pozycja pierwszej litery, niepoprawnego znaku lub końca tekstu.
+  */
+size_t tokenizer_skip_text(const char *data, size_t size, size_t pos,
+                           bool *error);
+
+/**
+  Wczytuje słowo, od razu zamieniając je na małe litery.
+  Wczytywanie kończy się na pierwszym znaku niebędącym literą, na
+  niepoprawnym znaku, na końcu tekstu lub po `max_len` literach.
+  @param[in] data Tekst.
+  @param[in] size Długość tekstu w bajtach.
+  @param[in] pos Pozycja początkowa.
+  @param[out] folded Słowo złożone z małych liter, zakończone znakiem
+  zerowym; musi mieścić `max_len + 1` znaków.
+  @param[in] max_len Maksymalna liczba liter.
+  @param[out] len Liczba wczytanych liter.
+  @param[out] error Czy słowo kończy się niepoprawnym znakiem.
+  @return Pozycja za ostatnią wczytaną literą.
+  */
+size_t tokenizer_scan_word(const char *data, size_t size, size_t pos,
+                           wchar_t *folded, size_t max_len, size_t *len,
+                           bool *error);
+
+#endif /* __TOKENIZER_H__ */
@@ -0,0 +1,160 @@
+/** @file
+    Testy podziału tekstu na słowa.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwerstet Warszawski
+    @date 2026-10-19
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <cmocka.h>
+#include <locale.h>
+#include "tokenizer.c"
+#include "utils.h"
+
+/**
+  Testuje zgodność tablic z funkcjami biblioteki standardowej.
+  @param state Środowisko testowe.
+  */
+static void tokenizer_tables_test(void** state)
+{
+    for (wint_t c = 0; c < TOKENIZER_TABLE_SIZE; c++)
+    {
+        assert_int_equal(tokenizer_is_letter(c), iswalpha(c) != 0);
+        if (iswalpha(c)) assert_int_equal(tokenizer_fold(c), towlower(c));
+    }
+
+    assert_true(tokenizer_is_letter(L'Ż'));
+    assert_int_equal(tokenizer_fold(L'Ż'), L'ż');
+    assert_false(tokenizer_is_letter(L'7'));
+    assert_false(tokenizer_is_letter(WEOF));
+}
+
+/**
+  Testuje zamianę słowa na małe litery.
+  @param state Środowisko testowe.
+  */
+static void tokenizer_fold_word_test(void** state)
+{
+    wchar_t word[] = L"ZaŻółĆ";
+    wchar_t invalid[] = L"kot1";
+
+    assert_int_equal(tokenizer_fold_word(word), 1);
+    assert_true(wcscmp(word, L"zażółć") == 0);
+    assert_int_equal(tokenizer_fold_word(invalid), 0);
+
+    // Kopia jest przydzielana przez funkcję bez atrap pamięci.
+#   undef free
+    const char utf8_word[] = "ZaŻółĆ";
+    char *folded;
+
+    assert_int_equal(tokenizer_fold_word_utf8(utf8_word, &folded), 1);
+    assert_true(strcmp(folded, "zażółć") == 0);
+    assert_true(strcmp(utf8_word, "ZaŻółĆ") == 0);
+    free(folded);
+    assert_int_equal(tokenizer_fold_word_utf8("Kot1", &folded), 0);
+    assert_true(strcmp(folded, "kot1") == 0);
+    free(folded);
+
+    // Małe Ⱥ (U+023A) zajmuje trzy bajty, a wielkie dwa.
+    assert_int_equal(tokenizer_fold_word_utf8("ŻȺB", &folded), 1);
+    assert_true(strcmp(folded, "ż\u2C65b") == 0);
+    free(folded);
+    assert_int_equal(tokenizer_fold_word_utf8("ȺB1C", &folded), 0);
+    assert_true(strcmp(folded, "\u2C65b1C") == 0);
+    free(folded);
+#   define free(ptr) _test_free(ptr, __FILE__, __LINE__)
+}
+
+/**
+  Testuje dekodowanie znaków.
+  @param state Środowisko testowe.
+  */
+static void tokenizer_decode_test(void** state)
+{
+    wchar_t c;
+
+    assert_int_equal(tokenizer_decode("a", 1, &c), 1);
+    assert_int_equal(c, L'a');
+    assert_int_equal(tokenizer_decode("ą", 2, &c), 2);
+    assert_int_equal(c, L'ą');
+    assert_int_equal(tokenizer_decode("€", 3, &c), 3);
+    assert_int_equal(c, L'€');
+    // Niepoprawne i niepełne sekwencje.
+    assert_int_equal(tokenizer_decode("\xff", 1, &c), 0);
+    assert_int_equal(tokenizer_decode("\xc4", 1, &c), 0);
+    assert_int_equal(tokenizer_decode("\xc0\x80", 2, &c), 0);
+}
+
+/**
+  Testuje pomijanie tekstu niebędącego słowami.
+  @param state Środowisko testowe.
+  */
+static void tokenizer_skip_text_test(void** state)
+{
+    const char *text = "12345678, 12345678 -- Ala";
+    const char *bad = "12345678 \xff kot";
+    bool error;
+
+    assert_int_equal(tokenizer_skip_text(text, strlen(text), 0, &error), 22);
+    assert_false(error);
+    assert_int_equal(tokenizer_skip_text(text, strlen(text), 22, &error), 22);
+    assert_int_equal(tokenizer_skip_text("1 ż", 4, 0, &error), 2);
+    assert_int_equal(tokenizer_skip_text("12345", 5, 0, &error), 5);
+    assert_false(error);
+
+    assert_int_equal(tokenizer_skip_text(bad, strlen(bad), 0, &error), 9);
+    assert_true(error);
+}
+
+/**
+  Testuje wczytywanie słów.
+  @param state Środowisko testowe.
+  */
+static void tokenizer_scan_word_test(void** state)
+{
+    const char *text = "ŻÓŁW, Kot";
+    wchar_t folded[5];
+    size_t len;
+    bool error;
+
+    size_t pos = tokenizer_scan_word(text, strlen(text), 0, folded, 4, &len,
+                                     &error);
+    assert_int_equal(pos, 7);
+    assert_int_equal(len, 4);
+    assert_false(error);
+    assert_true(wcscmp(folded, L"żółw") == 0);
+
+    pos = tokenizer_scan_word(text, strlen(text), 9, folded, 2, &len, &error);
+    assert_int_equal(pos, 11);
+    assert_true(wcscmp(folded, L"ko") == 0);
+
+    pos = tokenizer_scan_word("ab\xff", 3, 0, folded, 4, &len, &error);
+    assert_int_equal(pos, 2);
+    assert_true(error);
+    assert_true(wcscmp(folded, L"ab") == 0);
+}
+
+/**
+  Główna funkcja uruchamiająca testy.
+  */
+int main(void)
+{
+    setlocale(LC_ALL, "pl_PL.UTF-8");
+    tokenizer_init();
+
+    const struct CMUnitTest tests[] =
+    {
+        cmocka_unit_test(tokenizer_tables_test),
+        cmocka_unit_test(tokenizer_fold_word_test),
+        cmocka_unit_test(tokenizer_decode_test),
+        cmocka_unit_test(tokenizer_skip_text_test),
+        cmocka_unit_test(tokenizer_scan_word_test),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
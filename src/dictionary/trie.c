@@ -9,10 +9,23 @@
 
 #include "trie.h"
 #include "node.h"
+#include "utf8.h"
 #include <stdlib.h>
 #include <string.h>
 #include <wctype.h>
 
+/**
+ Liczba górnych poziomów drzewa, których synowie są układani wszerz przez
+ trie_compact() i trie_load(). Trzy poziomy polskich słów to kilkadziesiąt
+ tysięcy węzłów, więc kolejne poziomy są już układane poddrzewami.
+ */
+#define TRIE_BREADTH_FIRST_LEVELS 2
+
+/**
+ Początkowa długość bufora zapisu wczytywanego drzewa.
+ */
+#define TRIE_LOAD_TEXT 1024
+
 /**
  Struktura przechowująca drzewo.
  */
@@ -22,12 +35,105 @@ struct trie
     Node *root;
     /// Długość najdłuższego słowa jakie kiedykolwiek było w drzewie.
     size_t longest;
+    /// Drzewo bazowe nakładki (NULL, jeśli drzewo nie jest nakładką).
+    const Trie *base;
+    /// Alfabet kodujący znaki węzłów (w nakładce alfabet drzewa bazowego).
+    Alphabet *alphabet;
+    /// Blok węzłów ułożonych przez trie_compact() (NULL, jeśli go nie ma).
+    Node *block;
 };
 
 /** @name Funkcje pomocnicze
   @{
   */
 
+/*
+ Zwraca syna węzła o określonym znaku, korzystając z kodów znaków.
+ */
+static Node * get_child(const Trie *trie, const Node *node, wchar_t key)
+{
+    return node_get_coded_child(node, key, alphabet_find(trie->alphabet, key));
+}
+
+/*
+ Dodaje syna węzła, do którego prowadzi krawędź o danej etykiecie.
+ */
+static Node * add_edge(const Trie *trie, Node *node, const wchar_t *label,
+                       size_t length)
+{
+    return node_add_coded_edge(node, label, length,
+                               alphabet_find(trie->alphabet, label[0]));
+}
+
+/*
+ Zamienia pozycję wewnątrz krawędzi w węzeł i wstawia go u ojca krawędzi,
+ który nie może być współdzielony.
+ */
+static Node * split(const Trie *trie, Node *parent, Node *node)
+{
+    if (!node_is_inner(node)) return node;
+
+    wchar_t next = node_get_key(node_get_child_by_index(node, 0));
+    return node_split(parent, node, alphabet_find(trie->alphabet, next));
+}
+
+/*
+ Zwraca pierwszą pozycję krawędzi węzła. Pozycje krawędzi leżą w węźle,
+ więc nie korzysta z ojca węzła, który w kopiach może być nieaktualny.
+ */
+static Node * edge_start(Node *node)
+{
+    Node *parent;
+
+    while ((parent = node_get_parent(node)) != NULL && node_is_inner(parent))
+        node = parent;
+
+    return node;
+}
+
+/*
+ Przechodzi ścieżką słowa, dopóki jest ona w drzewie. Zapisuje osiągniętą
+ pozycję i ostatni węzeł przed nią, czyli ojca jej krawędzi.
+ Zwraca liczbę przebytych znaków.
+ */
+static size_t follow(const Trie *trie, const wchar_t *word, size_t len,
+                     Node **node, Node **parent)
+{
+    size_t depth = 0;
+    Node *current = trie->root;
+
+    *parent = NULL;
+    while (depth < len)
+    {
+        Node *child = get_child(trie, current, word[depth]);
+        if (child == NULL) break;
+
+        if (!node_is_inner(current)) *parent = current;
+        current = child;
+        depth++;
+    }
+
+    *node = current;
+    return depth;
+}
+
+/*
+ Dodaje do alfabetu nieznane znaki słowa. Dodanie znaku zmienia kody
+ znaków od niego większych, więc maski kodów dzieci są wtedy wyznaczane
+ na nowo. Drzewo nie może być współdzielone ani być nakładką.
+ */
+static void learn_word(Trie *trie, const wchar_t *word)
+{
+    bool changed = false;
+
+    for (; *word != L'\0'; word++)
+    {
+        if (alphabet_add(trie->alphabet, *word)) changed = true;
+    }
+
+    if (changed) node_recode(trie->root, trie->alphabet);
+}
+
 /*
  Stwierdza, czy można usunąć węzeł.
  */
@@ -39,16 +145,270 @@ static bool can_remove(const Node *node)
 }
 
 /*
- Usuwa zbędne węzły idąc "w górę" drzewa od podanego węzła.
+ Usuwa zbędne węzły idąc "w górę" drzewa od podanego węzła, a węzeł,
+ na którym się zatrzyma, łączy z jedynym synem w jedną krawędź.
  */
 static void remove_non_words(Node *node)
 {
     while (can_remove(node))
     {
-        Node *parent = node_get_parent(node);
-        node_remove_child(node_get_parent(node), node_get_key(node));
+        Node *start = edge_start(node);
+        Node *parent = node_get_parent(start);
+        node_remove_child(parent, node_get_key(start));
         node = parent;
     }
+
+    node_merge_child(node);
+}
+
+/*
+ Usuwa zbędne węzły z końca ścieżki węzłów, z których każdy jest synem
+ poprzedniego. Zwraca liczbę pozostałych węzłów ścieżki.
+ */
+static size_t remove_path_non_words(Node **path, size_t n)
+{
+    while (n > 1 && node_children_count(path[n - 1]) == 0
+           && !node_is_word(path[n - 1]))
+    {
+        node_remove_child(path[n - 2], node_get_key(edge_start(path[n - 1])));
+        n--;
+    }
+
+    return n;
+}
+
+/*
+ Destrukcja zastąpionego węzła na potrzeby epoch_retire().
+ */
+static void free_replaced_node(void *node)
+{
+    node_done_shallow((Node *) node);
+}
+
+/*
+ Kopiuje istniejącą część ścieżki słowa i łączy kopie ze sobą. Kopiowane
+ są całe krawędzie, na które wchodzi ścieżka: zapisuje ich węzły i kopie
+ (pierwszą jest korzeń), ich liczbę oraz pozycję w kopii, do której
+ prowadzi ścieżka. Zwraca liczbę przebytych znaków.
+ */
+static size_t copy_path(const Trie *trie, const wchar_t *word, size_t len,
+                        Node **old, Node **copy, size_t *copied, Node **end)
+{
+    size_t depth = 0, n = 1;
+    Node *old_node = trie_get_root((Trie *) trie);
+    Node *node = node_copy(old_node);
+
+    old[0] = old_node;
+    copy[0] = node;
+
+    while (depth < len)
+    {
+        Node *child = get_child(trie, old_node, word[depth]);
+        if (child == NULL) break;
+
+        // Dalsze pozycje krawędzi są już w jej kopii.
+        if (node_is_inner(old_node)) node = get_child(trie, node, word[depth]);
+        else
+        {
+            Node *child_copy = node_copy(child);
+            node_replace_child(node, child_copy);
+            old[n] = node_get_edge_end(child);
+            copy[n++] = node_get_edge_end(child_copy);
+            node = child_copy;
+        }
+
+        old_node = child;
+        depth++;
+    }
+
+    *copied = n;
+    *end = node;
+    return depth;
+}
+
+/*
+ Publikuje skopiowaną ścieżkę i przekazuje zastąpione węzły do zwolnienia.
+ Pierwsze kept kopii pozostało w drzewie.
+ */
+static void publish_path(Trie *trie, Node **old, Node **copy, size_t copied,
+                         size_t kept, Epoch *epoch)
+{
+    // Synowie współdzieleni z poprzednim drzewem wskazują teraz na kopie;
+    // klucze na ścieżce są takie same, więc słowa odtwarzane przez
+    // przechodzenie w górę się nie zmieniają.
+    for (size_t i = 0; i < kept; i++) node_adopt_children(copy[i]);
+
+    __atomic_store_n(&trie->root, copy[0], __ATOMIC_RELEASE);
+
+    for (size_t i = 0; i < copied; i++)
+        epoch_retire(epoch, old[i], free_replaced_node);
+}
+
+/*
+ Zwraca odpowiednik węzła w drzewie bazowym lub NULL, jeśli go nie ma.
+ */
+static const Node * base_child(const Trie *trie, const Node *base_node,
+                               wchar_t key)
+{
+    return base_node ? get_child(trie, base_node, key) : NULL;
+}
+
+/*
+ Zapewnia, że węzły nakładki na ścieżce słowa nie są współdzielone
+ z drzewem bazowym, kopiując współdzielone. Węzeł jest współdzielony,
+ jeśli jest tym samym węzłem co jego odpowiednik w drzewie bazowym;
+ krawędź jest kopiowana w całości przy wejściu na nią.
+ Ojcem kopii pozostaje odpowiednik jej ojca w drzewie bazowym: ma ten sam
+ klucz, a węzły bazowe nie są zmieniane, więc nie trzeba zmieniać ojca
+ współdzielonych synów. Zapisuje węzły krawędzi, na które wchodzi ścieżka
+ (pierwszym jest korzeń), ich liczbę oraz osiągniętą pozycję.
+ Zwraca liczbę przebytych znaków.
+ */
+static size_t own_path(Trie *trie, const wchar_t *word, size_t len,
+                       Node **path, size_t *n_path, Node **end)
+{
+    const Node *base_node = trie->base->root;
+    size_t depth = 0, n = 1;
+
+    if (trie->root == base_node) trie->root = node_copy(base_node);
+    Node *node = path[0] = trie->root;
+
+    while (depth < len)
+    {
+        Node *child = get_child(trie, node, word[depth]);
+        if (child == NULL) break;
+
+        base_node = base_child(trie, base_node, word[depth]);
+        if (child == base_node)
+        {
+            child = node_copy(child);
+            node_replace_child(node, child);
+        }
+        if (!node_is_inner(node)) path[n++] = node_get_edge_end(child);
+
+        node = child;
+        depth++;
+    }
+
+    *n_path = n;
+    *end = node;
+    return depth;
+}
+
+/*
+ Wstawia słowo do nakładki.
+ */
+static int overlay_insert_word(Trie *trie, const wchar_t *word)
+{
+    size_t word_length = wcslen(word);
+
+    if (trie_has_word(trie, word)) return 0;
+
+    Node *path[word_length + 1], *node;
+    size_t n;
+    size_t depth = own_path(trie, word, word_length, path, &n, &node);
+
+    // Alfabet jest współdzielony z drzewem bazowym, więc się nie zmienia.
+    if (node_is_inner(node)) node = split(trie, path[n - 2], node);
+    if (depth < word_length)
+        node = add_edge(trie, node, word + depth, word_length - depth);
+
+    node_set_is_word(node, true);
+    if (word_length > trie->longest) trie->longest = word_length;
+
+    return 1;
+}
+
+/*
+ Usuwa słowo z nakładki.
+ */
+static int overlay_delete_word(Trie *trie, const wchar_t *word)
+{
+    size_t word_length = wcslen(word);
+
+    if (!trie_has_word(trie, word)) return 0;
+
+    Node *path[word_length + 1], *node;
+    size_t n;
+    own_path(trie, word, word_length, path, &n, &node);
+
+    // Słowa kończą się w węzłach, więc node jest ostatnim węzłem ścieżki.
+    node_set_is_word(node, false);
+    remove_path_non_words(path, n);
+
+    return 1;
+}
+
+/*
+ Zwalnia węzły nakładki, które nie należą do drzewa bazowego.
+ */
+static void free_overlay_nodes(const Trie *trie, Node *node,
+                               const Node *base_node)
+{
+    if (node == base_node) return;
+
+    // Pozycje wewnątrz krawędzi leżą w jej węźle, który jest zwalniany
+    // ostatni, więc po powrocie z potomków nie czytamy już pozycji.
+    int n_children = node_children_count(node);
+    bool inner = node_is_inner(node);
+    for (int i = 0; i < n_children; i++)
+    {
+        Node *child = node_get_child_by_index(node, i);
+        free_overlay_nodes(trie, child,
+                           base_child(trie, base_node, node_get_key(child)));
+    }
+
+    if (!inner) node_done_shallow(node);
+}
+
+/*
+ Dodaje słowo kończące się w węźle i słowa z jego poddrzewa do listy.
+ */
+static void add_subtree_words(const Node *node, wchar_t *prefix,
+                              size_t depth, struct word_list *list)
+{
+    prefix[depth] = node_get_key(node);
+    prefix[depth + 1] = L'\0';
+    if (node_is_word(node)) word_list_add(list, prefix);
+
+    node_add_words_to_list(node, prefix, depth + 1, list);
+}
+
+/*
+ Wyznacza różnice między poddrzewem nakładki a jego odpowiednikiem
+ w drzewie bazowym (NULL, jeśli go nie ma).
+ */
+static void add_changes(const Trie *trie, const Node *node,
+                        const Node *base_node, wchar_t *prefix, size_t depth,
+                        struct word_list *added, struct word_list *deleted)
+{
+    if (node == base_node) return;
+
+    prefix[depth] = L'\0';
+    bool base_is_word = base_node != NULL && node_is_word(base_node);
+    if (depth > 0 && node_is_word(node) && !base_is_word)
+        word_list_add(added, prefix);
+    if (depth > 0 && !node_is_word(node) && base_is_word)
+        word_list_add(deleted, prefix);
+
+    for (int i = 0; i < node_children_count(node); i++)
+    {
+        Node *child = node_get_child_by_index(node, i);
+        prefix[depth] = node_get_key(child);
+        add_changes(trie, child,
+                    base_child(trie, base_node, node_get_key(child)),
+                    prefix, depth + 1, added, deleted);
+    }
+
+    // Usunięte poddrzewa drzewa bazowego.
+    for (int i = 0; base_node && i < node_children_count(base_node); i++)
+    {
+        Node *base = node_get_child_by_index(base_node, i);
+        if (get_child(trie, node, node_get_key(base)) == NULL)
+            add_subtree_words(base, prefix, depth, deleted);
+    }
+
+    prefix[depth] = L'\0';
 }
 
 /**@}*/
@@ -67,32 +427,62 @@ Trie * trie_new()
 
     trie->root = node_new(L'\0');
     trie->longest = 0;
+    trie->base = NULL;
+    trie->alphabet = alphabet_new();
+    trie->block = NULL;
+
+    return trie;
+}
+
+Trie * trie_new_overlay(const Trie *base)
+{
+    Trie *trie = trie_new();
+
+    node_done(trie->root);
+    alphabet_done(trie->alphabet);
+    trie->root = base->root;
+    trie->longest = base->longest;
+    trie->base = base;
+    trie->alphabet = base->alphabet;
 
     return trie;
 }
 
 Node *trie_get_root(Trie *trie)
 {
-    return trie->root;
+    return __atomic_load_n(&trie->root, __ATOMIC_ACQUIRE);
 }
 
 void trie_done(Trie *trie)
 {
-    node_done(trie->root);
+    if (trie->base) free_overlay_nodes(trie, trie->root, trie->base->root);
+    else
+    {
+        node_done(trie->root);
+        alphabet_done(trie->alphabet);
+    }
+    if (trie->block) node_free_block(trie->block);
     free(trie);
 }
 
 int trie_insert_word(Trie *trie, const wchar_t *word)
 {
-    Node *current_node = trie->root;
+    if (trie->base) return overlay_insert_word(trie, word);
+
+    Node *current_node, *parent;
     size_t word_length = wcslen(word);
 
-    for (int i = 0; i < word_length; i++)
+    learn_word(trie, word);
+    size_t depth = follow(trie, word, word_length, &current_node, &parent);
+
+    // Reszta słowa jest etykietą jednej nowej krawędzi.
+    current_node = split(trie, parent, current_node);
+    if (depth < word_length)
     {
-        current_node = node_add_child(current_node, word[i]);
+        current_node = add_edge(trie, current_node, word + depth,
+                                word_length - depth);
     }
-
-    if (node_is_word(current_node))
+    else if (node_is_word(current_node))
     {
         return 0;
     }
@@ -106,16 +496,14 @@ int trie_insert_word(Trie *trie, const wchar_t *word)
 
 int trie_delete_word(Trie *trie, const wchar_t *word)
 {
-    Node *current_node = trie->root;
+    if (trie->base) return overlay_delete_word(trie, word);
+
+    Node *current_node, *parent;
     size_t word_length = wcslen(word);
 
-    for (int i = 0; i < word_length; i++)
+    if (follow(trie, word, word_length, &current_node, &parent) < word_length)
     {
-        current_node = node_get_child(current_node, word[i]);
-        if (current_node == NULL)
-        {
-            return 0;
-        }
+        return 0;
     }
 
     if (!node_is_word(current_node))
@@ -129,57 +517,223 @@ int trie_delete_word(Trie *trie, const wchar_t *word)
     return 1;
 }
 
+int trie_insert_word_shared(Trie *trie, const wchar_t *word, Epoch *epoch)
+{
+    size_t word_length = wcslen(word);
+
+    if (trie_has_word(trie, word)) return 0;
+
+    Node *old[word_length + 1], *copy[word_length + 1], *node;
+    size_t copied;
+    size_t depth = copy_path(trie, word, word_length, old, copy, &copied,
+                             &node);
+
+    // Czytelnicy korzystają z alfabetu, więc się nie zmienia. Krawędź jest
+    // dzielona w kopii, więc czytelnicy widzą ją w całości.
+    if (node_is_inner(node)) node = split(trie, copy[copied - 2], node);
+    if (depth < word_length)
+        node = add_edge(trie, node, word + depth, word_length - depth);
+
+    node_set_is_word(node, true);
+
+    if (word_length > trie->longest)
+        __atomic_store_n(&trie->longest, word_length, __ATOMIC_RELAXED);
+
+    publish_path(trie, old, copy, copied, copied, epoch);
+
+    return 1;
+}
+
+int trie_delete_word_shared(Trie *trie, const wchar_t *word, Epoch *epoch)
+{
+    size_t word_length = wcslen(word);
+
+    if (!trie_has_word(trie, word)) return 0;
+
+    Node *old[word_length + 1], *copy[word_length + 1], *node;
+    size_t copied;
+    copy_path(trie, word, word_length, old, copy, &copied, &node);
+
+    // Krawędzie nie są tu łączone, bo syn węzła może być czytany; łączy je
+    // dopiero trie_compact().
+    node_set_is_word(node, false);
+    size_t kept = remove_path_non_words(copy, copied);
+
+    publish_path(trie, old, copy, copied, kept, epoch);
+
+    return 1;
+}
+
 bool trie_has_word(const Trie *trie, const wchar_t *word)
 {
-    return node_has_word(trie->root, word);
+    bool found;
+
+    trie_has_words(trie, &word, 1, &found);
+    return found;
+}
+
+bool trie_has_word_utf8(const Trie *trie, const char *word)
+{
+    const Node *node = trie_get_root((Trie *) trie);
+
+    while (*word != '\0')
+    {
+        wchar_t c;
+        size_t n = utf8_decode(word, &c);
+        if (n == 0) return false;
+
+        node = get_child(trie, node, c);
+        if (node == NULL) return false;
+        word += n;
+    }
+
+    return node_is_word(node);
+}
+
+void trie_has_words(const Trie *trie, const wchar_t * const *words, size_t n,
+                    bool *results)
+{
+    node_has_words(trie_get_root((Trie *) trie), trie->alphabet, words, n,
+                   results);
+}
+
+void trie_overlay_changes(const Trie *trie, struct word_list *added,
+                          struct word_list *deleted)
+{
+    size_t longest = trie->longest > trie->base->longest
+                     ? trie->longest : trie->base->longest;
+    wchar_t prefix[longest + 2];
+
+    add_changes(trie, trie->root, trie->base->root, prefix, 0, added,
+                deleted);
 }
 
 void trie_to_word_list(const Trie *trie, struct word_list *list)
 {
-    wchar_t prefix[trie->longest + 1];
-    node_add_words_to_list(trie->root, prefix, 0, list);
+    // Korzeń jest publikowany po zwiększeniu długości.
+    Node *root = trie_get_root((Trie *) trie);
+    wchar_t prefix[__atomic_load_n(&trie->longest, __ATOMIC_RELAXED) + 2];
+    node_add_words_to_list(root, prefix, 0, list);
 }
 
 int trie_save(const Trie *trie, IO *io)
 {
-    int ret = node_save(trie->root, io);
+    return trie_save_root(trie_get_root((Trie *) trie), io);
+}
+
+int trie_save_root(const Node *root, IO *io)
+{
+    int ret = node_save(root, io);
     if (io_printf(io, L"\n") < 0) return -1;
     return ret;
 }
 
+bool trie_compact(Trie *trie)
+{
+    if (trie->base) return false;
+
+    Node *root = node_relayout(trie->root, TRIE_BREADTH_FIRST_LEVELS);
+
+    node_done(trie->root);
+    if (trie->block) node_free_block(trie->block);
+    trie->root = trie->block = root;
+
+    return true;
+}
+
+const Alphabet * trie_get_alphabet(const Trie *trie)
+{
+    return trie->alphabet;
+}
+
 Trie * trie_load(IO *io)
 {
-    Trie *trie = trie_new();
-    Node *node = trie->root;
+    return trie_load_with_alphabet(io, alphabet_new());
+}
+
+wchar_t * trie_load_text(IO *io, size_t *length)
+{
+    size_t depth = 0, size = TRIE_LOAD_TEXT;
+    wchar_t *text = malloc(size * sizeof(wchar_t));
+    if (!text)
+    {
+        fprintf(stderr, "Failed to allocate memory for trie\n");
+        exit(EXIT_FAILURE);
+    }
 
+    *length = 0;
     wint_t c;
 
     while ((c = io_get_next(io)) != L'\n' && c != WEOF)
     {
-        if (c == L'*')
-        {
-            node_set_is_word(node, true);
-        }
-        else if (c == L'^')
+        if (c == L'^')
         {
-            node = node_get_parent(node);
-            if (node == NULL)
+            if (depth == 0)
             {
-                trie_done(trie);
+                free(text);
                 return NULL;
             }
+            depth--;
         }
-        else
+        else if (c != L'*')
         {
             if (!iswalpha(c))
             {
-                trie_done(trie);
+                free(text);
                 return NULL;
             }
-            node = node_add_child_at_end(node, c);
+            depth++;
+        }
+
+        if (*length == size)
+        {
+            size *= 2;
+            text = realloc(text, size * sizeof(wchar_t));
+            if (!text)
+            {
+                fprintf(stderr, "Failed to allocate memory for trie\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        text[(*length)++] = c;
+    }
+
+    return text;
+}
+
+Trie * trie_load_with_alphabet(IO *io, Alphabet *alphabet)
+{
+    // Zapis jest buforowany w całości, bo układ bloku zależy od całego
+    // drzewa; zajmuje on tylko ułamek pamięci rozrzuconych węzłów.
+    size_t length;
+    wchar_t *text = trie_load_text(io, &length);
+    if (text == NULL)
+    {
+        alphabet_done(alphabet);
+        return NULL;
+    }
+
+    Trie *trie = trie_new();
+    alphabet_done(trie->alphabet);
+    trie->alphabet = alphabet;
+
+    size_t depth = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        if (text[i] == L'^') depth--;
+        else if (text[i] != L'*')
+        {
+            alphabet_add(alphabet, text[i]);
+            if (++depth > trie->longest) trie->longest = depth;
         }
     }
 
+    // Alfabet jest już pełny, więc kody węzłów są od razu ostateczne.
+    node_done(trie->root);
+    trie->root = trie->block = node_load_block(L'\0', text, length, alphabet,
+                                               TRIE_BREADTH_FIRST_LEVELS);
+    free(text);
+
     return trie;
 }
 
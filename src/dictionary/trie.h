@@ -16,6 +16,7 @@
 #include "word_list.h"
 #include "io.h"
 #include "node.h"
+#include "epoch.h"
 
 /**
   Struktura przechowująca drzewo.
@@ -29,6 +30,20 @@ typedef struct trie Trie;
   */
 Trie * trie_new();
 
+/**
+  Inicjalizacja drzewa będącego nakładką na inne drzewo.
+  Nakładka początkowo zawiera te same słowa co drzewo bazowe i współdzieli
+  z nim wszystkie węzły. Wstawianie i usuwanie słów w nakładce kopiuje
+  węzły drzewa bazowego na ścieżce słowa, więc drzewo bazowe się nie
+  zmienia, a nakładka zajmuje pamięć tylko na zmienione ścieżki.
+  Nakładka koduje znaki alfabetem drzewa bazowego (zob. alphabet.h).
+  Drzewo bazowe nie może być zmieniane ani zniszczone przed nakładką.
+  Nakładkę należy zniszczyć za pomocą trie_done().
+  @param[in] base Drzewo bazowe.
+  @return Nowe drzewo.
+  */
+Trie * trie_new_overlay(const Trie *base);
+
 /**
   Destrukcja drzewa.
   @param[in,out] trie Drzewo.
@@ -44,6 +59,8 @@ Node *trie_get_root(Trie *trie);
 
 /**
   Wstawia słowo do drzewa.
+  Nieznane znaki słowa są dodawane do alfabetu drzewa, a po zmianie kodów
+  znaków wszystkie węzły są kodowane na nowo.
   @param[in,out] trie Drzewo.
   @param[in] word Wstawiane słowo.
   @return 0 jeśli słowo było już w drzewie, 1 jeśli udało się wstawić
@@ -58,6 +75,31 @@ int trie_insert_word(Trie *trie, const wchar_t *word);
   */
 int trie_delete_word(Trie *trie, const wchar_t *word);
 
+/**
+  Wstawia słowo do drzewa czytanego równolegle przez innych.
+  Zmieniane węzły są kopiowane, a nowy korzeń jest publikowany atomowo,
+  więc czytelnicy widzą drzewo sprzed albo po wstawieniu. Zastąpione
+  węzły są przekazywane do zwolnienia przez epoch_retire().
+  Alfabet drzewa się nie zmienia: węzły znaków spoza niego są wyszukiwane
+  bez kodów.
+  Pisarze muszą być wzajemnie wykluczeni przez wywołującego.
+  @param[in,out] trie Drzewo.
+  @param[in] word Wstawiane słowo.
+  @param[in,out] epoch Stan odzyskiwania pamięci czytelników drzewa.
+  @return 0 jeśli słowo było już w drzewie, 1 jeśli udało się wstawić
+  */
+int trie_insert_word_shared(Trie *trie, const wchar_t *word, Epoch *epoch);
+
+/**
+  Usuwa słowo z drzewa czytanego równolegle przez innych.
+  Działa jak trie_insert_word_shared().
+  @param[in,out] trie Drzewo.
+  @param[in] word Usuwane słowo.
+  @param[in,out] epoch Stan odzyskiwania pamięci czytelników drzewa.
+  @return 1 jeśli się udało, 0 w p.p.
+  */
+int trie_delete_word_shared(Trie *trie, const wchar_t *word, Epoch *epoch);
+
 /**
   Sprawdza, czy drzewo zawiera dane słowo.
   @param[in] trie Drzewo.
@@ -66,6 +108,38 @@ int trie_delete_word(Trie *trie, const wchar_t *word);
   */
 bool trie_has_word(const Trie *trie, const wchar_t *word);
 
+/**
+  Sprawdza, czy drzewo zawiera dane słowo zakodowane w UTF-8.
+  Znaki są dekodowane w trakcie przechodzenia drzewa, bez kopiowania słowa.
+  @param[in] trie Drzewo.
+  @param[in] word Sprawdzane słowo.
+  @return Wartość logiczna określająca czy słowo istnieje (false dla słowa
+  błędnie zakodowanego).
+  */
+bool trie_has_word_utf8(const Trie *trie, const char *word);
+
+/**
+  Sprawdza, czy drzewo zawiera dane słowa.
+  @param[in] trie Drzewo.
+  @param[in] words Sprawdzane słowa.
+  @param[in] n Liczba słów.
+  @param[out] results Wartości logiczne określające czy słowa istnieją.
+  */
+void trie_has_words(const Trie *trie, const wchar_t * const *words, size_t n,
+                    bool *results);
+
+/**
+  Wyznacza różnice między nakładką a jej drzewem bazowym.
+  Przegląda tylko węzły skopiowane przez nakładkę.
+  @param[in] trie Nakładka.
+  @param[in,out] added Lista słów nakładki, których nie ma w drzewie
+  bazowym.
+  @param[in,out] deleted Lista słów drzewa bazowego, których nie ma
+  w nakładce.
+  */
+void trie_overlay_changes(const Trie *trie, struct word_list *added,
+                          struct word_list *deleted);
+
 /**
   Zwraca listę słów zapisanych w drzewie.
   @param[in] trie Drzewp
@@ -81,12 +155,64 @@ void trie_to_word_list(const Trie *trie, struct word_list *list);
   */
 int trie_save(const Trie *trie, IO *io);
 
+/**
+  Zapisuje drzewo o danym korzeniu, np. migawkę pobraną przez
+  trie_get_root(), w formacie trie_save().
+  @param[in] root Korzeń drzewa.
+  @param[in,out] io We/wy.
+  @return <0 jeśli operacja się nie powiedzie, 0 w p.p.
+  */
+int trie_save_root(const Node *root, IO *io);
+
+/**
+  Wczytuje zapis drzewa w formacie trie_save() bez budowania węzłów
+  i sprawdza jego poprawność.
+  @param[in,out] io We/wy.
+  @param[out] length Długość zapisu.
+  @return Zapis, który należy zwolnić przez free(), lub NULL, jeśli zapis
+  jest błędny.
+  */
+wchar_t * trie_load_text(IO *io, size_t *length);
+
 /**
   Inicjuje i wczytuje drzewo.
+  Węzły są tworzone od razu w jednym bloku, ułożonym jak przez
+  trie_compact(), bez budowania rozrzuconego drzewa.
   Drzewo to należy zniszczyć za pomocą trie_done().
   @param[in,out] io We/wy.
   @return Nowe drzewo lub NULL, jeśli operacja się nie powiedzie.
   */
 Trie * trie_load(IO *io);
 
+/**
+  Inicjuje i wczytuje drzewo, kodując znaki węzłów danym alfabetem.
+  Znaki spoza alfabetu są do niego dodawane.
+  Drzewo to należy zniszczyć za pomocą trie_done().
+  @param[in,out] io We/wy.
+  @param[in] alphabet Alfabet, który przejmuje drzewo.
+  @return Nowe drzewo lub NULL, jeśli zapis jest błędny.
+  */
+Trie * trie_load_with_alphabet(IO *io, Alphabet *alphabet);
+
+/**
+  Układa węzły drzewa na nowo w jednym bloku pamięci (zob. node_relayout())
+  i zwalnia dotychczasowe węzły, rozrzucone po stercie przez wstawianie
+  i usuwanie słów. Nie zmienia słów drzewa, ale zmienia jego węzły, więc
+  nie można go wywołać, gdy drzewo jest czytane równolegle. Węzły
+  wstawiane później są przydzielane osobno, aż do kolejnego wywołania.
+  @param[in,out] trie Drzewo.
+  @return false, jeśli drzewo jest nakładką i nie zostało zmienione,
+  true w p.p.
+  */
+bool trie_compact(Trie *trie);
+
+/**
+  Zwraca alfabet kodujący znaki węzłów drzewa.
+  Alfabet współdzielonego drzewa ani nakładki się nie zmienia, więc można
+  go czytać równolegle ze zmianami drzewa.
+  @param[in] trie Drzewo.
+  @return Alfabet.
+  */
+const Alphabet * trie_get_alphabet(const Trie *trie);
+
 #endif /* __TRIE_H__ */
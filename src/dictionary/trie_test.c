@@ -153,6 +153,150 @@ static void trie_to_word_list_test(void** state)
     trie_teardown(state);
 }
 
+/**
+  Testuje nakładkę na drzewo.
+  @param state Środowisko testowe.
+  */
+static void trie_overlay_test(void** state)
+{
+    Trie *base = trie_new();
+    trie_insert_word(base, L"wątły");
+    trie_insert_word(base, L"wątlejszy");
+    trie_insert_word(base, L"łódka");
+
+    Trie *overlay = trie_new_overlay(base);
+    assert_true(trie_has_word(overlay, L"łódka"));
+
+    assert_true(trie_insert_word(overlay, L"wąs"));
+    assert_false(trie_insert_word(overlay, L"wąs"));
+    assert_true(trie_delete_word(overlay, L"wątlejszy"));
+    assert_true(trie_delete_word(overlay, L"łódka"));
+    assert_false(trie_delete_word(overlay, L"łódka"));
+
+    assert_true(trie_has_word(overlay, L"wąs"));
+    assert_true(trie_has_word(overlay, L"wątły"));
+    assert_false(trie_has_word(overlay, L"wątlejszy"));
+    assert_false(trie_has_word(overlay, L"łódka"));
+
+    // Drzewo bazowe się nie zmienia.
+    assert_false(trie_has_word(base, L"wąs"));
+    assert_true(trie_has_word(base, L"wątlejszy"));
+    assert_true(trie_has_word(base, L"łódka"));
+
+    struct word_list added, deleted;
+    word_list_init(&added);
+    word_list_init(&deleted);
+    trie_overlay_changes(overlay, &added, &deleted);
+
+    assert_int_equal(word_list_size(&added), 1);
+    assert_true(wcscmp(word_list_get(&added)[0], L"wąs") == 0);
+    assert_int_equal(word_list_size(&deleted), 2);
+    assert_true(wcscmp(word_list_get(&deleted)[0], L"wątlejszy") == 0);
+    assert_true(wcscmp(word_list_get(&deleted)[1], L"łódka") == 0);
+
+    word_list_done(&deleted);
+    word_list_done(&added);
+
+    // Przywrócenie słowa usuwa je z różnic.
+    assert_true(trie_insert_word(overlay, L"łódka"));
+    word_list_init(&added);
+    word_list_init(&deleted);
+    trie_overlay_changes(overlay, &added, &deleted);
+    assert_int_equal(word_list_size(&added), 1);
+    assert_int_equal(word_list_size(&deleted), 1);
+    word_list_done(&deleted);
+    word_list_done(&added);
+
+    trie_done(overlay);
+    trie_done(base);
+}
+
+/**
+  Testuje dzielenie i łączenie krawędzi przy wstawianiu i usuwaniu.
+  @param state Środowisko testowe.
+  */
+static void trie_edge_test(void** state)
+{
+    Trie *trie = trie_new();
+    Node *root = trie_get_root(trie);
+
+    // Reszta słowa jest jedną krawędzią.
+    trie_insert_word(trie, L"wątlejszy");
+    assert_true(node_is_inner(node_get_child(root, L'w')));
+
+    trie_insert_word(trie, L"wątlały");
+    Node *branch = node_get_descendant(root, L"wątl", 4);
+    assert_false(node_is_inner(branch));
+    assert_int_equal(node_children_count(branch), 2);
+
+    trie_insert_word(trie, L"wąt");
+    assert_false(node_is_inner(node_get_descendant(root, L"wąt", 3)));
+    assert_false(trie_has_word(trie, L"wątl"));
+
+    // Po usunięciu słów węzły bez rozgałęzień są łączone z synami.
+    trie_delete_word(trie, L"wąt");
+    assert_true(node_is_inner(node_get_descendant(root, L"wąt", 3)));
+    trie_delete_word(trie, L"wątlały");
+    assert_true(node_is_inner(node_get_descendant(root, L"wątl", 4)));
+    assert_true(trie_has_word(trie, L"wątlejszy"));
+    assert_false(trie_has_word(trie, L"wątlały"));
+
+    // Krawędzie współdzielonego drzewa są dzielone w kopiach.
+    Epoch *epoch = epoch_new();
+    assert_true(trie_insert_word_shared(trie, L"wątek", epoch));
+    assert_false(trie_insert_word_shared(trie, L"wątek", epoch));
+    assert_true(trie_insert_word_shared(trie, L"wą", epoch));
+    assert_true(trie_has_word(trie, L"wątlejszy"));
+    assert_true(trie_delete_word_shared(trie, L"wątek", epoch));
+    assert_true(trie_delete_word_shared(trie, L"wą", epoch));
+    assert_false(trie_has_word(trie, L"wątek"));
+    assert_false(trie_has_word(trie, L"wą"));
+    assert_true(trie_has_word(trie, L"wątlejszy"));
+    epoch_done(epoch);
+
+    trie_done(trie);
+}
+
+/**
+  Testuje kodowanie znaków alfabetem drzewa.
+  @param state Środowisko testowe.
+  */
+static void trie_alphabet_test(void** state)
+{
+    const wchar_t *words[] = {L"kot", L"żółw", L"kąt", L"akt", L"ćma",
+                              L"kotka"};
+    const size_t n = sizeof(words) / sizeof(words[0]);
+    Trie *trie = trie_new();
+
+    // Słowa dodają znaki mniejsze od znanych, więc kody się zmieniają.
+    for (size_t i = 0; i < n; i++)
+    {
+        trie_insert_word(trie, words[i]);
+        for (size_t j = 0; j <= i; j++)
+            assert_true(trie_has_word(trie, words[j]));
+    }
+    assert_int_equal(alphabet_size(trie_get_alphabet(trie)), 11);
+    assert_false(trie_has_word(trie, L"kąta"));
+    assert_false(trie_has_word(trie, L"kox"));
+
+    // Nakładka nie zmienia alfabetu drzewa bazowego.
+    Trie *overlay = trie_new_overlay(trie);
+    trie_insert_word(overlay, L"kox");
+    trie_insert_word(overlay, L"xa");
+    assert_true(trie_has_word(overlay, L"kox"));
+    assert_true(trie_has_word(overlay, L"xa"));
+    assert_true(trie_has_word(overlay, L"kot"));
+    assert_false(trie_has_word(trie, L"kox"));
+    assert_int_equal(alphabet_size(trie_get_alphabet(trie)), 11);
+    trie_done(overlay);
+
+    assert_true(trie_delete_word(trie, L"kąt"));
+    assert_false(trie_has_word(trie, L"kąt"));
+    assert_true(trie_has_word(trie, L"kot"));
+
+    trie_done(trie);
+}
+
 /**
   Testuje zapisywanie drzewa.
   @param state Środowisko testowe.
@@ -284,6 +428,9 @@ int main(void)
         cmocka_unit_test(trie_has_word_test),
         cmocka_unit_test(trie_delete_word_test),
         cmocka_unit_test(trie_to_word_list_test),
+        cmocka_unit_test(trie_overlay_test),
+        cmocka_unit_test(trie_edge_test),
+        cmocka_unit_test(trie_alphabet_test),
         cmocka_unit_test(trie_save_test),
         cmocka_unit_test(trie_load_test),
     };
@@ -0,0 +1,167 @@
+/** @file
+    Kodowanie i dekodowanie znaków UTF-8.
+
+    Funkcje nie zależą od bieżącego locale i odrzucają zapisy niepoprawne:
+    nadmiarowo długie, surogaty, znaki spoza Unicode i urwane sekwencje.
+    Są krótkie i wywoływane dla każdego znaku sprawdzanego słowa, więc są
+    zdefiniowane w nagłówku.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwersytet Warszawski
+    @date 2026-10-19
+ */
+
+#ifndef __UTF8_H__
+#define __UTF8_H__
+
+#include <stddef.h>
+#include <wchar.h>
+
+/**
+  Maksymalna liczba bajtów znaku.
+  */
+#define UTF8_MAX_BYTES 4
+
+/**
+  Dekoduje znak z napisu zakończonego bajtem zerowym.
+  @param[in] data Bajty; pierwszy nie jest zerowy.
+  @param[out] c Znak.
+  @return Liczba bajtów znaku lub 0, jeśli bajty nie są poprawnym znakiem.
+  */
+static inline size_t utf8_decode(const char *data, wchar_t *c)
+{
+    const unsigned char *b = (const unsigned char *) data;
+
+    if (b[0] < 0x80)
+    {
+        *c = b[0];
+        return 1;
+    }
+
+    size_t n;
+    wchar_t min;
+    wchar_t value;
+    if (b[0] >= 0xC2 && b[0] < 0xE0)
+    {
+        n = 2;
+        min = 0x80;
+        value = b[0] & 0x1F;
+    }
+    else if (b[0] >= 0xE0 && b[0] < 0xF0)
+    {
+        n = 3;
+        min = 0x800;
+        value = b[0] & 0x0F;
+    }
+    else if (b[0] >= 0xF0 && b[0] < 0xF5)
+    {
+        n = 4;
+        min = 0x10000;
+        value = b[0] & 0x07;
+    }
+    else return 0;
+
+    // Bajt zerowy nie jest bajtem kontynuacji, więc pętla nie wyjdzie poza
+    // koniec napisu.
+    for (size_t i = 1; i < n; i++)
+    {
+        if ((b[i] & 0xC0) != 0x80) return 0;
+        value = (value << 6) | (b[i] & 0x3F);
+    }
+
+    if (value < min || value > 0x10FFFF
+        || (value >= 0xD800 && value < 0xE000))
+        return 0;
+
+    *c = value;
+    return n;
+}
+
+/**
+  Koduje znak.
+  @param[in] c Znak.
+  @param[out] data Bufor na co najmniej UTF8_MAX_BYTES bajtów.
+  @return Liczba zapisanych bajtów lub 0, jeśli znak nie należy do Unicode.
+  */
+static inline size_t utf8_encode(wchar_t c, char *data)
+{
+    unsigned long u = c;
+
+    if (u < 0x80)
+    {
+        data[0] = u;
+        return 1;
+    }
+    if (u < 0x800)
+    {
+        data[0] = 0xC0 | (u >> 6);
+        data[1] = 0x80 | (u & 0x3F);
+        return 2;
+    }
+    if (u >= 0xD800 && u < 0xE000) return 0;
+    if (u < 0x10000)
+    {
+        data[0] = 0xE0 | (u >> 12);
+        data[1] = 0x80 | ((u >> 6) & 0x3F);
+        data[2] = 0x80 | (u & 0x3F);
+        return 3;
+    }
+    if (u <= 0x10FFFF)
+    {
+        data[0] = 0xF0 | (u >> 18);
+        data[1] = 0x80 | ((u >> 12) & 0x3F);
+        data[2] = 0x80 | ((u >> 6) & 0x3F);
+        data[3] = 0x80 | (u & 0x3F);
+        return 4;
+    }
+
+    return 0;
+}
+
+/**
+  Dekoduje słowo. Słowo ma co najwyżej tyle znaków, ile bajtów, więc
+  wystarcza bufor na strlen(word) + 1 znaków (np. tablica na stosie).
+  @param[in] word Słowo w UTF-8.
+  @param[out] wide Bufor na zdekodowane słowo.
+  @return Liczba znaków słowa lub (size_t) -1, jeśli słowo jest błędnie
+  zakodowane.
+  */
+static inline size_t utf8_to_wide(const char *word, wchar_t *wide)
+{
+    size_t length = 0;
+
+    while (*word != '\0')
+    {
+        size_t n = utf8_decode(word, &wide[length]);
+        if (n == 0) return (size_t) -1;
+        word += n;
+        length++;
+    }
+
+    wide[length] = L'\0';
+    return length;
+}
+
+/**
+  Zwraca liczbę bajtów słowa zakodowanego w UTF-8.
+  @param[in] word Słowo.
+  @return Liczba bajtów bez bajtu zerowego lub (size_t) -1, jeśli słowo
+  zawiera znak spoza Unicode.
+  */
+static inline size_t utf8_length(const wchar_t *word)
+{
+    size_t length = 0;
+    char bytes[UTF8_MAX_BYTES];
+
+    for (; *word != L'\0'; word++)
+    {
+        size_t n = utf8_encode(*word, bytes);
+        if (n == 0) return (size_t) -1;
+        length += n;
+    }
+
+    return length;
+}
+
+#endif /* __UTF8_H__ */
@@ -0,0 +1,104 @@
+/** @file
+    Testy kodowania UTF-8.
+
+    @ingroup dictionary
+    @author agent <agent@local>
+    @copyright Uniwerstet Warszawski
+    @date 2026-10-19
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <cmocka.h>
+#include <string.h>
+#include "utf8.h"
+#include "utils.h"
+
+/**
+  Testuje kodowanie i dekodowanie znaków o różnej liczbie bajtów.
+  @param state Środowisko testowe.
+  */
+static void utf8_encode_decode_test(void** state)
+{
+    const wchar_t chars[] = {L'a', 0x7F, 0x80, L'ż', 0x7FF, 0x800, L'一',
+                             0xD7FF, 0xE000, 0xFFFF, 0x10000, 0x10FFFF};
+    const size_t lengths[] = {1, 1, 2, 2, 2, 3, 3, 3, 3, 3, 4, 4};
+
+    for (size_t i = 0; i < sizeof(chars) / sizeof(chars[0]); i++)
+    {
+        char bytes[UTF8_MAX_BYTES + 1];
+        wchar_t c;
+
+        assert_int_equal(utf8_encode(chars[i], bytes), lengths[i]);
+        bytes[lengths[i]] = '\0';
+        assert_int_equal(utf8_decode(bytes, &c), lengths[i]);
+        assert_int_equal(c, chars[i]);
+    }
+
+    char bytes[UTF8_MAX_BYTES];
+    assert_int_equal(utf8_encode(0xD800, bytes), 0);
+    assert_int_equal(utf8_encode(0x110000, bytes), 0);
+}
+
+/**
+  Testuje odrzucanie błędnych zapisów.
+  @param state Środowisko testowe.
+  */
+static void utf8_invalid_test(void** state)
+{
+    const char *invalid[] = {
+        "\x80",             // Bajt kontynuacji na początku.
+        "\xC0\xAF",         // Nadmiarowo długi zapis '/'.
+        "\xE0\x80\xAF",     // Nadmiarowo długi zapis '/'.
+        "\xED\xA0\x80",     // Surogat.
+        "\xF4\x90\x80\x80", // Znak spoza Unicode.
+        "\xF8\x88\x80\x80", // Zbyt długa sekwencja.
+        "\xC5",             // Urwana sekwencja.
+        "\xE4\xB8",         // Urwana sekwencja.
+        "\xC5z",            // Brak bajtu kontynuacji.
+    };
+
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+    {
+        wchar_t c;
+        assert_int_equal(utf8_decode(invalid[i], &c), 0);
+    }
+}
+
+/**
+  Testuje dekodowanie słów i wyznaczanie ich długości.
+  @param state Środowisko testowe.
+  */
+static void utf8_word_test(void** state)
+{
+    const char *word = "żółw一";
+    wchar_t wide[strlen(word) + 1];
+
+    assert_int_equal(utf8_to_wide(word, wide), 5);
+    assert_true(wcscmp(wide, L"żółw一") == 0);
+    assert_int_equal(utf8_length(wide), strlen(word));
+
+    assert_int_equal(utf8_to_wide("", wide), 0);
+    assert_true(wide[0] == L'\0');
+    assert_int_equal(utf8_length(L""), 0);
+
+    assert_int_equal(utf8_to_wide("ko\xC5", wide), (size_t) -1);
+    assert_int_equal(utf8_length(L"ko\xD800t"), (size_t) -1);
+}
+
+/**
+  Główna funkcja uruchamiająca testy.
+  */
+int main(void)
+{
+    const struct CMUnitTest tests[] =
+    {
+        cmocka_unit_test(utf8_encode_decode_test),
+        cmocka_unit_test(utf8_invalid_test),
+        cmocka_unit_test(utf8_word_test),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
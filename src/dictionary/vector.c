@@ -26,6 +26,16 @@
   */
 #define GROWTH_FACTOR 1.5
 
+/**
+  Rozmiar linii pamięci podręcznej procesora.
+  */
+#define CACHE_LINE 64
+
+/**
+  Maksymalna liczba bajtów tablicy elementów wczytywanych z wyprzedzeniem.
+  */
+#define PREFETCH_BYTES (4 * CACHE_LINE)
+
 /**
   Struktura przechowująca wektor.
   */
@@ -187,6 +197,12 @@ void * vector_get_by_index(const Vector *vector, const int index)
     return vector->data[index];
 }
 
+void vector_set(Vector *vector, const int index, void *el)
+{
+    assert(index >= 0 && index < vector->size);
+    vector->data[index] = el;
+}
+
 void vector_sort(Vector *vector, vector_cmp_func cmp)
 {
     qsort(vector->data, vector->size, sizeof(void*), cmp);
@@ -197,4 +213,15 @@ const size_t vector_size(const Vector *vector)
     return vector->size;
 }
 
+void vector_prefetch(const Vector *vector)
+{
+    size_t bytes = vector->size * sizeof(void*);
+    if (bytes > PREFETCH_BYTES) bytes = PREFETCH_BYTES;
+
+    for (size_t i = 0; i < bytes; i += CACHE_LINE)
+    {
+        __builtin_prefetch((const char *) vector->data + i);
+    }
+}
+
 /**@}*/
@@ -78,6 +78,14 @@ void vector_clear(Vector *vector);
   */
 void * vector_get_by_index(const Vector *vector, const int index);
 
+/**
+  Zastępuje element o danym indeksie, nie zwalniając poprzedniego.
+  @param[in,out] vector Wektor.
+  @param[in] index Indeks.
+  @param[in] el Nowy element.
+  */
+void vector_set(Vector *vector, const int index, void *el);
+
 /**
   Sortuje elementy wektora. *
   @param vector Wektor.
@@ -92,4 +100,11 @@ void vector_sort(Vector *vector, vector_cmp_func cmp);
   */
 const size_t vector_size(const Vector *vector);
 
+/**
+  Zleca wczytanie z wyprzedzeniem tablicy elementów wektora do pamięci
+  podręcznej procesora. Sam wektor powinien już tam być.
+  @param[in] vector Wektor.
+  */
+void vector_prefetch(const Vector *vector);
+
 #endif /* __VECTOR_H__ */
@@ -9,9 +9,11 @@
  */
 
 #include "word_list.h"
+#include "utf8.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <stddef.h>
+#include <string.h>
 
 /**
   Początkowa pojemność.
@@ -132,6 +134,57 @@ static int word_compare(const void *a, const void *b)
     return wcscoll(_a, _b);
 }
 
+/*
+ Zwiększa pojemność listy w UTF-8, jeśli nie starczyłoby jej na dodanie
+ słowa o danej liczbie bajtów (z bajtem zerowym).
+ */
+static void utf8_increase_capacity_if_needed(struct utf8_word_list *list,
+                                             const size_t next_word_length)
+{
+    if (list->size == list->capacity)
+    {
+        size_t new_capacity = (size_t)(list->capacity * GROWTH_FACTOR + 1);
+        void *new_data = realloc(list->array, sizeof(char*) * new_capacity);
+        if (!new_data)
+        {
+            fprintf(stderr, "Failed to reallocate memory for word list\n");
+            exit(EXIT_FAILURE);
+        }
+
+        list->array = new_data;
+        list->capacity = new_capacity;
+    }
+
+    size_t new_capacity = list->buffer_capacity;
+    while (list->buffer_size + next_word_length >= new_capacity)
+        new_capacity = (size_t)(new_capacity * GROWTH_FACTOR + 1);
+
+    if (new_capacity != list->buffer_capacity)
+    {
+        char *new_data = realloc(list->buffer, new_capacity);
+        if (!new_data)
+        {
+            fprintf(stderr,
+                    "Failed to reallocate memory for word list buffer\n");
+            exit(EXIT_FAILURE);
+        }
+
+        for (size_t i = 0; i < list->size; i++)
+            list->array[i] = new_data + (list->array[i] - list->buffer);
+
+        list->buffer = new_data;
+        list->buffer_capacity = new_capacity;
+    }
+}
+
+/*
+ Porównuje słowa w UTF-8, uwzględniając locale.
+ */
+static int utf8_word_compare(const void *a, const void *b)
+{
+    return strcoll(*(const char**)a, *(const char**)b);
+}
+
 /**@}*/
 /** @name Elementy interfejsu
    @{
@@ -179,4 +232,62 @@ void word_list_sort(struct word_list *list)
     qsort(list->array, list->size, sizeof(wchar_t*), word_compare);
 }
 
+void utf8_word_list_init(struct utf8_word_list *list)
+{
+    list->size = 0;
+    list->capacity = MINIMAL_CAPACITY;
+    list->array = malloc(sizeof(char*) * list->capacity);
+
+    list->buffer_size = 0;
+    list->buffer_capacity = MINIMAL_BUFFER_CAPACITY;
+    list->buffer = malloc(list->buffer_capacity);
+
+    if (!list->array || !list->buffer)
+    {
+        fprintf(stderr, "Failed to allocate memory for word_list\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void utf8_word_list_done(struct utf8_word_list *list)
+{
+    free(list->array);
+    free(list->buffer);
+}
+
+int utf8_word_list_add(struct utf8_word_list *list, const char *word)
+{
+    size_t len = strlen(word) + 1;
+
+    utf8_increase_capacity_if_needed(list, len);
+
+    char *pos = list->buffer + list->buffer_size;
+    list->array[list->size++] = pos;
+    memcpy(pos, word, len);
+    list->buffer_size += len;
+
+    return 1;
+}
+
+int utf8_word_list_add_wide(struct utf8_word_list *list, const wchar_t *word)
+{
+    size_t len = utf8_length(word);
+    if (len == (size_t) -1) return 0;
+
+    utf8_increase_capacity_if_needed(list, len + 1);
+
+    char *pos = list->buffer + list->buffer_size;
+    list->array[list->size++] = pos;
+    for (; *word != L'\0'; word++) pos += utf8_encode(*word, pos);
+    *pos = '\0';
+    list->buffer_size += len + 1;
+
+    return 1;
+}
+
+void utf8_word_list_sort(struct utf8_word_list *list)
+{
+    qsort(list->array, list->size, sizeof(char*), utf8_word_compare);
+}
+
 /**@}*/
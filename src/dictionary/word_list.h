@@ -34,6 +34,27 @@ struct word_list
     wchar_t *buffer;
 };
 
+/**
+  Struktura przechowująca listę słów zakodowanych w UTF-8.
+  Litery alfabetów łacińskich zajmują w niej 1-2 bajty zamiast
+  sizeof(wchar_t). Należy używać funkcji operujących na strukturze.
+  */
+struct utf8_word_list
+{
+    /// Liczba słów.
+    size_t size;
+    /// Pojemność listy słów
+    size_t capacity;
+    /// Łączna liczba bajtów.
+    size_t buffer_size;
+    /// Pojemność bufora
+    size_t buffer_capacity;
+    /// Tablica słów.
+    const char **array;
+    /// Bufor, w którym pamiętane są słowa.
+    char *buffer;
+};
+
 /**
   Inicjuje listę słów.
   @param[in,out] list Lista słów.
@@ -82,4 +103,60 @@ const wchar_t * const * word_list_get(const struct word_list *list)
     return list->array;
 }
 
+/**
+  Inicjuje listę słów w UTF-8.
+  @param[in,out] list Lista słów.
+  */
+void utf8_word_list_init(struct utf8_word_list *list);
+
+/**
+  Destrukcja listy słów w UTF-8.
+  @param[in,out] list Lista słów.
+  */
+void utf8_word_list_done(struct utf8_word_list *list);
+
+/**
+  Dodaje słowo w UTF-8 do listy.
+  @param[in,out] list Lista słów.
+  @param[in] word Dodawane słowo.
+  @return 1 jeśli się udało, 0 w p.p.
+  */
+int utf8_word_list_add(struct utf8_word_list *list, const char *word);
+
+/**
+  Koduje słowo w UTF-8 i dodaje je do listy.
+  @param[in,out] list Lista słów.
+  @param[in] word Dodawane słowo.
+  @return 1 jeśli się udało, 0, jeśli słowo zawiera znak spoza Unicode.
+  */
+int utf8_word_list_add_wide(struct utf8_word_list *list, const wchar_t *word);
+
+/**
+  Sortuje listę.
+  @param[in,out] list Lista słów.
+  */
+void utf8_word_list_sort(struct utf8_word_list *list);
+
+/**
+  Zwraca liczę słów w liście w UTF-8.
+  @param[in] list Lista słów.
+  @return Liczba słów w liście.
+  */
+static inline
+size_t utf8_word_list_size(const struct utf8_word_list *list)
+{
+    return list->size;
+}
+
+/**
+  Zwraca tablicę słów w liście w UTF-8.
+  @param[in] list Lista słów.
+  @return Tablica słów.
+  */
+static inline
+const char * const * utf8_word_list_get(const struct utf8_word_list *list)
+{
+    return list->array;
+}
+
 #endif /* __WORD_LIST_H__ */
@@ -173,6 +173,36 @@ static void word_list_auto_resize_test(void **state)
     word_list_done(&l);
 }
 
+/**
+  Testuje listę słów w UTF-8.
+  @param state Środowisko testowe.
+  */
+static void utf8_word_list_test(void **state)
+{
+    struct utf8_word_list l;
+    utf8_word_list_init(&l);
+
+    for (size_t i = 0; i < MINIMAL_CAPACITY + 3; i++)
+    {
+        assert_int_equal(utf8_word_list_add(&l, "żółw"), 1);
+        assert_int_equal(utf8_word_list_add_wide(&l, L"féin"), 1);
+    }
+    assert_int_equal(utf8_word_list_add_wide(&l, L"ko\xD800t"), 0);
+    assert_int_equal(utf8_word_list_size(&l), 2 * (MINIMAL_CAPACITY + 3));
+
+    for (size_t i = 0; i < MINIMAL_CAPACITY + 3; i++)
+    {
+        assert_true(strcmp(utf8_word_list_get(&l)[2 * i], "żółw") == 0);
+        assert_true(strcmp(utf8_word_list_get(&l)[2 * i + 1], "féin") == 0);
+    }
+
+    // Litery zajmują 1-2 bajty zamiast sizeof(wchar_t).
+    size_t bytes = sizeof("żółw") + sizeof("féin");
+    assert_int_equal(l.buffer_size, (MINIMAL_CAPACITY + 3) * bytes);
+
+    utf8_word_list_done(&l);
+}
+
 /**
   Główna funkcja uruchamiająca testy.
   */
@@ -188,6 +218,7 @@ int main(void)
         cmocka_unit_test(word_list_repeat_test),
         cmocka_unit_test(word_list_auto_resize_test),
         cmocka_unit_test(word_list_sort_test),
+        cmocka_unit_test(utf8_word_list_test),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 
 #include "editor.h"
+#include "tokenizer.h"
 
 // gcc editor.c -Wall -o Editor `pkg-config --cflags --libs gtk+-2.0`
 
@@ -39,6 +40,7 @@ int main (int argc, char *argv[]) {
   GtkAccelGroup *accel = NULL;
       
   gtk_init(&argc, &argv);
+  tokenizer_init();
   editor_window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
 
   // If the user quits the app  
@@ -11,6 +11,7 @@
 #include "editor.h"
 #include "word_list.h"
 #include "dictionary.h"
+#include "tokenizer.h"
 
 /**
   Własne wartości zwracane z dialogów
@@ -19,8 +20,10 @@ enum CustomResponseType {
   CUSTOM_RESPONSE_ADD = 1000 // Żeby się nie pokrywało z bibliotecznymi
 };
 
-/// Aktualny słownik
+/// Aktualny słownik (nakładka użytkownika na słownik bazowy)
 static struct dictionary *dict = NULL;
+/// Słownik bazowy aktualnego słownika
+static struct dictionary *base_dict = NULL;
 /// Język aktualnego słownika
 static char *lang = NULL;
 /// Czy sprawdzać pisownię w locie
@@ -35,32 +38,34 @@ static bool select_lang ();
   */
 static void delete_dictionary () {
   if (dict != NULL) dictionary_done(dict);
+  if (base_dict != NULL) dictionary_done(base_dict);
   g_free(lang);
 }
 
 /**
   Podmienia słownik. *
-  @param dictionary Nowy słownik.
+  Dodane słowa trafiają do nakładki i są dopisywane do jej dziennika, więc
+  zapisanie słowa nie przepisuje całego słownika języka.
+  @param new_base Nowy słownik bazowy.
   @param new_lang Nowy język.
+  @return Czy udało się wczytać nakładkę.
   */
-static void swap_dictionary (struct dictionary *new_dict, char *new_lang) {
+static bool swap_dictionary (struct dictionary *new_base, char *new_lang) {
+  struct dictionary *new_dict = dictionary_load_lang_layered(new_base,
+                                                             new_lang);
+  if (!new_dict) {
+    dictionary_done(new_base);
+    g_free(new_lang);
+    return false;
+  }
+
+  dictionary_journal(new_dict, true);
+
   delete_dictionary();
+  base_dict = new_base;
   dict = new_dict;
   lang = new_lang;
-}
-
-/**
-  Zamienia słowo na złożone z małych liter.
-  @param word Modyfikowane słowo.
-  @return 0, jeśli słowo nie jest złożone z samych liter, 1 w p.p.
- */
-int make_lowercase (wchar_t *word) {
-    for (wchar_t *w = word; *w; ++w)
-        if (!iswalpha(*w))
-            return 0;
-        else
-            *w = towlower(*w);
-    return 1;
+  return true;
 }
 
 void show_about () {
@@ -132,23 +137,19 @@ static GtkTextIter get_word_start_iter (GtkTextIter *end) {
 }
 
 /**
-  Zwraca słowo wskazywane przez iterator.
+  Zwraca słowo wskazywane przez iterator, złożone z małych liter.
   @param end Iterator.
-  @return Słowo.
+  @return Słowo w UTF-8, które należy zwolnić przez free().
   */
-static gunichar * get_word (GtkTextIter *end) {
+static char * get_word (GtkTextIter *end) {
   GtkTextIter start = get_word_start_iter(end);
-  char *word;
-  gunichar *wword;
+  char *word, *folded;
 
   word = gtk_text_iter_get_text(&start, end);
-
-  wword = g_utf8_to_ucs4_fast(word, -1, NULL);
+  tokenizer_fold_word_utf8(word, &folded);
   g_free(word);
 
-  make_lowercase((wchar_t *)wword);
-
-  return wword;
+  return folded;
 }
 
 /**
@@ -189,7 +190,7 @@ static void clear_all_highlighted () {
   @param end Iterator.
   */
 static void check_on_iter (GtkTextIter *end) {
-  gunichar *wword;
+  char *word;
 
   if (dict == NULL) {
     if (!select_lang()) {
@@ -199,15 +200,15 @@ static void check_on_iter (GtkTextIter *end) {
   }
 
   if (is_on_word(end)) {
-    wword = get_word(end);
+    word = get_word(end);
 
     clear_highlight(end);
 
-    if (!dictionary_find(dict, (wchar_t *)wword)) {
+    if (!dictionary_find_utf8(dict, word)) {
       highlight(end);
     }
 
-    g_free(wword);
+    free(word);
   }
 }
 
@@ -276,8 +277,9 @@ static bool add_lang () {
       error_dialog("Nie udało się stworzyć słownika dla nowego języka");
       dictionary_done(new_dict);
       g_free(new_lang);
+    } else if (!swap_dictionary(new_dict, new_lang)) {
+      error_dialog("Nie udało się stworzyć słownika dla nowego języka");
     } else {
-      swap_dictionary(new_dict, new_lang);
       ret = true;
     }
   }
@@ -340,8 +342,9 @@ static bool select_lang () {
     if (!new_dict) {
       error_dialog("Nie udało się wczytać słownika dla wybranego języka.");
       g_free(new_lang);
+    } else if (!swap_dictionary(new_dict, new_lang)) {
+      error_dialog("Nie udało się wczytać słów dodanych do słownika.");
     } else {
-      swap_dictionary(new_dict, new_lang);
       ret = true;
     }
   } else if (response == CUSTOM_RESPONSE_ADD) {
@@ -364,8 +367,8 @@ static bool select_lang () {
   @param word Słowo.
   @return Czy udało się zapisać.
   */
-static bool add_word (wchar_t *word) {
-  dictionary_insert(dict, word);
+static bool add_word (const char *word) {
+  dictionary_insert_utf8(dict, word);
 
   if (dictionary_save_lang(dict, lang) < 0) {
     error_dialog("Nie udało się zapisać słowa");
@@ -384,7 +387,7 @@ static bool add_word (wchar_t *word) {
 static void check_word (GtkMenuItem *item, gpointer data) {
   GtkWidget *dialog;
   GtkTextIter start, end;
-  gunichar *wword;
+  char *word;
 
   // Znajdujemy pozycję kursora
   gtk_text_buffer_get_iter_at_mark(editor_buf, &end,
@@ -403,11 +406,11 @@ static void check_word (GtkMenuItem *item, gpointer data) {
     };
   }
 
-  wword = get_word(&end);
+  word = get_word(&end);
   start = get_word_start_iter(&end);
 
   // Sprawdzamy
-  if (dictionary_find(dict, (wchar_t *)wword)) {
+  if (dictionary_find_utf8(dict, word)) {
     dialog = gtk_message_dialog_new(NULL, 0, GTK_MESSAGE_INFO, GTK_BUTTONS_OK,
                                     "Wszystko w porządku,\nśpij spokojnie");
     gtk_dialog_run(GTK_DIALOG(dialog));
@@ -416,15 +419,15 @@ static void check_word (GtkMenuItem *item, gpointer data) {
   else {
     // Czas korekty
     GtkWidget *vbox, *label, *combo;
-    struct word_list hints;
+    struct utf8_word_list hints;
     int i;
-    const wchar_t * const * words;
+    const char * const * words;
 
-    dictionary_hints(dict, (wchar_t *)wword, &hints);
-    words = word_list_get(&hints);
+    dictionary_hints_utf8(dict, word, &hints);
+    words = utf8_word_list_get(&hints);
 
     // Tekst
-    if (word_list_size(&hints) == 0) {
+    if (utf8_word_list_size(&hints) == 0) {
       dialog = gtk_dialog_new_with_buttons("Korekta", NULL, 0,
                                            GTK_STOCK_OK,
                                            CUSTOM_RESPONSE_ADD,
@@ -455,20 +458,16 @@ static void check_word (GtkMenuItem *item, gpointer data) {
 
       // Spuszczane menu
       combo = gtk_combo_box_text_new();
-      for (i = 0; i < word_list_size(&hints); i++) {
-        // Combo box lubi mieć Gtk
-        char *uword = g_ucs4_to_utf8((gunichar *)words[i], -1, NULL, NULL, NULL);
-
-        // Dodajemy kolejny element
-        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(combo), uword);
-        g_free(uword);
+      for (i = 0; i < utf8_word_list_size(&hints); i++) {
+        // Podpowiedzi są już w UTF-8, jak lubi Gtk
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(combo), words[i]);
       }
       gtk_combo_box_set_active(GTK_COMBO_BOX(combo), 0);
       gtk_box_pack_start(GTK_BOX(vbox), combo, FALSE, FALSE, 1);
       gtk_widget_show(combo);
     }
 
-    word_list_done(&hints);
+    utf8_word_list_done(&hints);
 
     int response = gtk_dialog_run(GTK_DIALOG(dialog));
     if (response == GTK_RESPONSE_ACCEPT) {
@@ -481,11 +480,11 @@ static void check_word (GtkMenuItem *item, gpointer data) {
       gtk_text_buffer_insert(editor_buf, &start, korekta, -1);
       g_free(korekta);
     } else if (response == CUSTOM_RESPONSE_ADD) {
-      add_word((wchar_t *)wword);
+      add_word(word);
     }
     gtk_widget_destroy(dialog);
   }
-  g_free(wword);
+  free(word);
 }
 
 /**
@@ -11,6 +11,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 
 /**
   Struktura przechowująca we/wy.
@@ -19,6 +20,16 @@ struct io
 {
     /// Wejście
     FILE *in;
+    /// Bufor wejścia, jeśli wejście nie jest strumieniem
+    const char *buf;
+    /// Długość bufora wejścia
+    size_t buf_len;
+    /// Pozycja w buforze wejścia
+    size_t buf_pos;
+    /// Stan dekodowania bufora wejścia
+    mbstate_t buf_state;
+    /// Czy w buforze wejścia napotkano niepoprawny znak
+    bool buf_error;
     /// Wyjście
     FILE *out;
     /// Wyjście błędów
@@ -30,6 +41,48 @@ struct io
     size_t n_line;
 };
 
+/** @name Funkcje pomocnicze
+  @{
+  */
+
+/**
+  Zwraca następny znak z bufora wejścia.
+  Tak jak przy strumieniu, po napotkaniu niepoprawnego znaku każde kolejne
+  czytanie kończy się błędem.
+  @param[in,out] io We/wy.
+  @param[in] consume Czy zdjąć znak z wejścia.
+  @return Znak lub WEOF na końcu bufora bądź przy błędzie.
+  */
+static wint_t buffer_next(IO *io, bool consume)
+{
+    if (io->buf_pos == io->buf_len) return WEOF;
+
+    wchar_t c;
+    mbstate_t state = io->buf_state;
+    size_t n = mbrtowc(&c, io->buf + io->buf_pos,
+                       io->buf_len - io->buf_pos, &state);
+
+    // Jak przy strumieniu, niepełny znak na końcu wejścia kończy wejście.
+    if (n == (size_t) -2) return WEOF;
+
+    if (n == (size_t) -1)
+    {
+        io_eprintf(io, L"Failed to read\n");
+        io->buf_error = true;
+        return WEOF;
+    }
+
+    if (consume)
+    {
+        io->buf_pos += (n == 0 ? 1 : n);
+        io->buf_state = state;
+    }
+
+    return c;
+}
+
+/**@}*/
+
 /** @name Elementy interfejsu
   @{
   */
@@ -41,6 +94,8 @@ IO * io_new(FILE *in, FILE *out, FILE *err)
     io->in = in;
     io->out = out;
     io->err = err;
+    io->buf = NULL;
+    io->buf_len = io->buf_pos = 0;
 
     io->n_char = 1;
     io->n_line = 1;
@@ -48,6 +103,18 @@ IO * io_new(FILE *in, FILE *out, FILE *err)
     return io;
 }
 
+IO * io_new_buffer(const char *in, size_t in_len, FILE *out, FILE *err)
+{
+    IO *io = io_new(NULL, out, err);
+
+    io->buf = in;
+    io->buf_len = in_len;
+    io->buf_error = false;
+    memset(&io->buf_state, 0, sizeof(mbstate_t));
+
+    return io;
+}
+
 void io_done(IO *io)
 {
     free(io);
@@ -55,6 +122,18 @@ void io_done(IO *io)
 
 wint_t io_get_next(IO *io)
 {
+    if (io->in == NULL)
+    {
+        wint_t c = buffer_next(io, true);
+        io->n_char = io->n_char + 1;
+        if (c == L'\n')
+        {
+            io->n_char = 1;
+            io->n_line = io->n_line + 1;
+        }
+        return c;
+    }
+
     wint_t c = fgetwc(io->in);
 
     io->n_char = io->n_char + 1;
@@ -74,6 +153,8 @@ wint_t io_get_next(IO *io)
 
 wint_t io_peek_next(IO *io)
 {
+    if (io->in == NULL) return buffer_next(io, false);
+
     wint_t c = fgetwc(io->in);
 
     if (ferror(io->in))
@@ -118,4 +199,14 @@ size_t io_get_n_line(IO *io)
     return io->n_line;
 }
 
+void io_set_n_line(IO *io, size_t n_line)
+{
+    io->n_line = n_line;
+}
+
+bool io_error(IO *io)
+{
+    return io->in != NULL ? ferror(io->in) : io->buf_error;
+}
+
 /**@}*/
@@ -38,6 +38,18 @@ IO * io_new();
   */
 IO * io_new(FILE *in, FILE *out, FILE *err);
 
+/**
+  Tworzy nowe we/wy czytające z bufora w pamięci.
+  Bufor zawiera tekst wielobajtowy w kodowaniu bieżącego locale, jak plik
+  czytany przez io_new(). Bufor musi istnieć aż do zniszczenia we/wy.
+  @param[in] in Bufor wejścia.
+  @param[in] in_len Długość bufora w bajtach.
+  @param[in] out Strumień wyjścia.
+  @param[in] err Strumień wyjścia błędów.
+  @return Nowe we/wy.
+  */
+IO * io_new_buffer(const char *in, size_t in_len, FILE *out, FILE *err);
+
 /**
   Destrukcja we/wy.
   @param[in,out] io We/wy.
@@ -84,4 +96,19 @@ size_t io_get_n_char(IO *io);
   */
 size_t io_get_n_line(IO *io);
 
+/**
+  Ustawia numer linii, w której znajduje się "kursor".
+  Pozwala przetwarzać fragment wejścia zaczynający się w danej linii.
+  @param[in,out] io We/wy.
+  @param[in] n_line Numer linii.
+  */
+void io_set_n_line(IO *io, size_t n_line);
+
+/**
+  Stwierdza, czy wystąpił błąd odczytu wejścia.
+  @param[in] io We/wy.
+  @return Czy wystąpił błąd.
+  */
+bool io_error(IO *io);
+
 #endif /* __IO_H__ */
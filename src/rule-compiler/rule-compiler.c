@@ -0,0 +1,317 @@
+/** @defgroup rule-compiler Moduł rule-compiler
+    Program generuje kod C wyspecjalizowany dla zestawu reguł słownika.
+  */
+/** @file
+    Główny plik modułu rule-compiler
+
+    Program wczytuje słownik zapisany przez dictionary_save() i dla jego reguł
+    (zapisanych w formacie rule_save()) generuje plik źródłowy definiujący
+    symbol `compiled_rule_set` (patrz compiled_rules.h). Dla każdej reguły
+    porównania liter i równości zmiennych są rozwinięte w kod, więc generator
+    podpowiedzi nie musi interpretować reguły przy każdym zastosowaniu.
+
+    Użycie: `rule-compiler słownik plik_wyjściowy.c`
+    @ingroup rule-compiler
+    @author agent <agent@local>
+    @date 2026-10-19
+    @copyright Uniwersytet Warszawski
+  */
+
+#include "dictionary.h"
+#include "hints_generator.h"
+#include "rule.h"
+#include <inttypes.h>
+#include <locale.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <wchar.h>
+
+/**
+  Liczba zmiennych w regułach.
+  */
+#define N_VARS 10
+
+/**
+  Sprawdza, czy znak jest zmienną (cyfrą dziesiętną).
+  @param[in] wc Znak.
+  @return Czy znak jest zmienną.
+  */
+static bool is_var(wchar_t wc)
+{
+    return wc >= L'0' && wc <= L'9';
+}
+
+/**
+  Zwraca numer zmiennej występującej tylko po prawej stronie reguły.
+  @param[in] rule Reguła.
+  @param[out] n_free Liczba różnych takich zmiennych.
+  @return Numer zmiennej lub -1, jeśli nie ma takiej zmiennej.
+  */
+static int free_var(const Rule *rule, int *n_free)
+{
+    bool in_left[N_VARS] = { false };
+    bool counted[N_VARS] = { false };
+    int ret = -1;
+
+    *n_free = 0;
+
+    for (const wchar_t *c = rule_get_left(rule); *c; c++)
+    {
+        if (is_var(*c)) in_left[*c - L'0'] = true;
+    }
+
+    for (const wchar_t *c = rule_get_right(rule); *c; c++)
+    {
+        if (is_var(*c) && !in_left[*c - L'0'] && !counted[*c - L'0'])
+        {
+            counted[*c - L'0'] = true;
+            ret = *c - L'0';
+            (*n_free)++;
+        }
+    }
+
+    return ret;
+}
+
+/**
+  Wypisuje wyrażenie oznaczające znak lub wartość zmiennej.
+  @param[in,out] out Plik wyjściowy.
+  @param[in] wc Znak z reguły.
+  @param[in] free_index Numer zmiennej wolnej.
+  */
+static void emit_char(FILE *out, wchar_t wc, int free_index)
+{
+    if (!is_var(wc)) fprintf(out, "0x%" PRIx32, (uint32_t) wc);
+    else if (wc - L'0' == free_index) fprintf(out, "var");
+    else fprintf(out, "vars[%d]", wc - L'0');
+}
+
+/**
+  Generuje funkcję dopasowującą lewą stronę reguły.
+  @param[in,out] out Plik wyjściowy.
+  @param[in] rule Reguła.
+  @param[in] index Numer reguły.
+  */
+static void emit_match(FILE *out, const Rule *rule, size_t index)
+{
+    bool bound[N_VARS] = { false };
+    const wchar_t *left = rule_get_left(rule);
+
+    fprintf(out, "/* %ls -> %ls */\n", left, rule_get_right(rule));
+    fprintf(out, "static bool match_%zu(const wchar_t *word, wchar_t *vars)\n"
+                 "{\n", index);
+    fprintf(out, "    for (size_t i = 0; i < %d; i++) vars[i] = L'\\0';\n",
+            N_VARS);
+
+    for (size_t i = 0; left[i]; i++)
+    {
+        if (!is_var(left[i]))
+        {
+            fprintf(out, "    if (word[%zu] != 0x%" PRIx32 ") return false;\n",
+                    i, (uint32_t) left[i]);
+        }
+        else if (!bound[left[i] - L'0'])
+        {
+            bound[left[i] - L'0'] = true;
+            fprintf(out, "    vars[%d] = word[%zu];\n", left[i] - L'0', i);
+        }
+        else
+        {
+            fprintf(out, "    if (word[%zu] != vars[%d]) return false;\n",
+                    i, left[i] - L'0');
+        }
+    }
+
+    fprintf(out, "    return true;\n}\n\n");
+}
+
+/**
+  Generuje krok przejścia w drzewie dla fragmentu prawej strony.
+  Ciąg liter jest przechodzony jednym wywołaniem node_get_descendant().
+  @param[in,out] out Plik wyjściowy.
+  @param[in] right Prawa strona reguły od bieżącej pozycji.
+  @param[in] free_index Numer zmiennej wolnej lub -1.
+  @param[in] var Nazwa zmiennej z bieżącym węzłem.
+  @param[in] fail Instrukcja wykonywana, gdy ścieżka nie istnieje.
+  @param[in] indent Wcięcie.
+  @return Liczba przetworzonych znaków prawej strony.
+  */
+static size_t emit_step(FILE *out, const wchar_t *right, int free_index,
+                        const char *var, const char *fail, int indent)
+{
+    size_t len = 0;
+    while (right[len] && !is_var(right[len])) len++;
+
+    fprintf(out, "%*sif ((%s = ", indent, "", var);
+
+    if (len <= 1)
+    {
+        fprintf(out, "node_get_child(%s, ", var);
+        emit_char(out, right[0], free_index);
+        fprintf(out, ")) == NULL) %s;\n", fail);
+        return 1;
+    }
+
+    fprintf(out, "node_get_descendant(%s, (const wchar_t[]){ ", var);
+    for (size_t i = 0; i < len; i++)
+    {
+        if (i > 0) fprintf(out, ", ");
+        emit_char(out, right[i], free_index);
+    }
+    fprintf(out, " }, %zu)) == NULL) %s;\n", len, fail);
+
+    return len;
+}
+
+/**
+  Generuje funkcję stosującą prawą stronę reguły.
+  @param[in,out] out Plik wyjściowy.
+  @param[in] rule Reguła.
+  @param[in] index Numer reguły.
+  @param[in] free_index Numer zmiennej wolnej lub -1.
+  */
+static void emit_apply(FILE *out, const Rule *rule, size_t index,
+                       int free_index)
+{
+    const wchar_t *right = rule_get_right(rule);
+    size_t i = 0;
+
+    fprintf(out, "static void apply_%zu(const wchar_t *vars, Node *node, "
+                 "Vector *nodes)\n{\n", index);
+
+    while (right[i] && right[i] != L'0' + free_index)
+    {
+        i += emit_step(out, right + i, free_index, "node", "return", 4);
+    }
+
+    if (free_index == -1)
+    {
+        fprintf(out, "    vector_push_back(nodes, node);\n}\n\n");
+        return;
+    }
+
+    fprintf(out, "    for (int i = 0; i < node_children_count(node); i++)\n"
+                 "    {\n"
+                 "        Node *tmp = node_get_child_by_index(node, i);\n");
+
+    if (wcschr(right + i + 1, L'0' + free_index) != NULL)
+    {
+        fprintf(out, "        const wchar_t var = node_get_key(tmp);\n");
+    }
+
+    for (i++; right[i];)
+    {
+        i += emit_step(out, right + i, free_index, "tmp", "continue", 8);
+    }
+
+    fprintf(out, "        vector_push_back(nodes, tmp);\n    }\n}\n\n");
+}
+
+/**
+  Generuje plik źródłowy dla zestawu reguł.
+  @param[in,out] out Plik wyjściowy.
+  @param[in] gen Generator podpowiedzi z wczytanymi regułami.
+  */
+static void emit_rule_set(FILE *out, const Hints_Generator *gen)
+{
+    size_t n_rules = hints_generator_rule_count(gen);
+    bool compiled[n_rules + 1];
+
+    fprintf(out, "/* Plik wygenerowany przez rule-compiler, nie edytować. */\n"
+                 "\n"
+                 "#include \"compiled_rules.h\"\n"
+                 "\n");
+
+    for (size_t i = 0; i < n_rules; i++)
+    {
+        const Rule *rule = hints_generator_rule_get(gen, i);
+        int n_free;
+        int free_index = free_var(rule, &n_free);
+
+        // Reguły niezgodne z założeniami pozostają interpretowane.
+        compiled[i] = (n_free <= 1);
+        if (!compiled[i]) continue;
+
+        emit_match(out, rule, i);
+        emit_apply(out, rule, i, free_index);
+    }
+
+    fprintf(out, "static const Compiled_Rule rules[] =\n{\n");
+    for (size_t i = 0; i < n_rules; i++)
+    {
+        if (compiled[i]) fprintf(out, "    { match_%zu, apply_%zu },\n", i, i);
+        else fprintf(out, "    { NULL, NULL },\n");
+    }
+    if (n_rules == 0) fprintf(out, "    { NULL, NULL },\n");
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "const Compiled_Rule_Set compiled_rule_set =\n"
+                 "{\n"
+                 "    0x%016" PRIx64 "ULL,\n"
+                 "    %zu,\n"
+                 "    rules\n"
+                 "};\n",
+            hints_generator_fingerprint(gen), n_rules);
+}
+
+/**
+  Wczytuje słownik z regułami.
+  Cały plik jest wczytywany przez dictionary_load(), więc reguły są
+  znajdowane za wszystkimi zapisanymi przed nimi częściami słownika
+  (alfabetem, drzewem i indeksem wyszukiwania dokładnego).
+  @param[in] filename Nazwa pliku słownika.
+  @return Słownik.
+  */
+static struct dictionary * load_rules(const char *filename)
+{
+    FILE *f = fopen(filename, "r");
+    if (!f)
+    {
+        fprintf(stderr, "Failed to open dictionary file %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+
+    struct dictionary *dict = dictionary_load(f);
+    fclose(f);
+
+    if (dict == NULL)
+    {
+        fprintf(stderr, "Failed to load rules from file %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+
+    return dict;
+}
+
+/**
+  Funkcja main.
+  Główna funkcja generatora kodu reguł.
+ */
+int main(int argc, char *argv[])
+{
+    setlocale(LC_ALL, "pl_PL.UTF-8");
+
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: %s dictionary output.c\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    struct dictionary *dict = load_rules(argv[1]);
+
+    FILE *out = fopen(argv[2], "w");
+    if (!out)
+    {
+        fprintf(stderr, "Failed to open output file %s\n", argv[2]);
+        dictionary_done(dict);
+        return EXIT_FAILURE;
+    }
+
+    emit_rule_set(out, dictionary_get_hints_generator(dict));
+
+    fclose(out);
+    dictionary_done(dict);
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+checker=$1
+status=0
+
+# dłuższe wejście, dzielone przy -j i w trybie wielu plików na fragmenty
+for i in 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20; do
+    cat test0.in
+done > test4.m.in
+inputs="test0.in test1.in test2.in test3.in test4.m.in"
+
+# porównuje wynik trybu z wynikiem sprawdzania po kolei
+compare() {
+    if ! cmp -s $1.m.ref.out $1.m.out || ! cmp -s $1.m.ref.err $1.m.err \
+        || [ "$(cat $1.m.ref.status)" != "$3" ]; then
+        echo "$1: $2 differs from sequential check"
+        status=1
+    fi
+}
+
+# wynik sprawdzania po kolei (wejście z potoku)
+for f in $inputs; do
+    cat $f | $checker -v dict.txt > $f.m.ref.out 2> $f.m.ref.err
+    echo $? > $f.m.ref.status
+done
+
+for f in $inputs; do
+    $checker -v dict.txt < $f > $f.m.out 2> $f.m.err
+    compare $f "mmap" $?
+
+    $checker -v -j 3 dict.txt < $f > $f.m.out 2> $f.m.err
+    compare $f "-j 3" $?
+
+    cat $f | $checker -v -j 3 dict.txt > $f.m.out 2> $f.m.err
+    compare $f "-j 3 from pipe" $?
+
+    # statystyki są dopisywane na koniec wyjścia błędów
+    $checker -v --stats dict.txt < $f > $f.m.out 2> $f.m.stats
+    s=$?
+    head -c $(wc -c < $f.m.ref.err) $f.m.stats > $f.m.err
+    if [ "$(cat $f.m.ref.status)" = 0 ]; then
+        tail -c +$(($(wc -c < $f.m.ref.err) + 1)) $f.m.stats \
+            | grep -q "^token cache: " || s=-1
+    fi
+    compare $f "--stats" $s
+done
+
+$checker --freeze frozen.m.txt dict.txt
+for f in $inputs; do
+    $checker -v frozen.m.txt < $f > $f.m.out 2> $f.m.err
+    compare $f "--freeze" $?
+done
+
+# bez podpowiedzi, bo obraz ich nie udostępnia
+$checker --publish image.m.img dict.txt
+for f in $inputs; do
+    cat $f | $checker dict.txt > $f.m.ref.out 2> $f.m.ref.err
+    echo $? > $f.m.ref.status
+    $checker --image image.m.img < $f > $f.m.out 2> $f.m.err
+    compare $f "--image" $?
+done
+
+for f in $inputs; do
+    cat $f | $checker -v dict.txt > $f.m.ref.out 2> $f.m.ref.err
+    echo $? > $f.m.ref.status
+done
+
+rm -f daemon.m.sock
+$checker --daemon daemon.m.sock dict.txt &
+daemon=$!
+for i in 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20; do
+    $checker --connect daemon.m.sock < /dev/null 2> /dev/null && break
+    sleep 0.5
+done
+for f in $inputs; do
+    $checker -v --connect daemon.m.sock < $f > $f.m.out 2> $f.m.err
+    compare $f "--daemon/--connect" $?
+done
+kill $daemon
+wait $daemon 2> /dev/null
+
+# wiele plików: nagłówki na wyjściu i nazwy plików na wyjściu błędów
+$checker -v -j 3 dict.txt $inputs > files.m.out 2> files.m.err
+files_status=$?
+ref_status=0
+for f in $inputs; do
+    printf "==> %s <==\n" $f
+    cat $f.m.ref.out
+done > files.m.ref.out
+for f in $inputs; do
+    sed "s/^/$f:/" $f.m.ref.err
+    [ -z "$(tail -c 1 $f.m.ref.err)" ] || echo
+    [ "$(cat $f.m.ref.status)" = 0 ] || ref_status=1
+done > files.m.ref.err
+echo $ref_status > files.m.ref.status
+compare files "multiple files" $files_status
+
+$checker -v -j 3 --suffix .m.out dict.txt $inputs 2> /dev/null
+for f in $inputs; do
+    [ -f $f.m.out.err ] || touch $f.m.out.err
+    mv $f.m.out.err $f.m.err
+    compare $f "--suffix" "$(cat $f.m.ref.status)"
+done
+
+rm -f *.m.* test4.m.in
+exit $status
@@ -0,0 +1,20 @@
+cmake=$1
+source=$2
+build=$3
+rm -rf $build
+$cmake -S $source -B $build -DRULES_DICTIONARY=$PWD/dict.txt > /dev/null \
+    && $cmake --build $build --target dict-bench > /dev/null || exit 1
+bench=$build/dict-bench/dict-bench
+# odcisk reguł się zgadza, więc reguły wykonuje wygenerowany kod, który musi
+# dawać te same podpowiedzi co interpretowane reguły
+$bench rules dict.txt queries.txt > compiled.m.out
+grep -q "^compiled rules: yes$" compiled.m.out \
+    && grep -q "^queries with different hints: 0$" compiled.m.out
+status=$?
+# inny koszt reguły zmienia odcisk, więc reguły są interpretowane
+sed 's/^a\*\*2\*2$/a**1*2/' dict.txt > other.m.txt
+$bench rules other.m.txt queries.txt > other.m.out
+grep -q "^compiled rules: no$" other.m.out \
+    && grep -q "^queries with different hints: 0$" other.m.out || status=1
+rm -f compiled.m.out other.m.txt other.m.out
+exit $status
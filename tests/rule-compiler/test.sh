@@ -0,0 +1,12 @@
+compiler=$1
+editor=$2
+checker=$3
+$compiler dict.txt plain.m.c
+printf "load dict.txt\nsave saved.m.txt\n" | $editor > /dev/null
+$compiler saved.m.txt saved.m.c
+$checker --freeze frozen.m.txt dict.txt
+$compiler frozen.m.txt frozen.m.c
+cmp plain.m.c saved.m.c && cmp plain.m.c frozen.m.c
+status=$?
+rm -f plain.m.c saved.m.txt saved.m.c frozen.m.txt frozen.m.c
+exit $status